@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <memory>
+
+#include "DatabaseFactory.h"
+#include "FakeDatabase.h"
+
+namespace {
+
+std::unique_ptr<IDatabase> create_fake(const DatabaseConfig&) {
+    return std::make_unique<FakeDatabase>(0);
+}
+
+void register_fake() {
+    static const bool registered = [] {
+        DatabaseFactory::initialize();
+        DatabaseFactory::register_database("fake", create_fake);
+        return true;
+    }();
+    (void)registered;
+}
+
+// Lookup plus std::function call plus allocation of the backend
+void BM_FactoryCreate(benchmark::State& state) {
+    register_fake();
+    const DatabaseConfig config;
+    for (auto _ : state) {
+        auto db = DatabaseFactory::create("fake", config);
+        benchmark::DoNotOptimize(db.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FactoryCreate)->ThreadRange(1, 64)->UseRealTime();
+
+// Same through a handle resolved once, without hashing the type name
+void BM_FactoryCreateHandle(benchmark::State& state) {
+    register_fake();
+    const DatabaseConfig config;
+    const BackendHandle fake = DatabaseFactory::resolve("fake");
+    for (auto _ : state) {
+        auto db = fake.create(config);
+        benchmark::DoNotOptimize(db.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FactoryCreateHandle)->ThreadRange(1, 64)->UseRealTime();
+
+// Creates while the first thread keeps registering another type
+void BM_FactoryCreateWhileRegistering(benchmark::State& state) {
+    register_fake();
+    const DatabaseConfig config;
+    std::size_t count = 0;
+    for (auto _ : state) {
+        if (state.thread_index() == 0 && ++count % 1024 == 0)
+            DatabaseFactory::register_database("fake-churn", create_fake);
+        auto db = DatabaseFactory::create("fake", config);
+        benchmark::DoNotOptimize(db.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FactoryCreateWhileRegistering)->ThreadRange(1, 64)->UseRealTime();
+
+// Real backend construction without connecting
+void BM_FactoryCreatePostgres(benchmark::State& state) {
+    register_fake();
+    DatabaseConfig config;
+    config.database = "bench";
+    for (auto _ : state) {
+        auto db = DatabaseFactory::create("postgresql", config);
+        benchmark::DoNotOptimize(db.get());
+    }
+}
+BENCHMARK(BM_FactoryCreatePostgres);
+
+void BM_FactorySupported(benchmark::State& state) {
+    register_fake();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(DatabaseFactory::supported("postgresql"));
+    }
+}
+BENCHMARK(BM_FactorySupported);
+
+}  // namespace
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CellResult.h"
+#include "IDatabase.h"
+#include "ParamPack.h"
+
+// FakeDatabase class - in-process backend for the pure-CPU benchmarks.
+// exec() returns a prebuilt result of `rows` rows (id, name, score);
+// exec_params() formats every parameter the way a text-protocol driver
+// would and returns one row.
+class FakeDatabase : public IDatabase {
+   public:
+    explicit FakeDatabase(std::size_t rows = 100) : _connected(false) {
+        _result = std::make_unique<CellResult>(
+            std::vector<std::string>{"id", "name", "score"});
+        std::vector<Param> row(3);
+        for (std::size_t i = 0; i < rows; ++i) {
+            row[0] = Param(static_cast<std::int64_t>(i));
+            row[1] = Param("name-" + std::to_string(i));
+            row[2] = Param(i * 0.5);
+            _result->append(row);
+        }
+        _result->finish(0, 0);
+    }
+
+    std::string connection_info() const noexcept override {
+        return "Fake Database";
+    }
+
+    bool connected() const noexcept override { return _connected; }
+
+    void connect() override { _connected = true; }
+
+    void disconnect() override { _connected = false; }
+
+    std::unique_ptr<IResult> exec(const std::string& sql) override {
+        return std::make_unique<CellResult>(query(sql));
+    }
+
+    using IDatabase::exec_params;
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         const ParamPack& params) override {
+        return std::make_unique<CellResult>(query_params(sql, params));
+    }
+
+    // Same as exec and exec_params, returning the result by value (the
+    // entry points of Database<FakeDatabase>)
+    CellResult query(const std::string&) { return *_result; }
+
+    CellResult query_params(const std::string& sql, const ParamPack& params) {
+        char buffer[Param::TextSize];
+        std::size_t bytes = sql.size();
+        for (const auto& param : params) bytes += param.to_text(buffer).size();
+
+        CellResult result(std::vector<std::string>{"bytes"});
+        std::vector<Param> row{Param(static_cast<std::int64_t>(bytes))};
+        result.append(row);
+        result.finish(0, 0);
+        return result;
+    }
+
+    const CellResult& result() const noexcept { return *_result; }
+
+   private:
+    bool _connected;
+    std::unique_ptr<CellResult> _result;
+};
@@ -0,0 +1,122 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "MySQLDatabase.h"
+
+namespace {
+
+// Shared connection to the local server, nullptr when there is none.
+// Reads MYSQL_HOST, MYSQL_TCP_PORT, MYSQL_DATABASE, MYSQL_USER and
+// MYSQL_PWD; the database must exist.
+MySQLDatabase* mysql() {
+    static std::unique_ptr<MySQLDatabase> db = [] {
+        auto env = [](const char* name, const char* fallback) {
+            const char* value = std::getenv(name);
+            return std::string(value ? value : fallback);
+        };
+        DatabaseConfig config;
+        config.host = env("MYSQL_HOST", "127.0.0.1");
+        config.port = std::stoi(env("MYSQL_TCP_PORT", "3306"));
+        config.database = env("MYSQL_DATABASE", "test");
+        config.username = env("MYSQL_USER", "root");
+        config.password = env("MYSQL_PWD", "");
+
+        auto conn = std::make_unique<MySQLDatabase>(config);
+        try {
+            conn->connect();
+            // Same rows as bench_rows in PostgreBench.cpp
+            std::string insert = "INSERT INTO bench_rows VALUES ";
+            for (int id = 1; id <= 16384; ++id) {
+                if (id > 1) insert += ',';
+                insert += "(" + std::to_string(id) + ",'name-" +
+                          std::to_string(id) + "'," +
+                          std::to_string(id * 0.5) + ")";
+            }
+            conn->exec(
+                "CREATE TEMPORARY TABLE bench_rows (id BIGINT PRIMARY KEY, "
+                "name VARCHAR(32), score DOUBLE)");
+            conn->exec(insert);
+            conn->exec(
+                "CREATE TABLE IF NOT EXISTS dbf_bench_writes "
+                "(id BIGINT, name TEXT)");
+        } catch (const std::exception& e) {
+            std::cerr << "MySQL benchmarks skipped: " << e.what() << "\n";
+            conn.reset();
+        }
+        return conn;
+    }();
+    return db.get();
+}
+
+MySQLDatabase* require(benchmark::State& state) {
+    MySQLDatabase* db = mysql();
+    if (db == nullptr) state.SkipWithError("MySQL server not available");
+    return db;
+}
+
+// The workload of BM_PgExec, BM_PgExecParams, BM_PgFetch and
+// BM_PgAutocommitWrite, so items per second compare directly
+
+// Round trip of a trivial statement over the text protocol
+void BM_MySqlExec(benchmark::State& state) {
+    MySQLDatabase* db = require(state);
+    if (db == nullptr) return;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->exec("SELECT 1"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MySqlExec)->UseRealTime();
+
+// Point read through the prepared statement cache, rows in the binary
+// protocol
+void BM_MySqlExecParams(benchmark::State& state) {
+    MySQLDatabase* db = require(state);
+    if (db == nullptr) return;
+    std::int64_t id = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->exec_params(
+            "SELECT id, name, score FROM bench_rows WHERE id = ?",
+            ++id % 16384 + 1));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MySqlExecParams)->UseRealTime();
+
+// Query plus client-side reading of every row
+void BM_MySqlFetch(benchmark::State& state) {
+    MySQLDatabase* db = require(state);
+    if (db == nullptr) return;
+    for (auto _ : state) {
+        auto result = db->query_params(
+            "SELECT id, name, score FROM bench_rows LIMIT ?",
+            {state.range(0)});
+        std::int64_t sum = 0;
+        for (std::size_t row = 0; row < result.size(); ++row)
+            sum += result.get<std::int64_t>(row, 0);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MySqlFetch)->Range(16, 16384)->UseRealTime();
+
+// One small write per transaction, each paying its own commit
+void BM_MySqlAutocommitWrite(benchmark::State& state) {
+    MySQLDatabase* db = require(state);
+    if (db == nullptr) return;
+    std::int64_t id = 0;
+    for (auto _ : state) {
+        db->exec_params("INSERT INTO dbf_bench_writes VALUES (?, ?)", ++id,
+                        "name");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MySqlAutocommitWrite)->UseRealTime();
+
+}  // namespace
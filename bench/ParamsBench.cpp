@@ -0,0 +1,152 @@
+#include <benchmark/benchmark.h>
+
+#include <any>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Database.h"
+#include "FakeDatabase.h"
+#include "Metrics.h"
+#include "ParamPack.h"
+#include "PostgreParams.h"
+#include "SqlFingerprint.h"
+
+namespace {
+
+const std::string Sql =
+    "SELECT id, name, email FROM users WHERE id = $1 AND name = $2 AND "
+    "score > $3 AND deleted_at IS $4";
+
+void BM_ParamPackOf(benchmark::State& state) {
+    const std::string name = "alice";
+    for (auto _ : state) {
+        auto pack = ParamPack::of(42, name, 1.5, std::optional<int>());
+        benchmark::DoNotOptimize(pack);
+    }
+}
+BENCHMARK(BM_ParamPackOf);
+
+// Compatibility overload converting std::any once
+void BM_ParamPackFromAny(benchmark::State& state) {
+    const std::vector<std::any> args{42, std::string("alice"), 1.5};
+    for (auto _ : state) {
+        ParamPack pack(args);
+        benchmark::DoNotOptimize(pack);
+    }
+}
+BENCHMARK(BM_ParamPackFromAny);
+
+// Binding as done by PostgreDatabase::exec_params
+void BM_PostgreBind(benchmark::State& state) {
+    const auto pack =
+        ParamPack::of(42, std::string("alice"), 1.5, std::optional<int>());
+    for (auto _ : state) {
+        PostgreParams::Bound bound(pack);
+        benchmark::DoNotOptimize(&bound.get());
+    }
+}
+BENCHMARK(BM_PostgreBind);
+
+// Variadic exec_params through the IDatabase interface
+void BM_FakeExecParams(benchmark::State& state) {
+    FakeDatabase db;
+    db.connect();
+    const std::string name = "alice";
+    for (auto _ : state) {
+        auto result = db.exec_params(Sql, 42, name, 1.5, nullptr);
+        benchmark::DoNotOptimize(result.get());
+    }
+}
+BENCHMARK(BM_FakeExecParams);
+
+// The same call through Database<Backend>: bound at compile time, result
+// returned by value
+void BM_StaticExecParams(benchmark::State& state) {
+    Database<FakeDatabase> db;
+    db.connect();
+    const std::string name = "alice";
+    for (auto _ : state) {
+        auto result = db.exec_params(Sql, 42, name, 1.5, nullptr);
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_StaticExecParams);
+
+// ... and through its IDatabase adapter, hidden from devirtualization
+void BM_ErasedExecParams(benchmark::State& state) {
+    Database<FakeDatabase> db;
+    db.connect();
+    IDatabase* erased = &db.erased();
+    benchmark::DoNotOptimize(erased);
+    const std::string name = "alice";
+    for (auto _ : state) {
+        auto result = erased->exec_params(Sql, 42, name, 1.5, nullptr);
+        benchmark::DoNotOptimize(result.get());
+    }
+}
+BENCHMARK(BM_ErasedExecParams);
+
+// One-row exec, where dispatch and the result allocation dominate
+void BM_StaticExec(benchmark::State& state) {
+    Database<FakeDatabase> db(1);
+    db.connect();
+    for (auto _ : state) {
+        auto result = db.exec("SELECT 1");
+        benchmark::DoNotOptimize(result);
+    }
+}
+BENCHMARK(BM_StaticExec);
+
+void BM_ErasedExec(benchmark::State& state) {
+    Database<FakeDatabase> db(1);
+    db.connect();
+    IDatabase* erased = &db.erased();
+    benchmark::DoNotOptimize(erased);
+    for (auto _ : state) {
+        auto result = erased->exec("SELECT 1");
+        benchmark::DoNotOptimize(result.get());
+    }
+}
+BENCHMARK(BM_ErasedExec);
+
+void BM_Fingerprint(benchmark::State& state) {
+    const std::string sql =
+        "SELECT * FROM orders WHERE customer_id IN (1, 2, 3, 4) AND "
+        "status = 'open' AND total > 100.5 -- recent\nORDER BY id LIMIT 50";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(SqlFingerprint::normalize(sql));
+    }
+    state.SetBytesProcessed(state.iterations() * sql.size());
+}
+BENCHMARK(BM_Fingerprint);
+
+// Per-query cost of Metrics on the hot path
+void BM_MetricsRecord(benchmark::State& state) {
+    for (auto _ : state) {
+        const auto start = Metrics::start();
+        Metrics::record(Sql, start, 1, 64);
+    }
+}
+BENCHMARK(BM_MetricsRecord)->ThreadRange(1, 8);
+
+// Statements with inline literals: every call has new text but the same
+// fingerprint
+void BM_MetricsRecordLiterals(benchmark::State& state) {
+    std::vector<std::string> statements;
+    for (int i = 0; i < 4096; ++i) {
+        statements.push_back(
+            "SELECT id, name FROM orders WHERE customer_id = " +
+            std::to_string(state.thread_index() * 4096 + i) +
+            " AND status = 'open-" + std::to_string(i) + "'");
+    }
+    std::size_t next = 0;
+    for (auto _ : state) {
+        const auto start = Metrics::start();
+        Metrics::record(statements[next++ % statements.size()], start, 1,
+                        64);
+    }
+}
+BENCHMARK(BM_MetricsRecordLiterals)->ThreadRange(1, 8);
+
+}  // namespace
@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <memory>
+
+#include "ConnectionPool.h"
+#include "DatabaseFactory.h"
+#include "FakeDatabase.h"
+
+namespace {
+
+// Pool of max_size fake connections, all opened up front
+ConnectionPool& fake_pool(std::size_t maxSize) {
+    static const bool registered = [] {
+        DatabaseFactory::register_database(
+            "pool-fake", [](const DatabaseConfig&) {
+                return std::make_unique<FakeDatabase>(1);
+            });
+        return true;
+    }();
+    (void)registered;
+
+    auto make = [](std::size_t size) {
+        PoolConfig config;
+        config.min_size = size;
+        config.max_size = size;
+        return std::make_unique<ConnectionPool>("pool-fake", DatabaseConfig{},
+                                                config);
+    };
+    static auto small = make(4);
+    static auto large = make(64);
+    return maxSize <= 4 ? *small : *large;
+}
+
+// Lease and return alone, from 1 to 64 threads on a pool of 4 (threads
+// wait for each other's connections) and of 64 (only the pool lock is
+// shared)
+void BM_PoolLease(benchmark::State& state) {
+    ConnectionPool& pool = fake_pool(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        auto lease = pool.acquire();
+        benchmark::DoNotOptimize(lease.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PoolLease)
+    ->Arg(4)
+    ->Arg(64)
+    ->ArgNames({"pool"})
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+
+// Creating, connecting and dropping a fake backend per request, the
+// in-process floor of connect-per-request (BM_PgConnectPerRequest has the
+// real cost)
+void BM_PoolConnectPerRequest(benchmark::State& state) {
+    fake_pool(4);
+    const DatabaseConfig config;
+    for (auto _ : state) {
+        auto db = DatabaseFactory::create("pool-fake", config);
+        db->connect();
+        benchmark::DoNotOptimize(db.get());
+        db->disconnect();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PoolConnectPerRequest)->ThreadRange(1, 64)->UseRealTime();
+
+}  // namespace
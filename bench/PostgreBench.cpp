@@ -0,0 +1,555 @@
+#include <benchmark/benchmark.h>
+
+#if defined(__linux__)
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+#include "ConnectionPool.h"
+#include "DatabaseFactory.h"
+#include "HedgedDatabase.h"
+#include "LatencyHistogram.h"
+#include "PostgreDatabase.h"
+#include "PostgreGroupCommitter.h"
+#include "PostgrePipeline.h"
+#include "PostgreStream.h"
+
+namespace {
+
+// Shared connection to the local server, nullptr when there is none.
+// Reads PGHOST, PGPORT, PGDATABASE, PGUSER and PGPASSWORD like libpq.
+DatabaseConfig config() {
+    auto env = [](const char* name, const char* fallback) {
+        const char* value = std::getenv(name);
+        return std::string(value ? value : fallback);
+    };
+    DatabaseConfig config;
+    config.host = env("PGHOST", "localhost");
+    config.port = std::stoi(env("PGPORT", "5432"));
+    config.database = env("PGDATABASE", "postgres");
+    config.username = env("PGUSER", "postgres");
+    config.password = env("PGPASSWORD", "");
+    return config;
+}
+
+PostgreDatabase* postgres() {
+    static std::unique_ptr<PostgreDatabase> db = [] {
+        // Types for the benchmarks that go through DatabaseFactory
+        DatabaseFactory::initialize();
+        auto cfg = config();
+        auto conn = std::make_unique<PostgreDatabase>(
+            cfg.host, cfg.port, cfg.database, cfg.username, cfg.password);
+        try {
+            conn->connect();
+            conn->exec(
+                "CREATE TEMP TABLE bench_rows AS SELECT g AS id, "
+                "'name-' || g AS name, g * 0.5 AS score FROM "
+                "generate_series(1, 16384) AS g");
+            // Written by several connections, so not a temporary table
+            conn->exec(
+                "CREATE UNLOGGED TABLE IF NOT EXISTS dbf_bench_writes "
+                "(id bigint, name text)");
+        } catch (const std::exception& e) {
+            std::cerr << "PostgreSQL benchmarks skipped: " << e.what() << "\n";
+            conn.reset();
+        }
+        return conn;
+    }();
+    return db.get();
+}
+
+const PostgreResult& as_postgres(const std::unique_ptr<IResult>& result) {
+    return static_cast<const PostgreResult&>(*result);
+}
+
+// Shared connection, or nullptr after marking the benchmark skipped
+PostgreDatabase* require(benchmark::State& state) {
+    PostgreDatabase* db = postgres();
+    if (db == nullptr) state.SkipWithError("PostgreSQL server not available");
+    return db;
+}
+
+const char* const FirstRows =
+    "SELECT id, name, score FROM bench_rows ORDER BY id LIMIT 1024";
+
+// Round trip of a trivial statement, including the implicit transaction
+void BM_PgExec(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->exec("SELECT 1"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PgExec)->UseRealTime();
+
+// Round trip through the prepared statement cache
+void BM_PgExecParams(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    std::int64_t id = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->exec_params(
+            "SELECT id, name, score FROM bench_rows WHERE id = $1",
+            ++id % 16384 + 1));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PgExecParams)->UseRealTime();
+
+// Point read under each exec mode: Transaction pays BEGIN and COMMIT round
+// trips, NonTransaction and Auto run the statement alone
+void BM_PgExecMode(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    db->exec_mode(static_cast<PostgreExecMode>(state.range(0)));
+    std::int64_t id = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->exec_params(
+            "SELECT id, name, score FROM bench_rows WHERE id = $1",
+            ++id % 16384 + 1));
+    }
+    db->exec_mode(PostgreExecMode::Transaction);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PgExecMode)
+    ->Arg(static_cast<int>(PostgreExecMode::Transaction))
+    ->Arg(static_cast<int>(PostgreExecMode::NonTransaction))
+    ->Arg(static_cast<int>(PostgreExecMode::Auto))
+    ->ArgNames({"mode"})
+    ->UseRealTime();
+
+// One statement on a leased pooled connection, from 1 to 16 threads
+// sharing a pool of 16
+void BM_PgPoolLease(benchmark::State& state) {
+    if (require(state) == nullptr) return;
+    static ConnectionPool pool("postgresql", config(), [] {
+        PoolConfig pool;
+        pool.min_size = 16;
+        pool.max_size = 16;
+        return pool;
+    }());
+    for (auto _ : state) {
+        auto lease = pool.acquire();
+        benchmark::DoNotOptimize(lease->exec("SELECT 1"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PgPoolLease)->ThreadRange(1, 16)->UseRealTime();
+
+// The same statement on a connection opened and closed for it, the
+// baseline BM_PgPoolLease saves
+void BM_PgConnectPerRequest(benchmark::State& state) {
+    if (require(state) == nullptr) return;
+    const DatabaseConfig cfg = config();
+    for (auto _ : state) {
+        auto db = DatabaseFactory::create("postgresql", cfg);
+        db->connect();
+        benchmark::DoNotOptimize(db->exec("SELECT 1"));
+        db->disconnect();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PgConnectPerRequest)->ThreadRange(1, 16)->UseRealTime();
+
+// Round trip of SELECT 1, to tell the network delay a run was made under
+double round_trip_us(PostgreDatabase& db) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; ++i) db.exec("SELECT 1");
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - start)
+               .count() /
+           10;
+}
+
+constexpr int BatchSize = 100;
+
+// A batch of 100 small statements in one transaction, one round trip per
+// statement. Run under added network delay to see what pipelining saves:
+//   sudo tc qdisc add dev lo root netem delay 1ms   (del to remove)
+void BM_PgSequentialBatch(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    state.counters["rtt_us"] = round_trip_us(*db);
+    for (auto _ : state) {
+        auto txn = db->begin_transaction();
+        for (int i = 0; i < BatchSize; ++i)
+            benchmark::DoNotOptimize(txn.exec("SELECT 1"));
+        txn.commit();
+    }
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+}
+BENCHMARK(BM_PgSequentialBatch)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// The same batch through PostgrePipeline, sent in bursts of depth
+void BM_PgPipelineBatch(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    state.counters["rtt_us"] = round_trip_us(*db);
+    const auto depth = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        auto pipeline = db->begin_pipeline(depth);
+        for (int i = 0; i < BatchSize; ++i) pipeline.exec("SELECT 1");
+        pipeline.commit();
+    }
+    state.SetItemsProcessed(state.iterations() * BatchSize);
+}
+BENCHMARK(BM_PgPipelineBatch)
+    ->Arg(1)
+    ->Arg(8)
+    ->Arg(64)
+    ->ArgNames({"depth"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Query plus client-side reading of every row
+void BM_PgFetch(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    for (auto _ : state) {
+        auto result = db->exec_params(
+            "SELECT id, name, score FROM bench_rows LIMIT $1", state.range(0));
+        std::int64_t sum = 0;
+        for (const auto& row : as_postgres(result))
+            sum += row.get<std::int64_t>(0);
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PgFetch)->Range(16, 16384)->UseRealTime();
+
+const char* const TypedRows =
+    "SELECT id::int8, name, score::float8, "
+    "timestamptz '2000-01-01' + id * interval '1.000007 second' "
+    "FROM bench_rows ORDER BY id LIMIT $1";
+
+// Column i of the text and binary decodes hold the same bits
+template <std::size_t I, typename Columns>
+bool same_column(const Columns& text, const Columns& binary) {
+    const auto& a = std::get<I>(text);
+    const auto& b = std::get<I>(binary);
+    if (a.size() != b.size() || a.nulls() != b.nulls()) return false;
+    for (std::size_t row = 0; row < a.size(); ++row) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(a[row])>, double>) {
+            if (std::memcmp(&a[row], &b[row], sizeof(double)) != 0)
+                return false;
+        } else if (a[row] != b[row]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// CPU cost of decoding a fetched result into typed columns, text format
+// through ColumnDecoder (binary:0) against binary format through
+// PostgreBinary (binary:1). Both decodes are compared value for value
+// first; s_per_Mfield is the CPU time per million fields.
+void BM_PgBinaryDecode(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    const bool binary = state.range(0) != 0;
+    const std::int64_t rows = state.range(1);
+
+    using Timestamp = ColumnDecoder::Timestamp;
+    auto textResult = db->exec_params(TypedRows, rows);
+    const PostgreResult& text = as_postgres(textResult);
+    auto raw = db->exec_binary(TypedRows, rows);
+
+    const auto fromText =
+        text.to_columns<std::int64_t, std::string, double, Timestamp>();
+    const auto fromBinary =
+        raw->to_columns<std::int64_t, std::string, double, Timestamp>();
+    if (!same_column<0>(fromText, fromBinary) ||
+        !same_column<1>(fromText, fromBinary) ||
+        !same_column<2>(fromText, fromBinary) ||
+        !same_column<3>(fromText, fromBinary)) {
+        state.SkipWithError("binary decode differs from the text decode");
+        return;
+    }
+
+    for (auto _ : state) {
+        if (binary) {
+            benchmark::DoNotOptimize(
+                raw->to_columns<std::int64_t, std::string, double,
+                                Timestamp>());
+        } else {
+            benchmark::DoNotOptimize(
+                text.to_columns<std::int64_t, std::string, double,
+                                Timestamp>());
+        }
+    }
+    const auto fields = static_cast<double>(rows * 4);
+    state.SetItemsProcessed(state.iterations() * rows * 4);
+    state.counters["s_per_Mfield"] = benchmark::Counter(
+        fields / 1e6, benchmark::Counter::kIsIterationInvariantRate |
+                          benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_PgBinaryDecode)
+    ->ArgsProduct({{0, 1}, {1024, 16384}})
+    ->ArgNames({"binary", "rows"});
+
+#if defined(__linux__)
+// Resident set size in bytes
+std::size_t resident_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    std::size_t pages = 0;
+    std::size_t resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+constexpr std::int64_t WideRowCount = 500000;
+
+const char* const WideRows =
+    "SELECT g, repeat('x', 200) FROM generate_series(1, 500000) AS g";
+
+// Peak resident memory above the starting point while reading 500k rows
+// of about 200 bytes, as one result (stream:0) or through a cursor 1000
+// rows at a time (stream:1); compare the peak_rss_mb counters
+void BM_PgStreamMemory(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    const bool streamed = state.range(0) != 0;
+    std::size_t peak = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+#if defined(__GLIBC__)
+        ::malloc_trim(0);  // hand back what earlier runs freed
+#endif
+        const std::size_t base = resident_bytes();
+        state.ResumeTiming();
+
+        std::size_t high = base;
+        std::int64_t sum = 0;
+        if (streamed) {
+            auto stream = db->stream(WideRows, 1000);
+            for (const auto& row : stream) {
+                sum += row.get<std::int64_t>(0);
+                if (stream.rows() % 1000 == 0)
+                    high = std::max(high, resident_bytes());
+            }
+        } else {
+            auto result = db->exec(WideRows);
+            high = std::max(high, resident_bytes());
+            for (const auto& row : as_postgres(result))
+                sum += row.get<std::int64_t>(0);
+        }
+        benchmark::DoNotOptimize(sum);
+        peak = std::max(peak, high - base);
+    }
+    state.counters["peak_rss_mb"] = static_cast<double>(peak) / (1 << 20);
+    state.SetItemsProcessed(state.iterations() * WideRowCount);
+}
+BENCHMARK(BM_PgStreamMemory)
+    ->Arg(0)
+    ->Arg(1)
+    ->ArgNames({"stream"})
+    ->Iterations(3)
+    ->Unit(benchmark::kMillisecond);
+#endif  // __linux__
+
+// PostgreResult iteration alone, over a result fetched once
+void BM_PgResultIterate(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    auto result = db->exec_params(
+        "SELECT id, name, score FROM bench_rows LIMIT $1", state.range(0));
+    for (auto _ : state) {
+        std::size_t rows = 0;
+        for (const auto& row : as_postgres(result)) rows += row.size();
+        benchmark::DoNotOptimize(rows);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PgResultIterate)->Range(16, 16384);
+
+// PostgreRow::get<T> by index and by name
+void BM_PgRowGet(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    auto result = db->exec(FirstRows);
+    const PostgreResult& rows = as_postgres(result);
+    const bool byName = state.range(0) != 0;
+    for (auto _ : state) {
+        double sum = 0;
+        for (const auto& row : rows) {
+            sum += byName ? row.get<double>("score") : row.get<double>(2);
+            benchmark::DoNotOptimize(row.get<std::string>(1));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_PgRowGet)->Arg(0)->Arg(1)->ArgNames({"by_name"});
+
+// Same reads through row views, text as std::string_view
+void BM_PgRowView(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    auto result = db->exec(FirstRows);
+    const PostgreResult& rows = as_postgres(result);
+    for (auto _ : state) {
+        double sum = 0;
+        for (auto row : rows.rows()) {
+            sum += row.get<double>(2);
+            benchmark::DoNotOptimize(row.view(1));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_PgRowView);
+
+// Copy of a result into a detached arena
+void BM_PgDetach(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    auto result = db->exec(FirstRows);
+    const PostgreResult& rows = as_postgres(result);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rows.detach());
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_PgDetach);
+
+// Columnar decoding of the same rows
+void BM_PgToColumns(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    auto result = db->exec(FirstRows);
+    const PostgreResult& rows = as_postgres(result);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            rows.to_columns<std::int64_t, std::string, double>());
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_PgToColumns);
+
+// One small write per transaction, each paying its own commit
+void BM_PgAutocommitWrite(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    std::int64_t id = 0;
+    for (auto _ : state) {
+        db->exec_params("INSERT INTO dbf_bench_writes VALUES ($1, $2)", ++id,
+                        "name");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PgAutocommitWrite)->UseRealTime();
+
+// The same writes from many threads, sharing commits through the committer
+void BM_PgGroupCommit(benchmark::State& state) {
+    if (require(state) == nullptr) return;
+    static PostgreGroupCommitter committer(config());
+    std::int64_t id = 0;
+    for (auto _ : state) {
+        committer
+            .submit("INSERT INTO dbf_bench_writes VALUES ($1, $2)", ++id,
+                    "name")
+            .get();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PgGroupCommit)->ThreadRange(1, 64)->UseRealTime();
+
+// Reads with injected tail latency (1% sleep 20 ms) over two connections,
+// unhedged (budget 0) and hedged; compare the p99 and p999 counters
+void BM_PgHedgedRead(benchmark::State& state) {
+    if (require(state) == nullptr) return;
+    HedgeConfig hedge;
+    if (state.range(0) == 0) hedge.budget = 0;
+    HedgedDatabase db("postgresql", {config(), config()}, hedge);
+    db.connect();
+
+    LatencyHistogram latency;
+    for (auto _ : state) {
+        const auto start = std::chrono::steady_clock::now();
+        db.exec(
+            "SELECT CASE WHEN random() < 0.01 THEN pg_sleep(0.02) END, 1");
+        latency.record(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start)
+                .count()));
+    }
+
+    HistogramSnapshot snapshot;
+    latency.add_to(snapshot);
+    state.counters["p50_us"] = snapshot.percentile(0.5) / 1e3;
+    state.counters["p99_us"] = snapshot.percentile(0.99) / 1e3;
+    state.counters["p999_us"] = snapshot.percentile(0.999) / 1e3;
+    state.counters["hedges"] = static_cast<double>(db.stats().hedges);
+}
+BENCHMARK(BM_PgHedgedRead)
+    ->Arg(0)
+    ->Arg(1)
+    ->ArgNames({"hedged"})
+    ->Iterations(20000)
+    ->UseRealTime();
+
+struct BenchRow {
+    std::int64_t id;
+    std::string name;
+    double score;
+};
+
+constexpr auto BenchRowMap =
+    row_map(row_field("id", &BenchRow::id), row_field("name", &BenchRow::name),
+            row_field("score", &BenchRow::score));
+
+// One million rows fetched once for the struct mapping benchmarks
+const PostgreResult& million_rows(PostgreDatabase& db) {
+    static const PostgreResult rows = db.query(
+        "SELECT g AS id, 'name-' || g AS name, g * 0.5 AS score FROM "
+        "generate_series(1, 1000000) AS g");
+    return rows;
+}
+
+// Hand-written converter looking every column up by name
+void BM_PgToVectorByName(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    const PostgreResult& rows = million_rows(*db);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(
+            rows.to_vector<BenchRow>([](const PostgreRow& row) {
+                return BenchRow{row.get<std::int64_t>("id"),
+                                row.get<std::string>("name"),
+                                row.get<double>("score")};
+            }));
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_PgToVectorByName)->Unit(benchmark::kMillisecond);
+
+// Same rows through a RowMap, columns resolved once per result
+void BM_PgToStructs(benchmark::State& state) {
+    PostgreDatabase* db = require(state);
+    if (db == nullptr) return;
+    const PostgreResult& rows = million_rows(*db);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(rows.to_structs(BenchRowMap));
+    }
+    state.SetItemsProcessed(state.iterations() * rows.size());
+}
+BENCHMARK(BM_PgToStructs)->Unit(benchmark::kMillisecond);
+
+}  // namespace
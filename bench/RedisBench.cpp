@@ -0,0 +1,138 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RedisDatabase.h"
+#include "RedisProtocol.h"
+#include "RedisStub.h"
+
+namespace {
+
+// In-process server, for the benchmarks that need its extra commands
+RedisStub& stub() {
+    static RedisStub instance;
+    return instance;
+}
+
+// Shared connection to REDIS_HOST/REDIS_PORT when set, otherwise to the
+// in-process RedisStub; nullptr if it cannot connect
+RedisDatabase* redis() {
+    static std::unique_ptr<RedisDatabase> db = [] {
+        const char* host = std::getenv("REDIS_HOST");
+        const char* port = std::getenv("REDIS_PORT");
+        auto conn = host ? std::make_unique<RedisDatabase>(
+                               host, port ? std::atoi(port) : 6379)
+                         : std::make_unique<RedisDatabase>("127.0.0.1",
+                                                           stub().port());
+        try {
+            conn->connect();
+            conn->exec("SET dbf:bench:key 'a cached value of some bytes'");
+        } catch (const std::exception& e) {
+            std::cerr << "Redis benchmarks skipped: " << e.what() << "\n";
+            conn.reset();
+        }
+        return conn;
+    }();
+    return db.get();
+}
+
+// Shared connection, or nullptr after marking the benchmark skipped
+RedisDatabase* require(benchmark::State& state) {
+    RedisDatabase* db = redis();
+    if (db == nullptr) state.SkipWithError("Redis server not available");
+    return db;
+}
+
+// Hot-key read, one round trip per command
+void BM_RedisGet(benchmark::State& state) {
+    RedisDatabase* db = require(state);
+    if (db == nullptr) return;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->query("GET dbf:bench:key"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RedisGet)->UseRealTime();
+
+// The same reads from many threads on one connection; commands issued
+// while another batch is on the wire go out together
+void BM_RedisGetShared(benchmark::State& state) {
+    RedisDatabase* db = require(state);
+    if (db == nullptr) return;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->exec("GET dbf:bench:key"));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RedisGetShared)->ThreadRange(1, 64)->UseRealTime();
+
+// Explicit batches of GETs in one write; items are commands
+void BM_RedisPipeline(benchmark::State& state) {
+    RedisDatabase* db = require(state);
+    if (db == nullptr) return;
+    const std::vector<std::string> commands(
+        static_cast<std::size_t>(state.range(0)), "GET dbf:bench:key");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db->pipeline(commands));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RedisPipeline)->RangeMultiplier(8)->Range(8, 4096)->UseRealTime();
+
+// One reply of n 16-byte strings from the stub, read and walked; items
+// are elements, so the rate stays flat while the reply grows
+void BM_RedisLargeReply(benchmark::State& state) {
+    RedisDatabase db("127.0.0.1", stub().port());
+    db.connect();
+    const std::string command = "RANGE " + std::to_string(state.range(0)) +
+                                " 16";
+    for (auto _ : state) {
+        RedisResult result = db.query(command);
+        std::size_t bytes = 0;
+        for (std::size_t i = 0; i < result.size(); ++i)
+            bytes += result[i].str().size();
+        benchmark::DoNotOptimize(bytes);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RedisLargeReply)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Parsing alone: an n-element reply arriving in 16 KiB reads, resumed per
+// read (incremental:1) or parsed from the start after each (incremental:0)
+void BM_RedisParse(benchmark::State& state) {
+    const bool incremental = state.range(0) != 0;
+    const auto count = static_cast<std::size_t>(state.range(1));
+    std::string reply = "*" + std::to_string(count) + "\r\n";
+    for (std::size_t i = 0; i < count; ++i) reply += "$5\r\nvalue\r\n";
+
+    std::vector<RedisNode> nodes;
+    for (auto _ : state) {
+        RedisParser parser;
+        std::size_t used = 0;
+        for (std::size_t size = 16384; used == 0; size += 16384) {
+            size = std::min(size, reply.size());
+            if (incremental) {
+                used = parser.parse(reply.data(), size, nodes);
+            } else {
+                used = RedisProtocol::parse(reply.data(), size, nodes);
+            }
+        }
+        benchmark::DoNotOptimize(nodes.data());
+        nodes.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_RedisParse)
+    ->ArgsProduct({{0, 1}, {1000, 100000}})
+    ->ArgNames({"incremental", "elements"});
+
+}  // namespace
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cctype>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Errors.h"
+#include "RedisProtocol.h"
+
+// RedisStub class - in-process RESP server on 127.0.0.1 for the Redis
+// benchmarks and checks when no redis-server is around. Each connection
+// gets a thread; pipelined commands are answered in one write. Commands:
+//   PING, ECHO v, SET k v, GET k, DEL k..., INCR k, HELLO 2|3, SELECT n
+//   BLOB n       bulk string of n bytes ('a' + i % 26)
+//   RANGE n len  array of n bulk strings of len bytes
+//   ATTR         RESP3 attribute followed by +OK
+// Anything else is answered with an error reply.
+class RedisStub final {
+   public:
+    RedisStub() : _listener(-1), _stopping(false) {
+        _listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (_listener < 0) throw ConnectionError("[RedisStub] socket failed");
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t length = sizeof(addr);
+        if (::bind(_listener, reinterpret_cast<sockaddr*>(&addr),
+                   sizeof(addr)) != 0 ||
+            ::listen(_listener, 64) != 0 ||
+            ::getsockname(_listener, reinterpret_cast<sockaddr*>(&addr),
+                          &length) != 0) {
+            ::close(_listener);
+            throw ConnectionError("[RedisStub] cannot listen");
+        }
+        _port = ntohs(addr.sin_port);
+        _acceptor = std::thread([this] { accept_loop(); });
+    }
+
+    RedisStub(const RedisStub&) noexcept = delete;
+    RedisStub& operator=(const RedisStub&) noexcept = delete;
+
+    ~RedisStub() noexcept {
+        _stopping.store(true);
+        ::shutdown(_listener, SHUT_RDWR);
+        ::close(_listener);
+        if (_acceptor.joinable()) _acceptor.join();
+
+        std::vector<std::thread> clients;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (int fd : _sockets) ::shutdown(fd, SHUT_RDWR);
+            clients.swap(_clients);
+        }
+        for (auto& client : clients) client.join();
+        for (int fd : _sockets) ::close(fd);
+    }
+
+    int port() const noexcept { return _port; }
+
+   private:
+    void accept_loop() {
+        while (!_stopping.load()) {
+            const int fd = ::accept(_listener, nullptr, nullptr);
+            if (fd < 0) {
+                if (_stopping.load()) return;
+                continue;
+            }
+            int on = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            std::lock_guard<std::mutex> lock(_mutex);
+            _sockets.push_back(fd);
+            _clients.emplace_back([this, fd] { serve(fd); });
+        }
+    }
+
+    void serve(int fd) {
+        std::string input;
+        std::string output;
+        std::vector<RedisNode> nodes;
+        RedisParser parser;
+        char chunk[64 * 1024];
+        std::size_t begin = 0;
+        while (true) {
+            const ssize_t received = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) break;
+            input.append(chunk, static_cast<std::size_t>(received));
+
+            try {
+                while (std::size_t used = parser.parse(
+                           input.data() + begin, input.size() - begin,
+                           nodes)) {
+                    begin += used;
+                    reply(nodes, output);
+                    nodes.clear();
+                }
+            } catch (const std::exception&) {
+                break;
+            }
+            input.erase(0, begin);
+            begin = 0;
+            if (!send_all(fd, output)) break;
+            output.clear();
+        }
+        // Closed by the destructor, so the number is not reused meanwhile
+    }
+
+    static bool send_all(int fd, std::string_view data) {
+        while (!data.empty()) {
+            const ssize_t sent = ::send(fd, data.data(), data.size(),
+#if defined(MSG_NOSIGNAL)
+                                        MSG_NOSIGNAL
+#else
+                                        0
+#endif
+            );
+            if (sent <= 0) return false;
+            data.remove_prefix(static_cast<std::size_t>(sent));
+        }
+        return true;
+    }
+
+    static void bulk(std::string& out, std::string_view value) {
+        out += '$';
+        out += std::to_string(value.size());
+        out += "\r\n";
+        out.append(value.data(), value.size());
+        out += "\r\n";
+    }
+
+    void reply(const std::vector<RedisNode>& nodes, std::string& out) {
+        if (nodes.empty() || nodes[0].type != RedisType::Array ||
+            nodes[0].count == 0) {
+            out += "-ERR expected a command array\r\n";
+            return;
+        }
+        std::vector<std::string> args;
+        for (std::size_t i = 1; i < nodes.size(); ++i)
+            args.emplace_back(nodes[i].text);
+        std::string command = args[0];
+        for (auto& c : command)
+            c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+
+        auto count = [&args](std::size_t index) {
+            return index < args.size() ? std::stoul(args[index]) : 0UL;
+        };
+
+        if (command == "PING") {
+            out += "+PONG\r\n";
+        } else if (command == "ECHO" && args.size() == 2) {
+            bulk(out, args[1]);
+        } else if (command == "SET" && args.size() >= 3) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _values[args[1]] = args[2];
+            out += "+OK\r\n";
+        } else if (command == "GET" && args.size() == 2) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto itr = _values.find(args[1]);
+            if (itr == _values.end())
+                out += "$-1\r\n";
+            else
+                bulk(out, itr->second);
+        } else if (command == "DEL") {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::size_t removed = 0;
+            for (std::size_t i = 1; i < args.size(); ++i)
+                removed += _values.erase(args[i]);
+            out += ":" + std::to_string(removed) + "\r\n";
+        } else if (command == "INCR" && args.size() == 2) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::string& value = _values[args[1]];
+            const long long current = value.empty() ? 0 : std::stoll(value);
+            value = std::to_string(current + 1);
+            out += ":" + value + "\r\n";
+        } else if (command == "HELLO") {
+            const bool resp3 = args.size() > 1 && args[1] == "3";
+            out += resp3 ? "%2\r\n" : "*4\r\n";
+            bulk(out, "server");
+            bulk(out, "stub");
+            bulk(out, "proto");
+            out += resp3 ? ":3\r\n" : ":2\r\n";
+        } else if (command == "SELECT") {
+            out += "+OK\r\n";
+        } else if (command == "BLOB") {
+            std::string value(count(1), '\0');
+            for (std::size_t i = 0; i < value.size(); ++i)
+                value[i] = static_cast<char>('a' + i % 26);
+            bulk(out, value);
+        } else if (command == "RANGE") {
+            const std::size_t n = count(1);
+            const std::string value(count(2), 'v');
+            out += "*" + std::to_string(n) + "\r\n";
+            for (std::size_t i = 0; i < n; ++i) bulk(out, value);
+        } else if (command == "ATTR") {
+            out += "|1\r\n+ttl\r\n:3600\r\n+OK\r\n";
+        } else {
+            out += "-ERR unknown command '" + args[0] + "'\r\n";
+        }
+    }
+
+    int _listener;
+    int _port;
+    std::atomic<bool> _stopping;
+    std::thread _acceptor;
+
+    std::mutex _mutex;
+    std::vector<int> _sockets;
+    std::vector<std::thread> _clients;
+    std::map<std::string, std::string> _values;
+};
@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string>
+
+#include "ColumnDecoder.h"
+#include "FakeDatabase.h"
+
+namespace {
+
+// Typed reads over a buffered result
+void BM_CellResultGet(benchmark::State& state) {
+    const FakeDatabase db(static_cast<std::size_t>(state.range(0)));
+    const CellResult& result = db.result();
+    for (auto _ : state) {
+        std::int64_t sum = 0;
+        for (std::size_t row = 0; row < result.size(); ++row) {
+            sum += result.get<std::int64_t>(row, 0);
+            benchmark::DoNotOptimize(result.value(row, 1).as_text().size());
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CellResultGet)->Range(16, 16 << 10);
+
+// Copies made by result caches
+void BM_CellResultClone(benchmark::State& state) {
+    const FakeDatabase db(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(db.result().clone());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CellResultClone)->Range(16, 16 << 10);
+
+// Text-format integers as returned by PostgreSQL
+void BM_DecodeInt(benchmark::State& state) {
+    const std::string text = "1234567890123";
+    for (auto _ : state) {
+        std::int64_t value;
+        ColumnDecoder::decode(text.data(), text.size(), value);
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(BM_DecodeInt);
+
+void BM_DecodeDouble(benchmark::State& state) {
+    const std::string text = "12345.6789";
+    for (auto _ : state) {
+        double value;
+        ColumnDecoder::decode(text.data(), text.size(), value);
+        benchmark::DoNotOptimize(value);
+    }
+}
+BENCHMARK(BM_DecodeDouble);
+
+}  // namespace
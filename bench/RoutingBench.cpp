@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "FakeDatabase.h"
+#include "RoutingDatabase.h"
+
+namespace {
+
+// Primary plus three replicas, all in-process
+RoutingDatabase& router(RoutingBalance balance) {
+    auto make = [](RoutingBalance balance) {
+        std::vector<std::unique_ptr<IDatabase>> replicas;
+        for (int i = 0; i < 3; ++i)
+            replicas.push_back(std::make_unique<FakeDatabase>(1));
+        RoutingConfig config;
+        config.balance = balance;
+        config.check_interval = std::chrono::milliseconds(0);
+        auto db = std::make_unique<RoutingDatabase>(
+            std::make_unique<FakeDatabase>(1), std::move(replicas), config);
+        db->connect();
+        return db;
+    };
+    static auto leastOutstanding = make(RoutingBalance::LeastOutstanding);
+    static auto ewma = make(RoutingBalance::Ewma);
+    return balance == RoutingBalance::Ewma ? *ewma : *leastOutstanding;
+}
+
+// Classification, replica choice and one fake read
+void BM_RoutingRead(benchmark::State& state) {
+    auto& db = router(static_cast<RoutingBalance>(state.range(0)));
+    for (auto _ : state) {
+        auto result = db.exec("SELECT id, name FROM users WHERE id = 42");
+        benchmark::DoNotOptimize(result.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RoutingRead)
+    ->Arg(static_cast<int>(RoutingBalance::LeastOutstanding))
+    ->Arg(static_cast<int>(RoutingBalance::Ewma))
+    ->ThreadRange(1, 8)
+    ->UseRealTime();
+
+// Same read straight on a backend, the baseline for the routing overhead
+void BM_RoutingDirect(benchmark::State& state) {
+    FakeDatabase db(1);
+    db.connect();
+    for (auto _ : state) {
+        auto result = db.exec("SELECT id, name FROM users WHERE id = 42");
+        benchmark::DoNotOptimize(result.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RoutingDirect);
+
+}  // namespace
@@ -0,0 +1,199 @@
+// Self-checking stress test of DatabaseFactory: registrar threads keep
+// registering types while reader threads create and resolve them, and
+// every result is checked. Exits non-zero on the first wrong answer.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DatabaseFactory.h"
+#include "FakeDatabase.h"
+
+namespace {
+
+constexpr int Registrars = 4;
+constexpr int Readers = 16;
+constexpr int TypesPerRegistrar = 250;
+constexpr int Generations = 1000;
+
+// Backend whose connection_info() names the type and generation that
+// created it
+class TaggedDatabase final : public FakeDatabase {
+   public:
+    explicit TaggedDatabase(std::string tag)
+        : FakeDatabase(0), _tag(std::move(tag)) {}
+
+    std::string connection_info() const noexcept override { return _tag; }
+
+   private:
+    std::string _tag;
+};
+
+DatabaseFactory::Creator tagged(const std::string& tag) {
+    return [tag](const DatabaseConfig&) -> std::unique_ptr<IDatabase> {
+        return std::make_unique<TaggedDatabase>(tag);
+    };
+}
+
+std::string type_name(int registrar, int index) {
+    return "stress-" + std::to_string(registrar) + "-" +
+           std::to_string(index);
+}
+
+std::atomic<bool> failed{false};
+
+void fail(const std::string& message) {
+    if (!failed.exchange(true)) std::fprintf(stderr, "%s\n", message.c_str());
+}
+
+void check(bool condition, const std::string& message) {
+    if (!condition) fail(message);
+}
+
+// Generation encoded in a "stress-rebind:<n>" tag
+int generation(const std::string& tag) {
+    return std::stoi(tag.substr(tag.find(':') + 1));
+}
+
+}  // namespace
+
+int main() {
+    DatabaseFactory::initialize();
+    DatabaseFactory::register_database("stress-rebind",
+                                       tagged("stress-rebind:0"));
+
+    // Count of types each registrar has published so far
+    std::vector<std::atomic<int>> published(Registrars);
+    for (auto& count : published) count.store(0);
+    std::atomic<int> rebinds{0};
+    std::atomic<int> running{Registrars + 1};
+
+    std::vector<std::thread> threads;
+    for (int r = 0; r < Registrars; ++r) {
+        threads.emplace_back([&, r] {
+            for (int i = 0; i < TypesPerRegistrar && !failed; ++i) {
+                const std::string type = type_name(r, i);
+                DatabaseFactory::register_database(type, tagged(type));
+                published[r].store(i + 1, std::memory_order_release);
+            }
+            running.fetch_sub(1);
+        });
+    }
+    // Rebinds one type again and again; readers must never see it go back
+    threads.emplace_back([&] {
+        for (int g = 1; g <= Generations && !failed; ++g) {
+            DatabaseFactory::register_database(
+                "stress-rebind", tagged("stress-rebind:" + std::to_string(g)));
+            rebinds.store(g, std::memory_order_release);
+        }
+        running.fetch_sub(1);
+    });
+
+    std::atomic<long> checks{0};
+    for (int t = 0; t < Readers; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(t));
+            const DatabaseConfig config;
+            std::vector<std::pair<BackendHandle, std::string>> handles;
+            int lastGeneration = 0;
+            long local = 0;
+
+            while (running.load() > 0 && !failed) {
+                // A published type always resolves to its own creator
+                const int r = static_cast<int>(rng() % Registrars);
+                const int count = published[r].load(std::memory_order_acquire);
+                if (count > 0) {
+                    const std::string type =
+                        type_name(r, static_cast<int>(rng() % count));
+                    try {
+                        auto db = DatabaseFactory::create(type, config);
+                        check(db && db->connection_info() == type,
+                              "create(" + type + ") built the wrong backend");
+                        BackendHandle handle = DatabaseFactory::resolve(type);
+                        check(handle.type() == type,
+                              "resolve(" + type + ") has the wrong type");
+                        if (handles.size() < 64)
+                            handles.emplace_back(handle, type);
+                    } catch (const std::exception& e) {
+                        fail("published " + type + " failed: " + e.what());
+                    }
+                    local += 2;
+                }
+
+                // A type beyond what was published may or may not be there
+                // yet, but if it resolves it must be the right one
+                const std::string ahead = type_name(r, count + 1);
+                if (DatabaseFactory::supported(ahead)) {
+                    auto db = DatabaseFactory::create(ahead, config);
+                    check(db->connection_info() == ahead,
+                          "create(" + ahead + ") built the wrong backend");
+                }
+
+                // Rebinding is seen in order, never older than published
+                const int floor = rebinds.load(std::memory_order_acquire);
+                const int seen = generation(
+                    DatabaseFactory::create("stress-rebind", config)
+                        ->connection_info());
+                check(seen >= floor && seen >= lastGeneration,
+                      "stress-rebind went back to generation " +
+                          std::to_string(seen));
+                lastGeneration = seen;
+
+                // The built-in types never disappear
+                check(DatabaseFactory::supported("postgresql") &&
+                          DatabaseFactory::supported("redis"),
+                      "built-in type missing while registering");
+
+                // Unknown types throw and handles never go stale
+                try {
+                    DatabaseFactory::resolve("stress-unknown");
+                    fail("resolve(stress-unknown) did not throw");
+                } catch (const std::runtime_error&) {
+                }
+                if (!handles.empty()) {
+                    const auto& entry = handles[rng() % handles.size()];
+                    check(entry.first.create(config)->connection_info() ==
+                              entry.second,
+                          "handle of " + entry.second + " went stale");
+                }
+                local += 4;
+            }
+            checks.fetch_add(local);
+        });
+    }
+
+    for (auto& thread : threads) thread.join();
+    if (failed) return EXIT_FAILURE;
+
+    // Everything registered is listed and resolves to its creator
+    const auto types = DatabaseFactory::available_types();
+    const std::size_t expected =
+        static_cast<std::size_t>(Registrars * TypesPerRegistrar) + 1;
+    std::size_t listed = 0;
+    for (const auto& type : types)
+        if (type.compare(0, 7, "stress-") == 0) ++listed;
+    check(listed == expected, "available_types() lists " +
+                                  std::to_string(listed) + " of " +
+                                  std::to_string(expected) + " types");
+    for (int r = 0; r < Registrars; ++r) {
+        for (int i = 0; i < TypesPerRegistrar; ++i) {
+            const std::string type = type_name(r, i);
+            check(DatabaseFactory::create(type)->connection_info() == type,
+                  "create(" + type + ") wrong after registering");
+        }
+    }
+    check(generation(
+              DatabaseFactory::create("stress-rebind")->connection_info()) ==
+              Generations,
+          "stress-rebind is not the last generation");
+    if (failed) return EXIT_FAILURE;
+
+    std::printf("FactoryStress: %ld checks passed\n", checks.load());
+    return EXIT_SUCCESS;
+}
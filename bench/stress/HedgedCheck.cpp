@@ -0,0 +1,248 @@
+// Self-checking test of HedgedDatabase over in-process backends that stall
+// on demand and honour cancel(): a stalled read must be answered by the
+// hedge and the loser cancelled, a read must settle with the right answer
+// or error, hedges must only be counted when they run, and statements with
+// side effects must run once. Exits non-zero on the first wrong answer.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Errors.h"
+#include "FakeDatabase.h"
+#include "HedgedDatabase.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool failed = false;
+
+void check(bool condition, const std::string& message) {
+    if (!condition && !failed) {
+        failed = true;
+        std::fprintf(stderr, "%s\n", message.c_str());
+    }
+}
+
+// Backend whose next statements stall until cancelled or the stall time
+// passed; a cancelled statement fails with SQLSTATE 57014 like PostgreSQL.
+// With failing set, every statement then fails with that SQLSTATE.
+class StallDatabase final : public FakeDatabase {
+   public:
+    StallDatabase() : FakeDatabase(1) {}
+
+    std::unique_ptr<IResult> exec(const std::string& sql) override {
+        ++statements;
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_stalls > 0) {
+            --_stalls;
+            _cancelled = false;
+            _running = true;
+            _changed.notify_all();
+            const bool cancelled = _changed.wait_for(
+                lock, _stall, [this] { return _cancelled; });
+            _running = false;
+            if (cancelled) {
+                throw QueryError("canceling statement due to user request",
+                                 "57014");
+            }
+        }
+        if (!failing.empty()) throw QueryError("failed on purpose", failing);
+        lock.unlock();
+        return FakeDatabase::exec(sql);
+    }
+
+    using IDatabase::exec_params;
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         const ParamPack&) override {
+        return exec(sql);
+    }
+
+    // Like PQcancel: only the running statement is affected
+    bool cancel() override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++cancels;
+        _cancelled = true;
+        _changed.notify_all();
+        return true;
+    }
+
+    // Stall the next count statements for up to time
+    void stall(int count, std::chrono::milliseconds time) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stalls = count;
+        _stall = time;
+    }
+
+    // Wait until a statement is stalling
+    void wait_running() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _changed.wait(lock, [this] { return _running; });
+    }
+
+    std::atomic<int> statements{0};
+    std::atomic<int> cancels{0};
+    std::string failing;  // set before use
+
+   private:
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    int _stalls = 0;
+    std::chrono::milliseconds _stall{0};
+    bool _cancelled = false;
+    bool _running = false;
+};
+
+struct Hedged {
+    Hedged() {
+        std::vector<std::unique_ptr<IDatabase>> dbs;
+        for (auto*& backend : backends) {
+            auto db = std::make_unique<StallDatabase>();
+            backend = db.get();
+            dbs.push_back(std::move(db));
+        }
+        HedgeConfig config;
+        config.min_delay = std::chrono::milliseconds(2);
+        config.max_delay = std::chrono::milliseconds(2);
+        config.budget = 1.0;
+        hedged = std::make_unique<HedgedDatabase>(std::move(dbs), config);
+        hedged->connect();
+    }
+
+    int statements() const {
+        return backends[0]->statements + backends[1]->statements;
+    }
+
+    StallDatabase* backends[2];
+    std::unique_ptr<HedgedDatabase> hedged;
+};
+
+// Wait for a counter bumped by a pool thread after the read returned
+template <typename Condition>
+bool eventually(Condition condition) {
+    const auto deadline = Clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// A stalled first attempt loses to the hedge and is cancelled. A fresh
+// HedgedDatabase sends the first attempt to backend 0 and the hedge to
+// backend 1.
+void check_race() {
+    Hedged h;
+    h.backends[0]->stall(1, std::chrono::milliseconds(10 * 1000));
+
+    const auto start = Clock::now();
+    auto result = h.hedged->exec("SELECT id FROM users");
+    check(result != nullptr, "race returned no result");
+    check(Clock::now() - start < std::chrono::seconds(5),
+          "stalled read was not hedged");
+
+    HedgeStats stats = h.hedged->stats();
+    check(stats.reads == 1 && stats.hedges == 1, "hedge not counted");
+    check(stats.hedge_wins == 1, "hedge win not counted");
+    check(eventually([&] { return h.hedged->stats().cancels == 1; }),
+          "loser was not cancelled");
+    check(h.backends[0]->cancels == 1 && h.backends[1]->cancels == 0,
+          "cancel sent to the wrong backend");
+
+    // The cancel hit the stalled statement only: the next reads succeed
+    for (int i = 0; i < 4; ++i) {
+        try {
+            h.hedged->exec("SELECT id FROM users");
+        } catch (const DatabaseError& e) {
+            check(false, std::string("read after cancel: ") + e.what());
+        }
+    }
+}
+
+// A failing hedge leaves the read to the first attempt, and an error is
+// returned only once both failed (the first attempt's)
+void check_settle() {
+    {
+        Hedged h;
+        h.backends[0]->stall(1, std::chrono::milliseconds(50));
+        h.backends[1]->failing = "XX002";
+        auto result = h.hedged->exec("SELECT id FROM users");
+        check(result != nullptr, "failed hedge lost the first answer");
+        check(h.hedged->stats().hedges == 1 &&
+                  h.hedged->stats().hedge_wins == 0,
+              "failed hedge counted as a win");
+    }
+    {
+        Hedged h;
+        h.backends[0]->stall(1, std::chrono::milliseconds(50));
+        h.backends[0]->failing = "XX001";
+        h.backends[1]->failing = "XX002";
+        std::string sqlstate;
+        try {
+            h.hedged->exec("SELECT id FROM users");
+        } catch (const QueryError& e) {
+            sqlstate = e.sqlstate();
+        }
+        check(sqlstate == "XX001", "both failed: not the first error");
+    }
+    {
+        Hedged h;
+        h.backends[0]->failing = "XX001";
+        bool threw = false;
+        try {
+            h.hedged->exec("SELECT id FROM users");
+        } catch (const QueryError& e) {
+            threw = e.sqlstate() == "XX001";
+        }
+        check(threw, "failing read did not return its error");
+        check(h.hedged->stats().hedges == 0, "fast failure was hedged");
+    }
+}
+
+// Due hedges without an idle backend are skipped, not counted
+void check_counting() {
+    Hedged h;
+    // A write holds backend 0; the read then stalls on backend 1
+    h.backends[0]->stall(1, std::chrono::milliseconds(300));
+    std::thread writer(
+        [&h] { h.hedged->exec("INSERT INTO users VALUES (1)"); });
+    h.backends[0]->wait_running();
+
+    h.backends[1]->stall(1, std::chrono::milliseconds(100));
+    h.hedged->exec("SELECT id FROM users");
+    writer.join();
+
+    HedgeStats stats = h.hedged->stats();
+    check(stats.hedges == 0, "hedge counted without an idle backend");
+    check(stats.skipped == 1, "hedge without an idle backend not skipped");
+}
+
+// nextval() must not run twice, however slow it is
+void check_side_effects() {
+    Hedged h;
+    h.backends[0]->stall(1, std::chrono::milliseconds(50));
+    h.hedged->exec("SELECT nextval('orders_id_seq')");
+    check(h.statements() == 1, "nextval ran more than once");
+    check(h.hedged->stats().reads == 0, "nextval was hedged");
+}
+
+}  // namespace
+
+int main() {
+    check_race();
+    check_settle();
+    check_counting();
+    check_side_effects();
+    if (failed) return EXIT_FAILURE;
+
+    std::printf("HedgedCheck: passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,217 @@
+// Self-checking test of PostgreListener against a live server: listen()
+// futures become ready once LISTEN ran, callbacks receive each
+// notification, queued channels are read with poll() and wait() and count
+// what a full queue drops, and a connection killed with
+// pg_terminate_backend() is replaced and its channels subscribed again.
+// Exits non-zero on the first wrong answer and with 77 (skipped under
+// ctest) when no server is reachable.
+//
+// Connects using PGHOST, PGPORT, PGDATABASE, PGUSER and PGPASSWORD
+// (defaults localhost:5432, postgres).
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Errors.h"
+#include "PostgreDatabase.h"
+#include "PostgreListener.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int Skipped = 77;
+
+bool failed = false;
+
+void check(bool condition, const std::string& message) {
+    if (!condition && !failed) {
+        failed = true;
+        std::fprintf(stderr, "%s\n", message.c_str());
+    }
+}
+
+DatabaseConfig config() {
+    auto env = [](const char* name, const char* fallback) {
+        const char* value = std::getenv(name);
+        return std::string(value ? value : fallback);
+    };
+    DatabaseConfig config;
+    config.host = env("PGHOST", "localhost");
+    config.port = std::stoi(env("PGPORT", "5432"));
+    config.database = env("PGDATABASE", "postgres");
+    config.username = env("PGUSER", "postgres");
+    config.password = env("PGPASSWORD", "");
+    return config;
+}
+
+// Wait for something the listener thread does
+template <typename Condition>
+bool eventually(Condition condition) {
+    const auto deadline = Clock::now() + std::chrono::seconds(10);
+    while (!condition()) {
+        if (Clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// Whether future is ready in time and holds no error
+bool listened(std::future<void>& future) {
+    if (future.wait_for(std::chrono::seconds(10)) !=
+        std::future_status::ready)
+        return false;
+    try {
+        future.get();
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+std::int64_t scalar(PostgreDatabase& db, const std::string& sql) {
+    auto result = db.exec(sql);
+    return static_cast<const PostgreResult&>(*result).front().get<
+        std::int64_t>(0);
+}
+
+void check_callbacks(PostgreDatabase& db) {
+    std::mutex mutex;
+    std::vector<PostgreNotification> received;
+
+    PostgreListener listener(config());
+    auto future = listener.listen(
+        "dbf_check_calls", [&](const PostgreNotification& notification) {
+            std::lock_guard<std::mutex> lock(mutex);
+            received.push_back(notification);
+        });
+    check(listened(future), "listen future not ready");
+
+    const std::int64_t sender = scalar(db, "SELECT pg_backend_pid()");
+    db.exec("NOTIFY dbf_check_calls, 'one'");
+    check(eventually([&] {
+              std::lock_guard<std::mutex> lock(mutex);
+              return received.size() == 1;
+          }),
+          "callback not called");
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        check(!received.empty() && received[0].channel == "dbf_check_calls" &&
+                  received[0].payload == "one" && received[0].pid == sender,
+              "callback got the wrong notification");
+    }
+
+    // A throwing callback is counted and the others still run
+    auto throwing = listener.listen(
+        "dbf_check_calls",
+        [](const PostgreNotification&) { throw std::runtime_error("x"); });
+    check(listened(throwing), "second listen future not ready");
+    db.exec("NOTIFY dbf_check_calls, 'two'");
+    check(eventually([&] { return listener.stats().callback_errors == 1; }),
+          "callback error not counted");
+    check(eventually([&] {
+              std::lock_guard<std::mutex> lock(mutex);
+              return received.size() == 2;
+          }),
+          "throwing callback stopped the others");
+    check(listener.stats().dispatched == 2, "dispatched count wrong");
+}
+
+void check_queue(PostgreDatabase& db) {
+    PostgreListenOptions options;
+    options.queue_capacity = 4;
+    PostgreListener listener(config(), options);
+    auto future = listener.listen("dbf_check_queue");
+    check(listened(future), "queued listen future not ready");
+
+    PostgreNotification notification;
+    check(!listener.poll(notification), "poll on an empty queue");
+    check(!listener.wait(notification, std::chrono::milliseconds(20)),
+          "wait on an empty queue");
+
+    db.exec("NOTIFY dbf_check_queue, 'a'");
+    check(listener.wait(notification, std::chrono::seconds(10)) &&
+              notification.channel == "dbf_check_queue" &&
+              notification.payload == "a",
+          "wait missed a notification");
+
+    // Ten notifications into a queue of four: six are dropped
+    db.exec(
+        "SELECT pg_notify('dbf_check_queue', g::text) "
+        "FROM generate_series(1, 10) AS g");
+    check(eventually([&] { return listener.stats().received == 11; }),
+          "notifications not received");
+    PostgreListenStats stats = listener.stats();
+    check(stats.queued == 5 && stats.dropped == 6,
+          "queued or dropped count wrong");
+    for (const char* payload : {"1", "2", "3", "4"}) {
+        check(listener.poll(notification) && notification.payload == payload,
+              std::string("queue lost notification ") + payload);
+    }
+    check(!listener.poll(notification), "queue kept a dropped notification");
+}
+
+void check_reconnect(PostgreDatabase& db) {
+    std::atomic<int> calls{0};
+    std::atomic<int> reconnects{0};
+
+    PostgreListenOptions options;
+    options.reconnect_delay = std::chrono::milliseconds(10);
+    options.on_reconnect = [&] { ++reconnects; };
+    PostgreListener listener(config(), options);
+    auto future = listener.listen("dbf_check_reconnect",
+                                  [&](const PostgreNotification&) { ++calls; });
+    check(listened(future), "listen future not ready before reconnect");
+
+    db.exec("NOTIFY dbf_check_reconnect");
+    check(eventually([&] { return calls == 1; }), "notification lost");
+
+    // The listener's last statement was its LISTEN
+    const std::int64_t killed = scalar(
+        db,
+        "SELECT count(pg_terminate_backend(pid)) FROM pg_stat_activity "
+        "WHERE pid <> pg_backend_pid() "
+        "AND query = 'LISTEN \"dbf_check_reconnect\"'");
+    check(killed == 1, "listener backend not found");
+
+    check(eventually([&] { return reconnects == 1; }),
+          "on_reconnect did not run");
+    check(listener.connected() && listener.stats().reconnects == 1,
+          "reconnect not counted");
+
+    // on_reconnect runs after LISTEN, so this one is heard
+    db.exec("NOTIFY dbf_check_reconnect");
+    check(eventually([&] { return calls == 2; }),
+          "channel not subscribed again after reconnect");
+}
+
+}  // namespace
+
+int main() {
+    const DatabaseConfig cfg = config();
+    PostgreDatabase db(cfg.host, cfg.port, cfg.database, cfg.username,
+                       cfg.password);
+    try {
+        db.connect();
+    } catch (const ConnectionError& e) {
+        std::printf("ListenerCheck: skipped, no server (%s)\n", e.what());
+        return Skipped;
+    }
+
+    check_callbacks(db);
+    check_queue(db);
+    check_reconnect(db);
+    if (failed) return EXIT_FAILURE;
+
+    std::printf("ListenerCheck: passed\n");
+    return EXIT_SUCCESS;
+}
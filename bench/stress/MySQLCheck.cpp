@@ -0,0 +1,172 @@
+// Self-checking test of the MySQL backend against a live server: values of
+// every parameter type round-trip through '?' placeholders and the text
+// protocol, cached prepared statements are reused, failing statements
+// leave the connection usable, transactions roll back and streams read
+// and abandon large results. Exits non-zero on the first wrong answer and
+// with 77 (skipped under ctest) when no server is reachable.
+//
+// Connects using MYSQL_HOST, MYSQL_TCP_PORT, MYSQL_DATABASE, MYSQL_USER and
+// MYSQL_PWD (defaults 127.0.0.1:3306, test, root).
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Errors.h"
+#include "MySQLDatabase.h"
+#include "MySQLStream.h"
+
+namespace {
+
+constexpr int Skipped = 77;
+
+bool failed = false;
+
+void check(bool condition, const std::string& message) {
+    if (!condition && !failed) {
+        failed = true;
+        std::fprintf(stderr, "%s\n", message.c_str());
+    }
+}
+
+// SQLSTATE of the QueryError run throws, empty if it succeeds
+template <typename Run>
+std::string sqlstate_of(Run run) {
+    try {
+        run();
+    } catch (const QueryError& e) {
+        return e.sqlstate().empty() ? "?" : e.sqlstate();
+    }
+    return "";
+}
+
+DatabaseConfig config() {
+    auto env = [](const char* name, const char* fallback) {
+        const char* value = std::getenv(name);
+        return std::string(value ? value : fallback);
+    };
+    DatabaseConfig config;
+    config.host = env("MYSQL_HOST", "127.0.0.1");
+    config.port = std::stoi(env("MYSQL_TCP_PORT", "3306"));
+    config.database = env("MYSQL_DATABASE", "test");
+    config.username = env("MYSQL_USER", "root");
+    config.password = env("MYSQL_PWD", "");
+    return config;
+}
+
+void check_values(MySQLDatabase& db) {
+    auto text = db.query("SELECT 42, 2.5e0, 'x', NULL");
+    check(text.value(0, 0).type() == Param::Type::Int &&
+              text.get<std::int64_t>(0, 0) == 42,
+          "text protocol integer");
+    check(text.get<double>(0, 1) == 2.5, "text protocol double");
+    check(text.get<std::string>(0, 2) == "x", "text protocol string");
+    check(text.is_null(0, 3), "text protocol NULL");
+
+    const auto stamp = std::chrono::system_clock::time_point(
+        std::chrono::seconds(1700000000) + std::chrono::microseconds(123456));
+    auto bound = db.query_params(
+        "SELECT ?, ?, ?, ?, ?, ?, ?",
+        {-7, 0.25, std::string(1000, 'y'), nullptr,
+         Param::bytea(std::string("\0\xff", 2)), 'c',
+         std::uint64_t(18446744073709551615ull)});
+    check(bound.get<std::int64_t>(0, 0) == -7, "bound integer");
+    check(bound.get<double>(0, 1) == 0.25, "bound double");
+    check(bound.get<std::string>(0, 2) == std::string(1000, 'y'),
+          "bound long text");
+    check(bound.is_null(0, 3), "bound NULL");
+    check(bound.value(0, 4).as_text() == std::string("\0\xff", 2),
+          "bound bytes");
+    check(bound.get<std::string>(0, 5) == "c", "bound char");
+    check(bound.get<std::string>(0, 6) == "18446744073709551615",
+          "bound uint64 above INT64_MAX");
+
+    auto time = db.query_params("SELECT CAST(? AS DATETIME(6))", {stamp});
+    check(time.get<Param::Timestamp>(0, 0) == stamp, "bound timestamp");
+
+    // Several statements over the text protocol return the last result
+    auto last = db.query("SELECT 1; SELECT 2");
+    check(last.get<std::int64_t>(0, 0) == 2, "multi-statement result");
+}
+
+void check_statements(MySQLDatabase& db) {
+    db.exec(
+        "CREATE TEMPORARY TABLE dbf_check (id BIGINT PRIMARY KEY, "
+        "name VARCHAR(32)) ENGINE=InnoDB");
+
+    const std::size_t before = db.cached_statements();
+    const std::string insert = "INSERT INTO dbf_check VALUES (?, ?)";
+    for (int id = 1; id <= 100; ++id) db.exec_params(insert, id, "row");
+    check(db.cached_statements() == before + 1,
+          "prepared statement cached more than once");
+
+    auto count = db.query_params("SELECT count(*) FROM dbf_check", {});
+    check(count.get<std::int64_t>(0, 0) == 100, "cached insert lost rows");
+
+    // Errors keep their SQLSTATE and leave the connection usable
+    check(sqlstate_of([&] { db.exec_params(insert, 1, "dup"); }) == "23000",
+          "duplicate key not reported as 23000");
+    check(sqlstate_of([&] { db.exec("SELEC 1"); }) == "42000",
+          "syntax error not reported as 42000");
+    check(!sqlstate_of([&] { db.exec_params(insert, 1); }).empty(),
+          "missing parameter accepted");
+    db.exec_params(insert, 101, "after errors");
+
+    // Transactions roll back
+    db.exec("START TRANSACTION");
+    db.exec_params(insert, 102, "rolled back");
+    db.exec("ROLLBACK");
+    count = db.query("SELECT count(*) FROM dbf_check");
+    check(count.get<std::int64_t>(0, 0) == 101, "rollback kept a row");
+}
+
+void check_streams(MySQLDatabase& db) {
+    db.exec(
+        "CREATE TEMPORARY TABLE dbf_check_rows AS "
+        "SELECT a.id * 100 + b.id AS id FROM dbf_check a "
+        "CROSS JOIN dbf_check b WHERE a.id <= 100 AND b.id <= 100");
+
+    std::int64_t sum = 0;
+    {
+        MySQLStream stream = db.stream("SELECT id FROM dbf_check_rows");
+        for (const auto& row : stream) sum += row[0].as_int();
+        check(stream.done() && stream.rows() == 10000, "stream lost rows");
+    }
+    auto expected = db.query("SELECT CAST(sum(id) AS SIGNED) "
+                             "FROM dbf_check_rows");
+    check(sum == expected.get<std::int64_t>(0, 0), "streamed rows differ");
+
+    {
+        MySQLStream stream = db.stream_params(
+            "SELECT id FROM dbf_check_rows WHERE id > ?", {0});
+        std::size_t read = 0;
+        for (auto itr = stream.begin(); itr != stream.end() && read < 10;
+             ++itr)
+            ++read;
+        stream.close();
+    }
+    check(db.query("SELECT 1").get<std::int64_t>(0, 0) == 1,
+          "connection unusable after an abandoned stream");
+}
+
+}  // namespace
+
+int main() {
+    MySQLDatabase db(config());
+    try {
+        db.connect();
+    } catch (const ConnectionError& e) {
+        std::printf("MySQLCheck: skipped, no server (%s)\n", e.what());
+        return Skipped;
+    }
+
+    check_values(db);
+    check_statements(db);
+    check_streams(db);
+    if (failed) return EXIT_FAILURE;
+
+    std::printf("MySQLCheck: passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,315 @@
+// Self-checking comparison of the two PostgreSQL decoders: random values
+// are encoded the way the server sends them in binary and in text format,
+// and PostgreBinary must decode every one to exactly (bit for bit) what
+// ColumnDecoder makes of the text. No server is needed.
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ColumnDecoder.h"
+#include "PostgreBinary.h"
+
+namespace {
+
+using Timestamp = PostgreBinary::Timestamp;
+
+constexpr int Samples = 100000;
+
+// PostgreSQL epoch (2000-01-01) relative to the Unix epoch
+constexpr std::int64_t EpochDays = 10957;
+
+std::mt19937_64 rng(20240101);
+
+long checked = 0;
+long failures = 0;
+
+// Value in network byte order, as a binary-format field
+std::string network(std::uint64_t value, std::size_t size) {
+    std::string bytes(size, '\0');
+    for (std::size_t i = 0; i < size; ++i)
+        bytes[size - 1 - i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    return bytes;
+}
+
+template <typename T>
+bool same(const T& a, const T& b) {
+    if constexpr (std::is_floating_point_v<T>) {
+        return std::memcmp(&a, &b, sizeof(T)) == 0;
+    } else {
+        return a == b;
+    }
+}
+
+// Decode both representations and compare; a value both decoders reject
+// (out of the Timestamp range) agrees too
+template <typename T>
+void compare(unsigned oid, const std::string& binary, const std::string& text) {
+    ++checked;
+    T fromBinary{};
+    T fromText{};
+    std::string binaryError;
+    std::string textError;
+    try {
+        PostgreBinary::decode(oid, binary, fromBinary);
+    } catch (const std::exception& e) {
+        binaryError = e.what();
+    }
+    try {
+        ColumnDecoder::decode(text.c_str(), text.size(), fromText);
+    } catch (const std::exception& e) {
+        textError = e.what();
+    }
+
+    const char* problem = nullptr;
+    if (binaryError.empty() != textError.empty())
+        problem = "only one decoder rejects it";
+    else if (binaryError.empty() && !same(fromBinary, fromText))
+        problem = "binary and text differ";
+    if (problem != nullptr && failures++ < 10) {
+        std::fprintf(stderr, "oid %u \"%s\": %s %s%s\n", oid, text.c_str(),
+                     problem, binaryError.c_str(), textError.c_str());
+    }
+}
+
+template <typename Float>
+std::string float_text(Float value) {
+    if (std::isnan(value)) return "NaN";
+    if (std::isinf(value)) return value > 0 ? "Infinity" : "-Infinity";
+    // Shortest exact form, like the server with extra_float_digits = 1
+    char buffer[64];
+    auto end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+    return std::string(buffer, end);
+}
+
+// Days since 1970-01-01 to year, month, day (proleptic Gregorian)
+void civil_from_days(std::int64_t days, std::int64_t& year, unsigned& month,
+                     unsigned& day) {
+    days += 719468;
+    const std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const auto doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<std::int64_t>(yoe) + era * 400 + (month <= 2);
+}
+
+// Date as the server prints it with DateStyle ISO
+std::string date_text(std::int64_t unixDays) {
+    std::int64_t year;
+    unsigned month, day;
+    civil_from_days(unixDays, year, month, day);
+    char buffer[32];
+    const bool bc = year <= 0;
+    std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u",
+                  static_cast<long long>(bc ? 1 - year : year), month, day);
+    return buffer + std::string(bc ? " BC" : "");
+}
+
+// Timestamp (microseconds since the Unix epoch) as the server prints it,
+// with "+00" appended for timestamptz in a UTC session
+std::string timestamp_text(std::int64_t micros, bool zone) {
+    std::int64_t seconds = micros / 1000000;
+    std::int64_t fraction = micros % 1000000;
+    if (fraction < 0) {
+        fraction += 1000000;
+        --seconds;
+    }
+    std::int64_t days = seconds / 86400;
+    std::int64_t time = seconds % 86400;
+    if (time < 0) {
+        time += 86400;
+        --days;
+    }
+    std::int64_t year;
+    unsigned month, day;
+    civil_from_days(days, year, month, day);
+
+    char buffer[64];
+    const bool bc = year <= 0;
+    int length = std::snprintf(
+        buffer, sizeof(buffer), "%04lld-%02u-%02u %02d:%02d:%02d",
+        static_cast<long long>(bc ? 1 - year : year), month, day,
+        static_cast<int>(time / 3600), static_cast<int>(time / 60 % 60),
+        static_cast<int>(time % 60));
+    std::string text(buffer, length);
+    if (fraction != 0) {
+        std::snprintf(buffer, sizeof(buffer), ".%06lld",
+                      static_cast<long long>(fraction));
+        std::string digits(buffer);
+        digits.erase(digits.find_last_not_of('0') + 1);
+        text += digits;
+    }
+    if (zone) text += "+00";
+    if (bc) text += " BC";
+    return text;
+}
+
+void check_integers() {
+    using Int8 = std::numeric_limits<std::int64_t>;
+    using Int4 = std::numeric_limits<std::int32_t>;
+    using Int2 = std::numeric_limits<std::int16_t>;
+    std::vector<std::int64_t> values = {0,           1,           -1,
+                                        Int8::min(), Int8::max(), Int4::min(),
+                                        Int4::max(), Int2::min(), Int2::max()};
+    for (int i = 0; i < Samples; ++i) {
+        // Every magnitude, not only 19-digit values
+        values.push_back(static_cast<std::int64_t>(rng()) >> (rng() % 64));
+    }
+
+    for (std::int64_t value : values) {
+        const std::string text = std::to_string(value);
+        const auto bits = static_cast<std::uint64_t>(value);
+        compare<std::int64_t>(PostgreBinary::Int8, network(bits, 8), text);
+        if (value == static_cast<std::int32_t>(value))
+            compare<std::int32_t>(PostgreBinary::Int4, network(bits, 4), text);
+        if (value == static_cast<std::int16_t>(value))
+            compare<std::int16_t>(PostgreBinary::Int2, network(bits, 2), text);
+    }
+}
+
+void check_floats() {
+    std::vector<double> values = {0.0,
+                                  -0.0,
+                                  0.1,
+                                  1.0 / 3,
+                                  1e-310,
+                                  std::numeric_limits<double>::min(),
+                                  std::numeric_limits<double>::max(),
+                                  std::numeric_limits<double>::denorm_min(),
+                                  std::numeric_limits<double>::infinity(),
+                                  -std::numeric_limits<double>::infinity(),
+                                  std::numeric_limits<double>::quiet_NaN()};
+    std::uniform_real_distribution<double> uniform(-1e6, 1e6);
+    for (int i = 0; i < Samples; ++i) {
+        values.push_back(uniform(rng));
+        // Any finite bit pattern
+        std::uint64_t bits = rng();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (std::isfinite(value)) values.push_back(value);
+        // Money-like values with few digits
+        values.push_back(static_cast<double>(rng() % 10000000) / 100);
+    }
+
+    for (double value : values) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        compare<double>(PostgreBinary::Float8, network(bits, 8),
+                        float_text(value));
+
+        const auto narrow = static_cast<float>(value);
+        std::uint32_t narrowBits;
+        std::memcpy(&narrowBits, &narrow, sizeof(narrowBits));
+        compare<float>(PostgreBinary::Float4, network(narrowBits, 4),
+                       float_text(narrow));
+    }
+}
+
+void check_strings() {
+    std::vector<std::string> values = {"", "a", "name-1", "O'Brien", "--",
+                                       std::string(1000, 'x')};
+    for (int i = 0; i < Samples / 10; ++i) {
+        std::string value(rng() % 64, '\0');
+        for (auto& c : value) c = static_cast<char>(1 + rng() % 255);
+        values.push_back(value);
+    }
+    for (const auto& value : values) {
+        compare<std::string>(PostgreBinary::Text, value, value);
+        compare<std::string>(PostgreBinary::Varchar, value, value);
+    }
+
+    // uuid: 16 raw bytes against the canonical text form
+    static constexpr char Hex[] = "0123456789abcdef";
+    for (int i = 0; i < Samples / 10; ++i) {
+        std::string bytes = network(rng(), 8) + network(rng(), 8);
+        std::string text;
+        for (std::size_t b = 0; b < bytes.size(); ++b) {
+            if (b == 4 || b == 6 || b == 8 || b == 10) text += '-';
+            auto byte = static_cast<unsigned char>(bytes[b]);
+            text += Hex[byte >> 4];
+            text += Hex[byte & 0x0F];
+        }
+        compare<std::string>(PostgreBinary::Uuid, bytes, text);
+    }
+}
+
+void check_timestamps() {
+    // From 4713 BC, the first day both types hold, far past the 1678 to
+    // 2262 a Timestamp can hold; both decoders must reject the same ones
+    const std::int64_t low = -210866803200LL * 1000000;
+    const std::int64_t high = std::numeric_limits<std::int64_t>::max() / 2;
+    std::uniform_int_distribution<std::int64_t> anyTime(low, high);
+    // Most timestamps are recent; test those densely
+    std::uniform_int_distribution<std::int64_t> recent(0, 4102444800000000LL);
+
+    std::vector<std::int64_t> values = {0, -1, 1, 946684800000000LL, low,
+                                        high};
+    for (int i = 0; i < Samples; ++i) {
+        values.push_back(anyTime(rng));
+        values.push_back(recent(rng));
+        values.push_back(recent(rng) / 1000000 * 1000000);  // whole seconds
+    }
+
+    for (std::int64_t micros : values) {
+        const auto sinceEpoch = static_cast<std::uint64_t>(
+            micros - EpochDays * 86400 * 1000000);
+        compare<Timestamp>(PostgreBinary::TimestampType,
+                           network(sinceEpoch, 8),
+                           timestamp_text(micros, false));
+        compare<Timestamp>(PostgreBinary::TimestampTz, network(sinceEpoch, 8),
+                           timestamp_text(micros, true));
+
+        std::int64_t days = micros / 86400000000LL;
+        if (micros < 0 && micros % 86400000000LL != 0) --days;
+        compare<Timestamp>(PostgreBinary::Date,
+                           network(static_cast<std::uint64_t>(days - EpochDays),
+                                   4),
+                           date_text(days));
+    }
+
+    const auto infinity =
+        network(static_cast<std::uint64_t>(
+                    std::numeric_limits<std::int64_t>::max()),
+                8);
+    const auto minusInfinity =
+        network(static_cast<std::uint64_t>(
+                    std::numeric_limits<std::int64_t>::min()),
+                8);
+    compare<Timestamp>(PostgreBinary::TimestampTz, infinity, "infinity");
+    compare<Timestamp>(PostgreBinary::TimestampTz, minusInfinity, "-infinity");
+}
+
+void check_booleans() {
+    compare<bool>(PostgreBinary::Bool, std::string(1, '\1'), "t");
+    compare<bool>(PostgreBinary::Bool, std::string(1, '\0'), "f");
+}
+
+}  // namespace
+
+int main() {
+    check_integers();
+    check_floats();
+    check_strings();
+    check_timestamps();
+    check_booleans();
+
+    if (failures != 0) {
+        std::fprintf(stderr, "PostgreBinaryCheck: %ld of %ld values differ\n",
+                     failures, checked);
+        return EXIT_FAILURE;
+    }
+    std::printf("PostgreBinaryCheck: %ld values identical\n", checked);
+    return EXIT_SUCCESS;
+}
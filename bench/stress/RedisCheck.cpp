@@ -0,0 +1,240 @@
+// Self-checking test of the Redis client: the RESP parser is fed replies
+// in random pieces and must agree with a one-shot parse, then
+// RedisDatabase runs against the in-process RedisStub (or the server in
+// REDIS_HOST/REDIS_PORT). Exits non-zero on the first wrong answer.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Errors.h"
+#include "RedisDatabase.h"
+#include "RedisProtocol.h"
+#include "RedisStub.h"
+
+namespace {
+
+bool failed = false;
+
+void check(bool condition, const std::string& message) {
+    if (!condition && !failed) {
+        failed = true;
+        std::fprintf(stderr, "%s\n", message.c_str());
+    }
+}
+
+bool same(const RedisNode& a, const RedisNode& b) {
+    return a.type == b.type && a.count == b.count && a.next == b.next &&
+           a.text == b.text && a.integer == b.integer &&
+           (a.number == b.number || (a.number != a.number &&
+                                     b.number != b.number));
+}
+
+// Replies covering every type, nesting and attributes
+std::vector<std::string> corpus() {
+    std::vector<std::string> replies = {
+        "+OK\r\n",
+        "-ERR wrong type\r\n",
+        ":-42\r\n",
+        "$5\r\nhello\r\n",
+        "$0\r\n\r\n",
+        "$-1\r\n",
+        "*-1\r\n",
+        "_\r\n",
+        "#t\r\n",
+        ",3.25\r\n",
+        ",inf\r\n",
+        ",nan\r\n",
+        "(12345678901234567890\r\n",
+        "=15\r\ntxt:Some string\r\n",
+        "!9\r\nSYNTAX no\r\n",
+        "*0\r\n",
+        "*3\r\n:1\r\n$3\r\na\r\n\r\n*2\r\n+x\r\n*0\r\n",
+        "%2\r\n+a\r\n:1\r\n+b\r\n*1\r\n$1\r\nz\r\n",
+        "~2\r\n+a\r\n+b\r\n",
+        ">3\r\n$7\r\nmessage\r\n$2\r\nch\r\n$2\r\nhi\r\n",
+        "|1\r\n+ttl\r\n:3600\r\n+OK\r\n",
+        "*2\r\n|1\r\n+key\r\n+v\r\n:1\r\n|0\r\n:2\r\n",
+        "|1\r\n+a\r\n|1\r\n+b\r\n:2\r\n:3\r\n$2\r\nok\r\n",
+    };
+
+    // Deep nesting and a wide array
+    std::string deep;
+    for (int i = 0; i < 100; ++i) deep += "*1\r\n";
+    replies.push_back(deep + ":7\r\n");
+    std::string wide = "*1000\r\n";
+    for (int i = 0; i < 1000; ++i)
+        wide += "$" + std::to_string(i % 10) + "\r\n" +
+                std::string(i % 10, 'x') + "\r\n";
+    replies.push_back(wide);
+    return replies;
+}
+
+// Feeds every reply in random pieces into a buffer that moves on every
+// read, as the receive buffer does when it grows
+void check_parser() {
+    std::mt19937 rng(7);
+    for (const auto& reply : corpus()) {
+        std::vector<RedisNode> expected;
+        const std::size_t size =
+            RedisProtocol::parse(reply.data(), reply.size(), expected);
+        check(size == reply.size(), "one-shot parse of " + reply);
+
+        for (int round = 0; round < 20 && !failed; ++round) {
+            RedisParser parser;
+            std::vector<RedisNode> nodes;
+            auto buffer = std::make_unique<std::string>();
+            std::size_t used = 0;
+            std::size_t fed = 0;
+            while (used == 0 && fed < reply.size()) {
+                const std::size_t piece =
+                    std::min<std::size_t>(1 + rng() % 7, reply.size() - fed);
+                auto moved = std::make_unique<std::string>(*buffer);
+                moved->append(reply, fed, piece);
+                buffer = std::move(moved);
+                fed += piece;
+                used = parser.parse(buffer->data(), buffer->size(), nodes);
+            }
+            check(used == reply.size() && fed == reply.size(),
+                  "incremental parse did not finish " + reply);
+            check(nodes.size() == expected.size(),
+                  "incremental parse node count of " + reply);
+            for (std::size_t i = 0; i < nodes.size() && !failed; ++i) {
+                check(same(nodes[i], expected[i]) &&
+                          (nodes[i].text.empty() ||
+                           (nodes[i].text.data() >= buffer->data() &&
+                            nodes[i].text.data() <
+                                buffer->data() + buffer->size())),
+                      "incremental parse differs on " + reply);
+            }
+        }
+    }
+
+    // Malformed input is rejected, not waited on
+    for (const char* bad : {"?\r\n", ":12x\r\n", "$3\r\nabcd\r\n", "+a\rb"}) {
+        std::vector<RedisNode> nodes;
+        bool threw = false;
+        try {
+            RedisProtocol::parse(bad, std::strlen(bad), nodes);
+        } catch (const QueryError&) {
+            threw = true;
+        }
+        check(threw, std::string("malformed reply accepted: ") + bad);
+    }
+}
+
+void check_client(const std::string& host, int port) {
+    RedisDatabase db(host, port);
+    db.connect();
+
+    // Binary-safe values and error replies
+    const std::string value("a\r\nb\0c $1", 9);
+    db.exec_params("SET dbf:check $1", value);
+    check(db.query("GET dbf:check").str() == value, "GET after SET");
+    check(db.query("GET dbf:missing").is_null(), "GET of a missing key");
+    bool threw = false;
+    try {
+        db.exec("NOSUCHCOMMAND");
+    } catch (const QueryError&) {
+        threw = true;
+    }
+    check(threw, "error reply did not throw");
+    auto replies = db.pipeline({"PING", "NOSUCHCOMMAND", "ECHO x"});
+    check(replies.size() == 3 && replies[1]->is_error() &&
+              replies[2]->str() == "x",
+          "pipeline() replies");
+
+    // A malformed command rejects the whole pipeline before anything is
+    // queued, and the connection keeps serving callers afterwards
+    threw = false;
+    try {
+        db.pipeline({"SET dbf:check 1", "GET 'unterminated"});
+    } catch (const QueryError&) {
+        threw = true;
+    }
+    check(threw, "malformed pipeline command did not throw");
+    auto after = db.exec_async("ECHO after");
+    check(after.wait_for(std::chrono::seconds(5)) ==
+                  std::future_status::ready &&
+              static_cast<RedisResult&>(*after.get()).str() == "after",
+          "exec_async after a failed pipeline()");
+    check(db.query("GET dbf:check").str() == value,
+          "failed pipeline() ran some of its commands");
+
+    // Replies much larger than the receive buffer
+    auto blob = db.query("BLOB 8000000");
+    bool blobOk = blob.str().size() == 8000000;
+    for (std::size_t i = 0; blobOk && i < blob.str().size(); i += 4099)
+        blobOk = blob.str()[i] == static_cast<char>('a' + i % 26);
+    check(blobOk, "8 MB bulk reply");
+    auto range = db.query("RANGE 200000 3");
+    bool rangeOk = range.size() == 200000;
+    for (std::size_t i = 0; rangeOk && i < range.size(); ++i)
+        rangeOk = range[i].str() == "vvv";
+    check(rangeOk, "200000 element reply");
+
+    // Concurrent callers are pipelined and each gets its own reply
+    db.exec("DEL dbf:counter");
+    std::vector<std::thread> threads;
+    std::vector<std::vector<std::int64_t>> seen(8);
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&db, &seen, t] {
+            std::vector<std::future<std::unique_ptr<IResult>>> futures;
+            for (int i = 0; i < 500; ++i)
+                futures.push_back(db.exec_async("INCR dbf:counter"));
+            for (auto& future : futures) {
+                auto result = future.get();
+                seen[t].push_back(
+                    static_cast<RedisResult&>(*result).integer());
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    std::vector<bool> hit(4001, false);
+    bool counterOk = true;
+    for (const auto& values : seen) {
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            // Replies of one caller come back in its order
+            if (i > 0 && values[i] <= values[i - 1]) counterOk = false;
+            if (values[i] < 1 || values[i] > 4000 || hit[values[i]])
+                counterOk = false;
+            else
+                hit[values[i]] = true;
+        }
+    }
+    check(counterOk, "pipelined INCR replies");
+    db.exec("DEL dbf:check dbf:counter");
+
+    // RESP3, with a map reply to HELLO
+    RedisDatabase resp3(host, port);
+    resp3.protocol(3);
+    resp3.connect();
+    check(resp3.query("PING").str() == "PONG", "PING over RESP3");
+}
+
+}  // namespace
+
+int main() {
+    check_parser();
+    if (failed) return EXIT_FAILURE;
+
+    const char* host = std::getenv("REDIS_HOST");
+    if (host != nullptr) {
+        const char* port = std::getenv("REDIS_PORT");
+        check_client(host, port ? std::atoi(port) : 6379);
+    } else {
+        RedisStub stub;
+        check_client("127.0.0.1", stub.port());
+    }
+    if (failed) return EXIT_FAILURE;
+
+    std::printf("RedisCheck: passed\n");
+    return EXIT_SUCCESS;
+}
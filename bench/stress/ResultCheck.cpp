@@ -0,0 +1,200 @@
+// Self-checking test of PostgreSQL result access against a live server:
+// PostgreDetachedResult keeps every cell's offset, length and NULL flag
+// (NULL, empty and multi-byte text, results without rows or columns, and
+// copies outliving the original), and PostgreResult::to_structs decodes
+// rows and names the column of a NULL read into a plain member. Exits
+// non-zero on the first wrong answer and with 77 (skipped under ctest)
+// when no server is reachable.
+//
+// Connects using PGHOST, PGPORT, PGDATABASE, PGUSER and PGPASSWORD
+// (defaults localhost:5432, postgres).
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "DatabaseConfig.h"
+#include "Errors.h"
+#include "PostgreDatabase.h"
+#include "PostgreDetachedResult.h"
+#include "RowMap.h"
+
+namespace {
+
+constexpr int Skipped = 77;
+
+bool failed = false;
+
+void check(bool condition, const std::string& message) {
+    if (!condition && !failed) {
+        failed = true;
+        std::fprintf(stderr, "%s\n", message.c_str());
+    }
+}
+
+DatabaseConfig config() {
+    auto env = [](const char* name, const char* fallback) {
+        const char* value = std::getenv(name);
+        return std::string(value ? value : fallback);
+    };
+    DatabaseConfig config;
+    config.host = env("PGHOST", "localhost");
+    config.port = std::stoi(env("PGPORT", "5432"));
+    config.database = env("PGDATABASE", "postgres");
+    config.username = env("PGUSER", "postgres");
+    config.password = env("PGPASSWORD", "");
+    return config;
+}
+
+// Row g has: id g; name NULL when g % 3 == 0, empty when g % 3 == 1 and
+// g two-byte characters otherwise; score NULL when g is even
+constexpr int Rows = 200;
+const char* const RowsSql =
+    "SELECT g AS id, CASE WHEN g % 3 = 0 THEN NULL WHEN g % 3 = 1 THEN '' "
+    "ELSE repeat(chr(233), g) END AS name, CASE WHEN g % 2 = 0 THEN NULL "
+    "ELSE g * 0.5 END AS score FROM generate_series(1, 200) AS g";
+
+std::optional<std::string> expected_name(int g) {
+    if (g % 3 == 0) return std::nullopt;
+    std::string name;
+    if (g % 3 != 1) {
+        for (int i = 0; i < g; ++i) name += "\xc3\xa9";
+    }
+    return name;
+}
+
+// Every cell of detached against the expected rows
+void check_cells(const PostgreDetachedResult& detached,
+                 const std::string& what) {
+    check(detached.size() == Rows && detached.columns() == 3,
+          what + ": wrong shape");
+    if (detached.size() != Rows || detached.columns() != 3) return;
+    check(detached.column_name(1) == "name" &&
+              detached.column_index("score") == 2,
+          what + ": wrong column names");
+
+    for (int g = 1; g <= Rows; ++g) {
+        const auto row = detached[g - 1];
+        const std::string at = what + ", row " + std::to_string(g) + ": ";
+
+        check(!row.is_null(0) && row.view(0) == std::to_string(g),
+              at + "id wrong");
+
+        const auto name = expected_name(g);
+        const PostgreFieldView field = row[1];
+        check(field.is_null() == !name, at + "name NULL flag wrong");
+        check(field.size() == (name ? name->size() : 0) &&
+                  field.view() == (name ? *name : std::string()),
+              at + "name offsets wrong");
+        check(field.c_str()[field.size()] == '\0', at + "name not NUL-ended");
+
+        const bool scored = g % 2 != 0;
+        check(row.is_null(2) == !scored, at + "score NULL flag wrong");
+        check(!scored || row.get<double>(2) == g * 0.5, at + "score wrong");
+        check(scored || row.view(2).empty(), at + "NULL score has text");
+    }
+}
+
+void check_detached(PostgreDatabase& db) {
+    PostgreDetachedResult detached = db.query(RowsSql).detach();
+    check_cells(detached, "detached");
+
+    // Copies are independent of the original and of each other
+    std::unique_ptr<IResult> clone;
+    {
+        PostgreDetachedResult copy(detached);
+        clone = copy.clone();
+        detached = db.query("SELECT 1").detach();
+        check_cells(copy, "copy");
+    }
+    check_cells(static_cast<const PostgreDetachedResult&>(*clone), "clone");
+
+    // The same cells as the libpq result they came from
+    PostgreResult result = db.query(RowsSql);
+    PostgreDetachedResult same = result.detach();
+    for (std::size_t row = 0; row < result.size(); ++row) {
+        for (std::size_t col = 0; col < result.columns(); ++col) {
+            const PostgreFieldView a = result.field(row, col);
+            const PostgreFieldView b = same.field(row, col);
+            check(a.is_null() == b.is_null() && a.view() == b.view(),
+                  "detached cell differs from the result");
+        }
+    }
+
+    // Results without rows or without columns
+    PostgreDetachedResult empty = db.query("SELECT 1 AS a WHERE false")
+                                      .detach();
+    check(empty.size() == 0 && empty.columns() == 1 && empty.empty(),
+          "empty result shape wrong");
+    PostgreDetachedResult bare =
+        db.query("SELECT FROM generate_series(1, 3)").detach();
+    check(bare.size() == 3 && bare.columns() == 0,
+          "result without columns shape wrong");
+
+    // One-row NULL-only and empty-only results hit the last offset
+    PostgreDetachedResult null = db.query("SELECT NULL::text").detach();
+    check(null.field(0, 0).is_null() && null.field(0, 0).size() == 0,
+          "single NULL cell wrong");
+    PostgreDetachedResult blank = db.query("SELECT ''::text").detach();
+    check(!blank.field(0, 0).is_null() && blank.field(0, 0).size() == 0,
+          "single empty cell read as NULL");
+}
+
+struct Item {
+    std::int64_t id = 0;
+    std::string name;
+    std::optional<double> score;
+};
+
+constexpr auto ItemRow =
+    row_map(row_field("id", &Item::id), row_field("name", &Item::name),
+            row_field("score", &Item::score));
+
+void check_structs(PostgreDatabase& db) {
+    PostgreResult result = db.query(std::string(RowsSql) +
+                                    " WHERE g % 3 <> 0 ORDER BY g");
+    const std::vector<Item> items = result.to_structs(ItemRow);
+    check(items.size() == result.size(), "to_structs lost rows");
+    for (const Item& item : items) {
+        const int g = static_cast<int>(item.id);
+        check(item.name == *expected_name(g), "to_structs name wrong");
+        check(item.score.has_value() == (g % 2 != 0) &&
+                  (!item.score || *item.score == g * 0.5),
+              "to_structs optional score wrong");
+    }
+
+    // A NULL in a member that is not std::optional names its column
+    std::string message;
+    try {
+        db.query(RowsSql).to_structs(ItemRow);
+    } catch (const QueryError& e) {
+        message = e.what();
+    }
+    check(message.find("NULL in column name") != std::string::npos,
+          "to_structs NULL error: '" + message + "'");
+}
+
+}  // namespace
+
+int main() {
+    const DatabaseConfig cfg = config();
+    PostgreDatabase db(cfg.host, cfg.port, cfg.database, cfg.username,
+                       cfg.password);
+    try {
+        db.connect();
+    } catch (const ConnectionError& e) {
+        std::printf("ResultCheck: skipped, no server (%s)\n", e.what());
+        return Skipped;
+    }
+
+    check_detached(db);
+    check_structs(db);
+    if (failed) return EXIT_FAILURE;
+
+    std::printf("ResultCheck: passed\n");
+    return EXIT_SUCCESS;
+}
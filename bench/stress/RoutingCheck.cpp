@@ -0,0 +1,187 @@
+// Self-checking test of RoutingDatabase over in-process backends: every
+// statement must reach the backend its classification calls for, reads a
+// standby rejects as writes must be retried on the primary, and failed
+// replicas must be ejected. Exits non-zero on the first wrong answer.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Errors.h"
+#include "FakeDatabase.h"
+#include "RoutingDatabase.h"
+#include "SqlClassifier.h"
+
+namespace {
+
+bool failed = false;
+
+void check(bool condition, const std::string& message) {
+    if (!condition && !failed) {
+        failed = true;
+        std::fprintf(stderr, "%s\n", message.c_str());
+    }
+}
+
+// Backend counting its statements. A standby rejects statements calling
+// my_writer() the way PostgreSQL does; a down backend fails to connect.
+class ScriptedDatabase final : public FakeDatabase {
+   public:
+    explicit ScriptedDatabase(bool standby)
+        : FakeDatabase(1), _standby(standby) {}
+
+    std::unique_ptr<IResult> exec(const std::string& sql) override {
+        if (down) throw ConnectionError("backend is down");
+        ++statements;
+        if (_standby && sql.find("my_writer(") != std::string::npos) {
+            throw QueryError(
+                "cannot execute INSERT in a read-only transaction", "25006");
+        }
+        if (sql.find("bad_column") != std::string::npos)
+            throw QueryError("column \"bad_column\" does not exist", "42703");
+        return FakeDatabase::exec(sql);
+    }
+
+    void connect() override {
+        if (down) throw ConnectionError("backend is down");
+        FakeDatabase::connect();
+    }
+
+    int statements = 0;
+    bool down = false;
+
+   private:
+    bool _standby;
+};
+
+struct Cluster {
+    Cluster() {
+        auto primaryDb = std::make_unique<ScriptedDatabase>(false);
+        primary = primaryDb.get();
+        std::vector<std::unique_ptr<IDatabase>> replicaDbs;
+        for (auto*& replica : replicas) {
+            auto db = std::make_unique<ScriptedDatabase>(true);
+            replica = db.get();
+            replicaDbs.push_back(std::move(db));
+        }
+        RoutingConfig config;
+        config.check_interval = std::chrono::milliseconds(0);
+        config.eject_time = std::chrono::milliseconds(60 * 1000);
+        router = std::make_unique<RoutingDatabase>(
+            std::move(primaryDb), std::move(replicaDbs), config);
+        router->connect();
+    }
+
+    // Where one statement went: 'p' primary, 'r' a replica
+    char run(const std::string& sql) {
+        const int before = primary->statements;
+        router->exec(sql);
+        return primary->statements > before ? 'p' : 'r';
+    }
+
+    int replica_statements() const {
+        return replicas[0]->statements + replicas[1]->statements;
+    }
+
+    ScriptedDatabase* primary;
+    ScriptedDatabase* replicas[2];
+    std::unique_ptr<RoutingDatabase> router;
+};
+
+void check_classifier() {
+    auto effects = [](const std::string& sql) {
+        return SqlClassifier::classify(sql).side_effects;
+    };
+    check(effects("SELECT nextval('orders_id_seq')"), "nextval");
+    check(effects("select pg_catalog.setval('s', 1)"), "qualified setval");
+    check(effects("SELECT pg_advisory_lock(42)"), "advisory lock");
+    check(effects("SELECT pg_try_advisory_xact_lock(1) FROM jobs"),
+          "try advisory lock");
+    check(!effects("SELECT nextval FROM counters"), "column named nextval");
+    check(!effects("SELECT 'nextval(1)' FROM t"), "nextval in a literal");
+    check(SqlClassifier::classify("SELECT now()").tables.empty(),
+          "tableless read has tables");
+}
+
+void check_routing() {
+    Cluster cluster;
+
+    check(cluster.run("SELECT id FROM users WHERE id = 1") == 'r',
+          "table read went to the primary");
+    check(cluster.run("INSERT INTO users VALUES (1)") == 'p',
+          "write went to a replica");
+    for (const char* sql :
+         {"SELECT nextval('orders_id_seq')", "SELECT now()",
+          "SELECT my_function()", "SELECT pg_advisory_lock(7)",
+          "SELECT currval('s') FROM users",
+          "SELECT set_config('a.b', 'c', false) FROM users",
+          "SELECT id FROM users FOR UPDATE"}) {
+        check(cluster.run(sql) == 'p', std::string(sql) + " left the primary");
+    }
+    check(cluster.replica_statements() == 1, "primary-only SQL hit a replica");
+
+    // Inside a transaction every statement stays on the primary
+    check(cluster.run("BEGIN") == 'p', "BEGIN");
+    check(cluster.run("SELECT id FROM users") == 'p', "read in transaction");
+    check(cluster.run("COMMIT") == 'p', "COMMIT");
+    check(cluster.run("SELECT id FROM users") == 'r', "read after COMMIT");
+
+    // A function writing from a table read: the standby refuses, the
+    // primary runs it, and the replica stays in rotation
+    RoutingStats before = cluster.router->stats();
+    check(cluster.run("SELECT my_writer(id) FROM users") == 'p',
+          "25006 was not retried on the primary");
+    RoutingStats after = cluster.router->stats();
+    check(after.retries == before.retries + 1, "25006 retry not counted");
+    check(after.replicas[0].ejections == 0 && after.replicas[1].ejections == 0,
+          "25006 ejected a replica");
+
+    // SQL errors are the caller's, not a reason to retry
+    bool threw = false;
+    try {
+        cluster.run("SELECT bad_column FROM users");
+    } catch (const QueryError& e) {
+        threw = e.sqlstate() == "42703";
+    }
+    check(threw, "SQL error on a replica was not returned");
+    check(cluster.router->stats().retries == after.retries,
+          "SQL error was retried");
+}
+
+void check_failover() {
+    Cluster cluster;
+
+    // One replica down: ejected, and its reads retried on the other
+    cluster.replicas[0]->down = true;
+    cluster.replicas[0]->disconnect();
+    for (int i = 0; i < 4; ++i)
+        check(cluster.run("SELECT id FROM users") == 'r',
+              "read with one replica down");
+    RoutingStats stats = cluster.router->stats();
+    check(!stats.replicas[0].available && stats.replicas[0].ejections == 1,
+          "failed replica not ejected");
+    check(stats.replicas[1].available, "healthy replica ejected");
+
+    // Both down: reads fall back to the primary
+    cluster.replicas[1]->down = true;
+    cluster.replicas[1]->disconnect();
+    check(cluster.run("SELECT id FROM users") == 'p',
+          "read without replicas did not fall back");
+    check(cluster.router->stats().fallback_reads == 1,
+          "fallback read not counted");
+}
+
+}  // namespace
+
+int main() {
+    check_classifier();
+    check_routing();
+    check_failover();
+    if (failed) return EXIT_FAILURE;
+
+    std::printf("RoutingCheck: passed\n");
+    return EXIT_SUCCESS;
+}
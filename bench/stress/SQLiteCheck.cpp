@@ -0,0 +1,227 @@
+// Self-checking test of the SQLite backend: '$n', '?n' and '?' parameter
+// binding, reuse of cached prepared statements, recovery after failing
+// statements, and SQLiteWriteQueue keeping a failing write from undoing
+// the rest of its batch. Exits non-zero on the first wrong answer.
+
+#include <sqlite3.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Errors.h"
+#include "SQLiteDatabase.h"
+#include "SQLiteWriteQueue.h"
+
+namespace {
+
+bool failed = false;
+
+void check(bool condition, const std::string& message) {
+    if (!condition && !failed) {
+        failed = true;
+        std::fprintf(stderr, "%s\n", message.c_str());
+    }
+}
+
+// Whether sql fails with QueryError
+template <typename Run>
+bool throws(Run run) {
+    try {
+        run();
+    } catch (const QueryError&) {
+        return true;
+    }
+    return false;
+}
+
+// Statements prepared on the connection and not finalized
+int live_statements(const SQLiteDatabase& db) {
+    int count = 0;
+    for (sqlite3_stmt* stmt = sqlite3_next_stmt(db.handle(), nullptr); stmt;
+         stmt = sqlite3_next_stmt(db.handle(), stmt))
+        ++count;
+    return count;
+}
+
+void check_binding() {
+    SQLiteDatabase db;
+    db.connect();
+
+    auto row = db.query_params("SELECT $2, $1, $2 || $1", {7, "x"});
+    check(row.get<std::string>(0, 0) == "x" &&
+              row.get<std::int64_t>(0, 1) == 7 &&
+              row.get<std::string>(0, 2) == "x7",
+          "$n parameters bound out of order");
+
+    row = db.query_params("SELECT ?, ?, ?", {1, 2.5, nullptr});
+    check(row.get<std::int64_t>(0, 0) == 1 && row.get<double>(0, 1) == 2.5 &&
+              row.is_null(0, 2),
+          "? parameters not bound in order");
+
+    row = db.query_params("SELECT ?2, ?1", {"a", "b"});
+    check(row.get<std::string>(0, 0) == "b" &&
+              row.get<std::string>(0, 1) == "a",
+          "?n parameters bound out of order");
+
+    row = db.query_params("SELECT typeof(?), ?", {'c', true});
+    check(row.get<std::string>(0, 0) == "text" &&
+              row.get<std::int64_t>(0, 1) == 1,
+          "char or bool parameter mis-bound");
+
+    row = db.query_params(
+        "SELECT length(?), hex(?)",
+        {std::string(300, 'z'), Param::bytea(std::string("\0\1", 2))});
+    check(row.get<std::int64_t>(0, 0) == 300 &&
+              row.get<std::string>(0, 1) == "0001",
+          "long text or blob parameter mis-bound");
+
+    check(throws([&] { db.query_params("SELECT $3", {1, 2}); }),
+          "missing $n value accepted");
+    check(throws([&] { db.query_params("SELECT ?, ?", {1}); }),
+          "missing ? value accepted");
+}
+
+void check_statement_cache() {
+    SQLiteDatabase db;
+    db.connect();
+    db.exec("CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT)");
+
+    const std::string insert = "INSERT INTO items VALUES ($1, $2)";
+    for (int id = 1; id <= 100; ++id) db.exec_params(insert, id, "item");
+    check(db.cached_statements() == 2, "statement cached more than once");
+    check(live_statements(db) == 2, "statement prepared per call");
+
+    const std::string count = "SELECT count(*) FROM items";
+    for (int i = 0; i < 3; ++i)
+        check(db.query(count).get<std::int64_t>(0, 0) == 100,
+              "cached read sees wrong rows");
+
+    // Schema changes reprepare cached statements
+    const std::string all = "SELECT * FROM items WHERE id = 1";
+    check(db.query(all).columns() == 2, "wrong column count");
+    db.exec("ALTER TABLE items ADD COLUMN price REAL");
+    check(db.query(all).columns() == 3, "cached statement kept old schema");
+
+    // Scripts run every statement and are not cached
+    const std::size_t cached = db.cached_statements();
+    auto last = db.query("UPDATE items SET price = 1; SELECT sum(price) "
+                         "FROM items");
+    check(last.get<double>(0, 0) == 100.0, "script lost a statement");
+    check(db.cached_statements() == cached, "script was cached");
+
+    db.statement_cache(0);
+    db.query(count);
+    check(db.cached_statements() == 0 && live_statements(db) == 0,
+          "disabled cache kept statements");
+}
+
+void check_recovery() {
+    SQLiteDatabase db;
+    db.connect();
+    db.exec("CREATE TABLE keys (id INTEGER PRIMARY KEY)");
+
+    // A cached statement failing in step, then reused
+    const std::string insert = "INSERT INTO keys VALUES ($1)";
+    db.exec_params(insert, 1);
+    check(throws([&] { db.exec_params(insert, 1); }),
+          "duplicate key accepted");
+    db.exec_params(insert, 2);
+
+    // Failing to prepare or to bind leaves the connection usable
+    check(throws([&] { db.exec("SELEC 1"); }), "syntax error accepted");
+    check(throws([&] { db.exec_params(insert); }), "missing value accepted");
+    check(throws([&] { db.exec("SELECT * FROM missing"); }),
+          "missing table accepted");
+
+    // A script stops at its failing statement, the earlier ones stay
+    check(throws([&] {
+              db.exec("INSERT INTO keys VALUES (3); INSERT INTO keys "
+                      "VALUES (1); INSERT INTO keys VALUES (4)");
+          }),
+          "failing script accepted");
+
+    auto keys = db.query("SELECT group_concat(id) FROM keys");
+    check(keys.get<std::string>(0, 0) == "1,2,3",
+          "rows after errors: " + keys.get<std::string>(0, 0));
+
+    // An error inside a transaction leaves it open for ROLLBACK
+    db.exec("BEGIN");
+    db.exec_params(insert, 5);
+    check(throws([&] { db.exec_params(insert, 5); }),
+          "duplicate key in transaction accepted");
+    db.exec("ROLLBACK");
+    check(db.query("SELECT count(*) FROM keys").get<std::int64_t>(0, 0) == 3,
+          "rolled back row kept");
+}
+
+void check_write_queue() {
+    const std::string path = "dbfactory_sqlite_check.db";
+    for (const char* suffix : {"", "-wal", "-shm"})
+        std::remove((path + suffix).c_str());
+    {
+        SQLiteDatabase reader(path);
+        reader.connect();
+        reader.exec("CREATE TABLE events (id INTEGER PRIMARY KEY, note TEXT)");
+
+        std::vector<std::future<std::unique_ptr<IResult>>> futures;
+        {
+            SQLiteWriteQueue queue(DatabaseConfig(path), 8);
+            for (int id = 1; id <= 24; ++id) {
+                // Every fourth write collides with the previous one
+                const int key = id % 4 == 0 ? id - 1 : id;
+                futures.push_back(queue.submit(
+                    "INSERT INTO events VALUES ($1, $2)", key, "ok"));
+            }
+            // A write that changes rows before failing
+            futures.push_back(queue.submit(
+                "INSERT INTO events VALUES (100, 'x'), (1, 'dup')"));
+            futures.push_back(
+                queue.submit("UPDATE events SET note = 'done' WHERE id = 1"));
+
+            int good = 0, bad = 0;
+            for (auto& future : futures) {
+                try {
+                    future.get();
+                    ++good;
+                } catch (const QueryError&) {
+                    ++bad;
+                }
+            }
+            check(good == 19 && bad == 7, "wrong write outcomes");
+
+            SQLiteWriteStats stats = queue.stats();
+            check(stats.writes == 19 && stats.failures == 7,
+                  "write queue counters wrong");
+            check(stats.transactions >= 1 && stats.transactions <= 26,
+                  "write queue transactions out of range");
+        }
+
+        auto rows = reader.query("SELECT count(*), max(id) FROM events");
+        check(rows.get<std::int64_t>(0, 0) == 18 &&
+                  rows.get<std::int64_t>(0, 1) == 23,
+              "failing writes undid or kept rows");
+        check(reader.query("SELECT note FROM events WHERE id = 1")
+                      .get<std::string>(0, 0) == "done",
+              "write after a failure lost");
+    }
+    for (const char* suffix : {"", "-wal", "-shm"})
+        std::remove((path + suffix).c_str());
+}
+
+}  // namespace
+
+int main() {
+    check_binding();
+    check_statement_cache();
+    check_recovery();
+    check_write_queue();
+    if (failed) return EXIT_FAILURE;
+
+    std::printf("SQLiteCheck: passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,271 @@
+#include "CachingDatabase.h"
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <stdexcept>
+
+#include "SqlClassifier.h"
+
+namespace {
+
+std::future<std::unique_ptr<IResult>> ready(std::unique_ptr<IResult> result) {
+    std::promise<std::unique_ptr<IResult>> promise;
+    promise.set_value(std::move(result));
+    return promise.get_future();
+}
+
+}  // namespace
+
+// Fraction of reads answered from the cache
+double CacheStats::hit_ratio() const noexcept {
+    const std::uint64_t reads = hits + misses;
+    return reads == 0 ? 0.0 : static_cast<double>(hits) / reads;
+}
+
+CachingDatabase::CachingDatabase(std::unique_ptr<IDatabase> db,
+                                 const CacheConfig& config)
+    : _db(std::move(db)), _config(config), _epoch(0), _inTransaction(false) {
+    if (!_db) {
+        throw std::invalid_argument("CachingDatabase needs a database");
+    }
+    if (_config.shards == 0) _config.shards = 1;
+    _shardBytes = _config.max_bytes / _config.shards;
+
+    _shards.reserve(_config.shards);
+    for (std::size_t i = 0; i < _config.shards; ++i)
+        _shards.push_back(std::make_unique<Shard>());
+    for (auto& version : _tableVersions) version.store(0);
+}
+
+std::string CachingDatabase::connection_info() const noexcept {
+    return "Cached " + _db->connection_info();
+}
+
+bool CachingDatabase::connected() const noexcept { return _db->connected(); }
+
+void CachingDatabase::connect() {
+    std::lock_guard<std::mutex> lock(_dbMutex);
+    _db->connect();
+}
+
+void CachingDatabase::disconnect() {
+    std::lock_guard<std::mutex> lock(_dbMutex);
+    _db->disconnect();
+}
+
+std::unique_ptr<IResult> CachingDatabase::exec(const std::string& sql) {
+    return run(sql, nullptr);
+}
+
+std::unique_ptr<IResult> CachingDatabase::exec_params(
+    const std::string& sql, const ParamPack& params) {
+    return run(sql, &params);
+}
+
+// Hits complete immediately, misses run on the thread pool. Like run(),
+// an open transaction bypasses the cache.
+std::future<std::unique_ptr<IResult>> CachingDatabase::exec_async(
+    const std::string& sql) {
+    if (_inTransaction.load()) return IDatabase::exec_async(sql);
+    if (auto cached = lookup(cache_key(sql, nullptr)))
+        return ready(std::move(cached));
+    return IDatabase::exec_async(sql);
+}
+
+std::future<std::unique_ptr<IResult>> CachingDatabase::exec_params_async(
+    const std::string& sql, const ParamPack& params) {
+    if (_inTransaction.load())
+        return IDatabase::exec_params_async(sql, params);
+    if (auto cached = lookup(cache_key(sql, &params)))
+        return ready(std::move(cached));
+    return IDatabase::exec_params_async(sql, params);
+}
+
+// Drop cached reads of a table (for writes made outside the wrapper)
+void CachingDatabase::invalidate(const std::string& table) noexcept {
+    std::string name = table;
+    std::size_t dot = name.rfind('.');
+    if (dot != std::string::npos) name.erase(0, dot + 1);
+    std::transform(name.begin(), name.end(), name.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    _tableVersions[slot(name)].fetch_add(1);
+}
+
+// Drop every cached result
+void CachingDatabase::clear() noexcept {
+    _epoch.fetch_add(1);
+    for (auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->stats.invalidations += shard->entries.size();
+        shard->entries.clear();
+        shard->bytes = 0;
+    }
+}
+
+CacheStats CachingDatabase::stats() const {
+    CacheStats total;
+    for (const auto& shard : _shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.hits += shard->stats.hits;
+        total.misses += shard->stats.misses;
+        total.evictions += shard->stats.evictions;
+        total.expirations += shard->stats.expirations;
+        total.invalidations += shard->stats.invalidations;
+        total.entries += shard->entries.size();
+        total.bytes += shard->bytes;
+    }
+    return total;
+}
+
+// Wrapped database
+IDatabase& CachingDatabase::database() noexcept { return *_db; }
+
+std::unique_ptr<IResult> CachingDatabase::run(const std::string& sql,
+                                              const ParamPack* params) {
+    // A transaction sees its own uncommitted writes, so it bypasses the
+    // cache. Only reads are ever stored, so a hit needs no classification.
+    const bool inTransaction = _inTransaction.load();
+    std::string key;
+    if (!inTransaction) {
+        key = cache_key(sql, params);
+        if (auto cached = lookup(key)) return cached;
+    }
+
+    const SqlStatement statement = SqlClassifier::classify(sql);
+    auto execute = [&] {
+        std::lock_guard<std::mutex> lock(_dbMutex);
+        std::unique_ptr<IResult> result;
+        try {
+            result = params ? _db->exec_params(sql, *params) : _db->exec(sql);
+        } catch (...) {
+            // A failed COMMIT still ends the transaction
+            if (statement.transaction == SqlTransaction::End)
+                _inTransaction.store(false);
+            throw;
+        }
+        if (statement.transaction != SqlTransaction::None)
+            _inTransaction.store(statement.transaction ==
+                                 SqlTransaction::Begin);
+        return result;
+    };
+
+    // Reads of no table (nextval(), now(), pg_advisory_lock(), ...) are
+    // never invalidated by a write, so they always run
+    if (statement.kind == SqlKind::Read && !inTransaction &&
+        !statement.tables.empty()) {
+        // Versions are taken before the query, so a write that lands in
+        // between leaves the new entry already stale
+        auto entry = std::make_shared<Entry>();
+        entry->epoch = _epoch.load();
+        for (const auto& table : statement.tables) {
+            const std::uint32_t index = slot(table);
+            entry->tables.emplace_back(index, _tableVersions[index].load());
+        }
+
+        {
+            Shard& target = shard(key);
+            std::lock_guard<std::mutex> lock(target.mutex);
+            ++target.stats.misses;
+        }
+        auto result = execute();
+        if (result) store(key, *result, std::move(entry));
+        return result;
+    }
+
+    // Writes invalidate even when they fail, part of them may have run
+    struct Invalidate {
+        CachingDatabase& cache;
+        const SqlStatement& statement;
+        ~Invalidate() {
+            if (statement.kind == SqlKind::Write) {
+                for (const auto& table : statement.tables)
+                    cache._tableVersions[slot(table)].fetch_add(1);
+            } else if (statement.kind == SqlKind::Other) {
+                cache._epoch.fetch_add(1);
+            }
+        }
+    } invalidate{*this, statement};
+    return execute();
+}
+
+// Copy of a fresh cached result (nullptr on a miss)
+std::unique_ptr<IResult> CachingDatabase::lookup(const std::string& key) {
+    Shard& target = shard(key);
+    std::shared_ptr<const Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(target.mutex);
+        auto found = target.entries.find(key);
+        if (found == nullptr) return nullptr;
+        entry = *found;
+
+        bool stale = entry->epoch != _epoch.load();
+        for (const auto& table : entry->tables)
+            stale = stale || _tableVersions[table.first].load() != table.second;
+        const bool expired =
+            _config.ttl.count() > 0 && Clock::now() >= entry->expires;
+        if (stale || expired) {
+            ++(stale ? target.stats.invalidations : target.stats.expirations);
+            target.bytes -= entry->bytes;
+            target.entries.erase(key);
+            return nullptr;
+        }
+        ++target.stats.hits;
+    }
+    // Copied outside the lock, entries are immutable once stored
+    return entry->result->clone();
+}
+
+void CachingDatabase::store(const std::string& key, const IResult& result,
+                            std::shared_ptr<Entry> entry) {
+    entry->result = result.clone();
+    if (!entry->result) return;  // result type cannot be copied
+
+    entry->bytes = entry->result->memory_usage() + sizeof(Entry) +
+                   key.size() * 2 + entry->tables.size() * 16;
+    if (entry->bytes > _shardBytes) return;
+    entry->expires = Clock::now() + _config.ttl;
+
+    Shard& target = shard(key);
+    std::lock_guard<std::mutex> lock(target.mutex);
+    if (auto old = target.entries.peek(key)) target.bytes -= (*old)->bytes;
+    target.bytes += entry->bytes;
+    target.entries.insert(key, std::move(entry));
+    while (target.bytes > _shardBytes) {
+        auto evicted = target.entries.pop_back();
+        if (!evicted) break;
+        target.bytes -= evicted->second->bytes;
+        ++target.stats.evictions;
+    }
+}
+
+std::string CachingDatabase::cache_key(const std::string& sql,
+                                       const ParamPack* params) {
+    std::string key = sql;
+    if (params == nullptr) return key;
+
+    // Type tag and length keep different parameter lists apart
+    char buffer[Param::TextSize];
+    for (const auto& param : *params) {
+        auto text = param.to_text(buffer);
+        key += '\0';
+        key += static_cast<char>('0' + static_cast<int>(param.type()));
+        key += std::to_string(text.size());
+        key += ':';
+        key.append(text.data(), text.size());
+    }
+    return key;
+}
+
+std::uint32_t CachingDatabase::slot(const std::string& table) noexcept {
+    return static_cast<std::uint32_t>(std::hash<std::string>()(table) %
+                                      TableSlots);
+}
+
+CachingDatabase::Shard& CachingDatabase::shard(
+    const std::string& key) noexcept {
+    // Shards use the high bits, the LRU maps inside them the low bits
+    const std::size_t hash = std::hash<std::string>()(key);
+    return *_shards[(hash >> 16) % _shards.size()];
+}
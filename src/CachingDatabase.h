@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "IDatabase.h"
+#include "LruCache.h"
+
+// Result cache settings
+struct CacheConfig {
+    std::size_t shards = 16;                   // lock stripes
+    std::size_t max_bytes = 64 * 1024 * 1024;  // budget across all shards
+    std::chrono::milliseconds ttl{60 * 1000};  // 0 never expires
+};
+
+// Result cache counters
+struct CacheStats {
+    std::uint64_t hits = 0;           // reads answered from the cache
+    std::uint64_t misses = 0;         // reads sent to the database
+    std::uint64_t evictions = 0;      // entries dropped to stay in budget
+    std::uint64_t expirations = 0;    // entries dropped after their TTL
+    std::uint64_t invalidations = 0;  // entries dropped after a write
+    std::size_t entries = 0;
+    std::size_t bytes = 0;
+
+    // Fraction of reads answered from the cache
+    double hit_ratio() const noexcept;
+};
+
+// CachingDatabase class - read-through result cache in front of any
+// IDatabase. Reads (SELECT, WITH, VALUES, TABLE, SHOW) of named tables are
+// cached by SQL text plus parameters, except inside a transaction begun
+// through the wrapper; reads without tables (nextval(), now(), ...) always
+// run. Writes through the wrapper invalidate the cached
+// reads of the tables they touch, and statements whose tables cannot be
+// told invalidate everything. Writes made by other clients are only picked
+// up once entries expire. Hits never touch the wrapped database; misses
+// and writes are serialized on it.
+class CachingDatabase : public IDatabase {
+   public:
+    explicit CachingDatabase(std::unique_ptr<IDatabase> db,
+                             const CacheConfig& config = {});
+
+    CachingDatabase(const CachingDatabase&) noexcept = delete;
+    CachingDatabase& operator=(const CachingDatabase&) noexcept = delete;
+
+    std::string connection_info() const noexcept override;
+
+    bool connected() const noexcept override;
+
+    void connect() override;
+
+    void disconnect() override;
+
+    std::unique_ptr<IResult> exec(const std::string& sql) override;
+
+    using IDatabase::exec_params;
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         const ParamPack& params) override;
+
+    // Hits complete immediately, misses run on the thread pool
+    using IDatabase::exec_params_async;
+    std::future<std::unique_ptr<IResult>> exec_async(
+        const std::string& sql) override;
+    std::future<std::unique_ptr<IResult>> exec_params_async(
+        const std::string& sql, const ParamPack& params) override;
+
+    // Drop cached reads of a table (for writes made outside the wrapper)
+    void invalidate(const std::string& table) noexcept;
+
+    // Drop every cached result
+    void clear() noexcept;
+
+    CacheStats stats() const;
+
+    // Wrapped database
+    IDatabase& database() noexcept;
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    // Table versions are striped; a collision only costs an extra miss
+    static constexpr std::size_t TableSlots = 4096;
+
+    struct Entry {
+        std::unique_ptr<IResult> result;
+        std::size_t bytes;
+        Clock::time_point expires;
+        std::uint64_t epoch;
+        // Version of each table slot read when the query was sent
+        std::vector<std::pair<std::uint32_t, std::uint64_t>> tables;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        LruCache<std::string, std::shared_ptr<const Entry>> entries{
+            std::numeric_limits<std::size_t>::max()};
+        std::size_t bytes = 0;
+        CacheStats stats;
+    };
+
+    std::unique_ptr<IResult> run(const std::string& sql,
+                                 const ParamPack* params);
+    // Copy of a fresh cached result (nullptr on a miss)
+    std::unique_ptr<IResult> lookup(const std::string& key);
+    void store(const std::string& key, const IResult& result,
+               std::shared_ptr<Entry> entry);
+
+    static std::string cache_key(const std::string& sql,
+                                 const ParamPack* params);
+    static std::uint32_t slot(const std::string& table) noexcept;
+    Shard& shard(const std::string& key) noexcept;
+
+    std::unique_ptr<IDatabase> _db;
+    std::mutex _dbMutex;
+    CacheConfig _config;
+    std::size_t _shardBytes;
+    std::vector<std::unique_ptr<Shard>> _shards;
+    std::array<std::atomic<std::uint64_t>, TableSlots> _tableVersions;
+    std::atomic<std::uint64_t> _epoch;
+    std::atomic<bool> _inTransaction;  // BEGIN seen, COMMIT/ROLLBACK not yet
+};
@@ -0,0 +1,85 @@
+#include "CellResult.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+CellResult::CellResult(std::vector<std::string> columnNames) noexcept
+    : _columnNames(std::move(columnNames)),
+      _affectedRows(0),
+      _lastInsertId(0) {}
+
+std::unique_ptr<IResult> CellResult::clone() const {
+    return std::make_unique<CellResult>(*this);
+}
+
+std::size_t CellResult::memory_usage() const noexcept {
+    std::size_t bytes = sizeof(*this) + _cells.capacity() * sizeof(Param);
+    for (const auto& name : _columnNames) bytes += sizeof(name) + name.size();
+    // Long text and bytea values live on the heap
+    for (const auto& cell : _cells) {
+        auto size = cell.as_text().size();
+        if (size >= Param::InlineSize) bytes += size + 1;
+    }
+    return bytes;
+}
+
+// Result properties
+std::size_t CellResult::size() const noexcept {
+    return _columnNames.empty() ? 0 : _cells.size() / _columnNames.size();
+}
+bool CellResult::empty() const noexcept { return _cells.empty(); }
+std::size_t CellResult::columns() const noexcept {
+    return _columnNames.size();
+}
+std::size_t CellResult::affected_rows() const noexcept {
+    return _affectedRows;
+}
+std::int64_t CellResult::last_insert_id() const noexcept {
+    return _lastInsertId;
+}
+
+// Column information
+const std::string& CellResult::column_name(std::size_t col) const {
+    if (col >= columns()) {
+        throw std::out_of_range("Column index out of range");
+    }
+    return _columnNames[col];
+}
+
+std::size_t CellResult::column(const std::string& colName) const {
+    auto itr = std::find(_columnNames.begin(), _columnNames.end(), colName);
+    if (itr == _columnNames.end()) {
+        throw std::out_of_range("Unknown column: " + colName);
+    }
+    return static_cast<std::size_t>(itr - _columnNames.begin());
+}
+
+// Check if field is NULL
+bool CellResult::is_null(std::size_t row, std::size_t col) const {
+    return value(row, col).is_null();
+}
+
+// Cell as received (Int, Float, Text, Bytea, Timestamp or Null)
+const Param& CellResult::value(std::size_t row, std::size_t col) const {
+    if (row >= size()) {
+        throw std::out_of_range("Row index out of range");
+    }
+    if (col >= columns()) {
+        throw std::out_of_range("Column index out of range");
+    }
+    return _cells[row * columns() + col];
+}
+
+void CellResult::append(std::vector<Param>& row) {
+    for (auto& cell : row) _cells.push_back(std::move(cell));
+}
+
+void CellResult::finish(std::size_t affectedRows,
+                          std::int64_t lastInsertId) noexcept {
+    _affectedRows = affectedRows;
+    _lastInsertId = lastInsertId;
+}
+
+void CellResult::null_value(std::size_t col) const {
+    throw QueryError("Column " + _columnNames[col] + " is NULL");
+}
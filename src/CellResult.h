@@ -0,0 +1,136 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "ColumnDecoder.h"
+#include "Errors.h"
+#include "IDatabase.h"
+#include "ParamPack.h"
+
+// CellResult class - rows of a statement, copied out as typed cells
+// (integer, float, text, bytea, timestamp or NULL) so the statement can be
+// reused. Shared by the backends whose client libraries hand out one row
+// at a time.
+class CellResult : public IResult {
+   public:
+    explicit CellResult(std::vector<std::string> columnNames) noexcept;
+
+    std::unique_ptr<IResult> clone() const override;
+    std::size_t memory_usage() const noexcept override;
+
+    // Result properties
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    std::size_t columns() const noexcept;
+    std::size_t affected_rows() const noexcept;
+    // Id generated by the last INSERT on the connection
+    std::int64_t last_insert_id() const noexcept;
+
+    // Column information
+    const std::string& column_name(std::size_t col) const;
+    std::size_t column(const std::string& colName) const;
+
+    // Check if field is NULL
+    bool is_null(std::size_t row, std::size_t col) const;
+
+    // Cell as received (Int, Float, Text, Bytea, Timestamp or Null)
+    const Param& value(std::size_t row, std::size_t col) const;
+
+    // Get value converted to T, text cells are parsed
+    template <typename T>
+    T get(std::size_t row, std::size_t col) const {
+        const Param& cell = value(row, col);
+        if constexpr (std::is_same_v<T, std::string>) {
+            if (cell.is_null()) null_value(col);
+            char buffer[Param::TextSize];
+            return std::string(cell.to_text(buffer));
+        } else {
+            static_assert(ColumnDecoder::supports<T>,
+                          "Unsupported result type");
+            T result{};
+            switch (cell.type()) {
+                case Param::Type::Int:
+                    from_int(cell.as_int(), result);
+                    break;
+                case Param::Type::Float:
+                    from_float(cell.as_float(), result);
+                    break;
+                case Param::Type::Text:
+                    ColumnDecoder::decode(cell.c_str(), cell.as_text().size(),
+                                          result);
+                    break;
+                case Param::Type::Timestamp:
+                    if constexpr (std::is_same_v<T, Param::Timestamp>) {
+                        result = cell.as_timestamp();
+                        break;
+                    } else {
+                        throw QueryError("Timestamp cannot be read as number");
+                    }
+                default:
+                    null_value(col);
+            }
+            return result;
+        }
+    }
+
+    template <typename T>
+    std::optional<T> get_optional(std::size_t row, std::size_t col) const {
+        return is_null(row, col) ? std::nullopt
+                                 : std::make_optional(get<T>(row, col));
+    }
+
+    // Filled in by the backend while fetching rows
+    void append(std::vector<Param>& row);
+    void finish(std::size_t affectedRows, std::int64_t lastInsertId) noexcept;
+
+   private:
+    template <typename T>
+    static void from_int(std::int64_t value, T& result) {
+        if constexpr (std::is_same_v<T, bool>) {
+            result = value != 0;
+        } else if constexpr (std::is_integral_v<T>) {
+            if (value < static_cast<std::int64_t>(
+                            std::numeric_limits<T>::min()) ||
+                (value > 0 && static_cast<std::uint64_t>(value) >
+                                  static_cast<std::uint64_t>(
+                                      std::numeric_limits<T>::max())))
+                throw QueryError("Integer out of range: " +
+                                 std::to_string(value));
+            result = static_cast<T>(value);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            result = static_cast<T>(value);
+        } else {
+            // Unix time in seconds
+            result = T(std::chrono::seconds(value));
+        }
+    }
+
+    template <typename T>
+    static void from_float(double value, T& result) {
+        if constexpr (std::is_floating_point_v<T>) {
+            result = static_cast<T>(value);
+        } else if constexpr (std::is_integral_v<T>) {
+            auto integer = static_cast<std::int64_t>(value);
+            if (static_cast<double>(integer) != value)
+                throw QueryError("Not an integer: " + std::to_string(value));
+            from_int(integer, result);
+        } else {
+            throw QueryError("Float cannot be read as timestamp");
+        }
+    }
+
+    [[noreturn]] void null_value(std::size_t col) const;
+
+    std::vector<std::string> _columnNames;
+    std::vector<Param> _cells;  // row-major
+    std::size_t _affectedRows;
+    std::int64_t _lastInsertId;
+};
@@ -0,0 +1,243 @@
+#include "ColumnDecoder.h"
+
+#include <cstdlib>
+
+#include "Errors.h"
+
+namespace {
+
+bool is_digit(char c) noexcept {
+    return static_cast<unsigned>(static_cast<unsigned char>(c) - '0') <= 9u;
+}
+
+const char* skip_digits(const char* text, const char* end) noexcept {
+    while (text < end && is_digit(*text)) ++text;
+    return text;
+}
+
+// Days since 1970-01-01 of a civil date (proleptic Gregorian)
+std::int64_t days_from_civil(std::int64_t y, unsigned m, unsigned d) noexcept {
+    y -= m <= 2;
+    std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+// Exactly representable powers of ten for the float fast path
+template <typename T>
+constexpr T Pow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                       1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                       1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Decimal with at most 19 significant digits whose mantissa and power of
+// ten are both exact in T, so a single multiply or divide rounds correctly
+template <typename T>
+bool parse_fast(const char* text, const char* end, T& value) noexcept {
+    constexpr int MaxPow10 = std::is_same_v<T, float> ? 10 : 22;
+    constexpr std::uint64_t MaxMantissa =
+        std::uint64_t(1) << std::numeric_limits<T>::digits;
+
+    bool negative = false;
+    if (text < end && (*text == '-' || *text == '+'))
+        negative = *text++ == '-';
+
+    std::uint64_t mantissa = 0;
+    const char* digits = skip_digits(text, end);
+    std::ptrdiff_t count = digits - text;
+    if (count > 19 || !ColumnDecoder::parse_digits(text, digits, mantissa))
+        return false;
+    text = digits;
+
+    int exponent = 0;
+    if (text < end && *text == '.') {
+        digits = skip_digits(++text, end);
+        std::ptrdiff_t fraction = digits - text;
+        count += fraction;
+        if (count > 19 ||
+            !ColumnDecoder::parse_digits(text, digits, mantissa))
+            return false;
+        exponent = -static_cast<int>(fraction);
+        text = digits;
+    }
+    if (count == 0) return false;
+
+    if (text < end && (*text == 'e' || *text == 'E')) {
+        bool negativeExp = false;
+        if (++text < end && (*text == '-' || *text == '+'))
+            negativeExp = *text++ == '-';
+        digits = skip_digits(text, end);
+        std::uint64_t power = 0;
+        if (digits == text || digits - text > 4 ||
+            !ColumnDecoder::parse_digits(text, digits, power))
+            return false;
+        exponent += negativeExp ? -static_cast<int>(power)
+                                : static_cast<int>(power);
+        text = digits;
+    }
+
+    if (text != end || mantissa > MaxMantissa || exponent < -MaxPow10 ||
+        exponent > MaxPow10)
+        return false;
+
+    T result = static_cast<T>(mantissa);
+    result = exponent < 0 ? result / Pow10<T>[-exponent]
+                          : result * Pow10<T>[exponent];
+    value = negative ? -result : result;
+    return true;
+}
+
+// Fixed-width field of count digits at text
+bool parse_fixed(const char*& text, const char* end, std::size_t count,
+                 unsigned& value) noexcept {
+    if (static_cast<std::size_t>(end - text) < count) return false;
+    std::uint64_t parsed = 0;
+    if (!ColumnDecoder::parse_digits(text, text + count, parsed)) return false;
+    value = static_cast<unsigned>(parsed);
+    text += count;
+    return true;
+}
+
+bool expect(const char*& text, const char* end, char c) noexcept {
+    if (text == end || *text != c) return false;
+    ++text;
+    return true;
+}
+
+// "YYYY-MM-DD[ HH:MM:SS[.ffffff]][+HH[:MM[:SS]]][ BC]" in microseconds
+bool parse_timestamp(const char* text, const char* end,
+                     std::int64_t& micros) noexcept {
+    const char* yearEnd = skip_digits(text, end);
+    std::uint64_t year = 0;
+    if (yearEnd - text < 4 || yearEnd - text > 9 ||
+        !ColumnDecoder::parse_digits(text, yearEnd, year))
+        return false;
+    text = yearEnd;
+
+    unsigned month, day, hour = 0, minute = 0, second = 0;
+    if (!expect(text, end, '-') || !parse_fixed(text, end, 2, month) ||
+        !expect(text, end, '-') || !parse_fixed(text, end, 2, day) ||
+        month < 1 || month > 12 || day < 1 || day > 31)
+        return false;
+
+    std::int64_t fraction = 0;
+    if (text < end && (*text == ' ' || *text == 'T') && end - text > 3 &&
+        is_digit(text[1])) {
+        ++text;
+        if (!parse_fixed(text, end, 2, hour) || !expect(text, end, ':') ||
+            !parse_fixed(text, end, 2, minute) || !expect(text, end, ':') ||
+            !parse_fixed(text, end, 2, second))
+            return false;
+
+        if (text < end && *text == '.') {
+            const char* digits = skip_digits(++text, end);
+            std::ptrdiff_t count = digits - text;
+            std::uint64_t parsed = 0;
+            if (count == 0 || count > 6 ||
+                !ColumnDecoder::parse_digits(text, digits, parsed))
+                return false;
+            for (; count < 6; ++count) parsed *= 10;
+            fraction = static_cast<std::int64_t>(parsed);
+            text = digits;
+        }
+    }
+
+    std::int64_t offset = 0;
+    if (text < end && (*text == '+' || *text == '-')) {
+        bool negative = *text++ == '-';
+        unsigned parts[3] = {0, 0, 0};
+        if (!parse_fixed(text, end, 2, parts[0])) return false;
+        for (int i = 1; i < 3 && text < end && *text == ':'; ++i) {
+            ++text;
+            if (!parse_fixed(text, end, 2, parts[i])) return false;
+        }
+        offset = parts[0] * 3600 + parts[1] * 60 + parts[2];
+        if (negative) offset = -offset;
+    }
+
+    std::int64_t signedYear = static_cast<std::int64_t>(year);
+    if (end - text == 3 && std::memcmp(text, " BC", 3) == 0) {
+        // 1 BC is astronomical year 0
+        signedYear = 1 - signedYear;
+        text = end;
+    }
+    if (text != end) return false;
+
+    std::int64_t seconds = days_from_civil(signedYear, month, day) * 86400 +
+                           hour * 3600 + minute * 60 + second - offset;
+    micros = seconds * 1000000 + fraction;
+    return true;
+}
+
+}  // namespace
+
+void ColumnDecoder::decode(const char* text, std::size_t length, bool& value) {
+    if (length == 1 && (*text == 't' || *text == 'f')) {
+        value = *text == 't';
+        return;
+    }
+    if (length == 4 && std::memcmp(text, "true", 4) == 0) {
+        value = true;
+        return;
+    }
+    if (length == 5 && std::memcmp(text, "false", 5) == 0) {
+        value = false;
+        return;
+    }
+    fail(text, "boolean");
+}
+
+void ColumnDecoder::decode(const char* text, std::size_t length,
+                           double& value) {
+    if (parse_fast(text, text + length, value)) return;
+
+    // Long mantissas, large exponents, NaN and Infinity
+    char* end = nullptr;
+    value = std::strtod(text, &end);
+    if (length == 0 || end != text + length) fail(text, "double");
+}
+
+void ColumnDecoder::decode(const char* text, std::size_t length,
+                           float& value) {
+    if (parse_fast(text, text + length, value)) return;
+
+    char* end = nullptr;
+    value = std::strtof(text, &end);
+    if (length == 0 || end != text + length) fail(text, "float");
+}
+
+void ColumnDecoder::decode(const char* text, std::size_t length,
+                           std::string& value) {
+    value.assign(text, length);
+}
+
+void ColumnDecoder::decode(const char* text, std::size_t length,
+                           Timestamp& value) {
+    constexpr auto limit =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            Timestamp::duration::max())
+            .count();
+
+    std::int64_t micros;
+    if (parse_timestamp(text, text + length, micros)) {
+        if (micros > limit || micros < -limit) fail(text, "timestamp");
+        value = Timestamp(std::chrono::duration_cast<Timestamp::duration>(
+            std::chrono::microseconds(micros)));
+        return;
+    }
+
+    if (length == 8 && std::memcmp(text, "infinity", 8) == 0) {
+        value = Timestamp::max();
+        return;
+    }
+    if (length == 9 && std::memcmp(text, "-infinity", 9) == 0) {
+        value = Timestamp::min();
+        return;
+    }
+    fail(text, "timestamp");
+}
+
+void ColumnDecoder::fail(const char* text, const char* type) {
+    throw QueryError(std::string("Cannot decode '") + text + "' as " + type);
+}
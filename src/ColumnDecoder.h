@@ -0,0 +1,173 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Column class - one decoded result column stored as a contiguous array of
+// values plus a null bitmap (bit set = NULL, value left default-constructed)
+template <typename T>
+class Column final {
+   public:
+    using value_type = T;
+
+    Column() = default;
+
+    void reserve(std::size_t rows) {
+        _values.reserve(rows);
+        _nulls.reserve((rows + 63) / 64);
+    }
+
+    void push_back(T value) {
+        grow();
+        _values.push_back(std::move(value));
+    }
+
+    void push_null() {
+        grow();
+        _nulls.back() |= std::uint64_t(1) << (_values.size() % 64);
+        _values.emplace_back();
+        ++_nullCount;
+    }
+
+    bool is_null(std::size_t row) const noexcept {
+        return (_nulls[row / 64] >> (row % 64)) & 1;
+    }
+
+    const T& operator[](std::size_t row) const noexcept {
+        return _values[row];
+    }
+
+    std::size_t size() const noexcept { return _values.size(); }
+    bool empty() const noexcept { return _values.empty(); }
+    std::size_t null_count() const noexcept { return _nullCount; }
+
+    // Contiguous value array (NULL slots hold T{})
+    const T* data() const noexcept { return _values.data(); }
+    const std::vector<T>& values() const noexcept { return _values; }
+
+    // Null bitmap, 64 rows per word, least significant bit first
+    const std::vector<std::uint64_t>& nulls() const noexcept { return _nulls; }
+
+    typename std::vector<T>::const_iterator begin() const noexcept {
+        return _values.begin();
+    }
+    typename std::vector<T>::const_iterator end() const noexcept {
+        return _values.end();
+    }
+
+   private:
+    void grow() {
+        if (_values.size() % 64 == 0) _nulls.push_back(0);
+    }
+
+    std::vector<T> _values;
+    std::vector<std::uint64_t> _nulls;
+    std::size_t _nullCount = 0;
+};
+
+// ColumnDecoder class - parsers for the PostgreSQL text output format.
+// Digit runs are converted eight bytes at a time (SWAR) on little-endian
+// targets; anything outside the fast paths falls back to the C library.
+class ColumnDecoder final {
+   public:
+    using Timestamp = std::chrono::system_clock::time_point;
+
+    ColumnDecoder() = delete;
+    ~ColumnDecoder() = delete;
+
+    // Whether decode() has a fast path for T
+    template <typename T>
+    static constexpr bool supports =
+        std::is_integral_v<T> || std::is_same_v<T, float> ||
+        std::is_same_v<T, double> || std::is_same_v<T, std::string> ||
+        std::is_same_v<T, Timestamp>;
+
+    // Parse text of size length (NUL-terminated) into value, throws
+    // QueryError on malformed or out of range input
+    static void decode(const char* text, std::size_t length, bool& value);
+    static void decode(const char* text, std::size_t length, double& value);
+    static void decode(const char* text, std::size_t length, float& value);
+    static void decode(const char* text, std::size_t length,
+                       std::string& value);
+    static void decode(const char* text, std::size_t length,
+                       Timestamp& value);
+
+    template <typename T,
+              std::enable_if_t<std::is_integral_v<T> &&
+                                   !std::is_same_v<T, bool>,
+                               int> = 0>
+    static void decode(const char* text, std::size_t length, T& value) {
+        std::int64_t parsed;
+        if (!parse_int(text, length, parsed) ||
+            parsed < static_cast<std::int64_t>(
+                         std::numeric_limits<T>::min()) ||
+            (parsed > 0 && static_cast<std::uint64_t>(parsed) >
+                               static_cast<std::uint64_t>(
+                                   std::numeric_limits<T>::max())))
+            fail(text, "integer");
+        value = static_cast<T>(parsed);
+    }
+
+    // Signed decimal integer of up to 19 digits
+    static bool parse_int(const char* text, std::size_t length,
+                          std::int64_t& value) noexcept {
+        const char* end = text + length;
+        bool negative = false;
+        if (text < end && (*text == '-' || *text == '+'))
+            negative = *text++ == '-';
+        if (text == end || end - text > 19) return false;
+
+        std::uint64_t result = 0;
+        if (!parse_digits(text, end, result)) return false;
+
+        constexpr std::uint64_t max = std::numeric_limits<std::int64_t>::max();
+        if (result > max + negative) return false;
+        value = negative ? static_cast<std::int64_t>(0 - result)
+                         : static_cast<std::int64_t>(result);
+        return true;
+    }
+
+    // Accumulate a run of at most 19 ASCII digits into value
+    static bool parse_digits(const char* text, const char* end,
+                             std::uint64_t& value) noexcept {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        while (end - text >= 8) {
+            std::uint64_t chunk;
+            std::memcpy(&chunk, text, sizeof(chunk));
+            if (!eight_digits(chunk)) return false;
+            value = value * 100000000 + parse_eight(chunk);
+            text += 8;
+        }
+#endif
+        for (; text < end; ++text) {
+            unsigned digit = static_cast<unsigned char>(*text) - '0';
+            if (digit > 9) return false;
+            value = value * 10 + digit;
+        }
+        return true;
+    }
+
+   private:
+    // All eight bytes are '0'..'9'
+    static bool eight_digits(std::uint64_t chunk) noexcept {
+        return ((chunk & 0xF0F0F0F0F0F0F0F0) |
+                (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+               0x3333333333333333;
+    }
+
+    // Value of eight ASCII digits, first digit in the lowest byte
+    static std::uint32_t parse_eight(std::uint64_t chunk) noexcept {
+        chunk = ((chunk & 0x0F0F0F0F0F0F0F0F) * 2561) >> 8;
+        chunk = ((chunk & 0x00FF00FF00FF00FF) * 6553601) >> 16;
+        return static_cast<std::uint32_t>(
+            ((chunk & 0x0000FFFF0000FFFF) * 42949672960001) >> 32);
+    }
+
+    [[noreturn]] static void fail(const char* text, const char* type);
+};
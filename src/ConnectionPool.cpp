@@ -0,0 +1,237 @@
+#include "ConnectionPool.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "DatabaseFactory.h"
+#include "Errors.h"
+
+PooledConnection::PooledConnection() noexcept
+    : _pool(nullptr), _db(nullptr), _broken(false) {}
+
+PooledConnection::PooledConnection(ConnectionPool* pool,
+                                   std::unique_ptr<IDatabase> database) noexcept
+    : _pool(pool), _db(std::move(database)), _broken(false) {}
+
+PooledConnection::~PooledConnection() noexcept { release(); }
+
+// Enable move constructor and assignment
+PooledConnection::PooledConnection(PooledConnection&& lease) noexcept
+    : _pool(lease._pool), _db(std::move(lease._db)), _broken(lease._broken) {
+    lease._pool = nullptr;
+}
+PooledConnection& PooledConnection::operator=(
+    PooledConnection&& lease) noexcept {
+    if (this != &lease) {
+        release();
+
+        _pool = lease._pool;
+        _db = std::move(lease._db);
+        _broken = lease._broken;
+        lease._pool = nullptr;
+    }
+    return *this;
+}
+
+IDatabase* PooledConnection::operator->() const noexcept { return _db.get(); }
+IDatabase& PooledConnection::operator*() const noexcept { return *_db; }
+IDatabase* PooledConnection::get() const noexcept { return _db.get(); }
+
+bool PooledConnection::valid() const noexcept { return _db != nullptr; }
+
+void PooledConnection::release() noexcept {
+    if (_pool && _db) _pool->release(std::move(_db), _broken);
+    _pool = nullptr;
+    _db.reset();
+    _broken = false;
+}
+
+void PooledConnection::invalidate() noexcept { _broken = true; }
+
+ConnectionPool::ConnectionPool(const std::string& dbType,
+                               const DatabaseConfig& dbConfig,
+                               const PoolConfig& poolConfig,
+                               Validator validator)
+    : _dbType(dbType),
+      _dbConfig(dbConfig),
+      _poolConfig(poolConfig),
+      _validator(std::move(validator)) {
+    if (_poolConfig.max_size == 0)
+        throw std::invalid_argument("Pool max_size must be positive");
+    if (_poolConfig.min_size > _poolConfig.max_size)
+        throw std::invalid_argument("Pool min_size exceeds max_size");
+
+    // Pre-open the minimum number of connections
+    for (std::size_t i = 0; i < _poolConfig.min_size; ++i) {
+        auto db = open();
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_stats.size;
+        ++_stats.creates;
+        _idle.push_back(IdleConnection{std::move(db), Clock::now()});
+    }
+}
+
+ConnectionPool::~ConnectionPool() noexcept {
+    std::deque<IdleConnection> idle;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        idle.swap(_idle);
+    }
+    for (auto& conn : idle) close(std::move(conn.db));
+}
+
+// Lease a connection, waiting up to lease_timeout (throws ConnectionError)
+PooledConnection ConnectionPool::acquire() {
+    return acquire_until(Clock::now() + _poolConfig.lease_timeout, true);
+}
+
+// Lease a connection without waiting (returns an invalid lease if none)
+PooledConnection ConnectionPool::try_acquire() {
+    return acquire_until(Clock::now(), false);
+}
+
+// Close idle connections above min_size that exceeded idle_timeout
+void ConnectionPool::evict_idle() noexcept {
+    std::deque<IdleConnection> expired;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        collect_expired(expired);
+    }
+    for (auto& conn : expired) close(std::move(conn.db));
+}
+
+const PoolConfig& ConnectionPool::config() const noexcept {
+    return _poolConfig;
+}
+
+PoolStats ConnectionPool::stats() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    PoolStats stats = _stats;
+    stats.idle = _idle.size();
+    return stats;
+}
+
+PooledConnection ConnectionPool::acquire_until(Clock::time_point deadline,
+                                               bool wait) {
+    while (true) {
+        std::unique_ptr<IDatabase> db;
+        std::deque<IdleConnection> expired;
+        bool create = false;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (true) {
+                collect_expired(expired);
+
+                if (!_idle.empty()) {
+                    // Reuse the most recently returned (warmest) connection
+                    db = std::move(_idle.back().db);
+                    _idle.pop_back();
+                    break;
+                }
+                if (_stats.size < _poolConfig.max_size) {
+                    // Reserve a slot, open the connection outside the lock
+                    ++_stats.size;
+                    create = true;
+                    break;
+                }
+                if (!wait) return PooledConnection();
+                if (_available.wait_until(lock, deadline) ==
+                        std::cv_status::timeout &&
+                    _idle.empty() && _stats.size >= _poolConfig.max_size) {
+                    ++_stats.timeouts;
+                    lock.unlock();
+                    for (auto& conn : expired) close(std::move(conn.db));
+                    throw ConnectionError(
+                        "Timed out waiting for a pooled connection");
+                }
+            }
+        }
+        for (auto& conn : expired) close(std::move(conn.db));
+
+        if (create) {
+            try {
+                db = open();
+            } catch (...) {
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    --_stats.size;
+                }
+                _available.notify_one();
+                throw;
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            ++_stats.creates;
+        } else if (_poolConfig.validate_on_borrow && !usable(*db)) {
+            close(std::move(db));
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                --_stats.size;
+                ++_stats.discards;
+            }
+            _available.notify_one();
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_stats.leased;
+        ++_stats.acquires;
+        return PooledConnection(this, std::move(db));
+    }
+}
+
+std::unique_ptr<IDatabase> ConnectionPool::open() {
+    auto db = DatabaseFactory::create(_dbType, _dbConfig);
+    if (!db) throw ConnectionError("Factory returned no database: " + _dbType);
+    if (!db->connected()) db->connect();
+    return db;
+}
+
+bool ConnectionPool::usable(IDatabase& db) const noexcept {
+    try {
+        return db.connected() && (!_validator || _validator(db));
+    } catch (...) {
+        return false;
+    }
+}
+
+void ConnectionPool::release(std::unique_ptr<IDatabase> db,
+                             bool broken) noexcept {
+    bool keep = !broken && db->connected();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_stats.leased;
+        if (keep) {
+            _idle.push_back(IdleConnection{std::move(db), Clock::now()});
+        } else {
+            --_stats.size;
+            ++_stats.discards;
+        }
+    }
+    _available.notify_one();
+
+    if (!keep) close(std::move(db));
+}
+
+void ConnectionPool::collect_expired(
+    std::deque<IdleConnection>& expired) noexcept {
+    if (_poolConfig.idle_timeout.count() <= 0) return;
+
+    auto cutoff = Clock::now() - _poolConfig.idle_timeout;
+    // Oldest idle connections sit at the front
+    while (!_idle.empty() && _stats.size > _poolConfig.min_size &&
+           _idle.front().since < cutoff) {
+        expired.push_back(std::move(_idle.front()));
+        _idle.pop_front();
+        --_stats.size;
+        ++_stats.discards;
+    }
+}
+
+void ConnectionPool::close(std::unique_ptr<IDatabase> db) noexcept {
+    if (!db) return;
+    try {
+        if (db->connected()) db->disconnect();
+    } catch (...) {
+        // Ignore exceptions while closing
+    }
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "DatabaseConfig.h"
+#include "IDatabase.h"
+
+// Connection pool configuration
+struct PoolConfig {
+    // Connections opened up front and never evicted for idleness
+    std::size_t min_size = 1;
+    // Upper bound on open connections (idle + leased)
+    std::size_t max_size = 8;
+    // Idle connections above min_size are closed after this long (0 = never)
+    std::chrono::milliseconds idle_timeout{std::chrono::minutes(5)};
+    // How long acquire() waits for a free connection before throwing
+    std::chrono::milliseconds lease_timeout{std::chrono::seconds(5)};
+    // Check connections before handing them out
+    bool validate_on_borrow = true;
+};
+
+// Pool counters snapshot
+struct PoolStats {
+    std::size_t size = 0;    // open connections (idle + leased)
+    std::size_t idle = 0;    // connections waiting in the pool
+    std::size_t leased = 0;  // connections currently handed out
+
+    std::size_t acquires = 0;  // successful acquire() calls
+    std::size_t creates = 0;   // connections opened
+    std::size_t discards = 0;  // connections dropped (broken/invalid/idle)
+    std::size_t timeouts = 0;  // acquire() calls that timed out
+};
+
+class ConnectionPool;
+
+// RAII lease of a pooled connection, returned to the pool on destruction
+class PooledConnection final {
+   public:
+    PooledConnection() noexcept;
+
+    // Disable copy constructor and assignment
+    PooledConnection(const PooledConnection&) noexcept = delete;
+    PooledConnection& operator=(const PooledConnection&) noexcept = delete;
+
+    // Enable move constructor and assignment
+    PooledConnection(PooledConnection&& lease) noexcept;
+    PooledConnection& operator=(PooledConnection&& lease) noexcept;
+
+    ~PooledConnection() noexcept;
+
+    IDatabase* operator->() const noexcept;
+    IDatabase& operator*() const noexcept;
+    IDatabase* get() const noexcept;
+
+    bool valid() const noexcept;
+
+    // Return the connection to the pool before the lease goes out of scope
+    void release() noexcept;
+
+    // Mark the connection as broken so the pool closes it instead of reusing
+    void invalidate() noexcept;
+
+   private:
+    friend class ConnectionPool;
+
+    PooledConnection(ConnectionPool* pool,
+                     std::unique_ptr<IDatabase> database) noexcept;
+
+    ConnectionPool* _pool;
+    std::unique_ptr<IDatabase> _db;
+    bool _broken;
+};
+
+// Thread-safe pool of connections created through DatabaseFactory.
+// The pool must outlive every lease it hands out.
+class ConnectionPool final {
+   public:
+    // Extra health check run on borrow (in addition to connected())
+    using Validator = std::function<bool(IDatabase&)>;
+
+    ConnectionPool(const std::string& dbType, const DatabaseConfig& dbConfig,
+                   const PoolConfig& poolConfig = PoolConfig{},
+                   Validator validator = nullptr);
+
+    ConnectionPool(const ConnectionPool&) noexcept = delete;
+    ConnectionPool& operator=(const ConnectionPool&) noexcept = delete;
+    ConnectionPool(ConnectionPool&&) noexcept = delete;
+    ConnectionPool& operator=(ConnectionPool&&) noexcept = delete;
+
+    ~ConnectionPool() noexcept;
+
+    // Lease a connection, waiting up to lease_timeout (throws ConnectionError)
+    PooledConnection acquire();
+
+    // Lease a connection without waiting (returns an invalid lease if none)
+    PooledConnection try_acquire();
+
+    // Close idle connections above min_size that exceeded idle_timeout
+    void evict_idle() noexcept;
+
+    const PoolConfig& config() const noexcept;
+
+    PoolStats stats() const noexcept;
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    struct IdleConnection {
+        std::unique_ptr<IDatabase> db;
+        Clock::time_point since;
+    };
+
+    friend class PooledConnection;
+
+    PooledConnection acquire_until(Clock::time_point deadline, bool wait);
+
+    std::unique_ptr<IDatabase> open();
+    bool usable(IDatabase& db) const noexcept;
+    void release(std::unique_ptr<IDatabase> db, bool broken) noexcept;
+    void collect_expired(std::deque<IdleConnection>& expired) noexcept;
+
+    static void close(std::unique_ptr<IDatabase> db) noexcept;
+
+    const std::string _dbType;
+    const DatabaseConfig _dbConfig;
+    const PoolConfig _poolConfig;
+    const Validator _validator;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _available;
+    std::deque<IdleConnection> _idle;  // most recently returned at the back
+    PoolStats _stats;
+};
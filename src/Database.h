@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "IDatabase.h"
+#include "ParamPack.h"
+
+// Database class - statically typed front end over a backend chosen at
+// compile time, e.g. Database<PostgreDatabase>. Calls bind directly to the
+// backend's query() and query_params() and return its concrete result by
+// value (PostgreResult, SQLiteResult, ...), so the hot path has no virtual
+// dispatch, no heap-allocated IResult and no dynamic_cast. erased()
+// exposes the same connection as an IDatabase where the backend is picked
+// at run time (DatabaseFactory, ConnectionPool, CachingDatabase).
+template <typename Backend>
+class Database final {
+    static_assert(std::is_base_of_v<IDatabase, Backend>,
+                  "Backend must implement IDatabase");
+
+   public:
+    // Concrete result type of the backend
+    using Result = decltype(std::declval<Backend&>().query(
+        std::declval<const std::string&>()));
+
+    // Constructs the backend in place from its own constructor arguments
+    template <typename... Args,
+              typename = std::enable_if_t<
+                  std::is_constructible_v<Backend, Args&&...>>>
+    explicit Database(Args&&... args) : _backend(std::forward<Args>(args)...) {}
+
+    Database(const Database&) = delete;
+    Database& operator=(const Database&) = delete;
+
+    // Calls are qualified so they never go through the vtable
+    std::string connection_info() const noexcept {
+        return _backend.Backend::connection_info();
+    }
+    bool connected() const noexcept { return _backend.Backend::connected(); }
+
+    void connect() { _backend.Backend::connect(); }
+    void disconnect() { _backend.Backend::disconnect(); }
+
+    // Execute query as a statement of its own, with the backend's own
+    // transaction rules (PostgreDatabase: its exec_mode(), by default a
+    // transaction per statement)
+    Result exec(const std::string& sql) { return _backend.query(sql); }
+
+    // Execute parameterized query, same rules as exec
+    Result exec_params(const std::string& sql, const ParamPack& params) {
+        return _backend.query_params(sql, params);
+    }
+
+    // Execute parameterized query; values go straight to the backend when
+    // it binds them itself, otherwise through a ParamPack
+    template <typename... Args, typename = ParamPack::EnableIfValues<Args...>>
+    Result exec_params(const std::string& sql, Args&&... args) {
+        if constexpr (BindsValues<void, Args...>::value) {
+            return _backend.query_params(sql, std::forward<Args>(args)...);
+        } else {
+            return _backend.query_params(
+                sql, ParamPack::of(std::forward<Args>(args)...));
+        }
+    }
+
+    // Backend specific API (transactions, streams, pipelines, ...)
+    Backend& backend() noexcept { return _backend; }
+    const Backend& backend() const noexcept { return _backend; }
+
+    // Type-erased adapter over the same connection
+    IDatabase& erased() noexcept { return _backend; }
+
+   private:
+    // Whether Backend::query_params accepts the values without a ParamPack
+    template <typename, typename... Args>
+    struct BindsValues : std::false_type {};
+
+    template <typename... Args>
+    struct BindsValues<
+        std::void_t<decltype(std::declval<Backend&>().query_params(
+            std::declval<const std::string&>(), std::declval<Args>()...))>,
+        Args...> : std::true_type {};
+
+    Backend _backend;
+};
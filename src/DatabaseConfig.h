@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 
 // Database configuration structure
@@ -18,4 +19,10 @@ struct DatabaseConfig {
     std::string filepath = "";
     std::string username = "";
     std::string password = "";
+
+    // SQLite connection tuning, applied as pragmas on connect
+    std::string journal_mode = "wal";  // empty keeps the file's mode
+    std::int64_t mmap_size = 0;        // bytes memory-mapped, 0 disables
+    int cache_size = 0;                // pages (> 0), KiB (< 0), 0 default
+    int busy_timeout = 5000;           // ms to wait for another writer
 };
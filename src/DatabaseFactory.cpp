@@ -1,31 +1,99 @@
 #include "DatabaseFactory.h"
 
+#include <atomic>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_map>
 
-#include "MySQLDatabase.h"
 #include "PostgreDatabase.h"
 #include "RedisDatabase.h"
+
+#if defined(DBFACTORY_WITH_SQLITE)
 #include "SQLiteDatabase.h"
+#endif
+#if defined(DBFACTORY_WITH_MYSQL)
+#include "MySQLDatabase.h"
+#endif
+
+// Registered database type
+struct DatabaseBackend {
+    std::string type;
+    DatabaseFactory::Creator creator;
+};
+
+namespace {
+
+using Table = std::unordered_map<std::string, const DatabaseBackend*>;
+
+// Published table; null until the first registration. Readers only load it.
+std::atomic<const Table*> current{nullptr};
+
+// Every table and type ever published. Readers may still hold an older
+// table and handles point at their type, so none is freed; registrations
+// are expected at startup and the tables are small.
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<const Table>> tables;
+    std::vector<std::unique_ptr<const DatabaseBackend>> backends;
+};
+
+// Leaked on purpose: handles may be used during static destruction
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+const DatabaseBackend* find(const std::string& dbType) noexcept {
+    const Table* table = current.load(std::memory_order_acquire);
+    if (table == nullptr) return nullptr;
+
+    auto itr = table->find(dbType);
+    return itr != table->end() ? itr->second : nullptr;
+}
+
+}  // namespace
+
+const std::string& BackendHandle::type() const noexcept {
+    static const std::string none;
+    return _backend != nullptr ? _backend->type : none;
+}
 
-// Static member definition
-std::unordered_map<std::string, DatabaseFactory::Creator>
-    DatabaseFactory::_creators;
+// Create database instance (throws std::logic_error if empty)
+std::unique_ptr<IDatabase> BackendHandle::create(
+    const DatabaseConfig& dbConfig) const {
+    if (_backend == nullptr) throw std::logic_error("Empty backend handle");
+
+    return _backend->creator(dbConfig);
+}
 
 // Register a database type with its creator function
 void DatabaseFactory::register_database(const std::string& dbType,
                                         Creator creator) noexcept {
-    _creators[dbType] = creator;
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    reg.backends.push_back(std::make_unique<const DatabaseBackend>(
+        DatabaseBackend{dbType, std::move(creator)}));
+
+    const Table* table = current.load(std::memory_order_relaxed);
+    auto next = table != nullptr ? std::make_unique<Table>(*table)
+                                 : std::make_unique<Table>();
+    (*next)[dbType] = reg.backends.back().get();
+
+    current.store(next.get(), std::memory_order_release);
+    reg.tables.push_back(std::move(next));
 }
 
 // Initialize factory with default database types
 void DatabaseFactory::initialize() noexcept {
+#if defined(DBFACTORY_WITH_MYSQL)
     register_database(
         "mysql",
         [](const DatabaseConfig& dbConfig) -> std::unique_ptr<IDatabase> {
-            return std::make_unique<MySQLDatabase>(
-                dbConfig.host.empty() ? "localhost" : dbConfig.host,
-                dbConfig.port == 0 ? 3306 : dbConfig.port);
+            // Defaults to localhost:3306
+            return std::make_unique<MySQLDatabase>(dbConfig);
         });
+#endif
 
     register_database(
         "postgresql",
@@ -47,42 +115,56 @@ void DatabaseFactory::initialize() noexcept {
                 dbConfig.username, dbConfig.password);
         });
 
+#if defined(DBFACTORY_WITH_SQLITE)
     register_database(
         "sqlite",
         [](const DatabaseConfig& dbConfig) -> std::unique_ptr<IDatabase> {
-            return std::make_unique<SQLiteDatabase>(
-                dbConfig.filepath.empty() ? ":memory:" : dbConfig.filepath);
+            // Empty filepath opens an in-memory database
+            return std::make_unique<SQLiteDatabase>(dbConfig);
         });
+#endif
 
     register_database(
         "redis",
         [](const DatabaseConfig& dbConfig) -> std::unique_ptr<IDatabase> {
-            return std::make_unique<RedisDatabase>(
-                dbConfig.host.empty() ? "localhost" : dbConfig.host,
-                dbConfig.port == 0 ? 6379 : dbConfig.port);
+            // Defaults to localhost:6379, database selects the index
+            return std::make_unique<RedisDatabase>(dbConfig);
         });
 }
 
 // Check if a database type is supported
 bool DatabaseFactory::supported(const std::string& dbType) noexcept {
-    return _creators.find(dbType) != _creators.end();
+    return find(dbType) != nullptr;
 }
 
 // Get list of available database types
 std::vector<std::string> DatabaseFactory::available_types() noexcept {
     std::vector<std::string> dbTypes;
-    for (const auto& creator : _creators) dbTypes.push_back(creator.first);
+    const Table* table = current.load(std::memory_order_acquire);
+    if (table == nullptr) return dbTypes;
+
+    for (const auto& backend : *table) dbTypes.push_back(backend.first);
 
     return dbTypes;
 }
 
+// Look a database type up once (throws std::runtime_error if unknown)
+BackendHandle DatabaseFactory::resolve(const std::string& dbType) {
+    const DatabaseBackend* backend = find(dbType);
+
+    if (backend == nullptr)
+        throw std::runtime_error("Unknown database type: " + dbType);
+
+    return BackendHandle(backend);
+}
+
 // Create database instance
 std::unique_ptr<IDatabase> DatabaseFactory::create(
     const std::string& dbType, const DatabaseConfig& dbConfig) {
-    auto itr = _creators.find(dbType);
+    return resolve(dbType).create(dbConfig);
+}
 
-    if (itr == _creators.end())
-        throw std::runtime_error("Unknown database type: " + dbType);
+// Latency histograms and per-statement counters of every database
+MetricsSnapshot DatabaseFactory::metrics() { return Metrics::snapshot(); }
 
-    return itr->second(dbConfig);
-}
+void DatabaseFactory::reset_metrics() noexcept { Metrics::reset(); }
@@ -3,20 +3,49 @@
 #include <functional>
 #include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "DatabaseConfig.h"
 #include "IDatabase.h"
+#include "Metrics.h"
+
+// Registered database type (defined in DatabaseFactory.cpp)
+struct DatabaseBackend;
+
+// BackendHandle class - database type resolved once by
+// DatabaseFactory::resolve, so later creates skip the name lookup. Handles
+// stay valid for the life of the process and keep the creator that was
+// registered when they were resolved.
+class BackendHandle final {
+   public:
+    BackendHandle() noexcept = default;
+
+    explicit operator bool() const noexcept { return _backend != nullptr; }
+
+    const std::string& type() const noexcept;
+
+    // Create database instance (throws std::logic_error if empty)
+    std::unique_ptr<IDatabase> create(
+        const DatabaseConfig& dbConfig = DatabaseConfig{}) const;
 
-// Enhanced Database Factory with registration mechanism
-class DatabaseFactory final {
    private:
+    friend class DatabaseFactory;
+
+    explicit BackendHandle(const DatabaseBackend* backend) noexcept
+        : _backend(backend) {}
+
+    const DatabaseBackend* _backend = nullptr;
+};
+
+// Enhanced Database Factory with registration mechanism. Types live in an
+// immutable table that register_database copies and swaps in, so lookups
+// never lock or wait and may run while other threads register.
+class DatabaseFactory final {
+   public:
     using Creator =
         std::function<std::unique_ptr<IDatabase>(const DatabaseConfig&)>;
 
-    static std::unordered_map<std::string, Creator> _creators;
-
+   private:
     DatabaseFactory() noexcept = delete;
     ~DatabaseFactory() noexcept = delete;
 
@@ -39,8 +68,16 @@ class DatabaseFactory final {
     // Get list of available database types
     static std::vector<std::string> available_types() noexcept;
 
+    // Look a database type up once (throws std::runtime_error if unknown)
+    static BackendHandle resolve(const std::string& dbType);
+
     // Create database instance
     static std::unique_ptr<IDatabase> create(
         const std::string& dbType,
         const DatabaseConfig& dbConfig = DatabaseConfig{});
+
+    // Latency histograms and per-statement counters of every database
+    static MetricsSnapshot metrics();
+
+    static void reset_metrics() noexcept;
 };
@@ -8,3 +8,8 @@ ConnectionError::ConnectionError(const std::string& msg)
 
 QueryError::QueryError(const std::string& msg)
     : DatabaseError("Query error: " + msg) {}
+
+QueryError::QueryError(const std::string& msg, const std::string& sqlstate)
+    : DatabaseError("Query error: " + msg), _sqlstate(sqlstate) {}
+
+const std::string& QueryError::sqlstate() const noexcept { return _sqlstate; }
@@ -17,4 +17,11 @@ class ConnectionError final : public DatabaseError {
 class QueryError final : public DatabaseError {
    public:
     explicit QueryError(const std::string& msg);
+    QueryError(const std::string& msg, const std::string& sqlstate);
+
+    // SQLSTATE code reported by the server (empty if unknown)
+    const std::string& sqlstate() const noexcept;
+
+   private:
+    std::string _sqlstate;
 };
@@ -0,0 +1,141 @@
+#include "EventLoop.h"
+
+#if defined(__linux__)
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "Errors.h"
+
+namespace {
+
+std::uint32_t to_epoll(std::uint32_t events) noexcept {
+    std::uint32_t flags = 0;
+    if (events & EventLoop::Readable) flags |= EPOLLIN;
+    if (events & EventLoop::Writable) flags |= EPOLLOUT;
+    return flags;
+}
+
+std::uint32_t from_epoll(std::uint32_t flags) noexcept {
+    std::uint32_t events = 0;
+    if (flags & EPOLLIN) events |= EventLoop::Readable;
+    if (flags & EPOLLOUT) events |= EventLoop::Writable;
+    if (flags & (EPOLLERR | EPOLLHUP)) events |= EventLoop::Failed;
+    return events;
+}
+
+}  // namespace
+
+EventLoop::EventLoop()
+    : _epoll(::epoll_create1(EPOLL_CLOEXEC)),
+      _wakeup(::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+      _stopping(false) {
+    if (_epoll < 0 || _wakeup < 0) {
+        int err = errno;
+        if (_epoll >= 0) ::close(_epoll);
+        if (_wakeup >= 0) ::close(_wakeup);
+        throw DatabaseError(std::string("Event loop setup failed: ") +
+                            std::strerror(err));
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = _wakeup;
+    ::epoll_ctl(_epoll, EPOLL_CTL_ADD, _wakeup, &event);
+
+    _thread = std::thread([this] { run(); });
+}
+
+EventLoop::~EventLoop() noexcept {
+    _stopping = true;
+    std::uint64_t one = 1;
+    [[maybe_unused]] auto n = ::write(_wakeup, &one, sizeof(one));
+    if (_thread.joinable()) _thread.join();
+
+    ::close(_wakeup);
+    ::close(_epoll);
+}
+
+// Call handler on the loop thread whenever fd is ready for events
+void EventLoop::watch(int fd, std::uint32_t events, Handler handler) {
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    epoll_event event{};
+    event.events = to_epoll(events);
+    event.data.fd = fd;
+    if (::epoll_ctl(_epoll, EPOLL_CTL_ADD, fd, &event) < 0)
+        throw DatabaseError(std::string("Cannot watch socket: ") +
+                            std::strerror(errno));
+
+    _handlers[fd] = std::make_shared<Handler>(std::move(handler));
+}
+
+// Change the readiness a watched fd waits for
+void EventLoop::modify(int fd, std::uint32_t events) {
+    epoll_event event{};
+    event.events = to_epoll(events);
+    event.data.fd = fd;
+    if (::epoll_ctl(_epoll, EPOLL_CTL_MOD, fd, &event) < 0)
+        throw DatabaseError(std::string("Cannot modify socket: ") +
+                            std::strerror(errno));
+}
+
+// Stop watching fd (a handler already running may still finish)
+void EventLoop::unwatch(int fd) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    ::epoll_ctl(_epoll, EPOLL_CTL_DEL, fd, nullptr);
+    _handlers.erase(fd);
+}
+
+// Whether the caller runs on the loop thread
+bool EventLoop::in_loop() const noexcept {
+    return std::this_thread::get_id() == _thread.get_id();
+}
+
+// Process-wide loop
+EventLoop& EventLoop::shared() {
+    static EventLoop loop;
+    return loop;
+}
+
+void EventLoop::run() noexcept {
+    constexpr int MaxEvents = 64;
+    epoll_event events[MaxEvents];
+
+    while (!_stopping) {
+        int count = ::epoll_wait(_epoll, events, MaxEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == _wakeup) {
+                std::uint64_t value;
+                [[maybe_unused]] auto n =
+                    ::read(_wakeup, &value, sizeof(value));
+                continue;
+            }
+
+            std::shared_ptr<Handler> handler;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto itr = _handlers.find(fd);
+                if (itr == _handlers.end()) continue;
+                handler = itr->second;
+            }
+            try {
+                (*handler)(from_epoll(events[i].events));
+            } catch (...) {
+                // Handlers report failures through their own channels
+            }
+        }
+    }
+}
+
+#endif  // __linux__
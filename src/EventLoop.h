@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Single-threaded epoll reactor dispatching socket readiness to handlers
+// (Linux only)
+class EventLoop final {
+   public:
+    // Readiness flags passed to watch() and handlers
+    static constexpr std::uint32_t Readable = 1u << 0;
+    static constexpr std::uint32_t Writable = 1u << 1;
+    static constexpr std::uint32_t Failed = 1u << 2;
+
+    using Handler = std::function<void(std::uint32_t events)>;
+
+    EventLoop();
+
+    EventLoop(const EventLoop&) noexcept = delete;
+    EventLoop& operator=(const EventLoop&) noexcept = delete;
+    EventLoop(EventLoop&&) noexcept = delete;
+    EventLoop& operator=(EventLoop&&) noexcept = delete;
+
+    ~EventLoop() noexcept;
+
+    // Call handler on the loop thread whenever fd is ready for events.
+    // Handlers must tolerate spurious wake-ups.
+    void watch(int fd, std::uint32_t events, Handler handler);
+
+    // Change the readiness a watched fd waits for
+    void modify(int fd, std::uint32_t events);
+
+    // Stop watching fd (a handler already running may still finish)
+    void unwatch(int fd) noexcept;
+
+    // Whether the caller runs on the loop thread
+    bool in_loop() const noexcept;
+
+    // Process-wide loop
+    static EventLoop& shared();
+
+   private:
+    void run() noexcept;
+
+    int _epoll;
+    int _wakeup;
+    std::atomic<bool> _stopping;
+    std::mutex _mutex;
+    std::unordered_map<int, std::shared_ptr<Handler>> _handlers;
+    std::thread _thread;
+};
@@ -0,0 +1,320 @@
+#include "HedgedDatabase.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "DatabaseFactory.h"
+#include "Errors.h"
+#include "SqlClassifier.h"
+
+namespace {
+
+// Samples a window needs before it moves the hedge delay
+constexpr std::uint64_t MinWindowSamples = 32;
+
+std::vector<std::unique_ptr<IDatabase>> create_all(
+    const BackendHandle& backend, const std::vector<DatabaseConfig>& configs) {
+    std::vector<std::unique_ptr<IDatabase>> dbs;
+    dbs.reserve(configs.size());
+    for (const auto& config : configs) dbs.push_back(backend.create(config));
+    return dbs;
+}
+
+}  // namespace
+
+// Creates every connection through DatabaseFactory
+HedgedDatabase::HedgedDatabase(const std::string& dbType,
+                               const std::vector<DatabaseConfig>& configs,
+                               const HedgeConfig& config)
+    : HedgedDatabase(create_all(DatabaseFactory::resolve(dbType), configs),
+                     config) {}
+
+HedgedDatabase::HedgedDatabase(
+    std::vector<std::unique_ptr<IDatabase>> backends,
+    const HedgeConfig& config)
+    : _config(config),
+      _next(0),
+      _delayNs(0),
+      _reads(0),
+      _hedges(0),
+      _hedgeWins(0),
+      _skipped(0),
+      _cancels(0),
+      _pool(std::max<std::size_t>(backends.size(), 1)) {
+    if (backends.empty()) {
+        throw std::invalid_argument("HedgedDatabase needs a connection");
+    }
+    _backends.reserve(backends.size());
+    for (auto& db : backends) {
+        if (!db) throw std::invalid_argument("HedgedDatabase null connection");
+        _backends.push_back(std::make_unique<Backend>());
+        _backends.back()->db = std::move(db);
+    }
+
+    _config.percentile = std::clamp(_config.percentile, 0.0, 1.0);
+    _config.budget = std::clamp(_config.budget, 0.0, 1.0);
+    _config.max_delay = std::max(_config.max_delay, _config.min_delay);
+    if (_config.window == 0) _config.window = 1;
+    _delayNs.store(static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(_config.max_delay)
+            .count()));
+}
+
+std::string HedgedDatabase::connection_info() const noexcept {
+    return "Hedged " + _backends.front()->db->connection_info() + " with " +
+           std::to_string(_backends.size()) + " connections";
+}
+
+// Whether any connection is connected (dropped ones reconnect on use)
+bool HedgedDatabase::connected() const noexcept {
+    for (const auto& backend : _backends)
+        if (backend->db->connected()) return true;
+    return false;
+}
+
+void HedgedDatabase::connect() {
+    for (auto& backend : _backends) {
+        std::lock_guard<std::mutex> lock(backend->mutex);
+        backend->db->connect();
+    }
+}
+
+void HedgedDatabase::disconnect() {
+    for (auto& backend : _backends) {
+        std::lock_guard<std::mutex> lock(backend->mutex);
+        backend->db->disconnect();
+    }
+}
+
+std::unique_ptr<IResult> HedgedDatabase::exec(const std::string& sql) {
+    return route(sql, nullptr);
+}
+
+std::unique_ptr<IResult> HedgedDatabase::exec_params(
+    const std::string& sql, const ParamPack& params) {
+    return route(sql, &params);
+}
+
+HedgeStats HedgedDatabase::stats() const {
+    HedgeStats stats;
+    stats.reads = _reads.load();
+    stats.hedges = _hedges.load();
+    stats.hedge_wins = _hedgeWins.load();
+    stats.skipped = _skipped.load();
+    stats.cancels = _cancels.load();
+    stats.delay_ns = _delayNs.load();
+    return stats;
+}
+
+// Connections, for backend specific calls (not synchronized)
+std::size_t HedgedDatabase::size() const noexcept { return _backends.size(); }
+
+IDatabase& HedgedDatabase::backend(std::size_t index) {
+    return *_backends.at(index)->db;
+}
+
+std::unique_ptr<IResult> HedgedDatabase::route(const std::string& sql,
+                                               const ParamPack* params) {
+    if (!connected()) {
+        throw ConnectionError("[Hedged] Database not connected");
+    }
+
+    // Only reads of tables may run twice: nextval() and the like would
+    // take effect once per attempt
+    if (_backends.size() > 1) {
+        const SqlStatement statement = SqlClassifier::classify(sql);
+        if (statement.kind == SqlKind::Read && !statement.tables.empty() &&
+            !statement.side_effects)
+            return read(sql, params);
+    }
+
+    Backend& backend = *_backends.front();
+    std::lock_guard<std::mutex> lock(backend.mutex);
+    return run(backend, sql, params);
+}
+
+std::unique_ptr<IResult> HedgedDatabase::read(const std::string& sql,
+                                              const ParamPack* params) {
+    const std::uint64_t reads = _reads.fetch_add(1) + 1;
+    auto race = std::make_shared<Race>(sql, params);
+    _pool.post([this, race] { attempt(race, 0); });
+
+    std::unique_lock<std::mutex> lock(race->mutex);
+    const std::chrono::nanoseconds delay(_delayNs.load());
+    if (!race->changed.wait_for(lock, delay,
+                                [&race] { return race->settled; })) {
+        if (within_budget()) {
+            race->hedged = true;
+            _pool.post([this, race] { attempt(race, 1); });
+        } else {
+            _skipped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    race->changed.wait(lock, [&race] { return race->settled; });
+    std::unique_ptr<IResult> result = std::move(race->result);
+    const std::exception_ptr error = race->error;
+    lock.unlock();
+
+    if (reads % _config.window == 0) update_delay();
+    if (error) std::rethrow_exception(error);
+    return result;
+}
+
+std::unique_ptr<IResult> HedgedDatabase::run(Backend& backend,
+                                             const std::string& sql,
+                                             const ParamPack* params) {
+    if (!backend.db->connected()) backend.db->connect();
+
+    const auto start = Clock::now();
+    auto result = params ? backend.db->exec_params(sql, *params)
+                         : backend.db->exec(sql);
+    backend.latency.record(static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                             start)
+            .count()));
+    return result;
+}
+
+// Idle backend (locked into lock) other than busy, else nullptr
+HedgedDatabase::Backend* HedgedDatabase::try_pick(
+    std::unique_lock<std::mutex>& lock, const Backend* busy) {
+    const std::size_t count = _backends.size();
+    const std::size_t offset =
+        _next.fetch_add(1, std::memory_order_relaxed) % count;
+    for (std::size_t i = 0; i < count; ++i) {
+        Backend& backend = *_backends[(offset + i) % count];
+        if (&backend == busy) continue;
+        std::unique_lock<std::mutex> attempt(backend.mutex, std::try_to_lock);
+        if (attempt.owns_lock()) {
+            lock = std::move(attempt);
+            return &backend;
+        }
+    }
+    return nullptr;
+}
+
+// Idle backend if any, otherwise waits for the next in turn
+HedgedDatabase::Backend& HedgedDatabase::pick(
+    std::unique_lock<std::mutex>& lock) {
+    if (Backend* backend = try_pick(lock, nullptr)) return *backend;
+
+    const std::size_t next = _next.fetch_add(1, std::memory_order_relaxed);
+    Backend& backend = *_backends[next % _backends.size()];
+    lock = std::unique_lock<std::mutex>(backend.mutex);
+    return backend;
+}
+
+// Attempt index (0 first, 1 hedge) of a read, on the pool. The first
+// success settles the race and cancels the other attempt; a failure
+// settles it only when no attempt is left, with the first attempt's error.
+void HedgedDatabase::attempt(const std::shared_ptr<Race>& race,
+                             std::size_t index) noexcept {
+    Race& r = *race;
+    Attempt& self = r.attempts[index];
+    Attempt& other = r.attempts[1 - index];
+
+    std::unique_lock<std::mutex> backendLock;
+    Backend* backend = nullptr;
+    if (index == 0) {
+        backend = &pick(backendLock);
+    } else {
+        const Backend* busy;
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            if (r.settled) return;
+            busy = other.backend;
+        }
+        backend = try_pick(backendLock, busy);
+        if (backend == nullptr)
+            _skipped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Backend* loser = nullptr;
+    std::unique_lock<std::mutex> lock(r.mutex);
+    if (backend != nullptr && !r.settled) {
+        self.backend = backend;
+        self.running = true;
+        // Counted once it really runs, not when it was due
+        if (index == 1) _hedges.fetch_add(1);
+        lock.unlock();
+
+        std::unique_ptr<IResult> result;
+        std::exception_ptr error;
+        try {
+            result = run(*backend, r.sql, r.hasParams ? &r.params : nullptr);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        self.error = error;
+        if (!error && !r.settled) {
+            r.settled = true;
+            r.result = std::move(result);
+            if (index == 1) _hedgeWins.fetch_add(1, std::memory_order_relaxed);
+            if (other.running && !other.finished) {
+                loser = other.backend;
+                other.cancelling = true;
+            }
+        }
+    }
+    self.finished = true;
+
+    const bool pending = (index == 1 || r.hedged) && !other.finished;
+    if (!r.settled && !pending) {
+        r.settled = true;
+        r.error = r.attempts[0].error ? r.attempts[0].error
+                                      : r.attempts[1].error;
+    }
+
+    // Keep the backend until a cancel aimed at this attempt went out, so
+    // it cannot hit the backend's next statement
+    r.changed.wait(lock, [&self] { return !self.cancelling; });
+    lock.unlock();
+    r.changed.notify_all();
+
+    if (loser != nullptr) {
+        try {
+            if (loser->db->cancel())
+                _cancels.fetch_add(1, std::memory_order_relaxed);
+        } catch (...) {
+        }
+        lock.lock();
+        other.cancelling = false;
+        lock.unlock();
+        r.changed.notify_all();
+    }
+}
+
+bool HedgedDatabase::within_budget() const noexcept {
+    return static_cast<double>(_hedges.load()) <
+           _config.budget * static_cast<double>(_reads.load());
+}
+
+// Hedge delay from the latency of the reads since the last update
+void HedgedDatabase::update_delay() {
+    std::unique_lock<std::mutex> lock(_delayMutex, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+
+    HistogramSnapshot total;
+    for (const auto& backend : _backends) backend->latency.add_to(total);
+
+    HistogramSnapshot window = total;
+    window.count = 0;
+    for (std::size_t i = 0; i < window.buckets.size(); ++i) {
+        if (i < _lastWindow.buckets.size())
+            window.buckets[i] -= _lastWindow.buckets[i];
+        window.count += window.buckets[i];
+    }
+    if (window.count < MinWindowSamples) return;
+
+    const auto minNs = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(_config.min_delay)
+            .count());
+    const auto maxNs = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(_config.max_delay)
+            .count());
+    _delayNs.store(
+        std::clamp(window.percentile(_config.percentile), minNs, maxNs));
+    _lastWindow = std::move(total);
+}
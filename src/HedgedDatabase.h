@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DatabaseConfig.h"
+#include "IDatabase.h"
+#include "LatencyHistogram.h"
+#include "ThreadPool.h"
+
+// Hedging settings
+struct HedgeConfig {
+    double percentile = 0.95;  // of recent read latency, the hedge delay
+    std::chrono::microseconds min_delay{500};
+    std::chrono::microseconds max_delay{50 * 1000};  // also until measured
+    double budget = 0.05;     // hedges per read at most
+    std::size_t window = 256;  // reads between delay updates
+};
+
+// Hedging counters
+struct HedgeStats {
+    std::uint64_t reads = 0;        // statements eligible for hedging
+    std::uint64_t hedges = 0;       // second attempts sent
+    std::uint64_t hedge_wins = 0;   // answered first by the second attempt
+    std::uint64_t skipped = 0;      // due but over budget or all busy
+    std::uint64_t cancels = 0;      // losers cancelled
+    std::uint64_t delay_ns = 0;     // current hedge delay
+};
+
+// HedgedDatabase class - interchangeable connections (replicas of the same
+// data) behind one IDatabase that hedges reads: when the first connection
+// has not answered within the delay (a percentile of recent read latency),
+// the statement is sent again on an idle second connection, the first
+// answer is returned at once and the other attempt is cancelled
+// (IDatabase::cancel, i.e. PQcancel for PostgreSQL). A budget caps hedges
+// to a fraction of reads. Attempts run on a pool with one thread per
+// connection. Statements that are not plain reads of tables (see
+// SqlClassifier), including reads calling nextval() or taking advisory
+// locks, run once on the first connection, so transactions and session
+// state belong elsewhere, e.g. behind RoutingDatabase with this as a
+// replica.
+class HedgedDatabase : public IDatabase {
+   public:
+    // Creates every connection through DatabaseFactory
+    HedgedDatabase(const std::string& dbType,
+                   const std::vector<DatabaseConfig>& configs,
+                   const HedgeConfig& config = {});
+
+    HedgedDatabase(std::vector<std::unique_ptr<IDatabase>> backends,
+                   const HedgeConfig& config = {});
+
+    HedgedDatabase(const HedgedDatabase&) noexcept = delete;
+    HedgedDatabase& operator=(const HedgedDatabase&) noexcept = delete;
+
+    std::string connection_info() const noexcept override;
+
+    // Whether any connection is connected (dropped ones reconnect on use)
+    bool connected() const noexcept override;
+
+    void connect() override;
+
+    void disconnect() override;
+
+    std::unique_ptr<IResult> exec(const std::string& sql) override;
+
+    using IDatabase::exec_params;
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         const ParamPack& params) override;
+
+    HedgeStats stats() const;
+
+    // Connections, for backend specific calls (not synchronized)
+    std::size_t size() const noexcept;
+    IDatabase& backend(std::size_t index);
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Backend {
+        std::unique_ptr<IDatabase> db;
+        std::mutex mutex;          // one statement at a time
+        LatencyHistogram latency;  // written under mutex
+    };
+
+    struct Attempt {
+        Backend* backend = nullptr;
+        bool running = false;
+        bool finished = false;
+        bool cancelling = false;  // its backend must not be released yet
+        std::exception_ptr error;
+    };
+
+    // One read and its attempts; owns the statement since the losing
+    // attempt may still run after the caller returned
+    struct Race {
+        Race(const std::string& sql, const ParamPack* params)
+            : sql(sql), params(params ? *params : ParamPack()),
+              hasParams(params != nullptr) {}
+
+        const std::string sql;
+        const ParamPack params;
+        const bool hasParams;
+        std::mutex mutex;
+        std::condition_variable changed;
+        Attempt attempts[2];
+        bool hedged = false;
+        bool settled = false;
+        std::unique_ptr<IResult> result;
+        std::exception_ptr error;
+    };
+
+    std::unique_ptr<IResult> route(const std::string& sql,
+                                   const ParamPack* params);
+    std::unique_ptr<IResult> read(const std::string& sql,
+                                  const ParamPack* params);
+    // Run and time a statement while holding backend.mutex, reconnecting
+    // a dropped connection
+    static std::unique_ptr<IResult> run(Backend& backend,
+                                        const std::string& sql,
+                                        const ParamPack* params);
+
+    // Idle backend (locked into lock) other than busy, else nullptr
+    Backend* try_pick(std::unique_lock<std::mutex>& lock,
+                      const Backend* busy);
+    // Idle backend if any, otherwise waits for the next in turn
+    Backend& pick(std::unique_lock<std::mutex>& lock);
+
+    // Attempt index (0 first, 1 hedge) of a read, on the pool
+    void attempt(const std::shared_ptr<Race>& race,
+                 std::size_t index) noexcept;
+    bool within_budget() const noexcept;
+    void update_delay();
+
+    HedgeConfig _config;
+    std::vector<std::unique_ptr<Backend>> _backends;
+    std::atomic<std::uint32_t> _next;  // rotates the first attempt
+    std::atomic<std::uint64_t> _delayNs;
+
+    std::atomic<std::uint64_t> _reads;
+    std::atomic<std::uint64_t> _hedges;
+    std::atomic<std::uint64_t> _hedgeWins;
+    std::atomic<std::uint64_t> _skipped;
+    std::atomic<std::uint64_t> _cancels;
+
+    std::mutex _delayMutex;
+    HistogramSnapshot _lastWindow;  // totals at the last delay update
+
+    // Last member: joined first, while the rest is still alive
+    ThreadPool _pool;
+};
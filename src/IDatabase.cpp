@@ -0,0 +1,38 @@
+#include "IDatabase.h"
+
+#include "ThreadPool.h"
+
+// Independent copy of the same dynamic type, used by result caches
+std::unique_ptr<IResult> IResult::clone() const { return nullptr; }
+
+// Approximate bytes held by the result
+std::size_t IResult::memory_usage() const noexcept { return sizeof(*this); }
+
+// Ask the server to abandon the running statement
+bool IDatabase::cancel() { return false; }
+
+// Open connection asynchronously
+std::future<void> IDatabase::connect_async() {
+    return ThreadPool::shared().submit([this] {
+        std::lock_guard<std::mutex> lock(*_asyncMutex);
+        connect();
+    });
+}
+
+// Execute query asynchronously
+std::future<std::unique_ptr<IResult>> IDatabase::exec_async(
+    const std::string& sql) {
+    return ThreadPool::shared().submit([this, sql] {
+        std::lock_guard<std::mutex> lock(*_asyncMutex);
+        return exec(sql);
+    });
+}
+
+// Execute parameterized query asynchronously
+std::future<std::unique_ptr<IResult>> IDatabase::exec_params_async(
+    const std::string& sql, const ParamPack& params) {
+    return ThreadPool::shared().submit([this, sql, params] {
+        std::lock_guard<std::mutex> lock(*_asyncMutex);
+        return exec_params(sql, params);
+    });
+}
@@ -1,18 +1,34 @@
 #pragma once
 
 #include <any>
+#include <cstddef>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+#include "ParamPack.h"
+
 class IResult {
    public:
     virtual ~IResult() noexcept = default;
+
+    // Independent copy of the same dynamic type, used by result caches
+    // (nullptr if the result cannot be copied)
+    virtual std::unique_ptr<IResult> clone() const;
+
+    // Approximate bytes held by the result
+    virtual std::size_t memory_usage() const noexcept;
 };
 
 // Database interface
 class IDatabase {
    public:
+    IDatabase() = default;
+    IDatabase(IDatabase&&) noexcept = default;
+    IDatabase& operator=(IDatabase&&) noexcept = default;
+
     virtual ~IDatabase() = default;
 
     virtual std::string connection_info() const noexcept = 0;
@@ -23,9 +39,51 @@ class IDatabase {
     // Close connection
     virtual void disconnect() = 0;
 
+    // Ask the server to abandon the statement running on this connection,
+    // callable from any thread; the interrupted call throws. Returns false
+    // when the backend cannot cancel (the default).
+    virtual bool cancel();
+
     // Execute query without transaction (auto-commit)
     virtual std::unique_ptr<IResult> exec(const std::string& sql) = 0;
     // Execute parameterized query without transaction
-    virtual std::unique_ptr<IResult> exec_params(
-        const std::string& sql, const std::vector<std::any>& args) = 0;
+    virtual std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                                 const ParamPack& params) = 0;
+
+    // Execute parameterized query with type-erased arguments
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         const std::vector<std::any>& args) {
+        return exec_params(sql, ParamPack(args));
+    }
+
+    // Execute parameterized query, packing values without heap allocation
+    template <typename... Args, typename = ParamPack::EnableIfValues<Args...>>
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         Args&&... args) {
+        return exec_params(sql, ParamPack::of(std::forward<Args>(args)...));
+    }
+
+    // Asynchronous variants. The defaults run the blocking call on the
+    // shared ThreadPool, one call at a time per database; backends with a
+    // non-blocking driver override them. Keep the database alive until the
+    // futures are ready and do not mix with blocking calls in flight.
+
+    // Open connection asynchronously
+    virtual std::future<void> connect_async();
+    // Execute query asynchronously
+    virtual std::future<std::unique_ptr<IResult>> exec_async(
+        const std::string& sql);
+    // Execute parameterized query asynchronously
+    virtual std::future<std::unique_ptr<IResult>> exec_params_async(
+        const std::string& sql, const ParamPack& params);
+
+    std::future<std::unique_ptr<IResult>> exec_params_async(
+        const std::string& sql, const std::vector<std::any>& args) {
+        return exec_params_async(sql, ParamPack(args));
+    }
+
+   private:
+    // Serializes the thread-pool fallback, held by pointer so backends stay
+    // movable
+    std::unique_ptr<std::mutex> _asyncMutex = std::make_unique<std::mutex>();
 };
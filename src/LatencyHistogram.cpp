@@ -0,0 +1,84 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+double HistogramSnapshot::mean_ns() const noexcept {
+    return count == 0 ? 0.0 : static_cast<double>(sum_ns) / count;
+}
+
+// Latency below which a fraction p (0..1) of the samples fall, reported as
+// the upper bound of its bucket
+std::uint64_t HistogramSnapshot::percentile(double p) const noexcept {
+    if (count == 0) return 0;
+    p = std::min(std::max(p, 0.0), 1.0);
+    const auto rank = std::max<std::uint64_t>(
+        1, static_cast<std::uint64_t>(std::ceil(p * count)));
+
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(LatencyHistogram::upper_bound(i), max_ns);
+    }
+    return max_ns;
+}
+
+// Samples at or below ns
+std::uint64_t HistogramSnapshot::count_below(std::uint64_t ns) const noexcept {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < buckets.size(); ++i) {
+        if (LatencyHistogram::upper_bound(i) > ns) break;
+        total += buckets[i];
+    }
+    return total;
+}
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+    if (other.count == 0) return;
+    min_ns = count == 0 ? other.min_ns : std::min(min_ns, other.min_ns);
+    max_ns = std::max(max_ns, other.max_ns);
+    count += other.count;
+    sum_ns += other.sum_ns;
+    if (buckets.size() < other.buckets.size())
+        buckets.resize(other.buckets.size());
+    for (std::size_t i = 0; i < other.buckets.size(); ++i)
+        buckets[i] += other.buckets[i];
+}
+
+LatencyHistogram::LatencyHistogram() noexcept { reset(); }
+
+// Owning thread only
+void LatencyHistogram::reset() noexcept {
+    for (auto& counter : _counts) counter.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _min.store(std::numeric_limits<std::uint64_t>::max(),
+               std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+// Adds the current counts to snapshot. Reads race with the writer, so the
+// totals may be off by the samples recorded meanwhile.
+void LatencyHistogram::add_to(HistogramSnapshot& snapshot) const {
+    HistogramSnapshot own;
+    own.buckets.resize(Buckets);
+    for (std::size_t i = 0; i < Buckets; ++i) {
+        own.buckets[i] = _counts[i].load(std::memory_order_relaxed);
+        own.count += own.buckets[i];
+    }
+    if (own.count == 0) return;
+    own.sum_ns = _sum.load(std::memory_order_relaxed);
+    own.min_ns = _min.load(std::memory_order_relaxed);
+    own.max_ns = _max.load(std::memory_order_relaxed);
+    if (own.min_ns > own.max_ns) own.min_ns = own.max_ns;
+    snapshot.merge(own);
+}
+
+// Largest value counted in a bucket
+std::uint64_t LatencyHistogram::upper_bound(std::size_t bucket) noexcept {
+    if (bucket < SubBuckets) return bucket;
+    const std::size_t shift = (bucket - SubBuckets) / SubBuckets;
+    const std::uint64_t sub = (bucket - SubBuckets) % SubBuckets + SubBuckets;
+    return ((sub + 1) << shift) - 1;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Point-in-time copy of a LatencyHistogram, mergeable across threads
+struct HistogramSnapshot {
+    std::uint64_t count = 0;
+    std::uint64_t sum_ns = 0;
+    std::uint64_t min_ns = 0;
+    std::uint64_t max_ns = 0;
+    std::vector<std::uint64_t> buckets;  // counts per LatencyHistogram bucket
+
+    double mean_ns() const noexcept;
+
+    // Latency below which a fraction p (0..1) of the samples fall, reported
+    // as the upper bound of its bucket
+    std::uint64_t percentile(double p) const noexcept;
+
+    // Samples at or below ns
+    std::uint64_t count_below(std::uint64_t ns) const noexcept;
+
+    void merge(const HistogramSnapshot& other);
+};
+
+// LatencyHistogram class - nanosecond latencies in log-linear buckets in
+// the style of HdrHistogram: 16 linear sub-buckets per power of two, so
+// every bucket is within 1/16 (about 6%) of its values, from 1 ns up to
+// 2^40 ns (about 18 minutes, larger values are clamped). One thread
+// records, any thread may read; recording never locks or uses atomic
+// read-modify-write instructions.
+class LatencyHistogram final {
+   public:
+    static constexpr unsigned SubBucketBits = 4;
+    static constexpr unsigned MaxBits = 40;
+    static constexpr std::size_t SubBuckets = std::size_t(1) << SubBucketBits;
+    static constexpr std::size_t Buckets =
+        SubBuckets + (MaxBits - SubBucketBits) * SubBuckets;
+
+    LatencyHistogram() noexcept;
+
+    LatencyHistogram(const LatencyHistogram&) noexcept = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) noexcept = delete;
+
+    // Owning thread only
+    void record(std::uint64_t ns) noexcept;
+    void reset() noexcept;
+
+    // Adds the current counts to snapshot
+    void add_to(HistogramSnapshot& snapshot) const;
+
+    static std::size_t bucket(std::uint64_t ns) noexcept {
+        if (ns >= (std::uint64_t(1) << MaxBits))
+            ns = (std::uint64_t(1) << MaxBits) - 1;
+        if (ns < SubBuckets) return static_cast<std::size_t>(ns);
+        const unsigned bits = 63 - __builtin_clzll(ns);
+        const unsigned shift = bits - SubBucketBits;
+        return SubBuckets + shift * SubBuckets +
+               static_cast<std::size_t>((ns >> shift) - SubBuckets);
+    }
+
+    // Largest value counted in a bucket
+    static std::uint64_t upper_bound(std::size_t bucket) noexcept;
+
+   private:
+    // Single writer: plain load and store instead of fetch_add
+    static void add(std::atomic<std::uint64_t>& counter,
+                    std::uint64_t value) noexcept {
+        counter.store(counter.load(std::memory_order_relaxed) + value,
+                      std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<std::uint64_t>, Buckets> _counts;
+    std::atomic<std::uint64_t> _sum;
+    std::atomic<std::uint64_t> _min;
+    std::atomic<std::uint64_t> _max;
+};
+
+inline void LatencyHistogram::record(std::uint64_t ns) noexcept {
+    add(_counts[bucket(ns)], 1);
+    add(_sum, ns);
+    if (ns < _min.load(std::memory_order_relaxed))
+        _min.store(ns, std::memory_order_relaxed);
+    if (ns > _max.load(std::memory_order_relaxed))
+        _max.store(ns, std::memory_order_relaxed);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+// Bounded least-recently-used map (not thread-safe)
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache final {
+   public:
+    using Entry = std::pair<Key, Value>;
+
+    explicit LruCache(std::size_t capacity) noexcept : _capacity(capacity) {}
+
+    // Find entry and mark it most recently used (nullptr if absent)
+    Value* find(const Key& key) {
+        auto itr = _index.find(key);
+        if (itr == _index.end()) return nullptr;
+
+        _entries.splice(_entries.begin(), _entries, itr->second);
+        return &itr->second->second;
+    }
+
+    // Find entry without touching the recency order
+    const Value* peek(const Key& key) const {
+        auto itr = _index.find(key);
+        return itr == _index.end() ? nullptr : &itr->second->second;
+    }
+
+    // Insert or replace entry, returns the evicted entry if capacity exceeded
+    std::optional<Entry> insert(const Key& key, Value value) {
+        auto itr = _index.find(key);
+        if (itr != _index.end()) {
+            itr->second->second = std::move(value);
+            _entries.splice(_entries.begin(), _entries, itr->second);
+            return std::nullopt;
+        }
+
+        _entries.emplace_front(key, std::move(value));
+        _index.emplace(key, _entries.begin());
+
+        if (_index.size() <= _capacity) return std::nullopt;
+        return pop_back();
+    }
+
+    // Remove and return the least recently used entry
+    std::optional<Entry> pop_back() {
+        if (_entries.empty()) return std::nullopt;
+
+        _index.erase(_entries.back().first);
+        Entry entry = std::move(_entries.back());
+        _entries.pop_back();
+        return entry;
+    }
+
+    bool erase(const Key& key) {
+        auto itr = _index.find(key);
+        if (itr == _index.end()) return false;
+
+        _entries.erase(itr->second);
+        _index.erase(itr);
+        return true;
+    }
+
+    void clear() noexcept {
+        _index.clear();
+        _entries.clear();
+    }
+
+    // Visit entries from most to least recently used
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& entry : _entries) fn(entry.first, entry.second);
+    }
+
+    std::size_t size() const noexcept { return _index.size(); }
+    bool empty() const noexcept { return _index.empty(); }
+    std::size_t capacity() const noexcept { return _capacity; }
+
+   private:
+    using List = std::list<Entry>;
+
+    std::size_t _capacity;
+    List _entries;  // most recently used at the front
+    std::unordered_map<Key, typename List::iterator, Hash> _index;
+};
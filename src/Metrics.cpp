@@ -0,0 +1,459 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "SqlFingerprint.h"
+
+namespace {
+
+using Counter = std::atomic<std::uint64_t>;
+
+// Single writer: plain load and store instead of fetch_add
+void add(Counter& counter, std::uint64_t value) noexcept {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+}
+
+std::uint64_t load(const Counter& counter) noexcept {
+    return counter.load(std::memory_order_relaxed);
+}
+
+// Interned fingerprint, never freed
+struct Group {
+    std::uint64_t id;
+    std::string fingerprint;
+};
+
+// Counters of one group on one thread
+struct Counters {
+    explicit Counters(const Group* owner) noexcept : group(owner) {}
+
+    const Group* group;
+    Counter calls{0};
+    Counter errors{0};
+    Counter rows{0};
+    Counter bytes{0};
+    Counter total{0};
+    Counter min{0};
+    Counter max{0};
+    Counters* next = nullptr;  // published list, newest first
+};
+
+struct ThreadState {
+    std::array<LatencyHistogram, MetricsSnapshot::Phases> phases;
+    Counter generation{0};
+    std::atomic<Counters*> head{nullptr};
+
+    // Owning thread only
+    std::deque<Counters> counters;  // stable addresses
+    std::unordered_map<const Group*, Counters*> byGroup;
+    std::unordered_map<std::uint64_t, Counters*> byKey;  // by key(sql)
+    std::unordered_map<std::string, Counters*> bySql;    // first text
+
+    // Statements remembered per thread before the maps start over
+    static constexpr std::size_t MaxKeys = 1024;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadState>> threads;
+    MetricsSnapshot retired;  // threads that have exited
+    Counter generation{0};
+
+    std::mutex groupMutex;
+    std::unordered_map<std::string, std::unique_ptr<Group>> groups;
+    Group other{SqlFingerprint::hash("<other>"), "<other>"};
+};
+
+// Leaked on purpose: threads may still exit after static destruction
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+void collect(const ThreadState& state, MetricsSnapshot& snapshot,
+             std::unordered_map<const Group*, StatementMetrics>& groups) {
+    for (std::size_t i = 0; i < MetricsSnapshot::Phases; ++i)
+        state.phases[i].add_to(snapshot.phases[i]);
+
+    for (const Counters* counters =
+             state.head.load(std::memory_order_acquire);
+         counters != nullptr; counters = counters->next) {
+        const std::uint64_t calls = load(counters->calls);
+        if (calls == 0) continue;
+        StatementMetrics& group = groups[counters->group];
+        group.min_ns = group.calls == 0
+                           ? load(counters->min)
+                           : std::min(group.min_ns, load(counters->min));
+        group.max_ns = std::max(group.max_ns, load(counters->max));
+        group.calls += calls;
+        group.errors += load(counters->errors);
+        group.rows += load(counters->rows);
+        group.bytes += load(counters->bytes);
+        group.total_ns += load(counters->total);
+    }
+}
+
+void merge(MetricsSnapshot& into, MetricsSnapshot&& from) {
+    for (std::size_t i = 0; i < MetricsSnapshot::Phases; ++i)
+        into.phases[i].merge(from.phases[i]);
+    std::unordered_map<std::uint64_t, std::size_t> index;
+    for (std::size_t i = 0; i < into.statements.size(); ++i)
+        index.emplace(into.statements[i].id, i);
+    for (auto& statement : from.statements) {
+        auto found = index.find(statement.id);
+        if (found == index.end()) {
+            into.statements.push_back(std::move(statement));
+            continue;
+        }
+        StatementMetrics* existing = &into.statements[found->second];
+        existing->min_ns = std::min(existing->min_ns, statement.min_ns);
+        existing->max_ns = std::max(existing->max_ns, statement.max_ns);
+        existing->calls += statement.calls;
+        existing->errors += statement.errors;
+        existing->rows += statement.rows;
+        existing->bytes += statement.bytes;
+        existing->total_ns += statement.total_ns;
+    }
+}
+
+// Zero the state of the owning thread after a reset
+void sync(ThreadState& state) noexcept {
+    const std::uint64_t generation = load(registry().generation);
+    if (load(state.generation) == generation) return;
+    for (auto& phase : state.phases) phase.reset();
+    for (auto& counters : state.counters) {
+        for (Counter* counter :
+             {&counters.calls, &counters.errors, &counters.rows,
+              &counters.bytes, &counters.total, &counters.min, &counters.max})
+            counter->store(0, std::memory_order_relaxed);
+    }
+    state.generation.store(generation, std::memory_order_release);
+}
+
+// Registers the thread on first use, folds it into the retired totals
+// when the thread exits
+struct ThreadHandle {
+    ThreadHandle() : state(std::make_shared<ThreadState>()) {
+        Registry& reg = registry();
+        state->generation.store(load(reg.generation));
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.threads.push_back(state);
+    }
+
+    ~ThreadHandle() {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.threads.erase(
+            std::find(reg.threads.begin(), reg.threads.end(), state));
+        if (load(state->generation) != load(reg.generation)) return;
+        try {
+            MetricsSnapshot own;
+            std::unordered_map<const Group*, StatementMetrics> groups;
+            collect(*state, own, groups);
+            for (auto& group : groups) {
+                group.second.id = group.first->id;
+                group.second.fingerprint = group.first->fingerprint;
+                own.statements.push_back(std::move(group.second));
+            }
+            merge(reg.retired, std::move(own));
+        } catch (...) {
+            // Counts of this thread are lost
+        }
+    }
+
+    std::shared_ptr<ThreadState> state;
+};
+
+ThreadState& local() {
+    thread_local ThreadHandle handle;
+    return *handle.state;
+}
+
+const Group* intern(const std::string& sql) {
+    std::string fingerprint = SqlFingerprint::normalize(sql);
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.groupMutex);
+    auto itr = reg.groups.find(fingerprint);
+    if (itr != reg.groups.end()) return itr->second.get();
+    if (reg.groups.size() >= Metrics::MaxStatements) return &reg.other;
+
+    const std::uint64_t id = SqlFingerprint::hash(fingerprint);
+    auto group = std::make_unique<Group>(Group{id, fingerprint});
+    return reg.groups.emplace(std::move(fingerprint), std::move(group))
+        .first->second.get();
+}
+
+// Counters of sql on this thread. The text first seen for a fingerprint
+// is found by a plain string hash, which covers statements with bound
+// parameters. Others differing only in literals share a
+// SqlFingerprint::key, so only the first of a fingerprint on each thread
+// builds the normalized text and takes the registry lock.
+Counters& counters(ThreadState& state, const std::string& sql) {
+    auto exact = state.bySql.find(sql);
+    if (exact != state.bySql.end()) return *exact->second;
+    const std::uint64_t key = SqlFingerprint::key(sql);
+    auto itr = state.byKey.find(key);
+    if (itr != state.byKey.end()) return *itr->second;
+
+    const Group* group = intern(sql);
+    Counters*& slot = state.byGroup[group];
+    if (slot == nullptr) {
+        Counters& created = state.counters.emplace_back(group);
+        created.next = state.head.load(std::memory_order_relaxed);
+        state.head.store(&created, std::memory_order_release);
+        slot = &created;
+    }
+    if (state.byKey.size() >= ThreadState::MaxKeys) {
+        state.byKey.clear();
+        state.bySql.clear();
+    }
+    state.byKey.emplace(key, slot);
+    state.bySql.emplace(sql, slot);
+    return *slot;
+}
+
+std::uint64_t elapsed(Metrics::Clock::time_point start) noexcept {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Metrics::Clock::now() - start)
+            .count());
+}
+
+const char* const PhaseNames[MetricsSnapshot::Phases] = {"connect", "execute",
+                                                         "fetch", "commit"};
+
+// Escapes for JSON strings and Prometheus label values
+std::string escape(const std::string& text, bool json) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            default:
+                if (json && static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+std::string number(double value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+std::string hex(std::uint64_t value) {
+    char buffer[20];
+    std::snprintf(buffer, sizeof(buffer), "%016llx",
+                  static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+}  // namespace
+
+std::atomic<bool> Metrics::_enabled{true};
+
+double StatementMetrics::mean_ns() const noexcept {
+    return calls == 0 ? 0.0 : static_cast<double>(total_ns) / calls;
+}
+
+const HistogramSnapshot& MetricsSnapshot::phase(
+    MetricsPhase phase) const noexcept {
+    return phases[static_cast<std::size_t>(phase)];
+}
+
+// {"phases": {...}, "statements": [...]}, latencies in nanoseconds
+std::string MetricsSnapshot::to_json() const {
+    std::string out = "{\"phases\":{";
+    for (std::size_t i = 0; i < Phases; ++i) {
+        const HistogramSnapshot& h = phases[i];
+        if (i > 0) out += ',';
+        out += '"';
+        out += PhaseNames[i];
+        out += "\":{\"count\":" + std::to_string(h.count) +
+               ",\"sum_ns\":" + std::to_string(h.sum_ns) +
+               ",\"min_ns\":" + std::to_string(h.min_ns) +
+               ",\"max_ns\":" + std::to_string(h.max_ns) +
+               ",\"mean_ns\":" + number(h.mean_ns()) +
+               ",\"p50_ns\":" + std::to_string(h.percentile(0.5)) +
+               ",\"p90_ns\":" + std::to_string(h.percentile(0.9)) +
+               ",\"p99_ns\":" + std::to_string(h.percentile(0.99)) +
+               ",\"p999_ns\":" + std::to_string(h.percentile(0.999)) + '}';
+    }
+    out += "},\"statements\":[";
+    for (std::size_t i = 0; i < statements.size(); ++i) {
+        const StatementMetrics& s = statements[i];
+        if (i > 0) out += ',';
+        out += "{\"id\":\"" + hex(s.id) + "\",\"query\":\"" +
+               escape(s.fingerprint, true) +
+               "\",\"calls\":" + std::to_string(s.calls) +
+               ",\"errors\":" + std::to_string(s.errors) +
+               ",\"rows\":" + std::to_string(s.rows) +
+               ",\"bytes\":" + std::to_string(s.bytes) +
+               ",\"total_ns\":" + std::to_string(s.total_ns) +
+               ",\"min_ns\":" + std::to_string(s.min_ns) +
+               ",\"max_ns\":" + std::to_string(s.max_ns) +
+               ",\"mean_ns\":" + number(s.mean_ns()) + '}';
+    }
+    out += "]}";
+    return out;
+}
+
+// Prometheus text exposition format, latencies in seconds
+std::string MetricsSnapshot::to_prometheus() const {
+    static const double Bounds[] = {0.00005, 0.0001, 0.00025, 0.0005, 0.001,
+                                    0.0025,  0.005,  0.01,    0.025,  0.05,
+                                    0.1,     0.25,   0.5,     1,      2.5,
+                                    5,       10};
+
+    std::string out =
+        "# HELP dbfactory_phase_duration_seconds Latency of database client "
+        "phases\n# TYPE dbfactory_phase_duration_seconds histogram\n";
+    for (std::size_t i = 0; i < Phases; ++i) {
+        const HistogramSnapshot& h = phases[i];
+        const std::string phase = std::string("phase=\"") + PhaseNames[i] +
+                                  '"';
+        for (double bound : Bounds) {
+            const auto ns = static_cast<std::uint64_t>(bound * 1e9);
+            out += "dbfactory_phase_duration_seconds_bucket{" + phase +
+                   ",le=\"" + number(bound) +
+                   "\"} " + std::to_string(h.count_below(ns)) + '\n';
+        }
+        out += "dbfactory_phase_duration_seconds_bucket{" + phase +
+               ",le=\"+Inf\"} " + std::to_string(h.count) + '\n';
+        out += "dbfactory_phase_duration_seconds_sum{" + phase + "} " +
+               number(h.sum_ns / 1e9) + '\n';
+        out += "dbfactory_phase_duration_seconds_count{" + phase + "} " +
+               std::to_string(h.count) + '\n';
+    }
+
+    struct Series {
+        const char* name;
+        const char* help;
+        double (*value)(const StatementMetrics&);
+    };
+    static const Series Counters[] = {
+        {"dbfactory_statement_calls_total", "Executions per statement",
+         [](const StatementMetrics& s) { return double(s.calls); }},
+        {"dbfactory_statement_errors_total", "Failed executions",
+         [](const StatementMetrics& s) { return double(s.errors); }},
+        {"dbfactory_statement_rows_total", "Rows returned",
+         [](const StatementMetrics& s) { return double(s.rows); }},
+        {"dbfactory_statement_bytes_total", "Field bytes returned",
+         [](const StatementMetrics& s) { return double(s.bytes); }},
+        {"dbfactory_statement_seconds_total", "Execution time",
+         [](const StatementMetrics& s) { return s.total_ns / 1e9; }}};
+    for (const Series& series : Counters) {
+        out += std::string("# HELP ") + series.name + ' ' + series.help +
+               "\n# TYPE " + series.name + " counter\n";
+        for (const StatementMetrics& s : statements) {
+            out += std::string(series.name) + "{queryid=\"" + hex(s.id) +
+                   "\",query=\"" + escape(s.fingerprint, false) + "\"} " +
+                   number(series.value(s)) + '\n';
+        }
+    }
+    return out;
+}
+
+void Metrics::enable(bool enabled) noexcept {
+    _enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Metrics::enabled() noexcept {
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+// Latency of a phase since start
+void Metrics::record(MetricsPhase phase, Clock::time_point start) noexcept {
+    if (start == Clock::time_point()) return;
+    const std::uint64_t ns = elapsed(start);
+    try {
+        ThreadState& state = local();
+        sync(state);
+        state.phases[static_cast<std::size_t>(phase)].record(ns);
+    } catch (...) {
+        // Metrics never fail a query
+    }
+}
+
+// Execution of sql since start, counted under its fingerprint
+void Metrics::record(const std::string& sql, Clock::time_point start,
+                     std::size_t rows, std::size_t bytes,
+                     bool failed) noexcept {
+    if (start == Clock::time_point()) return;
+    const std::uint64_t ns = elapsed(start);
+    try {
+        ThreadState& state = local();
+        sync(state);
+        state.phases[static_cast<std::size_t>(MetricsPhase::Execute)].record(
+            ns);
+
+        Counters& c = counters(state, sql);
+        if (load(c.calls) == 0 || ns < load(c.min))
+            c.min.store(ns, std::memory_order_relaxed);
+        if (ns > load(c.max)) c.max.store(ns, std::memory_order_relaxed);
+        add(c.total, ns);
+        add(c.rows, rows);
+        add(c.bytes, bytes);
+        if (failed) add(c.errors, 1);
+        // Last, so snapshots skip counters still being filled
+        add(c.calls, 1);
+    } catch (...) {
+        // Metrics never fail a query
+    }
+}
+
+MetricsSnapshot Metrics::snapshot() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    MetricsSnapshot snapshot = reg.retired;
+    std::unordered_map<const Group*, StatementMetrics> groups;
+    const std::uint64_t generation = load(reg.generation);
+    for (const auto& state : reg.threads) {
+        // Threads that have not caught up with a reset count as zero
+        if (state->generation.load(std::memory_order_acquire) == generation)
+            collect(*state, snapshot, groups);
+    }
+
+    MetricsSnapshot live;
+    for (auto& group : groups) {
+        group.second.id = group.first->id;
+        group.second.fingerprint = group.first->fingerprint;
+        live.statements.push_back(std::move(group.second));
+    }
+    merge(snapshot, std::move(live));
+    std::sort(snapshot.statements.begin(), snapshot.statements.end(),
+              [](const StatementMetrics& a, const StatementMetrics& b) {
+                  return a.total_ns > b.total_ns;
+              });
+    return snapshot;
+}
+
+// Zero every counter; threads drop their own on their next record()
+void Metrics::reset() noexcept {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.generation.fetch_add(1);
+    reg.retired = MetricsSnapshot();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LatencyHistogram.h"
+
+// Phases timed by Metrics
+enum class MetricsPhase { Connect, Execute, Fetch, Commit };
+
+// Counters of one statement fingerprint
+struct StatementMetrics {
+    std::uint64_t id = 0;     // SqlFingerprint::hash of the fingerprint
+    std::string fingerprint;  // normalized statement text
+    std::uint64_t calls = 0;
+    std::uint64_t errors = 0;
+    std::uint64_t rows = 0;   // rows returned
+    std::uint64_t bytes = 0;  // field bytes returned
+    std::uint64_t total_ns = 0;
+    std::uint64_t min_ns = 0;
+    std::uint64_t max_ns = 0;
+
+    double mean_ns() const noexcept;
+};
+
+// Point-in-time copy of the metrics of every thread
+struct MetricsSnapshot {
+    static constexpr std::size_t Phases = 4;
+
+    std::array<HistogramSnapshot, Phases> phases;  // indexed by MetricsPhase
+    std::vector<StatementMetrics> statements;      // largest total first
+
+    const HistogramSnapshot& phase(MetricsPhase phase) const noexcept;
+
+    // {"phases": {...}, "statements": [...]}, latencies in nanoseconds
+    std::string to_json() const;
+
+    // Prometheus text exposition format, latencies in seconds
+    std::string to_prometheus() const;
+};
+
+// Metrics class - process-wide latency histograms per phase and counters
+// per statement fingerprint (see SqlFingerprint). Every thread records into
+// its own histograms and counters without locks or atomic read-modify-write
+// instructions; snapshot() merges them. Enabled by default.
+class Metrics final {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    // Fingerprints tracked before new ones are counted together as "<other>"
+    static constexpr std::size_t MaxStatements = 5000;
+
+    Metrics() = delete;
+    ~Metrics() = delete;
+
+    static void enable(bool enabled) noexcept;
+    static bool enabled() noexcept;
+
+    // Start of a measurement; while disabled the zero time point, which
+    // turns the matching record() into a no-op
+    static Clock::time_point start() noexcept {
+        return _enabled.load(std::memory_order_relaxed) ? Clock::now()
+                                                        : Clock::time_point();
+    }
+
+    // Latency of a phase since start
+    static void record(MetricsPhase phase, Clock::time_point start) noexcept;
+
+    // Execution of sql since start, counted under its fingerprint
+    static void record(const std::string& sql, Clock::time_point start,
+                       std::size_t rows, std::size_t bytes,
+                       bool failed = false) noexcept;
+
+    static MetricsSnapshot snapshot();
+
+    // Zero every counter; threads drop their own on their next record()
+    static void reset() noexcept;
+
+   private:
+    static std::atomic<bool> _enabled;
+};
@@ -3,47 +3,272 @@
 #include <iostream>
 #include <stdexcept>
 
+#include "ColumnDecoder.h"
+#include "Errors.h"
+#include "MySQLStream.h"
+
+namespace {
+
+// Frees the pending rows of a statement when leaving scope
+struct FreeGuard {
+    MySQLStatement* stmt;
+    ~FreeGuard() { stmt->free_result(); }
+};
+
+}  // namespace
+
+std::unique_ptr<IResult> MySQLResult::clone() const {
+    return std::make_unique<MySQLResult>(*this);
+}
+
+// Typed cell from a text protocol value
+Param MySQLResult::decode(const MYSQL_FIELD& field, const char* data,
+                          unsigned long length) {
+    switch (field.type) {
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_LONGLONG:
+        case MYSQL_TYPE_YEAR: {
+            std::int64_t value;
+            // Unsigned values above the int64 range stay text
+            if (ColumnDecoder::parse_int(data, length, value))
+                return Param(value);
+            break;
+        }
+        case MYSQL_TYPE_FLOAT:
+        case MYSQL_TYPE_DOUBLE: {
+            // Row values are NUL-terminated
+            double value;
+            ColumnDecoder::decode(data, length, value);
+            return Param(value);
+        }
+        case MYSQL_TYPE_BIT:
+        case MYSQL_TYPE_GEOMETRY:
+            return Param::bytea(std::string_view(data, length));
+        case MYSQL_TYPE_STRING:
+        case MYSQL_TYPE_VAR_STRING:
+        case MYSQL_TYPE_VARCHAR:
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB:
+        case MYSQL_TYPE_BLOB:
+            // Binary strings and blobs use the binary character set (63)
+            if (field.charsetnr == 63)
+                return Param::bytea(std::string_view(data, length));
+            break;
+        default:
+            break;
+    }
+    return Param(std::string_view(data, length));
+}
+
 MySQLDatabase::MySQLDatabase(const std::string& host, int port) noexcept
-    : _host(host), _port(port == 0 ? 3306 : port), _connected(false) {}
+    : MySQLDatabase(DatabaseConfig(host, port)) {}
+
+// Uses host, port, database, username and password
+MySQLDatabase::MySQLDatabase(const DatabaseConfig& config) noexcept
+    : _config(config), _mysql(nullptr), _statements(64) {
+    if (_config.host.empty()) _config.host = "localhost";
+    if (_config.port == 0) _config.port = 3306;
+}
+
+MySQLDatabase::~MySQLDatabase() noexcept {
+    _statements.clear();
+    if (_mysql) mysql_close(_mysql);
+}
 
 std::string MySQLDatabase::connection_info() const noexcept {
-    return "MySQL Database at " + _host + ":" + std::to_string(_port);
+    return "MySQL Database at " + _config.host + ":" +
+           std::to_string(_config.port);
 }
 
-bool MySQLDatabase::connected() const noexcept { return _connected; }
+bool MySQLDatabase::connected() const noexcept { return _mysql != nullptr; }
 
 void MySQLDatabase::connect() {
-    if (_connected) {
+    if (connected()) {
         std::cout << "[MySQL] Already connected\n";
         return;
     }
-    std::cout << "[MySQL] Connecting to " << _host << ":" << _port << "\n";
-    // Simulate connection logic
-    _connected = true;
+    std::cout << "[MySQL] Connecting to " << _config.host << ":"
+              << _config.port << "\n";
+
+    // mysql_init() initializes the library on first use, which is not
+    // thread-safe; do it once up front
+    static const int libraryInit = mysql_library_init(0, nullptr, nullptr);
+    if (libraryInit != 0) {
+        throw ConnectionError("[MySQL] Could not initialize client library");
+    }
+
+    MYSQL* mysql = mysql_init(nullptr);
+    if (mysql == nullptr) {
+        throw ConnectionError("[MySQL] Out of memory");
+    }
+    mysql_options(mysql, MYSQL_SET_CHARSET_NAME, "utf8mb4");
+
+    auto optional = [](const std::string& value) {
+        return value.empty() ? nullptr : value.c_str();
+    };
+    if (!mysql_real_connect(mysql, _config.host.c_str(),
+                            optional(_config.username),
+                            optional(_config.password),
+                            optional(_config.database),
+                            static_cast<unsigned>(_config.port), nullptr,
+                            CLIENT_MULTI_STATEMENTS)) {
+        std::string msg = mysql_error(mysql);
+        mysql_close(mysql);
+        throw ConnectionError("[MySQL] " + msg);
+    }
+    _mysql = mysql;
     std::cout << "[MySQL] Successfully connected\n";
 }
 
 void MySQLDatabase::disconnect() {
-    if (!_connected) {
+    if (!connected()) {
         std::cout << "[MySQL] Already disconnected\n";
         return;
     }
     std::cout << "[MySQL] Disconnecting from database\n";
-    _connected = false;
+    // Statements must be closed before the connection
+    _statements.clear();
+    mysql_close(_mysql);
+    _mysql = nullptr;
     std::cout << "[MySQL] Successfully disconnected\n";
 }
 
+// Execute one or more ';'-separated statements over the text protocol,
+// returns the last result
 std::unique_ptr<IResult> MySQLDatabase::exec(const std::string& sql) {
-    if (!_connected) {
-        throw std::runtime_error("[MySQL] Database not connected");
+    return std::make_unique<MySQLResult>(query(sql));
+}
+
+// Server-side prepared statement with '?' placeholders, rows in the binary
+// protocol
+std::unique_ptr<IResult> MySQLDatabase::exec_params(const std::string& sql,
+                                                    const ParamPack& params) {
+    return std::make_unique<MySQLResult>(query_params(sql, params));
+}
+
+// Same as exec and exec_params, returning the result by value
+MySQLResult MySQLDatabase::query(const std::string& sql) {
+    if (!connected()) {
+        throw ConnectionError("[MySQL] Database not connected");
+    }
+
+    if (mysql_real_query(_mysql, sql.data(), sql.size()) != 0) fail();
+
+    MySQLResult result{std::vector<std::string>()};
+    int status;
+    do {
+        result = read_text();
+        // 0: another result follows, -1: done, > 0: a statement failed
+        status = mysql_next_result(_mysql);
+        if (status > 0) fail();
+    } while (status == 0);
+    return result;
+}
+
+MySQLResult MySQLDatabase::query_params(const std::string& sql,
+                                        const ParamPack& params) {
+    if (!connected()) {
+        throw ConnectionError("[MySQL] Database not connected");
+    }
+
+    std::unique_ptr<MySQLStatement> owned;
+    MySQLStatement* stmt;
+    if (auto cached = _statements.find(sql)) {
+        stmt = cached->get();
+    } else {
+        owned = std::make_unique<MySQLStatement>(_mysql, sql);
+        stmt = owned.get();
+        if (_statements.capacity() > 0) {
+            // Evicted statements are closed on the server here
+            _statements.insert(sql, std::move(owned));
+        }
+    }
+
+    FreeGuard guard{stmt};
+    stmt->execute(params);
+
+    MySQLResult result(stmt->columns());
+    std::vector<Param> row;
+    while (stmt->fetch(row)) result.append(row);
+    result.finish(stmt->affected_rows(), stmt->insert_id());
+    return result;
+}
+
+// Read a large result row by row instead of buffering it
+MySQLStream MySQLDatabase::stream(const std::string& sql) {
+    if (!connected()) {
+        throw ConnectionError("[MySQL] Database not connected");
+    }
+
+    return MySQLStream(_mysql, sql);
+}
+
+MySQLStream MySQLDatabase::stream_params(const std::string& sql,
+                                         const ParamPack& params) {
+    if (!connected()) {
+        throw ConnectionError("[MySQL] Database not connected");
+    }
+
+    // Not cached: the statement stays busy until the stream is closed
+    return MySQLStream(_mysql, sql, params);
+}
+
+// Prepared statement cache keyed by SQL (capacity 0 disables)
+void MySQLDatabase::statement_cache(std::size_t capacity) {
+    _statements = LruCache<std::string, std::unique_ptr<MySQLStatement>>(
+        capacity);
+}
+
+std::size_t MySQLDatabase::cached_statements() const noexcept {
+    return _statements.size();
+}
+
+// Underlying connection handle (nullptr when disconnected)
+MYSQL* MySQLDatabase::handle() const noexcept { return _mysql; }
+
+MySQLResult MySQLDatabase::read_text() {
+    MYSQL_RES* res = mysql_store_result(_mysql);
+    if (res == nullptr) {
+        // Statements without a result set have no columns
+        if (mysql_field_count(_mysql) != 0) fail();
+        MySQLResult result{std::vector<std::string>()};
+        result.finish(mysql_affected_rows(_mysql), mysql_insert_id(_mysql));
+        return result;
+    }
+
+    const unsigned count = mysql_num_fields(res);
+    const MYSQL_FIELD* fields = mysql_fetch_fields(res);
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (unsigned col = 0; col < count; ++col)
+        names.emplace_back(fields[col].name);
+
+    MySQLResult result(std::move(names));
+    std::vector<Param> row(count);
+    try {
+        while (MYSQL_ROW values = mysql_fetch_row(res)) {
+            const unsigned long* lengths = mysql_fetch_lengths(res);
+            for (unsigned col = 0; col < count; ++col) {
+                row[col] = values[col] ? MySQLResult::decode(fields[col],
+                                                             values[col],
+                                                             lengths[col])
+                                       : Param();
+            }
+            result.append(row);
+        }
+    } catch (...) {
+        mysql_free_result(res);
+        throw;
     }
-    std::cout << "[MySQL] Executing query: " << sql << "\n";
-    // Simulate query execution
-    std::cout << "[MySQL] Query executed successfully\n";
-    return nullptr;
+    mysql_free_result(res);
+    return result;
 }
 
-std::unique_ptr<IResult> MySQLDatabase::exec_params(
-    const std::string& sql, const std::vector<std::any>& args) {
-    return nullptr;
+void MySQLDatabase::fail() const {
+    throw QueryError("[MySQL] " + std::string(mysql_error(_mysql)),
+                     mysql_sqlstate(_mysql));
 }
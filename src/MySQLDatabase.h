@@ -1,12 +1,47 @@
 #pragma once
 
+#include <mysql.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "CellResult.h"
+#include "DatabaseConfig.h"
 #include "IDatabase.h"
+#include "LruCache.h"
+#include "MySQLStatement.h"
+
+class MySQLStream;
+
+// MySQLResult class - rows of a MySQL statement. Prepared statements
+// (exec_params) return integer, float, timestamp, text and bytea cells;
+// the text protocol (exec) returns integer and float cells for numeric
+// columns and text or bytea otherwise.
+class MySQLResult : public CellResult {
+   public:
+    using CellResult::CellResult;
 
-// MySQL Database implementation
+    std::unique_ptr<IResult> clone() const override;
+
+    // Typed cell from a text protocol value
+    static Param decode(const MYSQL_FIELD& field, const char* data,
+                        unsigned long length);
+};
+
+// MySQL Database implementation over libmysqlclient (or the MariaDB client
+// library). Each instance owns one connection and is used by one thread at
+// a time.
 class MySQLDatabase : public IDatabase {
    public:
     MySQLDatabase(const std::string& host = "localhost",
                   int port = 3306) noexcept;
+    explicit MySQLDatabase(const DatabaseConfig& config) noexcept;
+
+    MySQLDatabase(const MySQLDatabase&) noexcept = delete;
+    MySQLDatabase& operator=(const MySQLDatabase&) noexcept = delete;
+
+    ~MySQLDatabase() noexcept override;
 
     std::string connection_info() const noexcept override;
 
@@ -16,13 +51,39 @@ class MySQLDatabase : public IDatabase {
 
     void disconnect() override;
 
+    // Execute one or more ';'-separated statements over the text protocol,
+    // returns the last result
     std::unique_ptr<IResult> exec(const std::string& sql) override;
 
-    std::unique_ptr<IResult> exec_params(
-        const std::string& sql, const std::vector<std::any>& args) override;
+    // Server-side prepared statement with '?' placeholders, rows in the
+    // binary protocol
+    using IDatabase::exec_params;
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         const ParamPack& params) override;
+
+    // Same as exec and exec_params, returning the result by value
+    MySQLResult query(const std::string& sql);
+    MySQLResult query_params(const std::string& sql, const ParamPack& params);
+
+    // Read a large result row by row instead of buffering it. The
+    // connection cannot run other statements until the stream is done.
+    MySQLStream stream(const std::string& sql);
+
+    MySQLStream stream_params(const std::string& sql, const ParamPack& params);
+
+    // Prepared statement cache keyed by SQL (capacity 0 disables)
+    void statement_cache(std::size_t capacity);
+
+    std::size_t cached_statements() const noexcept;
+
+    // Underlying connection handle (nullptr when disconnected)
+    MYSQL* handle() const noexcept;
 
    private:
-    std::string _host;
-    int _port;
-    bool _connected;
+    MySQLResult read_text();
+    [[noreturn]] void fail() const;
+
+    DatabaseConfig _config;
+    MYSQL* _mysql;
+    LruCache<std::string, std::unique_ptr<MySQLStatement>> _statements;
 };
@@ -0,0 +1,327 @@
+#include "MySQLStatement.h"
+
+#include <cstdio>
+
+namespace {
+
+// Initial fetch buffer of string columns, grown on truncation
+constexpr std::size_t InitialBytes = 64;
+
+constexpr std::int64_t MicrosPerDay = 86400LL * 1000000;
+
+// Civil date from days since 1970-01-01 (proleptic Gregorian)
+void civil_from_days(std::int64_t days, int& y, unsigned& m, unsigned& d) {
+    days += 719468;
+    std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = static_cast<unsigned>(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(yoe + era * 400 + (m <= 2));
+}
+
+// Days since 1970-01-01 of a civil date (proleptic Gregorian)
+std::int64_t days_from_civil(std::int64_t y, unsigned m, unsigned d) noexcept {
+    y -= m <= 2;
+    std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+MYSQL_TIME to_time(std::int64_t micros) {
+    std::int64_t days = micros / MicrosPerDay;
+    std::int64_t rest = micros % MicrosPerDay;
+    if (rest < 0) {
+        --days;
+        rest += MicrosPerDay;
+    }
+
+    int year;
+    unsigned month, day;
+    civil_from_days(days, year, month, day);
+    if (year < 0 || year > 9999) {
+        throw QueryError("[MySQL] Timestamp out of range");
+    }
+
+    MYSQL_TIME time{};
+    time.year = static_cast<unsigned>(year);
+    time.month = month;
+    time.day = day;
+    time.hour = static_cast<unsigned>(rest / 3600000000LL);
+    time.minute = static_cast<unsigned>(rest / 60000000 % 60);
+    time.second = static_cast<unsigned>(rest / 1000000 % 60);
+    time.second_part = static_cast<unsigned long>(rest % 1000000);
+    time.time_type = MYSQL_TIMESTAMP_DATETIME;
+    return time;
+}
+
+// Result buffer kind of a column type
+bool integer_type(enum_field_types type) noexcept {
+    switch (type) {
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_LONGLONG:
+        case MYSQL_TYPE_YEAR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Binary strings and blobs use the binary character set (63)
+bool binary_type(const MYSQL_FIELD& field) noexcept {
+    switch (field.type) {
+        case MYSQL_TYPE_BIT:
+        case MYSQL_TYPE_GEOMETRY:
+            return true;
+        case MYSQL_TYPE_STRING:
+        case MYSQL_TYPE_VAR_STRING:
+        case MYSQL_TYPE_VARCHAR:
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB:
+        case MYSQL_TYPE_BLOB:
+            return field.charsetnr == 63;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+// Prepare sql on conn (throws QueryError)
+MySQLStatement::MySQLStatement(MYSQL* conn, const std::string& sql)
+    : _stmt(mysql_stmt_init(conn)), _rebind(false) {
+    if (_stmt == nullptr) {
+        throw QueryError("[MySQL] " + std::string(mysql_error(conn)));
+    }
+    try {
+        if (mysql_stmt_prepare(_stmt, sql.data(), sql.size()) != 0)
+            throw error();
+        _params.resize(mysql_stmt_param_count(_stmt));
+        _values.resize(_params.size());
+        bind_result();
+    } catch (...) {
+        mysql_stmt_close(_stmt);
+        throw;
+    }
+}
+
+MySQLStatement::~MySQLStatement() noexcept { mysql_stmt_close(_stmt); }
+
+// Bind params by position ('?') and execute (throws QueryError)
+void MySQLStatement::execute(const ParamPack& params) {
+    if (params.size() != _params.size()) {
+        throw QueryError("[MySQL] Statement expects " +
+                         std::to_string(_params.size()) +
+                         " parameters, got " + std::to_string(params.size()));
+    }
+    for (std::size_t i = 0; i < params.size(); ++i) bind_param(i, params[i]);
+    if (!_params.empty() && mysql_stmt_bind_param(_stmt, _params.data()))
+        throw error();
+    if (mysql_stmt_execute(_stmt) != 0) throw error();
+
+    // Metadata may change when the server re-prepares after DDL
+    if (mysql_stmt_field_count(_stmt) != _columns.size()) bind_result();
+}
+
+// Column names of the result set (empty if the statement has none)
+const std::vector<std::string>& MySQLStatement::columns() const noexcept {
+    return _names;
+}
+
+// Fetch the next row into row, false after the last one
+bool MySQLStatement::fetch(std::vector<Param>& row) {
+    if (_rebind) {
+        if (mysql_stmt_bind_result(_stmt, _results.data())) throw error();
+        _rebind = false;
+    }
+
+    int rc = mysql_stmt_fetch(_stmt);
+    if (rc == MYSQL_NO_DATA) return false;
+    if (rc == 1) throw error();
+    if (rc == MYSQL_DATA_TRUNCATED) {
+        // Grow the buffers of long values and read them again
+        for (std::size_t col = 0; col < _columns.size(); ++col) {
+            Column& column = _columns[col];
+            if (!column.error || column.kind == Kind::Int ||
+                column.kind == Kind::Float || column.kind == Kind::Time)
+                continue;
+            column.bytes.resize(column.length);
+            MYSQL_BIND& bind = _results[col];
+            bind.buffer = column.bytes.data();
+            bind.buffer_length = column.bytes.size();
+            if (mysql_stmt_fetch_column(_stmt, &bind,
+                                        static_cast<unsigned>(col), 0))
+                throw error();
+            _rebind = true;
+        }
+    }
+
+    row.resize(_columns.size());
+    for (std::size_t col = 0; col < _columns.size(); ++col)
+        row[col] = cell(col);
+    return true;
+}
+
+// Discard unread rows so the statement can be executed again
+void MySQLStatement::free_result() noexcept { mysql_stmt_free_result(_stmt); }
+
+std::uint64_t MySQLStatement::affected_rows() const noexcept {
+    return _columns.empty() ? mysql_stmt_affected_rows(_stmt) : 0;
+}
+
+std::uint64_t MySQLStatement::insert_id() const noexcept {
+    return mysql_stmt_insert_id(_stmt);
+}
+
+QueryError MySQLStatement::error() const {
+    return QueryError("[MySQL] " + std::string(mysql_stmt_error(_stmt)),
+                      mysql_stmt_sqlstate(_stmt));
+}
+
+void MySQLStatement::bind_param(std::size_t index, const Param& param) {
+    MYSQL_BIND& bind = _params[index];
+    Value& value = _values[index];
+    bind = MYSQL_BIND{};
+    switch (param.type()) {
+        case Param::Type::Null:
+            bind.buffer_type = MYSQL_TYPE_NULL;
+            break;
+        case Param::Type::Bool:
+            value.tiny = param.as_bool() ? 1 : 0;
+            bind.buffer_type = MYSQL_TYPE_TINY;
+            bind.buffer = &value.tiny;
+            break;
+        case Param::Type::Int:
+            value.integer = param.as_int();
+            bind.buffer_type = MYSQL_TYPE_LONGLONG;
+            bind.buffer = &value.integer;
+            break;
+        case Param::Type::Float:
+            value.number = param.as_float();
+            bind.buffer_type = MYSQL_TYPE_DOUBLE;
+            bind.buffer = &value.number;
+            break;
+        case Param::Type::Text:
+        case Param::Type::Bytea: {
+            // The pack outlives the execution, send its bytes in place
+            auto bytes = param.as_text();
+            bind.buffer_type = param.type() == Param::Type::Text
+                                   ? MYSQL_TYPE_STRING
+                                   : MYSQL_TYPE_BLOB;
+            bind.buffer = const_cast<char*>(bytes.data());
+            bind.buffer_length = static_cast<unsigned long>(bytes.size());
+            break;
+        }
+        case Param::Type::Timestamp:
+            value.time = to_time(param.as_micros());
+            bind.buffer_type = MYSQL_TYPE_DATETIME;
+            bind.buffer = &value.time;
+            break;
+    }
+}
+
+// Rebuild result buffers from the statement's metadata
+void MySQLStatement::bind_result() {
+    _names.clear();
+    _columns.clear();
+    _results.clear();
+    _rebind = false;
+
+    MYSQL_RES* meta = mysql_stmt_result_metadata(_stmt);
+    if (meta == nullptr) {
+        if (mysql_stmt_errno(_stmt) != 0) throw error();
+        return;  // no result set
+    }
+
+    const unsigned count = mysql_num_fields(meta);
+    const MYSQL_FIELD* fields = mysql_fetch_fields(meta);
+    _names.reserve(count);
+    _columns.resize(count);
+    _results.resize(count);
+    for (unsigned col = 0; col < count; ++col) {
+        const MYSQL_FIELD& field = fields[col];
+        Column& column = _columns[col];
+        MYSQL_BIND& bind = _results[col];
+        _names.emplace_back(field.name);
+
+        bind.length = &column.length;
+        bind.is_null = &column.isNull;
+        bind.error = &column.error;
+        if (integer_type(field.type)) {
+            column.kind = Kind::Int;
+            column.isUnsigned = (field.flags & UNSIGNED_FLAG) != 0;
+            bind.buffer_type = MYSQL_TYPE_LONGLONG;
+            bind.buffer = &column.integer;
+            bind.is_unsigned = column.isUnsigned;
+        } else if (field.type == MYSQL_TYPE_FLOAT ||
+                   field.type == MYSQL_TYPE_DOUBLE) {
+            column.kind = Kind::Float;
+            bind.buffer_type = MYSQL_TYPE_DOUBLE;
+            bind.buffer = &column.number;
+        } else if (field.type == MYSQL_TYPE_DATE ||
+                   field.type == MYSQL_TYPE_DATETIME ||
+                   field.type == MYSQL_TYPE_TIMESTAMP) {
+            column.kind = Kind::Time;
+            bind.buffer_type = MYSQL_TYPE_DATETIME;
+            bind.buffer = &column.time;
+        } else {
+            // Everything else (DECIMAL, TIME, JSON, ...) arrives as text
+            column.kind = binary_type(field) ? Kind::Bytes : Kind::Text;
+            column.bytes.resize(InitialBytes);
+            bind.buffer_type = column.kind == Kind::Bytes ? MYSQL_TYPE_BLOB
+                                                          : MYSQL_TYPE_STRING;
+            bind.buffer = column.bytes.data();
+            bind.buffer_length = static_cast<unsigned long>(InitialBytes);
+        }
+    }
+    mysql_free_result(meta);
+    _rebind = true;
+}
+
+Param MySQLStatement::cell(std::size_t col) const {
+    const Column& column = _columns[col];
+    if (column.isNull) return Param();
+
+    switch (column.kind) {
+        case Kind::Int:
+            if (column.isUnsigned && column.integer < 0) {
+                // Above the int64 range, keep the digits
+                return Param(
+                    std::to_string(static_cast<std::uint64_t>(column.integer)));
+            }
+            return Param(column.integer);
+        case Kind::Float:
+            return Param(column.number);
+        case Kind::Time: {
+            const MYSQL_TIME& time = column.time;
+            if (time.month == 0 || time.day == 0) {
+                // Zero dates have no point in time, keep them as text
+                char text[32];
+                int size = std::snprintf(
+                    text, sizeof(text), "%04u-%02u-%02u %02u:%02u:%02u",
+                    time.year, time.month, time.day, time.hour, time.minute,
+                    time.second);
+                return Param(std::string_view(text, size));
+            }
+            std::int64_t seconds =
+                days_from_civil(time.year, time.month, time.day) * 86400 +
+                time.hour * 3600 + time.minute * 60 + time.second;
+            return Param(Param::Timestamp(std::chrono::microseconds(
+                seconds * 1000000 + time.second_part)));
+        }
+        case Kind::Text:
+            return Param(std::string_view(column.bytes.data(), column.length));
+        case Kind::Bytes:
+        default:
+            return Param::bytea(
+                std::string_view(column.bytes.data(), column.length));
+    }
+}
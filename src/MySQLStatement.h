@@ -0,0 +1,82 @@
+#pragma once
+
+#include <mysql.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Errors.h"
+#include "ParamPack.h"
+
+// MySQLStatement class - server-side prepared statement whose parameter
+// and result buffers are kept across executions. Rows arrive in the binary
+// protocol and are fetched unbuffered, straight off the socket.
+class MySQLStatement final {
+   public:
+    // Prepare sql on conn (throws QueryError)
+    MySQLStatement(MYSQL* conn, const std::string& sql);
+
+    MySQLStatement(const MySQLStatement&) noexcept = delete;
+    MySQLStatement& operator=(const MySQLStatement&) noexcept = delete;
+
+    ~MySQLStatement() noexcept;
+
+    // Bind params by position ('?') and execute (throws QueryError)
+    void execute(const ParamPack& params);
+
+    // Column names of the result set (empty if the statement has none)
+    const std::vector<std::string>& columns() const noexcept;
+
+    // Fetch the next row into row, false after the last one
+    bool fetch(std::vector<Param>& row);
+
+    // Discard unread rows so the statement can be executed again
+    void free_result() noexcept;
+
+    std::uint64_t affected_rows() const noexcept;
+    std::uint64_t insert_id() const noexcept;
+
+   private:
+    // bool with MySQL 8, my_bool with older clients and MariaDB
+    using Flag = std::remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+
+    enum class Kind : std::uint8_t { Int, Float, Time, Text, Bytes };
+
+    // Fetch buffer of one result column
+    struct Column {
+        Kind kind;
+        bool isUnsigned;
+        std::int64_t integer;
+        double number;
+        MYSQL_TIME time;
+        std::string bytes;  // grows when a value is truncated
+        unsigned long length;
+        Flag isNull;
+        Flag error;
+    };
+
+    // Storage of one bound parameter
+    union Value {
+        signed char tiny;
+        std::int64_t integer;
+        double number;
+        MYSQL_TIME time;
+    };
+
+    QueryError error() const;
+    void bind_param(std::size_t index, const Param& param);
+    // Rebuild result buffers from the statement's metadata
+    void bind_result();
+    Param cell(std::size_t col) const;
+
+    MYSQL_STMT* _stmt;
+    std::vector<MYSQL_BIND> _params;
+    std::vector<Value> _values;
+    std::vector<std::string> _names;
+    std::vector<Column> _columns;
+    std::vector<MYSQL_BIND> _results;
+    bool _rebind;  // result buffers moved since the last bind
+};
@@ -0,0 +1,144 @@
+#include "MySQLStream.h"
+
+#include "Errors.h"
+
+MySQLStream::iterator::iterator(MySQLStream* stream) : _stream(stream) {}
+
+const std::vector<Param>& MySQLStream::iterator::operator*() const {
+    return _stream->_row;
+}
+
+bool MySQLStream::iterator::operator==(const MySQLStream::iterator& itr) const {
+    bool atEnd = _stream == nullptr || _stream->done();
+    bool itrAtEnd = itr._stream == nullptr || itr._stream->done();
+    return atEnd == itrAtEnd;
+}
+
+bool MySQLStream::iterator::operator!=(const MySQLStream::iterator& itr) const {
+    return !(*this == itr);
+}
+
+MySQLStream::iterator& MySQLStream::iterator::operator++() {
+    _stream->advance();
+    return *this;
+}
+
+void MySQLStream::iterator::operator++(int) { _stream->advance(); }
+
+void MySQLStream::Free::operator()(MYSQL_RES* result) const noexcept {
+    mysql_free_result(result);
+}
+
+// Plain query over the text protocol
+MySQLStream::MySQLStream(MYSQL* conn, const std::string& sql)
+    : _conn(conn), _fields(nullptr), _rows(0), _started(false), _done(false) {
+    if (mysql_real_query(conn, sql.data(), sql.size()) != 0) {
+        throw QueryError("[MySQL] " + std::string(mysql_error(conn)),
+                         mysql_sqlstate(conn));
+    }
+    _result.reset(mysql_use_result(conn));
+    if (!_result) {
+        if (mysql_field_count(conn) != 0) {
+            throw QueryError("[MySQL] " + std::string(mysql_error(conn)),
+                             mysql_sqlstate(conn));
+        }
+        close();  // statement without rows
+        return;
+    }
+
+    const unsigned count = mysql_num_fields(_result.get());
+    _fields = mysql_fetch_fields(_result.get());
+    for (unsigned col = 0; col < count; ++col)
+        _names.emplace_back(_fields[col].name);
+    _row.resize(count);
+}
+
+// Prepared statement over the binary protocol
+MySQLStream::MySQLStream(MYSQL* conn, const std::string& sql,
+                         const ParamPack& params)
+    : _conn(conn), _fields(nullptr), _rows(0), _started(false), _done(false) {
+    _stmt = std::make_unique<MySQLStatement>(conn, sql);
+    _stmt->execute(params);
+    _names = _stmt->columns();
+    if (_names.empty()) close();
+}
+
+MySQLStream::~MySQLStream() {
+    try {
+        close();
+    } catch (...) {
+        // Ignore exceptions in destructor
+    }
+}
+
+MySQLStream::iterator MySQLStream::begin() {
+    if (!_started) advance();
+    return iterator(this);
+}
+MySQLStream::iterator MySQLStream::end() { return iterator(nullptr); }
+
+const std::vector<std::string>& MySQLStream::columns() const noexcept {
+    return _names;
+}
+
+// Rows handed out so far
+std::size_t MySQLStream::rows() const noexcept { return _rows; }
+
+// Whether the result is exhausted
+bool MySQLStream::done() const noexcept { return _done; }
+
+// Discard the unread rows and release the connection
+void MySQLStream::close() {
+    _done = true;
+    if (_result) {
+        // Freeing an unbuffered result reads and drops the remaining rows
+        _result.reset();
+        // Skip the results of any further statements in the query
+        while (mysql_more_results(_conn) && mysql_next_result(_conn) == 0) {
+            if (MYSQL_RES* next = mysql_use_result(_conn))
+                mysql_free_result(next);
+        }
+    }
+    if (_stmt) {
+        _stmt->free_result();
+        _stmt.reset();
+    }
+}
+
+// Move to the next row
+void MySQLStream::advance() {
+    if (_done) return;
+    _started = true;
+
+    try {
+        bool more;
+        if (_stmt) {
+            more = _stmt->fetch(_row);
+        } else {
+            MYSQL_ROW row = mysql_fetch_row(_result.get());
+            if (row == nullptr && mysql_errno(_conn) != 0) {
+                throw QueryError("[MySQL] " + std::string(mysql_error(_conn)),
+                                 mysql_sqlstate(_conn));
+            }
+            more = row != nullptr;
+            if (more) {
+                const unsigned long* lengths =
+                    mysql_fetch_lengths(_result.get());
+                for (std::size_t col = 0; col < _row.size(); ++col) {
+                    _row[col] = row[col] ? MySQLResult::decode(_fields[col],
+                                                               row[col],
+                                                               lengths[col])
+                                         : Param();
+                }
+            }
+        }
+        if (!more) {
+            close();
+            return;
+        }
+        ++_rows;
+    } catch (...) {
+        close();
+        throw;
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <mysql.h>
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "MySQLDatabase.h"
+
+// MySQLStream class - single-pass result read from the socket row by row
+// (mysql_use_result for plain queries, an unbuffered prepared statement
+// for parameterized ones), holding one row in client memory at a time
+class MySQLStream {
+   public:
+    // Plain query over the text protocol
+    MySQLStream(MYSQL* conn, const std::string& sql);
+    // Prepared statement over the binary protocol
+    MySQLStream(MYSQL* conn, const std::string& sql, const ParamPack& params);
+
+    MySQLStream(MySQLStream&&) noexcept = default;
+    MySQLStream& operator=(MySQLStream&&) noexcept = delete;
+
+    ~MySQLStream();
+
+    // Single-pass input iterator over the cells of each row
+    class iterator {
+       public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::vector<Param>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::vector<Param>*;
+        using reference = const std::vector<Param>&;
+
+        explicit iterator(MySQLStream* stream = nullptr);
+
+        const std::vector<Param>& operator*() const;
+
+        bool operator==(const iterator& itr) const;
+        bool operator!=(const iterator& itr) const;
+
+        iterator& operator++();
+        void operator++(int);
+
+       private:
+        MySQLStream* _stream;
+    };
+
+    iterator begin();
+    iterator end();
+
+    const std::vector<std::string>& columns() const noexcept;
+
+    // Rows handed out so far
+    std::size_t rows() const noexcept;
+
+    // Whether the result is exhausted
+    bool done() const noexcept;
+
+    // Discard the unread rows and release the connection
+    void close();
+
+   private:
+    struct Free {
+        void operator()(MYSQL_RES* result) const noexcept;
+    };
+
+    // Move to the next row
+    void advance();
+
+    MYSQL* _conn;
+    std::unique_ptr<MYSQL_RES, Free> _result;
+    const MYSQL_FIELD* _fields;
+    std::unique_ptr<MySQLStatement> _stmt;
+    std::vector<std::string> _names;
+    std::vector<Param> _row;
+    std::size_t _rows;
+    bool _started;
+    bool _done;
+};
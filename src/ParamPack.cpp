@@ -0,0 +1,321 @@
+#include "ParamPack.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <typeinfo>
+
+#include "Errors.h"
+
+namespace {
+
+// Civil date from days since 1970-01-01 (proleptic Gregorian)
+void civil_from_days(std::int64_t days, int& y, unsigned& m, unsigned& d) {
+    days += 719468;
+    std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = static_cast<unsigned>(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(yoe + era * 400 + (m <= 2));
+}
+
+// Convert a type-erased argument, returns false if the type is unknown
+template <typename T>
+bool convert_as(const std::any& arg, Param& param) {
+    if (arg.type() != typeid(T)) return false;
+    param = Param(std::any_cast<const T&>(arg));
+    return true;
+}
+
+Param convert(const std::any& arg) {
+    Param param;
+    if (!arg.has_value() || arg.type() == typeid(std::nullptr_t)) return param;
+
+    if (convert_as<Param>(arg, param) || convert_as<std::string>(arg, param) ||
+        convert_as<const char*>(arg, param) ||
+        convert_as<std::string_view>(arg, param) ||
+        convert_as<int>(arg, param) || convert_as<long>(arg, param) ||
+        convert_as<long long>(arg, param) ||
+        convert_as<unsigned>(arg, param) ||
+        convert_as<unsigned long>(arg, param) ||
+        convert_as<unsigned long long>(arg, param) ||
+        convert_as<short>(arg, param) || convert_as<char>(arg, param) ||
+        convert_as<double>(arg, param) ||
+        convert_as<float>(arg, param) || convert_as<bool>(arg, param) ||
+        convert_as<Param::Timestamp>(arg, param))
+        return param;
+
+    throw DatabaseError(std::string("Unsupported parameter type: ") +
+                        arg.type().name());
+}
+
+}  // namespace
+
+Param::Param() noexcept : _size(0), _type(Type::Null), _heap(false) {
+    _value.i = 0;
+}
+
+Param::Param(std::nullptr_t) noexcept : Param() {}
+
+Param::Param(bool value) noexcept : Param() {
+    _type = Type::Bool;
+    _value.b = value;
+}
+
+// One-character text
+Param::Param(char value) noexcept : Param() {
+    _type = Type::Text;
+    _size = 1;
+    _value.text[0] = value;
+    _value.text[1] = '\0';
+}
+
+Param::Param(const char* value) : Param() {
+    if (value != nullptr)
+        assign_text(value, std::strlen(value), Type::Text);
+}
+
+Param::Param(std::string_view value) : Param() {
+    assign_text(value.data(), value.size(), Type::Text);
+}
+
+Param::Param(const std::string& value) : Param() {
+    assign_text(value.data(), value.size(), Type::Text);
+}
+
+Param::Param(Timestamp value) noexcept : Param() {
+    _type = Type::Timestamp;
+    _value.i = std::chrono::duration_cast<std::chrono::microseconds>(
+                   value.time_since_epoch())
+                   .count();
+}
+
+// Binary string parameter
+Param Param::bytea(std::string_view bytes) {
+    Param param;
+    param.assign_text(bytes.data(), bytes.size(), Type::Bytea);
+    return param;
+}
+
+Param::Param(const Param& param) : Param() { *this = param; }
+
+Param& Param::operator=(const Param& param) {
+    if (this == &param) return *this;
+
+    if (param._type == Type::Text || param._type == Type::Bytea) {
+        assign_text(param.c_str(), param._size, param._type);
+        return *this;
+    }
+    release();
+    _value = param._value;
+    _size = param._size;
+    _type = param._type;
+    return *this;
+}
+
+Param::Param(Param&& param) noexcept
+    : _value(param._value),
+      _size(param._size),
+      _type(param._type),
+      _heap(param._heap) {
+    param._heap = false;
+    param._type = Type::Null;
+    param._size = 0;
+}
+
+Param& Param::operator=(Param&& param) noexcept {
+    if (this != &param) {
+        release();
+        _value = param._value;
+        _size = param._size;
+        _type = param._type;
+        _heap = param._heap;
+        param._heap = false;
+        param._type = Type::Null;
+        param._size = 0;
+    }
+    return *this;
+}
+
+Param::~Param() noexcept { release(); }
+
+Param::Type Param::type() const noexcept { return _type; }
+bool Param::is_null() const noexcept { return _type == Type::Null; }
+
+bool Param::as_bool() const noexcept { return _value.b; }
+std::int64_t Param::as_int() const noexcept { return _value.i; }
+double Param::as_float() const noexcept { return _value.f; }
+
+// Text or bytea contents
+std::string_view Param::as_text() const noexcept {
+    return std::string_view(c_str(), _size);
+}
+
+// NUL-terminated text or bytea contents
+const char* Param::c_str() const noexcept {
+    if (_type != Type::Text && _type != Type::Bytea) return "";
+    return _heap ? _value.heap : _value.text;
+}
+
+// Microseconds since the Unix epoch
+std::int64_t Param::as_micros() const noexcept { return _value.i; }
+
+Param::Timestamp Param::as_timestamp() const noexcept {
+    return Timestamp(std::chrono::duration_cast<Timestamp::duration>(
+        std::chrono::microseconds(_value.i)));
+}
+
+// Text form of the value
+std::string_view Param::to_text(char (&buffer)[TextSize]) const noexcept {
+    switch (_type) {
+        case Type::Null:
+            return std::string_view();
+        case Type::Bool:
+            return _value.b ? "true" : "false";
+        case Type::Int: {
+            auto end = std::to_chars(buffer, buffer + TextSize, _value.i).ptr;
+            return std::string_view(buffer, end - buffer);
+        }
+        case Type::Float: {
+            auto end = std::to_chars(buffer, buffer + TextSize, _value.f).ptr;
+            return std::string_view(buffer, end - buffer);
+        }
+        case Type::Text:
+        case Type::Bytea:
+            return as_text();
+        case Type::Timestamp: {
+            std::int64_t micros = _value.i;
+            std::int64_t seconds = micros / 1000000;
+            std::int64_t fraction = micros % 1000000;
+            if (fraction < 0) {
+                fraction += 1000000;
+                --seconds;
+            }
+            std::int64_t days = seconds / 86400;
+            std::int64_t rest = seconds % 86400;
+            if (rest < 0) {
+                rest += 86400;
+                --days;
+            }
+            int y;
+            unsigned m, d;
+            civil_from_days(days, y, m, d);
+            int n = std::snprintf(buffer, TextSize,
+                                  "%04d-%02u-%02u %02d:%02d:%02d.%06d+00", y,
+                                  m, d, static_cast<int>(rest / 3600),
+                                  static_cast<int>(rest / 60 % 60),
+                                  static_cast<int>(rest % 60),
+                                  static_cast<int>(fraction));
+            return std::string_view(buffer, n);
+        }
+    }
+    return std::string_view();
+}
+
+void Param::assign_text(const char* data, std::size_t size, Type type) {
+    char* target;
+    if (size < InlineSize) {
+        release();
+        target = _value.text;
+    } else {
+        target = new char[size + 1];
+        release();
+        _value.heap = target;
+        _heap = true;
+    }
+    std::memcpy(target, data, size);
+    target[size] = '\0';
+    _size = static_cast<std::uint32_t>(size);
+    _type = type;
+}
+
+// Decimal text of value, at most 20 digits so always inline
+void Param::assign_unsigned(std::uint64_t value) noexcept {
+    release();
+    auto end = std::to_chars(_value.text, _value.text + InlineSize - 1, value)
+                   .ptr;
+    *end = '\0';
+    _size = static_cast<std::uint32_t>(end - _value.text);
+    _type = Type::Text;
+}
+
+void Param::release() noexcept {
+    if (_heap) delete[] _value.heap;
+    _heap = false;
+    _size = 0;
+    _type = Type::Null;
+}
+
+ParamPack::ParamPack() noexcept : _size(0) {}
+
+ParamPack::ParamPack(std::initializer_list<Param> params) : ParamPack() {
+    for (const auto& param : params) push_back(param);
+}
+
+// Convert type-erased arguments (throws DatabaseError if unsupported)
+ParamPack::ParamPack(const std::vector<std::any>& args) : ParamPack() {
+    for (const auto& arg : args) push_back(convert(arg));
+}
+
+ParamPack::ParamPack(const ParamPack& pack) : ParamPack() { *this = pack; }
+
+ParamPack& ParamPack::operator=(const ParamPack& pack) {
+    if (this != &pack) {
+        clear();
+        for (const auto& param : pack) push_back(param);
+    }
+    return *this;
+}
+
+ParamPack::ParamPack(ParamPack&& pack) noexcept : ParamPack() {
+    *this = std::move(pack);
+}
+
+ParamPack& ParamPack::operator=(ParamPack&& pack) noexcept {
+    if (this != &pack) {
+        clear();
+        for (std::size_t i = 0; i < InlineCount; ++i)
+            _inline[i] = std::move(pack._inline[i]);
+        _overflow = std::move(pack._overflow);
+        _size = pack._size;
+        pack.clear();
+    }
+    return *this;
+}
+
+void ParamPack::push_back(Param param) {
+    if (_size < InlineCount && _overflow.empty()) {
+        _inline[_size++] = std::move(param);
+        return;
+    }
+    if (_overflow.empty()) {
+        // Spill inline values to the heap once
+        _overflow.reserve(InlineCount * 2);
+        for (auto& inlined : _inline) _overflow.push_back(std::move(inlined));
+    }
+    _overflow.push_back(std::move(param));
+    ++_size;
+}
+
+void ParamPack::clear() noexcept {
+    for (std::size_t i = 0; i < InlineCount && i < _size; ++i)
+        _inline[i] = Param();
+    _overflow.clear();
+    _size = 0;
+}
+
+std::size_t ParamPack::size() const noexcept { return _size; }
+bool ParamPack::empty() const noexcept { return _size == 0; }
+
+const Param& ParamPack::operator[](std::size_t index) const noexcept {
+    return data()[index];
+}
+const Param* ParamPack::begin() const noexcept { return data(); }
+const Param* ParamPack::end() const noexcept { return data() + _size; }
+
+const Param* ParamPack::data() const noexcept {
+    return _overflow.empty() ? _inline : _overflow.data();
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <any>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Param class - single bound query parameter. A tagged value that keeps
+// short text inline and only allocates for text longer than InlineSize - 1.
+class Param final {
+   public:
+    enum class Type : std::uint8_t {
+        Null,
+        Bool,
+        Int,
+        Float,
+        Text,
+        Bytea,
+        Timestamp
+    };
+
+    using Timestamp = std::chrono::system_clock::time_point;
+
+    // Inline text capacity including the terminating NUL
+    static constexpr std::size_t InlineSize = 23;
+    // Buffer size needed by to_text() for non-text values
+    static constexpr std::size_t TextSize = 40;
+
+    Param() noexcept;
+    Param(std::nullptr_t) noexcept;
+    Param(bool value) noexcept;
+    // One-character text
+    Param(char value) noexcept;
+    // Unsigned values above INT64_MAX are bound as decimal text
+    template <typename T,
+              std::enable_if_t<std::is_integral_v<T> &&
+                                   !std::is_same_v<T, bool> &&
+                                   !std::is_same_v<T, char>,
+                               int> = 0>
+    Param(T value) noexcept : Param() {
+        if constexpr (std::is_unsigned_v<T> &&
+                      sizeof(T) >= sizeof(std::int64_t)) {
+            if (value > static_cast<std::uint64_t>(
+                            std::numeric_limits<std::int64_t>::max())) {
+                assign_unsigned(value);
+                return;
+            }
+        }
+        _type = Type::Int;
+        _value.i = static_cast<std::int64_t>(value);
+    }
+    template <typename T,
+              std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+    Param(T value) noexcept : Param() {
+        _type = Type::Float;
+        _value.f = static_cast<double>(value);
+    }
+    Param(const char* value);
+    Param(std::string_view value);
+    Param(const std::string& value);
+    Param(Timestamp value) noexcept;
+    template <typename T>
+    Param(const std::optional<T>& value) : Param() {
+        if (value) *this = Param(*value);
+    }
+
+    // Binary string parameter
+    static Param bytea(std::string_view bytes);
+
+    Param(const Param& param);
+    Param& operator=(const Param& param);
+    Param(Param&& param) noexcept;
+    Param& operator=(Param&& param) noexcept;
+
+    ~Param() noexcept;
+
+    Type type() const noexcept;
+    bool is_null() const noexcept;
+
+    bool as_bool() const noexcept;
+    std::int64_t as_int() const noexcept;
+    double as_float() const noexcept;
+    // Text or bytea contents
+    std::string_view as_text() const noexcept;
+    // NUL-terminated text or bytea contents
+    const char* c_str() const noexcept;
+    // Microseconds since the Unix epoch
+    std::int64_t as_micros() const noexcept;
+    Timestamp as_timestamp() const noexcept;
+
+    // Text form of the value. Text and bytea return their own bytes, other
+    // types are formatted into buffer; NULL yields an empty view.
+    std::string_view to_text(char (&buffer)[TextSize]) const noexcept;
+
+   private:
+    void assign_text(const char* data, std::size_t size, Type type);
+    void assign_unsigned(std::uint64_t value) noexcept;
+    void release() noexcept;
+
+    union Storage {
+        bool b;
+        std::int64_t i;
+        double f;
+        char text[InlineSize];
+        char* heap;
+    } _value;
+    std::uint32_t _size;
+    Type _type;
+    bool _heap;
+};
+
+// ParamPack class - ordered parameter list holding up to InlineCount
+// values without touching the heap
+class ParamPack final {
+   public:
+    static constexpr std::size_t InlineCount = 8;
+
+    // Enabled when Args are plain values rather than a prepared pack
+    template <typename... Args>
+    using EnableIfValues = std::enable_if_t<
+        !std::disjunction_v<std::is_same<std::decay_t<Args>, ParamPack>...,
+                            std::is_same<std::decay_t<Args>,
+                                         std::vector<std::any>>...>>;
+
+    ParamPack() noexcept;
+    ParamPack(std::initializer_list<Param> params);
+    // Convert type-erased arguments (throws DatabaseError if unsupported)
+    explicit ParamPack(const std::vector<std::any>& args);
+
+    ParamPack(const ParamPack& pack);
+    ParamPack& operator=(const ParamPack& pack);
+    ParamPack(ParamPack&& pack) noexcept;
+    ParamPack& operator=(ParamPack&& pack) noexcept;
+
+    ~ParamPack() noexcept = default;
+
+    // Pack values in order
+    template <typename... Args>
+    static ParamPack of(Args&&... args) {
+        ParamPack pack;
+        (pack.push_back(Param(std::forward<Args>(args))), ...);
+        return pack;
+    }
+
+    void push_back(Param param);
+    void clear() noexcept;
+
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+
+    const Param& operator[](std::size_t index) const noexcept;
+    const Param* begin() const noexcept;
+    const Param* end() const noexcept;
+
+   private:
+    const Param* data() const noexcept;
+
+    Param _inline[InlineCount];
+    std::vector<Param> _overflow;  // used once more than InlineCount values
+    std::size_t _size;
+};
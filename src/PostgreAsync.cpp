@@ -0,0 +1,152 @@
+#include "PostgreAsync.h"
+
+#if defined(__linux__)
+
+#include <utility>
+
+#include "Errors.h"
+
+// Open the connection and register it with loop
+std::shared_ptr<PostgreAsyncSession> PostgreAsyncSession::open(
+    const std::string& connectionString, EventLoop& loop) {
+    std::shared_ptr<PostgreAsyncSession> session(
+        new PostgreAsyncSession(connectionString, loop));
+
+    std::weak_ptr<PostgreAsyncSession> weak = session;
+    loop.watch(session->_conn.socket(), EventLoop::Readable,
+               [weak](std::uint32_t events) {
+                   if (auto self = weak.lock()) self->on_event(events);
+               });
+    return session;
+}
+
+PostgreAsyncSession::PostgreAsyncSession(const std::string& connectionString,
+                                         EventLoop& loop)
+    : _loop(loop),
+      _conn(connectionString),
+      _running(false),
+      _writing(false),
+      _closed(false) {}
+
+PostgreAsyncSession::~PostgreAsyncSession() noexcept { close(); }
+
+// Queue query, the future yields a PostgreRawResult
+PostgreAsyncSession::Future PostgreAsyncSession::submit(
+    const std::string& sql, PostgreRawConnection::Params params) {
+    Request request{sql, std::move(params), {}};
+    auto future = request.promise.get_future();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_closed) {
+        request.promise.set_exception(std::make_exception_ptr(
+            ConnectionError("Async session is closed")));
+        return future;
+    }
+    _queue.push_back(std::move(request));
+    if (!_running) start_next();
+    return future;
+}
+
+// Queries queued or running
+std::size_t PostgreAsyncSession::in_flight() const noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+}
+
+// Cancel the running query (it completes with a QueryError)
+bool PostgreAsyncSession::cancel() noexcept { return _conn.cancel(); }
+
+// Stop watching the socket and fail everything still queued
+void PostgreAsyncSession::close() noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_closed) return;
+
+    _closed = true;
+    _loop.unwatch(_conn.socket());
+    fail_all(std::make_exception_ptr(
+        ConnectionError("Async session closed with queries in flight")));
+}
+
+// Send the query at the front of the queue (called with _mutex held)
+void PostgreAsyncSession::start_next() {
+    while (!_queue.empty()) {
+        auto& request = _queue.front();
+        try {
+            _conn.send(request.sql, request.params);
+            _running = true;
+            _last.reset();
+            _error = nullptr;
+
+            // Wait for the socket to drain if the query did not fit
+            _writing = !_conn.flush();
+            _loop.modify(_conn.socket(),
+                         EventLoop::Readable |
+                             (_writing ? EventLoop::Writable : 0u));
+            return;
+        } catch (...) {
+            request.promise.set_exception(std::current_exception());
+            _queue.pop_front();
+            _running = false;
+        }
+    }
+}
+
+void PostgreAsyncSession::on_event(std::uint32_t events) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_closed || !_running) return;
+
+    try {
+        if (_writing && (events & EventLoop::Writable)) {
+            _writing = !_conn.flush();
+            if (!_writing) _loop.modify(_conn.socket(), EventLoop::Readable);
+        }
+        if (!(events & (EventLoop::Readable | EventLoop::Failed))) return;
+        if (!_conn.consume()) return;
+
+        // Drain every result the running query produced
+        while (true) {
+            PGresult* raw = _conn.next_result();
+            if (raw == nullptr) break;
+
+            auto result = std::make_unique<PostgreRawResult>(raw);
+            try {
+                PostgreRawConnection::check(raw);
+                _last = std::move(result);
+            } catch (...) {
+                if (!_error) _error = std::current_exception();
+            }
+            if (!_conn.consume()) return;
+        }
+
+        auto request = std::move(_queue.front());
+        _queue.pop_front();
+        _running = false;
+        if (_error)
+            request.promise.set_exception(_error);
+        else
+            request.promise.set_value(std::move(_last));
+        _error = nullptr;
+
+        start_next();
+    } catch (...) {
+        // Connection-level failure, nothing queued can complete
+        _closed = true;
+        _loop.unwatch(_conn.socket());
+        fail_all(std::current_exception());
+    }
+}
+
+// Fail queued queries (called with _mutex held)
+void PostgreAsyncSession::fail_all(std::exception_ptr error) noexcept {
+    for (auto& request : _queue) {
+        try {
+            request.promise.set_exception(error);
+        } catch (...) {
+            // Promise already satisfied
+        }
+    }
+    _queue.clear();
+    _running = false;
+}
+
+#endif  // __linux__
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "EventLoop.h"
+#include "IDatabase.h"
+#include "PostgreRaw.h"
+
+// PostgreAsyncSession class - dedicated libpq connection whose queries are
+// sent without blocking and completed by an EventLoop. Queries submitted
+// while one is running are queued; use several sessions for parallelism.
+class PostgreAsyncSession final
+    : public std::enable_shared_from_this<PostgreAsyncSession> {
+   public:
+    using Future = std::future<std::unique_ptr<IResult>>;
+
+    // Open the connection and register it with loop
+    static std::shared_ptr<PostgreAsyncSession> open(
+        const std::string& connectionString, EventLoop& loop);
+
+    PostgreAsyncSession(const PostgreAsyncSession&) noexcept = delete;
+    PostgreAsyncSession& operator=(const PostgreAsyncSession&) noexcept =
+        delete;
+
+    ~PostgreAsyncSession() noexcept;
+
+    // Queue query, the future yields a PostgreRawResult
+    Future submit(const std::string& sql,
+                  PostgreRawConnection::Params params = {});
+
+    // Queries queued or running
+    std::size_t in_flight() const noexcept;
+
+    // Cancel the running query (it completes with a QueryError)
+    bool cancel() noexcept;
+
+    // Stop watching the socket and fail everything still queued
+    void close() noexcept;
+
+   private:
+    struct Request {
+        std::string sql;
+        PostgreRawConnection::Params params;
+        std::promise<std::unique_ptr<IResult>> promise;
+    };
+
+    PostgreAsyncSession(const std::string& connectionString, EventLoop& loop);
+
+    void start_next();
+    void on_event(std::uint32_t events) noexcept;
+    void fail_all(std::exception_ptr error) noexcept;
+
+    EventLoop& _loop;
+    PostgreRawConnection _conn;
+    mutable std::mutex _mutex;
+    std::deque<Request> _queue;  // front is running when _running is set
+    std::unique_ptr<PostgreRawResult> _last;
+    std::exception_ptr _error;
+    bool _running;
+    bool _writing;
+    bool _closed;
+};
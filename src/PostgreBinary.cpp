@@ -0,0 +1,145 @@
+#include "PostgreBinary.h"
+
+#include <cstring>
+
+#include "Errors.h"
+
+namespace {
+
+// PostgreSQL epoch (2000-01-01) relative to the Unix epoch
+constexpr std::int64_t EpochSeconds = 946684800;
+constexpr std::int64_t EpochDays = 10957;
+
+// Largest offset from the Unix epoch a Timestamp can hold
+constexpr std::int64_t MaxMicros =
+    std::chrono::duration_cast<std::chrono::microseconds>(
+        PostgreBinary::Timestamp::duration::max())
+        .count();
+
+// Big-endian unsigned integer of sizeof(T) bytes
+template <typename T>
+T read(const char* bytes) noexcept {
+    const auto* data = reinterpret_cast<const unsigned char*>(bytes);
+    T value = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) value = (value << 8) | data[i];
+    return value;
+}
+
+}  // namespace
+
+void PostgreBinary::decode(unsigned oid, std::string_view bytes, bool& value) {
+    if (oid != Bool || bytes.size() != 1) fail(oid, "boolean");
+    value = bytes[0] != 0;
+}
+
+void PostgreBinary::decode(unsigned oid, std::string_view bytes,
+                           double& value) {
+    if (oid == Float8 && bytes.size() == 8) {
+        std::uint64_t bits = read<std::uint64_t>(bytes.data());
+        std::memcpy(&value, &bits, sizeof(value));
+    } else if (oid == Float4 && bytes.size() == 4) {
+        float narrow;
+        decode(oid, bytes, narrow);
+        value = narrow;
+    } else {
+        value = static_cast<double>(integer(oid, bytes));
+    }
+}
+
+void PostgreBinary::decode(unsigned oid, std::string_view bytes,
+                           float& value) {
+    if (oid == Float4 && bytes.size() == 4) {
+        std::uint32_t bits = read<std::uint32_t>(bytes.data());
+        std::memcpy(&value, &bits, sizeof(value));
+    } else if (oid == Float8) {
+        double wide;
+        decode(oid, bytes, wide);
+        value = static_cast<float>(wide);
+    } else {
+        value = static_cast<float>(integer(oid, bytes));
+    }
+}
+
+void PostgreBinary::decode(unsigned oid, std::string_view bytes,
+                           std::string& value) {
+    switch (oid) {
+        case Bytea:
+        case Name:
+        case Text:
+        case Json:
+        case Unknown:
+        case Bpchar:
+        case Varchar:
+            value.assign(bytes.data(), bytes.size());
+            return;
+        case Uuid: {
+            if (bytes.size() != 16) break;
+            static constexpr char Hex[] = "0123456789abcdef";
+            value.resize(36);
+            std::size_t pos = 0;
+            for (std::size_t i = 0; i < 16; ++i) {
+                if (i == 4 || i == 6 || i == 8 || i == 10) value[pos++] = '-';
+                auto byte = static_cast<unsigned char>(bytes[i]);
+                value[pos++] = Hex[byte >> 4];
+                value[pos++] = Hex[byte & 0x0F];
+            }
+            return;
+        }
+        default:
+            break;
+    }
+    fail(oid, "string");
+}
+
+void PostgreBinary::decode(unsigned oid, std::string_view bytes,
+                           Timestamp& value) {
+    using std::chrono::duration_cast;
+
+    if ((oid == TimestampType || oid == TimestampTz) && bytes.size() == 8) {
+        auto micros = static_cast<std::int64_t>(
+            read<std::uint64_t>(bytes.data()));
+        // +-infinity are sent as the extreme 64-bit values
+        if (micros == std::numeric_limits<std::int64_t>::max()) {
+            value = Timestamp::max();
+        } else if (micros == std::numeric_limits<std::int64_t>::min()) {
+            value = Timestamp::min();
+        } else if (micros > MaxMicros - EpochSeconds * 1000000 ||
+                   micros < -MaxMicros - EpochSeconds * 1000000) {
+            fail(oid, "timestamp in clock range");
+        } else {
+            value = Timestamp(duration_cast<Timestamp::duration>(
+                std::chrono::microseconds(micros) +
+                std::chrono::seconds(EpochSeconds)));
+        }
+        return;
+    }
+    if (oid == Date && bytes.size() == 4) {
+        std::int64_t days =
+            static_cast<std::int32_t>(read<std::uint32_t>(bytes.data()));
+        std::int64_t seconds = (days + EpochDays) * 86400;
+        if (seconds > MaxMicros / 1000000 || seconds < -MaxMicros / 1000000)
+            fail(oid, "date in clock range");
+        value = Timestamp(
+            duration_cast<Timestamp::duration>(std::chrono::seconds(seconds)));
+        return;
+    }
+    fail(oid, "timestamp");
+}
+
+// int2/int4/int8/oid value widened to 64 bits
+std::int64_t PostgreBinary::integer(unsigned oid, std::string_view bytes) {
+    if (oid == Int8 && bytes.size() == 8)
+        return static_cast<std::int64_t>(read<std::uint64_t>(bytes.data()));
+    if (oid == Int4 && bytes.size() == 4)
+        return static_cast<std::int32_t>(read<std::uint32_t>(bytes.data()));
+    if (oid == Int2 && bytes.size() == 2)
+        return static_cast<std::int16_t>(read<std::uint16_t>(bytes.data()));
+    if (oid == OidType && bytes.size() == 4)
+        return read<std::uint32_t>(bytes.data());
+    fail(oid, "integer");
+}
+
+void PostgreBinary::fail(unsigned oid, const char* type) {
+    throw QueryError("Cannot decode binary column of type " +
+                     std::to_string(oid) + " as " + type);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Decoders for PostgreSQL binary wire-format values (network byte order)
+class PostgreBinary final {
+   private:
+    PostgreBinary() noexcept = delete;
+    ~PostgreBinary() noexcept = delete;
+
+   public:
+    using Timestamp = std::chrono::system_clock::time_point;
+
+    // Built-in type OIDs (see pg_type.dat)
+    enum Oid : unsigned {
+        Bool = 16,
+        Bytea = 17,
+        Name = 19,
+        Int8 = 20,
+        Int2 = 21,
+        Int4 = 23,
+        Text = 25,
+        OidType = 26,
+        Json = 114,
+        Float4 = 700,
+        Float8 = 701,
+        Unknown = 705,
+        Bpchar = 1042,
+        Varchar = 1043,
+        Date = 1082,
+        TimestampType = 1114,
+        TimestampTz = 1184,
+        Uuid = 2950
+    };
+
+    // Decode bytes of a column of type oid into value, throws QueryError if
+    // the column type cannot be represented as the requested C++ type
+    static void decode(unsigned oid, std::string_view bytes, bool& value);
+    static void decode(unsigned oid, std::string_view bytes, double& value);
+    static void decode(unsigned oid, std::string_view bytes, float& value);
+    // Text types as is, bytea as raw bytes, uuid in canonical form
+    static void decode(unsigned oid, std::string_view bytes,
+                       std::string& value);
+    static void decode(unsigned oid, std::string_view bytes,
+                       Timestamp& value);
+
+    template <typename T,
+              std::enable_if_t<std::is_integral_v<T> &&
+                                   !std::is_same_v<T, bool>,
+                               int> = 0>
+    static void decode(unsigned oid, std::string_view bytes, T& value) {
+        std::int64_t parsed = integer(oid, bytes);
+        if (parsed < static_cast<std::int64_t>(std::numeric_limits<T>::min()) ||
+            (parsed > 0 && static_cast<std::uint64_t>(parsed) >
+                               static_cast<std::uint64_t>(
+                                   std::numeric_limits<T>::max())))
+            fail(oid, "out of range integer");
+        value = static_cast<T>(parsed);
+    }
+
+    // int2/int4/int8/oid value widened to 64 bits
+    static std::int64_t integer(unsigned oid, std::string_view bytes);
+
+   private:
+    [[noreturn]] static void fail(unsigned oid, const char* type);
+};
@@ -0,0 +1,107 @@
+#include "PostgreBulkWriter.h"
+
+#include "Errors.h"
+#include "PostgreParams.h"
+
+PostgreBulkWriter::PostgreBulkWriter(pqxx::connection& conn,
+                                     const std::string& table,
+                                     const std::vector<std::string>& columns,
+                                     const PostgreBulkOptions& options)
+    : _conn(&conn),
+      _table(PostgreParams::quote_table(conn, table)),
+      _options(options),
+      _chunkRows(0),
+      _chunkBytes(0),
+      _start(std::chrono::steady_clock::now()) {
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) _columns += ',';
+        _columns += conn.quote_name(columns[i]);
+    }
+}
+
+PostgreBulkWriter::~PostgreBulkWriter() {
+    try {
+        close(false);
+    } catch (...) {
+        // Ignore exceptions in destructor
+    }
+}
+
+// Commit rows written so far
+void PostgreBulkWriter::commit() {
+    if (!_txn) return;
+
+    close(true);
+    _stats.elapsed = std::chrono::steady_clock::now() - _start;
+}
+
+// Commit remaining rows and close the writer
+PostgreBulkStats PostgreBulkWriter::finish() {
+    commit();
+    _stats.elapsed = std::chrono::steady_clock::now() - _start;
+    return _stats;
+}
+
+const PostgreBulkStats& PostgreBulkWriter::stats() const noexcept {
+    return _stats;
+}
+
+pqxx::stream_to& PostgreBulkWriter::stream() {
+    if (_stream) return *_stream;
+
+    try {
+        _txn = std::make_unique<pqxx::work>(*_conn);
+        _stream = std::make_unique<pqxx::stream_to>(
+            pqxx::stream_to::raw_table(*_txn, _table, _columns));
+    } catch (const pqxx::sql_error& e) {
+        _stream.reset();
+        _txn.reset();
+        throw QueryError(e.what(), e.sqlstate());
+    } catch (const std::exception& e) {
+        _stream.reset();
+        _txn.reset();
+        throw DatabaseError(e.what());
+    }
+    return *_stream;
+}
+
+void PostgreBulkWriter::written(std::size_t bytes) {
+    ++_chunkRows;
+    _chunkBytes += bytes;
+
+    if ((_options.commit_rows != 0 && _chunkRows >= _options.commit_rows) ||
+        (_options.commit_bytes != 0 && _chunkBytes >= _options.commit_bytes))
+        commit();
+}
+
+void PostgreBulkWriter::close(bool commit) {
+    if (!_txn) return;
+
+    auto stream = std::move(_stream);
+    auto txn = std::move(_txn);
+    std::size_t rows = _chunkRows, bytes = _chunkBytes;
+    _chunkRows = _chunkBytes = 0;
+
+    if (!commit) {
+        // Dropping an incomplete stream_to aborts the COPY with the txn
+        stream.reset();
+        try {
+            txn->abort();
+        } catch (const std::exception&) {
+            // A lost connection rolled the chunk back already
+        }
+        return;
+    }
+
+    try {
+        stream->complete();
+        txn->commit();
+    } catch (const pqxx::sql_error& e) {
+        throw QueryError(e.what(), e.sqlstate());
+    } catch (const std::exception& e) {
+        throw DatabaseError(e.what());
+    }
+    _stats.rows += rows;
+    _stats.bytes += bytes;
+    ++_stats.commits;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <pqxx/pqxx>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Errors.h"
+
+// Bulk load options
+struct PostgreBulkOptions {
+    // Commit the running COPY after this many rows (0 = no row limit)
+    std::size_t commit_rows = 100000;
+    // Commit the running COPY after roughly this many bytes (0 = no limit)
+    std::size_t commit_bytes = 64 * 1024 * 1024;
+};
+
+// Bulk load counters
+struct PostgreBulkStats {
+    std::size_t rows = 0;     // rows written
+    std::size_t bytes = 0;    // estimated payload bytes written
+    std::size_t commits = 0;  // chunks committed
+    std::chrono::steady_clock::duration elapsed{};
+
+    double rows_per_second() const noexcept {
+        auto seconds = std::chrono::duration<double>(elapsed).count();
+        return seconds > 0.0 ? static_cast<double>(rows) / seconds : 0.0;
+    }
+};
+
+// PostgreBulkWriter class - streams rows into a table with COPY FROM STDIN,
+// committing in chunks. Uncommitted rows are rolled back on destruction.
+class PostgreBulkWriter {
+   public:
+    PostgreBulkWriter(pqxx::connection& conn, const std::string& table,
+                      const std::vector<std::string>& columns,
+                      const PostgreBulkOptions& options = PostgreBulkOptions{});
+
+    PostgreBulkWriter(PostgreBulkWriter&&) noexcept = default;
+    PostgreBulkWriter& operator=(PostgreBulkWriter&&) noexcept = delete;
+
+    ~PostgreBulkWriter();
+
+    // Write one row given as values. A failing row (QueryError or
+    // DatabaseError) rolls back the uncommitted rows of its chunk.
+    template <typename... Args>
+    void write(const Args&... values) {
+        pqxx::stream_to& copy = stream();
+        try {
+            copy.write_values(values...);
+        } catch (const pqxx::sql_error& e) {
+            close(false);
+            throw QueryError(e.what(), e.sqlstate());
+        } catch (const std::exception& e) {
+            close(false);
+            throw DatabaseError(e.what());
+        }
+        written((field_size(values) + ... + sizeof...(Args)));
+    }
+
+    // Write one row given as a tuple
+    template <typename... Args>
+    void write_row(const std::tuple<Args...>& row) {
+        std::apply([this](const auto&... values) { write(values...); }, row);
+    }
+
+    // Write rows of any type, converting each with toTuple
+    template <typename Range, typename ToTuple>
+    void write_all(const Range& rows, ToTuple&& toTuple) {
+        for (const auto& row : rows) write_row(toTuple(row));
+    }
+
+    // Commit rows written so far
+    void commit();
+
+    // Commit remaining rows and close the writer
+    PostgreBulkStats finish();
+
+    const PostgreBulkStats& stats() const noexcept;
+
+   private:
+    pqxx::stream_to& stream();
+    void written(std::size_t bytes);
+    void close(bool commit);
+
+    // Estimated COPY text size of one field
+    template <typename T>
+    static std::size_t field_size(const T& value) {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            return std::string_view(value).size();
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            return sizeof(T) * 2;
+        } else if constexpr (std::is_same_v<T, std::nullptr_t>) {
+            return 2;
+        } else {
+            return 16;
+        }
+    }
+    template <typename T>
+    static std::size_t field_size(const std::optional<T>& value) {
+        return value ? field_size(*value) : 2;
+    }
+
+    pqxx::connection* _conn;
+    std::string _table;
+    std::string _columns;
+    PostgreBulkOptions _options;
+    std::unique_ptr<pqxx::work> _txn;
+    std::unique_ptr<pqxx::stream_to> _stream;
+    std::size_t _chunkRows;
+    std::size_t _chunkBytes;
+    PostgreBulkStats _stats;
+    std::chrono::steady_clock::time_point _start;
+};
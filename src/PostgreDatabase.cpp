@@ -1,44 +1,18 @@
 #include "PostgreDatabase.h"
 
 #include <iostream>
-#include <sstream>
 #include <stdexcept>
 
 #include "Errors.h"
+#include "EventLoop.h"
+#include "PostgreAsync.h"
+#include "PostgreParams.h"
+#include "PostgrePipeline.h"
+#include "PostgreStream.h"
+#include "SqlClassifier.h"
 
 PostgreRow::PostgreRow(const pqxx::row& row) : _row(row) {}
 
-// Get value by column index
-template <typename T>
-T PostgreRow::get(int col) const {
-    if (col >= _row.size()) {
-        throw std::out_of_range("Column index out of range");
-    }
-    return _row[col].as<T>();
-}
-
-// Get value by column name
-template <typename T>
-T PostgreRow::get(const std::string& colName) const {
-    return _row[colName].as<T>();
-}
-
-// Get optional value (returns nullopt if NULL)
-template <typename T>
-std::optional<T> PostgreRow::get_optional(int col) const {
-    if (col >= _row.size()) {
-        throw std::out_of_range("Column index out of range");
-    }
-    return _row[col].is_null() ? std::nullopt
-                               : std::make_optional(_row[col].as<T>());
-}
-
-template <typename T>
-std::optional<T> PostgreRow::get_optional(const std::string& colName) const {
-    auto field = _row[colName];
-    return field.is_null() ? std::nullopt : std::make_optional(field.as<T>());
-}
-
 // Check if column is NULL
 bool PostgreRow::is_null(int col) const {
     return col < _row.size() && _row[col].is_null();
@@ -86,6 +60,21 @@ PostgreResult::iterator PostgreResult::iterator::operator++(int) {
 
 PostgreResult::PostgreResult(const pqxx::result& result) : _result(result) {}
 
+// Copies share the immutable underlying result
+std::unique_ptr<IResult> PostgreResult::clone() const {
+    return std::make_unique<PostgreResult>(_result);
+}
+
+std::size_t PostgreResult::memory_usage() const noexcept {
+    // Field bytes plus libpq's per-field bookkeeping (length and pointer)
+    std::size_t bytes = sizeof(*this);
+    for (const auto& row : _result) {
+        for (const auto& field : row)
+            bytes += field.size() + 1 + sizeof(int) + sizeof(char*);
+    }
+    return bytes;
+}
+
 PostgreResult::iterator PostgreResult::begin() const {
     return PostgreResult::iterator(_result.begin());
 }
@@ -123,25 +112,54 @@ bool PostgreResult::empty() const { return _result.empty(); }
 size_t PostgreResult::columns() const { return _result.columns(); }
 size_t PostgreResult::affected_rows() const { return _result.affected_rows(); }
 
+// Bytes of field data, without per-row overhead
+size_t PostgreResult::payload_bytes() const noexcept {
+    size_t bytes = 0;
+    for (const auto& row : _result) {
+        for (const auto& field : row) bytes += field.size();
+    }
+    return bytes;
+}
+
 // Column information
 std::string PostgreResult::column_name(size_t col) const {
     return _result.column_name(col);
 }
 
-// Convert all rows to vector
-template <typename T>
-std::vector<T> PostgreResult::to_vector(
-    std::function<T(const PostgreRow&)> converter) const {
-    std::vector<T> vec;
-    vec.reserve(size());
-    for (const auto& row : *this) vec.push_back(converter(row));
+// Column number of name (throws std::out_of_range)
+size_t PostgreResult::column_index(std::string_view name) const {
+    try {
+        return static_cast<size_t>(_result.column_number(name));
+    } catch (const std::exception&) {
+        throw std::out_of_range("Unknown column " + std::string(name));
+    }
+}
+
+// Field view pointing into the result (unchecked)
+PostgreFieldView PostgreResult::field(size_t row, size_t col) const {
+    const pqxx::field field = _result[static_cast<pqxx::result::size_type>(
+        row)][static_cast<pqxx::row::size_type>(col)];
+    return PostgreFieldView(field.c_str(), field.size(), field.is_null());
+}
+
+// Rows as views, without PostgreRow objects or string copies
+PostgreRowRange<PostgreResult> PostgreResult::rows() const noexcept {
+    return PostgreRowRange<PostgreResult>(*this);
+}
 
-    return vec;
+// Copy into one arena that outlives the connection
+PostgreDetachedResult PostgreResult::detach() const {
+    return PostgreDetachedResult(_result);
 }
 
 PostgreTransaction::PostgreTransaction(pqxx::connection& conn)
     : _txn(std::make_unique<pqxx::work>(conn)), _committed(false) {}
 
+// Takes over a transaction of any kind (read-only, nontransaction, ...)
+PostgreTransaction::PostgreTransaction(
+    std::unique_ptr<pqxx::transaction_base> txn)
+    : _txn(std::move(txn)), _committed(false) {}
+
 PostgreTransaction::~PostgreTransaction() {
     if (!_committed) {
         try {
@@ -157,46 +175,36 @@ PostgreResult PostgreTransaction::exec(const std::string& sql) {
     try {
         return PostgreResult(_txn->exec(sql));
     } catch (const pqxx::sql_error& e) {
-        throw QueryError(e.what());
+        throw QueryError(e.what(), e.sqlstate());
     } catch (const std::exception& e) {
         throw DatabaseError(e.what());
     }
 }
 
 // Execute parameterized query
-template <typename... Args>
-PostgreResult PostgreTransaction::exec_params(
-    const std::string& sql, const std::vector<std::any>& args) {
-    if (args.size() != sizeof...(Args))
-        throw DatabaseError("Argument count mismatch");
+PostgreResult PostgreTransaction::exec_params(const std::string& sql,
+                                              const ParamPack& params) {
+    PostgreParams::Bound bound(params);
+    return exec_params(sql, bound.get());
+}
 
+PostgreResult PostgreTransaction::exec_params(const std::string& sql,
+                                              const pqxx::params& params) {
     try {
-        return PostgreResult(
-            _txn->exec_params(sql, std::any_cast<Args>(args[0])...));
+        return PostgreResult(_txn->exec_params(sql, params));
     } catch (const pqxx::sql_error& e) {
-        throw QueryError(e.what());
+        throw QueryError(e.what(), e.sqlstate());
     } catch (const std::exception& e) {
         throw DatabaseError(e.what());
     }
 }
 
-// Execute parameterized query
-template <typename... Args>
-PostgreResult PostgreTransaction::exec_params(const std::string& sql,
-                                              Args&&... args) {
-    std::vector<std::any> packed{std::forward<Args>(args)...};
-    return exec_params(sql, packed);
-}
-
-// Execute prepared statement
-template <typename... Args>
 PostgreResult PostgreTransaction::exec_prepared(const std::string& name,
-                                                Args&&... args) {
+                                                const pqxx::params& params) {
     try {
-        return PostgreResult(
-            _txn->exec_prepared(name, std::forward<Args>(args)...));
+        return PostgreResult(_txn->exec_prepared(name, params));
     } catch (const pqxx::sql_error& e) {
-        throw QueryError(e.what());
+        throw QueryError(e.what(), e.sqlstate());
     } catch (const std::exception& e) {
         throw DatabaseError(e.what());
     }
@@ -207,9 +215,11 @@ void PostgreTransaction::commit() {
     if (_committed) {
         throw std::runtime_error("Transaction already committed");
     }
+    const auto start = Metrics::start();
     try {
         _txn->commit();
         _committed = true;
+        Metrics::record(MetricsPhase::Commit, start);
     } catch (const std::exception& e) {
         throw DatabaseError(e.what());
     }
@@ -234,25 +244,50 @@ std::string PostgreTransaction::quote_name(const std::string& name) {
 
 // Constructor with connection string
 PostgreDatabase::PostgreDatabase(const std::string& connectionString) noexcept
-    : _connectionString(connectionString) {}
+    : _connectionString(connectionString),
+      _execMode(PostgreExecMode::Transaction),
+      _inSession(false) {}
 
 PostgreDatabase::PostgreDatabase(const std::string& host, int port,
                                  const std::string& database,
                                  const std::string& username,
-                                 const std::string& password) noexcept {
-    std::ostringstream oss;
-    oss << "host=" << host << " port=" << (port == 0 ? 5432 : port)
-        << " dbname=" << database << " user=" << username
-        << " password=" << password;
-    _connectionString = oss.str();
-}
+                                 const std::string& password) noexcept
+    : _connectionString(connection_string(host, port == 0 ? 5432 : port,
+                                          database, username, password)),
+      _execMode(PostgreExecMode::Transaction),
+      _inSession(false) {}
 
 PostgreDatabase::PostgreDatabase(const std::string& host, int port,
-                                 const std::string& database) noexcept {
-    std::ostringstream oss;
-    oss << "host=" << host << " port=" << (port == 0 ? 5432 : port)
-        << " dbname=" << database;
-    _connectionString = oss.str();
+                                 const std::string& database) noexcept
+    : _connectionString(
+          connection_string(host, port == 0 ? 5432 : port, database)),
+      _execMode(PostgreExecMode::Transaction),
+      _inSession(false) {}
+
+// libpq connection string with every value quoted
+std::string PostgreDatabase::connection_string(const std::string& host,
+                                               int port,
+                                               const std::string& database,
+                                               const std::string& username,
+                                               const std::string& password) {
+    std::string result;
+    auto add = [&result](const char* key, const std::string& value) {
+        if (value.empty()) return;
+        if (!result.empty()) result += ' ';
+        result += key;
+        result += "='";
+        for (char c : value) {
+            if (c == '\\' || c == '\'') result += '\\';
+            result += c;
+        }
+        result += '\'';
+    };
+    add("host", host);
+    add("port", port == 0 ? std::string() : std::to_string(port));
+    add("dbname", database);
+    add("user", username);
+    add("password", password);
+    return result;
 }
 
 // Get connection info
@@ -281,13 +316,29 @@ void PostgreDatabase::connect() {
 
     try {
         std::cout << "[Postgre] Connecting to " << _connectionString << "\n";
+        const auto start = Metrics::start();
         _conn = std::make_unique<pqxx::connection>(_connectionString);
+        Metrics::record(MetricsPhase::Connect, start);
+        // Server-side statements of any previous session are gone
+        _statements.clear();
         std::cout << "[Postgre] Successfully connected\n";
     } catch (const std::exception& e) {
         throw ConnectionError(e.what());
     }
 }
 
+// Cancel the running statement with PQcancel
+bool PostgreDatabase::cancel() {
+    if (!connected()) return false;
+
+    try {
+        _conn->cancel_query();
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
 void PostgreDatabase::disconnect() {
     if (!connected()) {
         std::cout << "[Postgre] Already disconnected\n";
@@ -297,6 +348,14 @@ void PostgreDatabase::disconnect() {
     if (_conn) {
         _conn.reset();  // _conn->close();
     }
+    _statements.clear();
+    _binary.reset();
+    _binarySql.clear();
+    {
+        std::lock_guard<std::mutex> lock(_sessionMutex);
+        if (_async) _async->close();
+        _async.reset();
+    }
     std::cout << "[Postgre] Successfully disconnected\n";
 }
 
@@ -309,101 +368,326 @@ PostgreTransaction PostgreDatabase::begin_transaction() {
     return PostgreTransaction(*_conn);
 }
 
-// Execute query without transaction (auto-commit)
+// Create read-only transaction for a batch of reads
+PostgreTransaction PostgreDatabase::begin_read_transaction(bool deferrable) {
+    if (!connected()) {
+        throw ConnectionError("Connection is not open");
+    }
+
+    if (!deferrable) {
+        return PostgreTransaction(
+            std::make_unique<pqxx::read_transaction>(*_conn));
+    }
+    using Serializable = pqxx::transaction<pqxx::isolation_level::serializable,
+                                           pqxx::write_policy::read_only>;
+    std::unique_ptr<pqxx::transaction_base> txn;
+    try {
+        txn = std::make_unique<Serializable>(*_conn);
+        txn->exec("SET TRANSACTION DEFERRABLE");
+    } catch (const pqxx::sql_error& e) {
+        throw QueryError(e.what(), e.sqlstate());
+    } catch (const std::exception& e) {
+        throw DatabaseError(e.what());
+    }
+    return PostgreTransaction(std::move(txn));
+}
+
+// Create pipelined transaction sending queries in bursts of depth
+PostgrePipeline PostgreDatabase::begin_pipeline(std::size_t depth) {
+    if (!connected()) {
+        throw ConnectionError("Connection is not open");
+    }
+
+    return PostgrePipeline(*_conn, depth);
+}
+
+// Execute query as a statement of its own under exec_mode()
 std::unique_ptr<IResult> PostgreDatabase::exec(const std::string& sql) {
+    return std::make_unique<PostgreResult>(query(sql));
+}
+
+// Execute parameterized query under exec_mode()
+std::unique_ptr<IResult> PostgreDatabase::exec_params(
+    const std::string& sql, const ParamPack& params) {
+    return std::make_unique<PostgreResult>(query_params(sql, params));
+}
+
+// Same as exec and exec_params, returning the result by value
+PostgreResult PostgreDatabase::query(const std::string& sql) {
     if (!connected()) {
         throw ConnectionError("[Postgre] Database not connected");
     }
 
+    const auto start = Metrics::start();
     try {
-        auto txn = begin_transaction();
+        auto txn = begin_statement(sql);
         auto result = txn.exec(sql);
         txn.commit();
-        return std::make_unique<PostgreResult>(result);
+        record(sql, start, &result);
+        return result;
+    } catch (const DatabaseError&) {
+        record(sql, start, nullptr);
+        throw;
     } catch (const std::exception& e) {
+        record(sql, start, nullptr);
         throw QueryError(e.what());
     }
-    return nullptr;
 }
 
-// Execute parameterized query without transaction
-std::unique_ptr<IResult> PostgreDatabase::exec_params(
-    const std::string& sql, const std::vector<std::any>& args) {
+PostgreResult PostgreDatabase::query_params(const std::string& sql,
+                                            const ParamPack& params) {
+    PostgreParams::Bound bound(params);
+    return exec_cached(
+        sql,
+        [&](PostgreTransaction& txn, const std::string& name) {
+            return txn.exec_prepared(name, bound.get());
+        },
+        [&](PostgreTransaction& txn) {
+            return txn.exec_params(sql, bound.get());
+        });
+}
+
+// Execute query without blocking
+std::future<std::unique_ptr<IResult>> PostgreDatabase::exec_async(
+    const std::string& sql) {
+#if defined(__linux__)
+    return async_session()->submit(sql);
+#else
+    return IDatabase::exec_async(sql);
+#endif
+}
+
+std::future<std::unique_ptr<IResult>> PostgreDatabase::exec_params_async(
+    const std::string& sql, const ParamPack& params) {
+#if defined(__linux__)
+    return async_session()->submit(sql, PostgreParams::text(params));
+#else
+    return IDatabase::exec_params_async(sql, params);
+#endif
+}
+
+// Stream a large result through a server-side cursor
+PostgreStream PostgreDatabase::stream(const std::string& sql,
+                                      std::size_t fetchSize) {
     if (!connected()) {
         throw ConnectionError("[Postgre] Database not connected");
     }
 
+    return PostgreStream(*_conn, sql, ParamPack(), fetchSize);
+}
+
+PostgreStream PostgreDatabase::stream_params(const std::string& sql,
+                                             const ParamPack& params,
+                                             std::size_t fetchSize) {
+    if (!connected()) {
+        throw ConnectionError("[Postgre] Database not connected");
+    }
+
+    // The DECLARE binds the values like exec_params
+    return PostgreStream(*_conn, sql, params, fetchSize);
+}
+
+// Execute parameterized query asking for binary wire-format results
+std::unique_ptr<PostgreRawResult> PostgreDatabase::exec_binary(
+    const std::string& sql, const ParamPack& params) {
+    auto& conn = binary_connection();
+    const auto start = Metrics::start();
     try {
-        auto txn = begin_transaction();
-        // txn.exec_params must also support vector<any>
-        auto result = txn.exec_params(sql, args);
-        txn.commit();
-        return std::make_unique<PostgreResult>(result);
-    } catch (const std::exception& e) {
-        throw QueryError(e.what());
+        auto result = conn.exec(sql, PostgreParams::text(params), 1);
+        Metrics::record(sql, start, result->size(), result->memory_usage());
+        return result;
+    } catch (...) {
+        Metrics::record(sql, start, 0, 0, true);
+        throw;
     }
-    return nullptr;
 }
 
-// Execute parameterized query without transaction
-template <typename... Args>
-std::unique_ptr<IResult> PostgreDatabase::exec_params(const std::string& sql,
-                                                      Args&&... args) {
-    std::vector<std::any> packed{std::forward<Args>(args)...};
-    return exec_params(sql, packed);
+// Prepare a statement on the connection used by exec_binary
+void PostgreDatabase::prepare_binary(const std::string& name,
+                                     const std::string& sql) {
+    binary_connection().prepare(name, sql);
+    _binarySql[name] = sql;
+}
+
+// Execute a statement from prepare_binary with binary results
+std::unique_ptr<PostgreRawResult> PostgreDatabase::exec_prepared_binary(
+    const std::string& name, const ParamPack& params) {
+    auto& conn = binary_connection();
+    auto itr = _binarySql.find(name);
+    const std::string& sql = itr != _binarySql.end() ? itr->second : name;
+    const auto start = Metrics::start();
+    try {
+        auto result = conn.exec_prepared(name, PostgreParams::text(params), 1);
+        Metrics::record(sql, start, result->size(), result->memory_usage());
+        return result;
+    } catch (...) {
+        Metrics::record(sql, start, 0, 0, true);
+        throw;
+    }
+}
+
+// Count a statement started at start in Metrics (result nullptr if it
+// failed)
+void PostgreDatabase::record(const std::string& sql,
+                             Metrics::Clock::time_point start,
+                             const PostgreResult* result) noexcept {
+    if (start == Metrics::Clock::time_point()) return;
+    if (result == nullptr) {
+        Metrics::record(sql, start, 0, 0, true);
+    } else {
+        Metrics::record(sql, start, result->size(), result->payload_bytes());
+    }
+}
+
+// How single statements are run (default Transaction)
+PostgreExecMode PostgreDatabase::exec_mode() const noexcept {
+    return _execMode;
+}
+
+void PostgreDatabase::exec_mode(PostgreExecMode mode) noexcept {
+    _execMode = mode;
+    _inSession = false;
+}
+
+// Transaction for running sql on its own under the exec mode
+PostgreTransaction PostgreDatabase::begin_statement(const std::string& sql) {
+    bool autocommit = _execMode == PostgreExecMode::NonTransaction;
+    if (_execMode != PostgreExecMode::Transaction) {
+        // Multi-statement strings, DO blocks and the like keep their
+        // transaction; inside a session transaction started through exec
+        // everything must go straight to the server. The session is
+        // tracked in both modes for the binary API.
+        auto statement = SqlClassifier::classify(sql);
+        if (_execMode == PostgreExecMode::Auto)
+            autocommit = _inSession || statement.kind != SqlKind::Other;
+        if (statement.transaction == SqlTransaction::Begin)
+            _inSession = true;
+        else if (statement.transaction == SqlTransaction::End)
+            _inSession = false;
+    }
+    if (!autocommit) return begin_transaction();
+
+    if (!connected()) {
+        throw ConnectionError("Connection is not open");
+    }
+    return PostgreTransaction(std::make_unique<pqxx::nontransaction>(*_conn));
+}
+
+// Lazily opened connection serving the binary-format API
+PostgreRawConnection& PostgreDatabase::binary_connection() {
+    if (!connected()) {
+        throw ConnectionError("[Postgre] Database not connected");
+    }
+
+    // Its own session cannot see a transaction open on _conn. libpqxx
+    // refuses a second transaction on the connection, so opening one
+    // (which sends nothing) tells whether a transaction, pipeline, stream
+    // or bulk writer is open.
+    if (_inSession) {
+        throw DatabaseError(
+            "[Postgre] Binary API used inside a transaction begun through "
+            "exec; it runs on a separate connection");
+    }
+    try {
+        pqxx::nontransaction probe(*_conn);
+    } catch (const pqxx::usage_error&) {
+        throw DatabaseError(
+            "[Postgre] Binary API used while a transaction is open on the "
+            "connection; it runs on a separate connection");
+    }
+
+    if (!_binary || !_binary->connected()) {
+        _binary.reset();
+        _binarySql.clear();
+        _binary = std::make_unique<PostgreRawConnection>(_connectionString);
+    }
+    return *_binary;
+}
+
+#if defined(__linux__)
+// Lazily opened connection serving the async API
+std::shared_ptr<PostgreAsyncSession> PostgreDatabase::async_session() {
+    if (!connected()) {
+        throw ConnectionError("[Postgre] Database not connected");
+    }
+
+    std::lock_guard<std::mutex> lock(_sessionMutex);
+    if (!_async) {
+        _async = PostgreAsyncSession::open(_connectionString,
+                                           EventLoop::shared());
+    }
+    return _async;
+}
+#endif  // __linux__
+
+// Prepared statement cache used by exec_params (capacity 0 disables)
+void PostgreDatabase::statement_cache(std::size_t capacity,
+                                      std::size_t prepareThreshold) {
+    _statements.configure(_conn.get(), capacity, prepareThreshold);
+}
+
+const PostgreStatementStats& PostgreDatabase::statement_stats()
+    const noexcept {
+    return _statements.stats();
 }
 
 // Check if table exists
 bool PostgreDatabase::table_exists(const std::string& tableName) {
-    auto result = exec_params(
+    auto result = query_params(
         "SELECT EXISTS (SELECT FROM information_schema.tables WHERE "
         "table_name "
         "= $1)",
         tableName);
 
-    auto pgResult = dynamic_cast<PostgreResult*>(result.get());
-    return pgResult->front().get<bool>(0);
+    return result.front().get<bool>(0);
 }
 
 // Get table column names
 std::vector<std::string> PostgreDatabase::get_columns(
     const std::string& tableName) {
-    auto result = exec_params(
+    auto result = query_params(
         "SELECT column_name FROM information_schema.columns WHERE "
         "table_name = "
         "$1 ORDER BY ordinal_position",
         tableName);
 
-    auto pgResult = dynamic_cast<PostgreResult*>(result.get());
-
     std::vector<std::string> columns;
-    for (const auto& row : *pgResult)
+    for (const auto& row : result)
         columns.push_back(row.get<std::string>(0));
 
     return columns;
 }
 
-// Simple insert helper
-template <typename... Args>
-void PostgreDatabase::insert(const std::string& table,
-                             const std::vector<std::string>& columns,
-                             Args&&... values) {
-    if (sizeof...(values) != columns.size())
-        throw std::invalid_argument(
-            "Number of values doesn't match number of columns");
-
-    std::ostringstream oss;
-    oss << "INSERT INTO " << table << " (";
-    for (std::size_t i = 0; i < columns.size(); ++i) {
-        if (i > 0) oss << ", ";
-        oss << columns[i];
+// COPY-based bulk loader, prefer over insert() for many rows
+PostgreBulkWriter PostgreDatabase::bulk_writer(
+    const std::string& table, const std::vector<std::string>& columns,
+    const PostgreBulkOptions& options) {
+    if (!connected()) {
+        throw ConnectionError("Connection is not open");
     }
-    oss << ") VALUES (";
-    for (std::size_t i = 0; i < columns.size(); ++i) {
-        if (i > 0) oss << ", ";
-        oss << "$" << (i + 1);
+
+    return PostgreBulkWriter(*_conn, table, columns, options);
+}
+
+// Set-based insert-or-update binding each column as one array
+PostgreUpsert PostgreDatabase::upsert_writer(
+    const std::string& table, const std::vector<std::string>& columns,
+    const std::vector<std::string>& keyColumns,
+    const PostgreUpsertOptions& options) {
+    if (!connected()) {
+        throw ConnectionError("Connection is not open");
     }
-    oss << ")";
 
-    exec_params(oss.str(), std::forward<Args>(values)...);
+    return PostgreUpsert(*_conn, table, columns, keyColumns, options);
+}
+
+// Upsert rows (one value per column) in chunks
+PostgreUpsertStats PostgreDatabase::bulk_upsert(
+    const std::string& table, const std::vector<std::string>& columns,
+    const std::vector<std::string>& keyColumns,
+    const std::vector<ParamPack>& rows, const PostgreUpsertOptions& options) {
+    auto upsert = upsert_writer(table, columns, keyColumns, options);
+    for (const auto& row : rows) upsert.write_params(row);
+    return upsert.finish();
 }
+
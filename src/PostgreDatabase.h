@@ -1,15 +1,42 @@
 #pragma once
 
+#include <array>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <pqxx/pqxx>
-
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include "ColumnDecoder.h"
+#include "Errors.h"
 #include "IDatabase.h"
+#include "Metrics.h"
+#include "PostgreBulkWriter.h"
+#include "PostgreDetachedResult.h"
+#include "PostgreRaw.h"
+#include "PostgreStatementCache.h"
+#include "PostgreUpsert.h"
+#include "PostgreView.h"
+#include "RowMap.h"
+
+// How exec, exec_params, query and query_params run a statement
+enum class PostgreExecMode {
+    Transaction,     // inside its own BEGIN ... COMMIT (pqxx::work)
+    NonTransaction,  // autocommit, one round trip (pqxx::nontransaction)
+    Auto  // autocommit, except for statements SqlClassifier cannot place
+};
 
 // Forward declarations
 class PostgreRow;
 class PostgreResult;
 class PostgreTransaction;
+class PostgrePipeline;
+class PostgreStream;
+class PostgreAsyncSession;
 class PostgreDatabase;
 
 // PostgreRow class - represents a single row from query results
@@ -54,6 +81,10 @@ class PostgreResult : public IResult {
 
     ~PostgreResult() noexcept = default;
 
+    // Copies share the immutable underlying result
+    std::unique_ptr<IResult> clone() const override;
+    std::size_t memory_usage() const noexcept override;
+
     // Iterator support
     class iterator {
        public:
@@ -90,16 +121,59 @@ class PostgreResult : public IResult {
     bool empty() const;
     size_t columns() const;
     size_t affected_rows() const;
+    // Bytes of field data, without per-row overhead
+    size_t payload_bytes() const noexcept;
 
     // Column information
     std::string column_name(size_t col) const;
+    // Column number of name (throws std::out_of_range)
+    size_t column_index(std::string_view name) const;
+
+    // Field view pointing into the result (unchecked). Each call goes
+    // through a libpqxx row, so to_structs and to_column take one per row.
+    PostgreFieldView field(size_t row, size_t col) const;
+
+    // Rows as views, without PostgreRow objects or string copies
+    PostgreRowRange<PostgreResult> rows() const noexcept;
+
+    // Copy into one arena that outlives the connection
+    PostgreDetachedResult detach() const;
 
     // Convert all rows to vector
     template <typename T>
     std::vector<T> to_vector(
         std::function<T(const PostgreRow&)> converter) const;
 
+    // Decode one column into a contiguous typed array with a null bitmap
+    template <typename T>
+    Column<T> to_column(size_t col) const;
+
+    // Decode the leading sizeof...(T) columns, one pass per column
+    // (struct-of-arrays instead of row objects)
+    template <typename... T>
+    std::tuple<Column<T>...> to_columns() const;
+
+    // Decode every row into a Struct through map, resolving its column
+    // names once (throws std::out_of_range for a missing column and
+    // QueryError for NULL in a member that is not std::optional)
+    template <typename Struct, typename... T>
+    std::vector<Struct> to_structs(const RowMap<Struct, T...>& map) const;
+
    private:
+    template <typename... T, std::size_t... Col>
+    std::tuple<Column<T>...> to_columns(std::index_sequence<Col...>) const;
+
+    template <typename Struct, typename... T, std::size_t... I>
+    std::vector<Struct> to_structs(const RowMap<Struct, T...>& map,
+                                   std::index_sequence<I...>) const;
+
+    // Decode field into value; NULL throws QueryError naming the column
+    template <typename T>
+    static void decode(const pqxx::field& field, T& value);
+
+    template <typename T>
+    static void decode(const pqxx::field& field, std::optional<T>& value);
+
     pqxx::result _result;
 };
 
@@ -108,24 +182,31 @@ class PostgreTransaction {
    public:
     explicit PostgreTransaction(pqxx::connection& conn);
 
+    // Takes over a transaction of any kind (read-only, nontransaction, ...)
+    explicit PostgreTransaction(std::unique_ptr<pqxx::transaction_base> txn);
+
     ~PostgreTransaction();
 
     // Execute query
     PostgreResult exec(const std::string& sql);
 
     // Execute parameterized query
-    template <typename... Args>
+    PostgreResult exec_params(const std::string& sql, const ParamPack& params);
+
     PostgreResult exec_params(const std::string& sql,
-                              const std::vector<std::any>& args);
+                              const pqxx::params& params);
 
-    // Execute parameterized query
-    template <typename... Args>
+    // Execute parameterized query, binding values directly to libpqxx
+    template <typename... Args, typename = ParamPack::EnableIfValues<Args...>>
     PostgreResult exec_params(const std::string& sql, Args&&... args);
 
     // Execute prepared statement
     template <typename... Args>
     PostgreResult exec_prepared(const std::string& name, Args&&... args);
 
+    PostgreResult exec_prepared(const std::string& name,
+                                const pqxx::params& params);
+
     // Commit transaction
     void commit();
 
@@ -138,7 +219,7 @@ class PostgreTransaction {
     std::string quote_name(const std::string& name);
 
    private:
-    std::unique_ptr<pqxx::work> _txn;
+    std::unique_ptr<pqxx::transaction_base> _txn;
     bool _committed;
 };
 
@@ -153,6 +234,13 @@ class PostgreDatabase : public IDatabase {
     PostgreDatabase(const std::string& host, int port = 5432,
                     const std::string& database = "postgres") noexcept;
 
+    // libpq connection string with every value quoted; empty values and
+    // port 0 are left out, so libpq uses its defaults
+    static std::string connection_string(const std::string& host, int port,
+                                         const std::string& database,
+                                         const std::string& username = "",
+                                         const std::string& password = "");
+
     // Get connection info
     std::string port() const noexcept;
     std::string hostname() const noexcept;
@@ -167,21 +255,89 @@ class PostgreDatabase : public IDatabase {
 
     void disconnect() override;
 
+    // Cancel the running statement with PQcancel (fails with SQLSTATE
+    // 57014); harmless when the connection is idle
+    bool cancel() override;
+
     // Create transaction
     PostgreTransaction begin_transaction();
 
-    // Execute query without transaction (auto-commit)
+    // Create read-only transaction for a batch of reads. A deferrable one
+    // is SERIALIZABLE READ ONLY DEFERRABLE: it may wait once for a safe
+    // snapshot, then never fails on serialization or takes predicate locks.
+    PostgreTransaction begin_read_transaction(bool deferrable = false);
+
+    // Create pipelined transaction sending queries in bursts of depth
+    PostgrePipeline begin_pipeline(std::size_t depth = 16);
+
+    // Execute query as a statement of its own under exec_mode() (by
+    // default inside its own transaction)
     std::unique_ptr<IResult> exec(const std::string& sql) override;
 
-    // Execute parameterized query without transaction
-    std::unique_ptr<IResult> exec_params(
-        const std::string& sql, const std::vector<std::any>& args) override;
+    using IDatabase::exec_params;
+    using IDatabase::exec_params_async;
 
-    // Execute parameterized query without transaction
-    template <typename... Args>
+    // Execute parameterized query under exec_mode()
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         const ParamPack& params) override;
+
+    // Execute parameterized query under exec_mode(), binding values
+    // directly to libpqxx
+    template <typename... Args, typename = ParamPack::EnableIfValues<Args...>>
     std::unique_ptr<IResult> exec_params(const std::string& sql,
                                          Args&&... args);
 
+    // Same as exec and exec_params, returning the result by value
+    PostgreResult query(const std::string& sql);
+    PostgreResult query_params(const std::string& sql,
+                               const ParamPack& params);
+    template <typename... Args, typename = ParamPack::EnableIfValues<Args...>>
+    PostgreResult query_params(const std::string& sql, Args&&... args);
+
+    // Execute query without blocking; results are PostgreRawResult and are
+    // completed by the shared EventLoop on a dedicated libpq connection
+    std::future<std::unique_ptr<IResult>> exec_async(
+        const std::string& sql) override;
+
+    std::future<std::unique_ptr<IResult>> exec_params_async(
+        const std::string& sql, const ParamPack& params) override;
+
+    // Execute parameterized query asking for binary wire-format results,
+    // decoded by PostgreRawResult::get<T>/to_columns<T...> without text
+    // parsing. Runs on a separate libpq connection, so it throws
+    // DatabaseError while a transaction, pipeline, stream or bulk writer
+    // is open on this database or exec began a transaction, and does not
+    // see session state (SET, temporary tables) set through exec.
+    std::unique_ptr<PostgreRawResult> exec_binary(const std::string& sql,
+                                                  const ParamPack& params = {});
+
+    template <typename... Args, typename = ParamPack::EnableIfValues<Args...>>
+    std::unique_ptr<PostgreRawResult> exec_binary(const std::string& sql,
+                                                  Args&&... args) {
+        return exec_binary(sql, ParamPack::of(std::forward<Args>(args)...));
+    }
+
+    // Prepare a statement on the connection used by exec_binary
+    void prepare_binary(const std::string& name, const std::string& sql);
+
+    // Execute a statement from prepare_binary with binary results
+    std::unique_ptr<PostgreRawResult> exec_prepared_binary(
+        const std::string& name, const ParamPack& params = {});
+
+    // Stream a large result through a server-side cursor, fetching
+    // fetchSize rows per round trip
+    PostgreStream stream(const std::string& sql, std::size_t fetchSize = 1000);
+
+    PostgreStream stream_params(const std::string& sql,
+                                const ParamPack& params,
+                                std::size_t fetchSize = 1000);
+
+    // Prepared statement cache used by exec_params (capacity 0 disables)
+    void statement_cache(std::size_t capacity,
+                         std::size_t prepareThreshold = 1);
+
+    const PostgreStatementStats& statement_stats() const noexcept;
+
     // Utility methods for common operations
 
     // Check if table exists
@@ -190,12 +346,321 @@ class PostgreDatabase : public IDatabase {
     // Get table column names
     std::vector<std::string> get_columns(const std::string& tableName);
 
+    // COPY-based bulk loader, prefer over insert() for many rows
+    PostgreBulkWriter bulk_writer(
+        const std::string& table, const std::vector<std::string>& columns,
+        const PostgreBulkOptions& options = PostgreBulkOptions{});
+
+    // Set-based insert-or-update binding each column as one array, prefer
+    // over many single-row upserts
+    PostgreUpsert upsert_writer(
+        const std::string& table, const std::vector<std::string>& columns,
+        const std::vector<std::string>& keyColumns,
+        const PostgreUpsertOptions& options = PostgreUpsertOptions{});
+
+    // Upsert rows (one value per column) in chunks
+    PostgreUpsertStats bulk_upsert(
+        const std::string& table, const std::vector<std::string>& columns,
+        const std::vector<std::string>& keyColumns,
+        const std::vector<ParamPack>& rows,
+        const PostgreUpsertOptions& options = PostgreUpsertOptions{});
+
+    template <typename... Args>
+    PostgreUpsertStats bulk_upsert(
+        const std::string& table, const std::vector<std::string>& columns,
+        const std::vector<std::string>& keyColumns,
+        const std::vector<std::tuple<Args...>>& rows,
+        const PostgreUpsertOptions& options = PostgreUpsertOptions{});
+
     // Simple insert helper
     template <typename... Args>
     void insert(const std::string& table,
                 const std::vector<std::string>& columns, Args&&... values);
 
+    // How single statements are run (default Transaction)
+    PostgreExecMode exec_mode() const noexcept;
+    void exec_mode(PostgreExecMode mode) noexcept;
+
    private:
+    // Transaction for running sql on its own under the exec mode
+    PostgreTransaction begin_statement(const std::string& sql);
+
+    // Run through a cached prepared statement when available, falling back
+    // to plain SQL text once if its plan went stale
+    template <typename Prepared, typename Plain>
+    PostgreResult exec_cached(const std::string& sql, Prepared&& prepared,
+                              Plain&& plain);
+
+    // Count a statement started at start in Metrics (result nullptr if it
+    // failed)
+    static void record(const std::string& sql, Metrics::Clock::time_point start,
+                       const PostgreResult* result) noexcept;
+
+    // Lazily opened connection serving the binary-format API (throws
+    // DatabaseError while a transaction is open on _conn)
+    PostgreRawConnection& binary_connection();
+
+    // Lazily opened connection serving the async API
+    std::shared_ptr<PostgreAsyncSession> async_session();
+
     std::string _connectionString;
     std::unique_ptr<pqxx::connection> _conn;
+    PostgreExecMode _execMode;
+    bool _inSession;  // BEGIN sent through exec outside Transaction mode
+    PostgreStatementCache _statements;
+    std::shared_ptr<PostgreAsyncSession> _async;
+    std::unique_ptr<PostgreRawConnection> _binary;
+    // SQL of each prepare_binary statement, for its metrics
+    std::unordered_map<std::string, std::string> _binarySql;
+    std::mutex _sessionMutex;
 };
+
+// Get value by column index
+template <typename T>
+T PostgreRow::get(int col) const {
+    if (col >= _row.size()) {
+        throw std::out_of_range("Column index out of range");
+    }
+    return _row[col].as<T>();
+}
+
+// Get value by column name
+template <typename T>
+T PostgreRow::get(const std::string& colName) const {
+    return _row[colName].as<T>();
+}
+
+// Get optional value (returns nullopt if NULL)
+template <typename T>
+std::optional<T> PostgreRow::get_optional(int col) const {
+    if (col >= _row.size()) {
+        throw std::out_of_range("Column index out of range");
+    }
+    return _row[col].is_null() ? std::nullopt
+                               : std::make_optional(_row[col].as<T>());
+}
+
+template <typename T>
+std::optional<T> PostgreRow::get_optional(const std::string& colName) const {
+    auto field = _row[colName];
+    return field.is_null() ? std::nullopt : std::make_optional(field.as<T>());
+}
+
+// Convert all rows to vector
+template <typename T>
+std::vector<T> PostgreResult::to_vector(
+    std::function<T(const PostgreRow&)> converter) const {
+    std::vector<T> vec;
+    vec.reserve(size());
+    for (const auto& row : *this) vec.push_back(converter(row));
+
+    return vec;
+}
+
+// Decode one column into a contiguous typed array with a null bitmap
+template <typename T>
+Column<T> PostgreResult::to_column(size_t col) const {
+    if (col >= columns()) {
+        throw std::out_of_range("Column index out of range");
+    }
+
+    Column<T> column;
+    const size_t rows = size();
+    column.reserve(rows);
+    for (size_t row = 0; row < rows; ++row) {
+        const pqxx::row fields = _result[row];
+        const pqxx::field field = fields[col];
+        if (field.is_null()) {
+            column.push_null();
+        } else if constexpr (ColumnDecoder::supports<T>) {
+            T value;
+            ColumnDecoder::decode(field.c_str(), field.size(), value);
+            column.push_back(std::move(value));
+        } else {
+            column.push_back(field.as<T>());
+        }
+    }
+    return column;
+}
+
+// Decode the leading sizeof...(T) columns, one pass per column
+template <typename... T>
+std::tuple<Column<T>...> PostgreResult::to_columns() const {
+    if (sizeof...(T) > columns()) {
+        throw std::invalid_argument(
+            "More column types requested than the result has columns");
+    }
+    return to_columns<T...>(std::index_sequence_for<T...>{});
+}
+
+template <typename... T, std::size_t... Col>
+std::tuple<Column<T>...> PostgreResult::to_columns(
+    std::index_sequence<Col...>) const {
+    return std::tuple<Column<T>...>(to_column<T>(Col)...);
+}
+
+// Decode every row into a Struct through map
+template <typename Struct, typename... T>
+std::vector<Struct> PostgreResult::to_structs(
+    const RowMap<Struct, T...>& map) const {
+    return to_structs(map, std::index_sequence_for<T...>{});
+}
+
+template <typename Struct, typename... T, std::size_t... I>
+std::vector<Struct> PostgreResult::to_structs(
+    const RowMap<Struct, T...>& map, std::index_sequence<I...>) const {
+    const std::array<size_t, sizeof...(T)> cols{
+        column_index(map.template field<I>().column)...};
+
+    std::vector<Struct> structs;
+    const size_t rows = size();
+    structs.reserve(rows);
+    for (size_t row = 0; row < rows; ++row) {
+        const pqxx::row fields = _result[row];
+        Struct& value = structs.emplace_back();
+        (decode(fields[cols[I]], value.*(map.template field<I>().member)),
+         ...);
+    }
+    return structs;
+}
+
+template <typename T>
+void PostgreResult::decode(const pqxx::field& field, T& value) {
+    if (field.is_null()) {
+        throw QueryError(std::string("NULL in column ") + field.name());
+    }
+    PostgreFieldView(field.c_str(), field.size(), false).decode(value);
+}
+
+template <typename T>
+void PostgreResult::decode(const pqxx::field& field,
+                           std::optional<T>& value) {
+    if (field.is_null()) {
+        value.reset();
+    } else {
+        decode(field, value.emplace());
+    }
+}
+
+// Execute parameterized query, binding values directly to libpqxx
+template <typename... Args, typename>
+PostgreResult PostgreTransaction::exec_params(const std::string& sql,
+                                              Args&&... args) {
+    try {
+        return PostgreResult(
+            _txn->exec_params(sql, std::forward<Args>(args)...));
+    } catch (const pqxx::sql_error& e) {
+        throw QueryError(e.what(), e.sqlstate());
+    } catch (const std::exception& e) {
+        throw DatabaseError(e.what());
+    }
+}
+
+// Execute prepared statement
+template <typename... Args>
+PostgreResult PostgreTransaction::exec_prepared(const std::string& name,
+                                                Args&&... args) {
+    try {
+        return PostgreResult(
+            _txn->exec_prepared(name, std::forward<Args>(args)...));
+    } catch (const pqxx::sql_error& e) {
+        throw QueryError(e.what(), e.sqlstate());
+    } catch (const std::exception& e) {
+        throw DatabaseError(e.what());
+    }
+}
+
+// Execute parameterized query under exec_mode(), binding values
+// directly to libpqxx
+template <typename... Args, typename>
+std::unique_ptr<IResult> PostgreDatabase::exec_params(const std::string& sql,
+                                                      Args&&... args) {
+    return std::make_unique<PostgreResult>(
+        query_params(sql, std::forward<Args>(args)...));
+}
+
+template <typename... Args, typename>
+PostgreResult PostgreDatabase::query_params(const std::string& sql,
+                                            Args&&... args) {
+    return exec_cached(
+        sql,
+        [&](PostgreTransaction& txn, const std::string& name) {
+            return txn.exec_prepared(name, args...);
+        },
+        [&](PostgreTransaction& txn) { return txn.exec_params(sql, args...); });
+}
+
+// Run through a cached prepared statement when available, falling back
+// to plain SQL text once if its plan went stale
+template <typename Prepared, typename Plain>
+PostgreResult PostgreDatabase::exec_cached(const std::string& sql,
+                                           Prepared&& prepared, Plain&& plain) {
+    if (!connected()) {
+        throw ConnectionError("[Postgre] Database not connected");
+    }
+
+    const auto start = Metrics::start();
+    try {
+        if (auto name = _statements.lookup(*_conn, sql)) {
+            try {
+                auto txn = begin_statement(sql);
+                auto result = prepared(txn, *name);
+                txn.commit();
+                record(sql, start, &result);
+                return result;
+            } catch (const QueryError& e) {
+                if (!PostgreStatementCache::stale(e)) throw;
+                // Plan went stale, drop it and run as plain text once
+                _statements.invalidate(*_conn, sql);
+            }
+        }
+
+        auto txn = begin_statement(sql);
+        auto result = plain(txn);
+        txn.commit();
+        record(sql, start, &result);
+        return result;
+    } catch (const DatabaseError&) {
+        record(sql, start, nullptr);
+        throw;
+    } catch (const std::exception& e) {
+        record(sql, start, nullptr);
+        throw QueryError(e.what());
+    }
+}
+
+template <typename... Args>
+PostgreUpsertStats PostgreDatabase::bulk_upsert(
+    const std::string& table, const std::vector<std::string>& columns,
+    const std::vector<std::string>& keyColumns,
+    const std::vector<std::tuple<Args...>>& rows,
+    const PostgreUpsertOptions& options) {
+    auto upsert = upsert_writer(table, columns, keyColumns, options);
+    for (const auto& row : rows) upsert.write_row(row);
+    return upsert.finish();
+}
+
+// Simple insert helper
+template <typename... Args>
+void PostgreDatabase::insert(const std::string& table,
+                             const std::vector<std::string>& columns,
+                             Args&&... values) {
+    if (sizeof...(values) != columns.size())
+        throw std::invalid_argument(
+            "Number of values doesn't match number of columns");
+
+    std::ostringstream oss;
+    oss << "INSERT INTO " << table << " (";
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) oss << ", ";
+        oss << columns[i];
+    }
+    oss << ") VALUES (";
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) oss << ", ";
+        oss << "$" << (i + 1);
+    }
+    oss << ")";
+
+    exec_params(oss.str(), std::forward<Args>(values)...);
+}
@@ -0,0 +1,114 @@
+#include "PostgreDetachedResult.h"
+
+#include <cstring>
+#include <stdexcept>
+
+PostgreDetachedResult::PostgreDetachedResult(const pqxx::result& result)
+    : _rows(static_cast<std::size_t>(result.size())),
+      _affectedRows(static_cast<std::size_t>(result.affected_rows())),
+      _arenaWords(0) {
+    const std::size_t cols = static_cast<std::size_t>(result.columns());
+    _columnNames.reserve(cols);
+    for (std::size_t col = 0; col < cols; ++col)
+        _columnNames.emplace_back(result.column_name(col));
+
+    // Every cell takes its text plus a NUL, NULL cells just the NUL
+    const std::size_t cells = _rows * cols;
+    std::size_t bytes = 0;
+    for (const auto& row : result) {
+        for (const auto& field : row) bytes += field.size() + 1;
+    }
+
+    _arenaWords = cells + 1 + (bytes + sizeof(std::uint64_t) - 1) /
+                                  sizeof(std::uint64_t);
+    _arena = std::make_unique<std::uint64_t[]>(_arenaWords);
+
+    std::uint64_t* offsets = _arena.get();
+    char* text = reinterpret_cast<char*>(offsets + cells + 1);
+    std::size_t cell = 0, offset = 0;
+    for (const auto& row : result) {
+        for (const auto& field : row) {
+            const std::size_t size = field.is_null() ? 0 : field.size();
+            offsets[cell++] = offset | (field.is_null() ? NullBit : 0);
+            std::memcpy(text + offset, field.c_str(), size);
+            text[offset + size] = '\0';
+            offset += size + 1;
+        }
+    }
+    offsets[cell] = offset;
+}
+
+PostgreDetachedResult::PostgreDetachedResult(
+    const PostgreDetachedResult& result)
+    : IResult(result),
+      _columnNames(result._columnNames),
+      _rows(result._rows),
+      _affectedRows(result._affectedRows),
+      _arenaWords(result._arenaWords),
+      _arena(std::make_unique<std::uint64_t[]>(result._arenaWords)) {
+    std::memcpy(_arena.get(), result._arena.get(),
+                _arenaWords * sizeof(std::uint64_t));
+}
+
+std::unique_ptr<IResult> PostgreDetachedResult::clone() const {
+    return std::make_unique<PostgreDetachedResult>(*this);
+}
+
+std::size_t PostgreDetachedResult::memory_usage() const noexcept {
+    std::size_t bytes = sizeof(*this) + _arenaWords * sizeof(std::uint64_t);
+    for (const auto& name : _columnNames) bytes += name.capacity();
+    return bytes;
+}
+
+// Result properties
+std::size_t PostgreDetachedResult::size() const noexcept { return _rows; }
+bool PostgreDetachedResult::empty() const noexcept { return _rows == 0; }
+std::size_t PostgreDetachedResult::columns() const noexcept {
+    return _columnNames.size();
+}
+std::size_t PostgreDetachedResult::affected_rows() const noexcept {
+    return _affectedRows;
+}
+
+// Column information
+const std::string& PostgreDetachedResult::column_name(std::size_t col) const {
+    if (col >= _columnNames.size()) {
+        throw std::out_of_range("Column index out of range");
+    }
+    return _columnNames[col];
+}
+
+// Column number of name (throws std::out_of_range)
+std::size_t PostgreDetachedResult::column_index(std::string_view name) const {
+    for (std::size_t col = 0; col < _columnNames.size(); ++col) {
+        if (_columnNames[col] == name) return col;
+    }
+    throw std::out_of_range("Unknown column " + std::string(name));
+}
+
+// Field view (unchecked)
+PostgreFieldView PostgreDetachedResult::field(std::size_t row,
+                                              std::size_t col) const noexcept {
+    const std::uint64_t* offsets = _arena.get();
+    const std::size_t cell = row * _columnNames.size() + col;
+    const std::uint64_t begin = offsets[cell] & ~NullBit;
+    const std::uint64_t end = offsets[cell + 1] & ~NullBit;
+    return PostgreFieldView(text() + begin, end - begin - 1,
+                            (offsets[cell] & NullBit) != 0);
+}
+
+// Row views
+PostgreRowView<PostgreDetachedResult> PostgreDetachedResult::operator[](
+    std::size_t row) const noexcept {
+    return PostgreRowView<PostgreDetachedResult>(*this, row);
+}
+
+PostgreRowRange<PostgreDetachedResult> PostgreDetachedResult::rows()
+    const noexcept {
+    return PostgreRowRange<PostgreDetachedResult>(*this);
+}
+
+const char* PostgreDetachedResult::text() const noexcept {
+    return reinterpret_cast<const char*>(_arena.get() + _rows * columns() +
+                                         1);
+}
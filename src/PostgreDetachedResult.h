@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <pqxx/pqxx>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "IDatabase.h"
+#include "PostgreView.h"
+
+// PostgreDetachedResult class - copy of a whole result in one contiguous
+// arena (cell offsets followed by NUL-terminated text), independent of the
+// connection and of libpq. Immutable, so one instance can be shared across
+// threads, e.g. through std::shared_ptr<const PostgreDetachedResult>.
+class PostgreDetachedResult : public IResult {
+   public:
+    explicit PostgreDetachedResult(const pqxx::result& result);
+
+    PostgreDetachedResult(const PostgreDetachedResult& result);
+    PostgreDetachedResult(PostgreDetachedResult&&) noexcept = default;
+    PostgreDetachedResult& operator=(const PostgreDetachedResult&) = delete;
+    PostgreDetachedResult& operator=(PostgreDetachedResult&&) noexcept =
+        default;
+
+    std::unique_ptr<IResult> clone() const override;
+    std::size_t memory_usage() const noexcept override;
+
+    // Result properties
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    std::size_t columns() const noexcept;
+    std::size_t affected_rows() const noexcept;
+
+    // Column information
+    const std::string& column_name(std::size_t col) const;
+    // Column number of name (throws std::out_of_range)
+    std::size_t column_index(std::string_view name) const;
+
+    // Field view (unchecked)
+    PostgreFieldView field(std::size_t row, std::size_t col) const noexcept;
+
+    // Row views
+    PostgreRowView<PostgreDetachedResult> operator[](
+        std::size_t row) const noexcept;
+    PostgreRowRange<PostgreDetachedResult> rows() const noexcept;
+
+   private:
+    // Set on the offset of a NULL cell
+    static constexpr std::uint64_t NullBit = std::uint64_t(1) << 63;
+
+    const char* text() const noexcept;
+
+    std::vector<std::string> _columnNames;
+    std::size_t _rows;
+    std::size_t _affectedRows;
+    std::size_t _arenaWords;
+    // rows * columns + 1 offsets into the text, then the text itself
+    std::unique_ptr<std::uint64_t[]> _arena;
+};
@@ -0,0 +1,186 @@
+#include "PostgreGroupCommitter.h"
+
+#include <exception>
+
+#include "Errors.h"
+#include "PostgreDatabase.h"
+#include "PostgreParams.h"
+
+// Connects immediately (throws ConnectionError)
+PostgreGroupCommitter::PostgreGroupCommitter(
+    const DatabaseConfig& config, const PostgreGroupCommitOptions& options)
+    : _connectionString(PostgreDatabase::connection_string(
+          config.host.empty() ? "localhost" : config.host,
+          config.port == 0 ? 5432 : config.port,
+          config.database.empty() ? "postgres" : config.database,
+          config.username, config.password)),
+      _options(options),
+      _inFlight(0),
+      _stopping(false) {
+    if (_options.max_batch == 0) _options.max_batch = 1;
+    _conn = std::make_unique<PostgreRawConnection>(_connectionString);
+    _committer = std::thread([this] { run(); });
+}
+
+// Commits queued statements, then stops the committer
+PostgreGroupCommitter::~PostgreGroupCommitter() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _ready.notify_all();
+    if (_committer.joinable()) _committer.join();
+}
+
+// Queue a statement, the future is ready once its transaction committed
+std::future<std::unique_ptr<IResult>> PostgreGroupCommitter::submit(
+    std::string sql, ParamPack params) {
+    Write write{std::move(sql), std::move(params), {}};
+    auto future = write.promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stopping)
+            throw DatabaseError("[Postgre] Group committer is stopped");
+        _queue.push_back(std::move(write));
+    }
+    _ready.notify_one();
+    return future;
+}
+
+// Statements queued but not yet committed
+std::size_t PostgreGroupCommitter::pending() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size() + _inFlight;
+}
+
+PostgreGroupCommitStats PostgreGroupCommitter::stats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void PostgreGroupCommitter::run() noexcept {
+    std::vector<Write> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _ready.wait(lock, [this] { return _stopping || !_queue.empty(); });
+            if (_queue.empty()) return;  // stopping and drained
+
+            // Give more statements a chance to join the batch
+            if (_options.window.count() > 0) {
+                _ready.wait_for(lock, _options.window, [this] {
+                    return _stopping || _queue.size() >= _options.max_batch;
+                });
+            }
+
+            while (!_queue.empty() && batch.size() < _options.max_batch) {
+                batch.push_back(std::move(_queue.front()));
+                _queue.pop_front();
+            }
+            _inFlight = batch.size();
+        }
+
+        commit(batch);
+        batch.clear();
+    }
+}
+
+void PostgreGroupCommitter::commit(std::vector<Write>& batch) noexcept {
+    std::vector<std::unique_ptr<IResult>> results(batch.size());
+    std::vector<std::exception_ptr> errors(batch.size());
+    std::size_t failures = 0, retries = 0;
+    std::exception_ptr batchError;
+
+    try {
+        if (!_conn || !_conn->connected())
+            _conn = std::make_unique<PostgreRawConnection>(_connectionString);
+
+        // Statements after a failing one never run and the transaction is
+        // lost, so rerun the batch without it until one commits
+        std::vector<std::size_t> live;
+        live.reserve(batch.size());
+        while (true) {
+            live.clear();
+            for (std::size_t i = 0; i < batch.size(); ++i)
+                if (!errors[i]) live.push_back(i);
+            if (live.empty()) break;
+            if (failures > 0) ++retries;
+
+            if (run_pipelined(batch, live, results, errors)) break;
+            ++failures;
+        }
+    } catch (...) {
+        batchError = std::current_exception();
+        // The pipeline may be left half read, start over on a new connection
+        _conn.reset();
+    }
+
+    // Counters first, so they include a statement once its future is ready
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (batchError) {
+            _stats.failures += batch.size();
+        } else {
+            _stats.writes += batch.size() - failures;
+            _stats.failures += failures;
+            if (failures < batch.size()) ++_stats.transactions;
+        }
+        _stats.retries += retries;
+        _inFlight = 0;
+    }
+
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        if (batchError)
+            batch[i].promise.set_exception(batchError);
+        else if (errors[i])
+            batch[i].promise.set_exception(errors[i]);
+        else
+            batch[i].promise.set_value(std::move(results[i]));
+    }
+}
+
+// Run live as one transaction in pipeline mode, a single round trip; false
+// after recording the first failing statement in errors
+bool PostgreGroupCommitter::run_pipelined(
+    const std::vector<Write>& batch, const std::vector<std::size_t>& live,
+    std::vector<std::unique_ptr<IResult>>& results,
+    std::vector<std::exception_ptr>& errors) {
+    PostgreRawConnection& conn = *_conn;
+    conn.enter_pipeline();
+    conn.send("BEGIN", {});
+    for (auto i : live)
+        conn.send(batch[i].sql, PostgreParams::text(batch[i].params));
+    conn.send("COMMIT", {});
+    conn.sync_pipeline();
+
+    // After an error the server skips the rest up to the sync, each of
+    // those reporting PGRES_PIPELINE_ABORTED
+    const auto begin = conn.pipeline_result();
+    bool failed = PQresultStatus(begin->handle()) != PGRES_COMMAND_OK;
+    bool statementFailed = false;
+    for (auto i : live) {
+        auto result = conn.pipeline_result();
+        if (failed) continue;
+        try {
+            PostgreRawConnection::check(result->handle());
+            results[i] = std::move(result);
+        } catch (const QueryError&) {
+            errors[i] = std::current_exception();
+            failed = statementFailed = true;
+        }
+    }
+    const auto committed = conn.pipeline_result();
+    const auto sync = conn.pipeline_result();
+    if (PQresultStatus(sync->handle()) != PGRES_PIPELINE_SYNC)
+        throw ConnectionError("[Postgre] Pipeline results out of step");
+    conn.exit_pipeline();
+
+    PostgreRawConnection::check(begin->handle());
+    if (statementFailed) {
+        // The skipped COMMIT left the transaction open and aborted
+        conn.exec("ROLLBACK", {});
+        return false;
+    }
+    PostgreRawConnection::check(committed->handle());
+    return true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "DatabaseConfig.h"
+#include "IDatabase.h"
+#include "ParamPack.h"
+#include "PostgreRaw.h"
+
+// Group commit settings
+struct PostgreGroupCommitOptions {
+    std::size_t max_batch = 256;          // statements per transaction
+    std::chrono::microseconds window{0};  // wait for more after the first
+};
+
+// Group commit counters
+struct PostgreGroupCommitStats {
+    std::size_t writes = 0;        // statements committed
+    std::size_t failures = 0;      // statements failed or rolled back
+    std::size_t transactions = 0;  // batches committed
+    std::size_t retries = 0;       // batches rerun without a failed statement
+};
+
+// PostgreGroupCommitter class - committer thread with its own connection.
+// Statements submitted from any thread are batched into one transaction,
+// so a stream of small writes pays one WAL flush per batch instead of one
+// per statement. A batch takes everything queued while the previous one
+// committed, plus what arrives within window, up to max_batch statements,
+// and is sent in libpq pipeline mode: BEGIN, the statements with their
+// values bound by the server and COMMIT cost a single round trip. A
+// failing statement gets its own error and the batch is rerun without it;
+// errors of the transaction itself (commit, lost connection) fail every
+// statement in the batch.
+class PostgreGroupCommitter final {
+   public:
+    // Connects immediately (throws ConnectionError)
+    explicit PostgreGroupCommitter(
+        const DatabaseConfig& config,
+        const PostgreGroupCommitOptions& options = PostgreGroupCommitOptions{});
+
+    PostgreGroupCommitter(const PostgreGroupCommitter&) noexcept = delete;
+    PostgreGroupCommitter& operator=(const PostgreGroupCommitter&) noexcept =
+        delete;
+
+    // Commits queued statements, then stops the committer
+    ~PostgreGroupCommitter() noexcept;
+
+    // Queue a statement, the future is ready once its transaction committed
+    // and holds a PostgreRawResult. sql must not begin or end transactions
+    // itself and holds a single statement.
+    std::future<std::unique_ptr<IResult>> submit(std::string sql,
+                                                 ParamPack params = {});
+
+    template <typename... Args, typename = ParamPack::EnableIfValues<Args...>>
+    std::future<std::unique_ptr<IResult>> submit(std::string sql,
+                                                 Args&&... args) {
+        return submit(std::move(sql),
+                      ParamPack::of(std::forward<Args>(args)...));
+    }
+
+    // Statements queued but not yet committed
+    std::size_t pending() const;
+
+    PostgreGroupCommitStats stats() const;
+
+   private:
+    struct Write {
+        std::string sql;
+        ParamPack params;
+        std::promise<std::unique_ptr<IResult>> promise;
+    };
+
+    void run() noexcept;
+    void commit(std::vector<Write>& batch) noexcept;
+    bool run_pipelined(const std::vector<Write>& batch,
+                       const std::vector<std::size_t>& live,
+                       std::vector<std::unique_ptr<IResult>>& results,
+                       std::vector<std::exception_ptr>& errors);
+
+    std::string _connectionString;
+    std::unique_ptr<PostgreRawConnection> _conn;
+    PostgreGroupCommitOptions _options;
+    mutable std::mutex _mutex;
+    std::condition_variable _ready;
+    std::deque<Write> _queue;
+    std::size_t _inFlight;
+    PostgreGroupCommitStats _stats;
+    bool _stopping;
+    std::thread _committer;
+};
@@ -0,0 +1,381 @@
+#include "PostgreListener.h"
+
+#if defined(__linux__)
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+#include "Errors.h"
+#include "PostgreDatabase.h"
+
+namespace {
+
+std::size_t ring_size(std::size_t capacity) noexcept {
+    std::size_t size = 2;
+    while (size < capacity) size <<= 1;
+    return size;
+}
+
+}  // namespace
+
+// Connects immediately (throws ConnectionError)
+PostgreListener::PostgreListener(const DatabaseConfig& config,
+                                 const PostgreListenOptions& options)
+    : _connectionString(PostgreDatabase::connection_string(
+          config.host.empty() ? "localhost" : config.host,
+          config.port == 0 ? 5432 : config.port,
+          config.database.empty() ? "postgres" : config.database,
+          config.username, config.password)),
+      _options(options),
+      _resubscribed(false),
+      _dirty(false),
+      _stopping(false),
+      _queue(ring_size(options.queue_capacity)),
+      _mask(_queue.size() - 1),
+      _head(0),
+      _tail(0),
+      _waiters(0),
+      _connected(false),
+      _received(0),
+      _dispatched(0),
+      _queued(0),
+      _dropped(0),
+      _callbackErrors(0),
+      _reconnects(0),
+      _wakeup(-1) {
+    if (_options.reconnect_delay.count() <= 0)
+        _options.reconnect_delay = std::chrono::milliseconds(1);
+    _options.max_reconnect_delay =
+        std::max(_options.max_reconnect_delay, _options.reconnect_delay);
+
+    _conn = std::make_unique<PostgreRawConnection>(_connectionString);
+    _wakeup = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_wakeup < 0) throw ConnectionError("[Postgre] eventfd failed");
+    _connected.store(true);
+    _thread = std::thread([this] { run(); });
+}
+
+// Stops the listener thread and closes the connection
+PostgreListener::~PostgreListener() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _stopped.notify_all();
+    wake();
+    if (_thread.joinable()) _thread.join();
+    ::close(_wakeup);
+
+    const auto error = std::make_exception_ptr(
+        DatabaseError("[Postgre] Listener stopped before LISTEN ran"));
+    for (auto& subscription : _pending) subscription.done.set_exception(error);
+}
+
+// Call callback for every notification on channel
+std::future<void> PostgreListener::listen(const std::string& channel,
+                                          Callback callback) {
+    if (!callback) {
+        throw std::invalid_argument("PostgreListener callback is empty");
+    }
+    return subscribe(channel, std::move(callback));
+}
+
+// Queue the notifications on channel for poll() and wait()
+std::future<void> PostgreListener::listen(const std::string& channel) {
+    return subscribe(channel, nullptr);
+}
+
+// Drop the callbacks and queueing of channel
+void PostgreListener::unlisten(const std::string& channel) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_channels.erase(channel) == 0) return;
+        _dirty = true;
+    }
+    wake();
+}
+
+// Next queued notification without blocking
+bool PostgreListener::poll(PostgreNotification& notification) {
+    const std::size_t head = _head.load(std::memory_order_relaxed);
+    if (head == _tail.load(std::memory_order_acquire)) return false;
+
+    notification = std::move(_queue[head & _mask]);
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+// Next queued notification, waiting up to timeout
+bool PostgreListener::wait(PostgreNotification& notification,
+                           std::chrono::milliseconds timeout) {
+    if (poll(notification)) return true;
+
+    // The listener only takes _waitMutex when it sees a waiter, so the
+    // waiter registers before its last look at the queue
+    _waiters.fetch_add(1);
+    {
+        std::unique_lock<std::mutex> lock(_waitMutex);
+        _available.wait_for(lock, timeout, [this] {
+            return _head.load(std::memory_order_relaxed) != _tail.load();
+        });
+    }
+    _waiters.fetch_sub(1);
+    return poll(notification);
+}
+
+// Whether the listener connection is currently up
+bool PostgreListener::connected() const noexcept { return _connected.load(); }
+
+PostgreListenStats PostgreListener::stats() const {
+    PostgreListenStats stats;
+    stats.received = _received.load();
+    stats.dispatched = _dispatched.load();
+    stats.queued = _queued.load();
+    stats.dropped = _dropped.load();
+    stats.callback_errors = _callbackErrors.load();
+    stats.reconnects = _reconnects.load();
+    return stats;
+}
+
+std::future<void> PostgreListener::subscribe(const std::string& channel,
+                                             Callback callback) {
+    if (channel.empty()) {
+        throw std::invalid_argument("PostgreListener channel is empty");
+    }
+
+    Subscription subscription{channel, {}};
+    auto future = subscription.done.get_future();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stopping) throw DatabaseError("[Postgre] Listener is stopped");
+
+        // Copy on write, so dispatch runs the callbacks without the lock
+        Channel& entry = _channels[channel];
+        if (callback) {
+            auto callbacks = entry.callbacks
+                                 ? std::make_shared<std::vector<Callback>>(
+                                       *entry.callbacks)
+                                 : std::make_shared<std::vector<Callback>>();
+            callbacks->push_back(std::move(callback));
+            entry.callbacks = std::move(callbacks);
+        } else {
+            entry.queued = true;
+        }
+        _pending.push_back(std::move(subscription));
+        _dirty = true;
+    }
+    wake();
+    return future;
+}
+
+void PostgreListener::run() noexcept {
+    auto delay = _options.reconnect_delay;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stopping) return;
+        }
+        if (!_conn) {
+            if (!reconnect()) {
+                // Back off between attempts, stopping cuts the wait short
+                std::unique_lock<std::mutex> lock(_mutex);
+                _stopped.wait_for(lock, delay, [this] { return _stopping; });
+                delay = std::min(delay * 2, _options.max_reconnect_delay);
+                continue;
+            }
+            delay = _options.reconnect_delay;
+        }
+
+        try {
+            sync();
+            drain();
+
+            pollfd fds[2] = {{_conn->socket(), POLLIN, 0},
+                             {_wakeup, POLLIN, 0}};
+            const auto keepalive = _options.keepalive.count();
+            const int ready =
+                ::poll(fds, 2, keepalive > 0 ? int(keepalive) : -1);
+            if (ready < 0 && errno != EINTR) {
+                throw ConnectionError("[Postgre] Listener poll failed");
+            }
+
+            if (fds[1].revents & POLLIN) {
+                std::uint64_t value;
+                [[maybe_unused]] auto n =
+                    ::read(_wakeup, &value, sizeof(value));
+            }
+            if (fds[0].revents != 0) {
+                _conn->consume();
+            } else if (ready == 0) {
+                // Idle: a round trip notices a connection that died silently
+                _conn->exec("SELECT 1", {});
+            }
+            drain();
+        } catch (const std::exception&) {
+            _conn.reset();
+            _connected.store(false);
+        }
+    }
+}
+
+// Open a new connection, subscribed by the next sync
+bool PostgreListener::reconnect() noexcept {
+    try {
+        _conn = std::make_unique<PostgreRawConnection>(_connectionString);
+    } catch (const std::exception&) {
+        return false;
+    }
+    _subscribed.clear();
+    _resubscribed = true;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _dirty = true;
+    }
+    _reconnects.fetch_add(1, std::memory_order_relaxed);
+    _connected.store(true);
+    return true;
+}
+
+// LISTEN and UNLISTEN until the connection matches _channels
+void PostgreListener::sync() {
+    std::set<std::string> wanted;
+    std::vector<Subscription> pending;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_dirty) return;
+        for (const auto& entry : _channels) wanted.insert(entry.first);
+        pending.swap(_pending);
+        _dirty = false;
+    }
+
+    std::map<std::string, std::exception_ptr> refused;
+    try {
+        for (const auto& channel : wanted) {
+            if (_subscribed.count(channel) != 0) continue;
+            try {
+                _conn->exec("LISTEN " + _conn->quote_identifier(channel), {});
+                _subscribed.insert(channel);
+            } catch (const QueryError&) {
+                if (!_conn->connected()) throw;
+                refused[channel] = std::current_exception();
+            }
+        }
+        for (auto itr = _subscribed.begin(); itr != _subscribed.end();) {
+            if (wanted.count(*itr) != 0) {
+                ++itr;
+                continue;
+            }
+            _conn->exec("UNLISTEN " + _conn->quote_identifier(*itr), {});
+            itr = _subscribed.erase(itr);
+        }
+    } catch (...) {
+        // Connection lost, the next connection resubscribes everything
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& subscription : pending)
+            _pending.push_back(std::move(subscription));
+        throw;
+    }
+
+    if (!refused.empty()) {
+        // A channel listened to again since the swap keeps its entry, and
+        // the next sync tries LISTEN once more for the new subscription
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (const auto& entry : refused) {
+            const bool again = std::any_of(
+                _pending.begin(), _pending.end(),
+                [&entry](const Subscription& subscription) {
+                    return subscription.channel == entry.first;
+                });
+            if (!again) _channels.erase(entry.first);
+        }
+    }
+    for (auto& subscription : pending) {
+        auto itr = refused.find(subscription.channel);
+        if (itr == refused.end())
+            subscription.done.set_value();
+        else
+            subscription.done.set_exception(itr->second);
+    }
+
+    if (_resubscribed) {
+        _resubscribed = false;
+        if (_options.on_reconnect) {
+            try {
+                _options.on_reconnect();
+            } catch (...) {
+                _callbackErrors.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+// Dispatch the notifications libpq has read
+void PostgreListener::drain() {
+    while (PGnotify* raw = _conn->next_notification()) {
+        PostgreNotification notification;
+        notification.channel = raw->relname;
+        notification.payload = raw->extra ? raw->extra : "";
+        notification.pid = raw->be_pid;
+        PQfreemem(raw);
+
+        _received.fetch_add(1, std::memory_order_relaxed);
+        dispatch(notification);
+    }
+}
+
+void PostgreListener::dispatch(PostgreNotification& notification) {
+    std::shared_ptr<const std::vector<Callback>> callbacks;
+    bool queued = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto itr = _channels.find(notification.channel);
+        if (itr == _channels.end()) return;  // unlisten still pending
+        callbacks = itr->second.callbacks;
+        queued = itr->second.queued;
+    }
+
+    if (callbacks) {
+        for (const auto& callback : *callbacks) {
+            try {
+                callback(notification);
+                _dispatched.fetch_add(1, std::memory_order_relaxed);
+            } catch (...) {
+                _callbackErrors.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+    if (queued) {
+        if (push(notification))
+            _queued.fetch_add(1, std::memory_order_relaxed);
+        else
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool PostgreListener::push(PostgreNotification& notification) noexcept {
+    const std::size_t tail = _tail.load(std::memory_order_relaxed);
+    if (tail - _head.load(std::memory_order_acquire) == _queue.size())
+        return false;
+
+    _queue[tail & _mask] = std::move(notification);
+    _tail.store(tail + 1);
+    if (_waiters.load() > 0) {
+        std::lock_guard<std::mutex> lock(_waitMutex);
+        _available.notify_all();
+    }
+    return true;
+}
+
+void PostgreListener::wake() noexcept {
+    const std::uint64_t one = 1;
+    [[maybe_unused]] auto n = ::write(_wakeup, &one, sizeof(one));
+}
+
+#endif  // __linux__
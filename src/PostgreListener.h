@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DatabaseConfig.h"
+#include "PostgreRaw.h"
+
+// Notification received on a channel (NOTIFY or pg_notify)
+struct PostgreNotification {
+    std::string channel;
+    std::string payload;
+    int pid = 0;  // server process that sent it
+};
+
+// Listener settings
+struct PostgreListenOptions {
+    std::size_t queue_capacity = 4096;  // for poll(), rounded to a power of 2
+    std::chrono::milliseconds reconnect_delay{100};  // doubles per failure
+    std::chrono::milliseconds max_reconnect_delay{10 * 1000};
+    std::chrono::milliseconds keepalive{30 * 1000};  // idle probe, 0 never
+    // Called on the listener thread once a new connection resubscribed;
+    // notifications sent while disconnected are lost
+    std::function<void()> on_reconnect;
+};
+
+// Listener counters
+struct PostgreListenStats {
+    std::uint64_t received = 0;         // notifications read
+    std::uint64_t dispatched = 0;       // callback calls
+    std::uint64_t queued = 0;           // pushed for poll()
+    std::uint64_t dropped = 0;          // not queued, the queue was full
+    std::uint64_t callback_errors = 0;  // callbacks that threw
+    std::uint64_t reconnects = 0;       // connections replaced
+};
+
+// PostgreListener class - LISTEN/NOTIFY without polling. A listener thread
+// owns a dedicated connection and sleeps on its socket; each notification
+// goes to the callbacks of its channel (run on the listener thread, so
+// they should be short) and, for queued channels, into a bounded
+// lock-free single-consumer queue read with poll() or wait(). A lost
+// connection is replaced with exponential backoff and every channel is
+// subscribed again, then on_reconnect runs.
+class PostgreListener final {
+   public:
+    using Callback = std::function<void(const PostgreNotification&)>;
+
+    // Connects immediately (throws ConnectionError)
+    explicit PostgreListener(
+        const DatabaseConfig& config,
+        const PostgreListenOptions& options = PostgreListenOptions{});
+
+    PostgreListener(const PostgreListener&) noexcept = delete;
+    PostgreListener& operator=(const PostgreListener&) noexcept = delete;
+
+    // Stops the listener thread and closes the connection
+    ~PostgreListener() noexcept;
+
+    // Call callback for every notification on channel. The future is ready
+    // once LISTEN ran (after the next reconnect while disconnected) and
+    // holds the QueryError if the server refused it.
+    std::future<void> listen(const std::string& channel, Callback callback);
+
+    // Queue the notifications on channel for poll() and wait()
+    std::future<void> listen(const std::string& channel);
+
+    // Drop the callbacks and queueing of channel
+    void unlisten(const std::string& channel);
+
+    // Next queued notification without blocking. One consumer thread at a
+    // time; the listener thread is the only producer.
+    bool poll(PostgreNotification& notification);
+
+    // Next queued notification, waiting up to timeout
+    bool wait(PostgreNotification& notification,
+              std::chrono::milliseconds timeout);
+
+    // Whether the listener connection is currently up
+    bool connected() const noexcept;
+
+    PostgreListenStats stats() const;
+
+   private:
+    struct Channel {
+        std::shared_ptr<const std::vector<Callback>> callbacks;
+        bool queued = false;
+    };
+
+    struct Subscription {
+        std::string channel;
+        std::promise<void> done;
+    };
+
+    std::future<void> subscribe(const std::string& channel,
+                                Callback callback);
+
+    void run() noexcept;
+    bool reconnect() noexcept;
+    // LISTEN and UNLISTEN until the connection matches _channels
+    void sync();
+    // Dispatch the notifications libpq has read
+    void drain();
+    void dispatch(PostgreNotification& notification);
+    bool push(PostgreNotification& notification) noexcept;
+    void wake() noexcept;
+
+    std::string _connectionString;
+    PostgreListenOptions _options;
+
+    // Listener thread only, after construction
+    std::unique_ptr<PostgreRawConnection> _conn;
+    std::set<std::string> _subscribed;
+    bool _resubscribed;  // on_reconnect is due after the next sync
+
+    mutable std::mutex _mutex;
+    std::condition_variable _stopped;  // ends reconnect backoff early
+    std::map<std::string, Channel> _channels;
+    std::vector<Subscription> _pending;  // waiting for their LISTEN
+    bool _dirty;                         // _channels changed since sync
+    bool _stopping;
+
+    // Ring of queued notifications: the listener thread advances _tail,
+    // the consumer _head
+    std::vector<PostgreNotification> _queue;
+    std::size_t _mask;
+    std::atomic<std::size_t> _head;
+    std::atomic<std::size_t> _tail;
+    std::atomic<std::size_t> _waiters;
+    std::mutex _waitMutex;
+    std::condition_variable _available;
+
+    std::atomic<bool> _connected;
+    std::atomic<std::uint64_t> _received;
+    std::atomic<std::uint64_t> _dispatched;
+    std::atomic<std::uint64_t> _queued;
+    std::atomic<std::uint64_t> _dropped;
+    std::atomic<std::uint64_t> _callbackErrors;
+    std::atomic<std::uint64_t> _reconnects;
+
+    int _wakeup;  // eventfd interrupting the listener's poll
+    std::thread _thread;
+};
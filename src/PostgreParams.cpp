@@ -0,0 +1,102 @@
+#include "PostgreParams.h"
+
+#include <cstddef>
+#include <string_view>
+
+#include "Errors.h"
+
+namespace {
+
+// bytea hex input format
+std::string hex(std::string_view bytes) {
+    static constexpr char Digits[] = "0123456789abcdef";
+
+    std::string out = "\\x";
+    out.reserve(2 + 2 * bytes.size());
+    for (unsigned char byte : bytes) {
+        out += Digits[byte >> 4];
+        out += Digits[byte & 0xF];
+    }
+    return out;
+}
+
+}  // namespace
+
+PostgreParams::Bound::Bound(const ParamPack& params) {
+    _params.reserve(params.size());
+    // Sized once so scratch buffers never move while bound
+    if (params.size() > ParamPack::InlineCount)
+        _overflow.resize(params.size() - ParamPack::InlineCount);
+    for (std::size_t i = 0; i < params.size(); ++i) {
+        const Param& param = params[i];
+        switch (param.type()) {
+            case Param::Type::Null:
+                _params.append();
+                break;
+            case Param::Type::Text:
+                _params.append(
+                    pqxx::zview(param.c_str(), param.as_text().size()));
+                break;
+            case Param::Type::Bytea:
+                _params.append(std::basic_string_view<std::byte>(
+                    reinterpret_cast<const std::byte*>(param.c_str()),
+                    param.as_text().size()));
+                break;
+            default: {
+                // libpq reads text values up to the terminating NUL
+                auto& buffer = scratch(i).text;
+                auto text = param.to_text(buffer);
+                if (text.data() == buffer) {
+                    buffer[text.size()] = '\0';
+                    _params.append(pqxx::zview(buffer, text.size()));
+                } else {
+                    _params.append(pqxx::zview(text.data(), text.size()));
+                }
+                break;
+            }
+        }
+    }
+}
+
+const pqxx::params& PostgreParams::Bound::get() const noexcept {
+    return _params;
+}
+
+PostgreParams::Bound::Scratch& PostgreParams::Bound::scratch(
+    std::size_t index) {
+    return index < ParamPack::InlineCount
+               ? _inline[index]
+               : _overflow[index - ParamPack::InlineCount];
+}
+
+// Convert parameters to libpq text-format values (nullopt for NULL)
+std::vector<std::optional<std::string>> PostgreParams::text(
+    const ParamPack& params) {
+    std::vector<std::optional<std::string>> values;
+    values.reserve(params.size());
+    char buffer[Param::TextSize];
+    for (const auto& param : params) {
+        if (param.is_null())
+            values.emplace_back(std::nullopt);
+        else if (param.type() == Param::Type::Bytea)
+            values.emplace_back(hex(param.as_text()));
+        else
+            values.emplace_back(std::string(param.to_text(buffer)));
+    }
+    return values;
+}
+
+// Quote a possibly schema-qualified table name
+std::string PostgreParams::quote_table(const pqxx::connection& conn,
+                                       const std::string& table) {
+    std::string quoted;
+    std::size_t start = 0;
+    while (true) {
+        auto dot = table.find('.', start);
+        quoted += conn.quote_name(table.substr(start, dot - start));
+        if (dot == std::string::npos) break;
+        quoted += '.';
+        start = dot + 1;
+    }
+    return quoted;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <optional>
+#include <pqxx/pqxx>
+#include <string>
+#include <vector>
+
+#include "ParamPack.h"
+
+// Conversion of query parameters for libpqxx and libpq
+class PostgreParams final {
+   private:
+    PostgreParams() noexcept = delete;
+    ~PostgreParams() noexcept = delete;
+
+   public:
+    // Bound libpqxx parameters. Text is referenced in place and numbers are
+    // formatted into inline scratch space, so binding does not allocate per
+    // value. The pack must outlive the binding.
+    class Bound final {
+       public:
+        explicit Bound(const ParamPack& params);
+
+        Bound(const Bound&) noexcept = delete;
+        Bound& operator=(const Bound&) noexcept = delete;
+
+        const pqxx::params& get() const noexcept;
+
+       private:
+        struct Scratch {
+            char text[Param::TextSize];
+        };
+
+        Scratch& scratch(std::size_t index);
+
+        pqxx::params _params;
+        Scratch _inline[ParamPack::InlineCount];
+        std::vector<Scratch> _overflow;
+    };
+
+    // Convert parameters to libpq text-format values (nullopt for NULL)
+    static std::vector<std::optional<std::string>> text(
+        const ParamPack& params);
+
+    // Quote a possibly schema-qualified table name
+    static std::string quote_table(const pqxx::connection& conn,
+                                   const std::string& table);
+};
@@ -0,0 +1,179 @@
+#include "PostgrePipeline.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Errors.h"
+#include "PostgreParams.h"
+
+PostgrePipeline::PostgrePipeline(pqxx::connection& conn, std::size_t depth)
+    : _txn(std::make_unique<pqxx::work>(conn)),
+      _depth(depth),
+      _nextHandle(0),
+      _committed(false) {
+    open();
+}
+
+PostgrePipeline::~PostgrePipeline() {
+    if (!_committed && _txn) {
+        try {
+            abort();
+        } catch (...) {
+            // Ignore exceptions in destructor
+        }
+    }
+}
+
+// Queue query, returns a handle to fetch its result later
+PostgrePipeline::Handle PostgrePipeline::exec(const std::string& sql) {
+    if (!_pipeline) throw DatabaseError("Pipeline is closed");
+
+    try {
+        const auto id = _pipeline->insert(sql);
+        _pending.push_back({_nextHandle, id});
+        return _nextHandle++;
+    } catch (const std::exception& e) {
+        throw DatabaseError(e.what());
+    }
+}
+
+// Run parameterized query with bound values after the queued queries.
+// libpqxx pipelines carry SQL text only and the transaction takes no
+// other query while one is open, so this sends what is queued, runs the
+// query in the same transaction and opens a new pipeline.
+PostgrePipeline::Handle PostgrePipeline::exec_params(
+    const std::string& sql, const ParamPack& params) {
+    if (!_pipeline) throw DatabaseError("Pipeline is closed");
+
+    flush();
+    _pipeline.reset();
+    const Handle handle = _nextHandle++;
+    Outcome outcome;
+    try {
+        PostgreParams::Bound bound(params);
+        outcome.result.emplace(_txn->exec_params(sql, bound.get()));
+    } catch (const pqxx::sql_error& e) {
+        outcome.error =
+            std::make_exception_ptr(QueryError(e.what(), e.sqlstate()));
+    } catch (const std::exception& e) {
+        outcome.error = std::make_exception_ptr(QueryError(e.what()));
+    }
+    _outcomes[handle] = std::move(outcome);
+    open();
+    return handle;
+}
+
+// Send everything queued and wait for all results
+void PostgrePipeline::flush() {
+    if (!_pipeline) return;
+
+    try {
+        _pipeline->complete();
+    } catch (const std::exception&) {
+        // Failures are reported per query below
+    }
+    auto pending = std::move(_pending);
+    _pending.clear();
+    for (const auto& queued : pending) collect(queued);
+}
+
+// Whether the result for handle has arrived (does not block)
+bool PostgrePipeline::ready(Handle handle) {
+    if (_outcomes.count(handle)) return true;
+    auto queued = std::find_if(
+        _pending.begin(), _pending.end(),
+        [handle](const Queued& entry) { return entry.handle == handle; });
+    if (!_pipeline || queued == _pending.end()) return false;
+
+    try {
+        _pipeline->resume();
+        return _pipeline->is_finished(queued->id);
+    } catch (const std::exception&) {
+        // Let result() report the failure
+        return true;
+    }
+}
+
+// Result of a queued query, waits if needed
+PostgreResult PostgrePipeline::result(Handle handle) {
+    auto itr = _outcomes.find(handle);
+    if (itr == _outcomes.end()) {
+        auto pending = std::find_if(
+            _pending.begin(), _pending.end(),
+            [handle](const Queued& entry) { return entry.handle == handle; });
+        if (pending == _pending.end())
+            throw std::out_of_range("Unknown pipeline handle");
+
+        const Queued queued = *pending;
+        _pending.erase(pending);
+        collect(queued);
+        itr = _outcomes.find(handle);
+    }
+
+    Outcome outcome = std::move(itr->second);
+    _outcomes.erase(itr);
+    if (outcome.error) std::rethrow_exception(outcome.error);
+    return std::move(*outcome.result);
+}
+
+// Number of queued queries whose results were not collected yet
+std::size_t PostgrePipeline::pending() const noexcept {
+    return _pending.size() + _outcomes.size();
+}
+
+std::size_t PostgrePipeline::depth() const noexcept { return _depth; }
+void PostgrePipeline::depth(std::size_t depth) {
+    _depth = depth;
+    if (_pipeline) _pipeline->retain(static_cast<int>(_depth));
+}
+
+// Flush and commit transaction
+void PostgrePipeline::commit() {
+    if (_committed) {
+        throw std::runtime_error("Transaction already committed");
+    }
+    flush();
+    // Pipeline must be detached before the transaction can commit
+    _pipeline.reset();
+    try {
+        _txn->commit();
+        _committed = true;
+    } catch (const std::exception& e) {
+        throw DatabaseError(e.what());
+    }
+}
+
+// Abort transaction, discarding queued queries
+void PostgrePipeline::abort() {
+    if (_committed) return;
+
+    if (_pipeline) {
+        _pipeline->cancel();
+        _pipeline.reset();
+    }
+    _pending.clear();
+    _txn->abort();
+    _committed = true;  // Mark as completed to avoid double-abort
+}
+
+void PostgrePipeline::open() {
+    try {
+        _pipeline = std::make_unique<pqxx::pipeline>(*_txn);
+        _pipeline->retain(static_cast<int>(_depth));
+    } catch (const std::exception& e) {
+        throw DatabaseError(e.what());
+    }
+}
+
+void PostgrePipeline::collect(const Queued& queued) {
+    Outcome outcome;
+    try {
+        outcome.result.emplace(_pipeline->retrieve(queued.id));
+    } catch (const pqxx::sql_error& e) {
+        outcome.error =
+            std::make_exception_ptr(QueryError(e.what(), e.sqlstate()));
+    } catch (const std::exception& e) {
+        outcome.error = std::make_exception_ptr(QueryError(e.what()));
+    }
+    _outcomes[queued.handle] = std::move(outcome);
+}
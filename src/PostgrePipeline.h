@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <pqxx/pqxx>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PostgreDatabase.h"
+
+// PostgrePipeline class - queues queries inside one transaction and sends
+// them to the server in bursts instead of one round trip per query
+class PostgrePipeline {
+   public:
+    using Handle = std::size_t;
+
+    // depth: number of queries held back before a burst is sent
+    PostgrePipeline(pqxx::connection& conn, std::size_t depth);
+
+    PostgrePipeline(PostgrePipeline&&) noexcept = default;
+    PostgrePipeline& operator=(PostgrePipeline&&) noexcept = delete;
+
+    ~PostgrePipeline();
+
+    // Queue query, returns a handle to fetch its result later
+    Handle exec(const std::string& sql);
+
+    // Run parameterized query with bound values once the queued queries
+    // are done (sends them first; the result waits under its handle)
+    Handle exec_params(const std::string& sql, const ParamPack& params);
+
+    template <typename... Args, typename = ParamPack::EnableIfValues<Args...>>
+    Handle exec_params(const std::string& sql, Args&&... args) {
+        return exec_params(sql, ParamPack::of(std::forward<Args>(args)...));
+    }
+
+    // Send everything queued and wait for all results
+    void flush();
+
+    // Whether the result for handle has arrived (does not block)
+    bool ready(Handle handle);
+
+    // Result of a queued query, waits if needed (throws QueryError if that
+    // query failed; queries after a failure are not executed)
+    PostgreResult result(Handle handle);
+
+    // Number of queued queries whose results were not collected yet
+    std::size_t pending() const noexcept;
+
+    std::size_t depth() const noexcept;
+    void depth(std::size_t depth);
+
+    // Flush and commit transaction
+    void commit();
+
+    // Abort transaction, discarding queued queries
+    void abort();
+
+   private:
+    struct Outcome {
+        std::optional<PostgreResult> result;
+        std::exception_ptr error;
+    };
+
+    // Query in the current libpqxx pipeline, which numbers its own
+    struct Queued {
+        Handle handle;
+        pqxx::pipeline::query_id id;
+    };
+
+    void open();
+    void collect(const Queued& queued);
+
+    std::unique_ptr<pqxx::work> _txn;
+    std::unique_ptr<pqxx::pipeline> _pipeline;
+    std::vector<Queued> _pending;
+    std::unordered_map<Handle, Outcome> _outcomes;
+    std::size_t _depth;
+    Handle _nextHandle;
+    bool _committed;
+};
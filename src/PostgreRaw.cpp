@@ -0,0 +1,271 @@
+#include "PostgreRaw.h"
+
+#include <new>
+
+#include "Errors.h"
+
+PostgreRawResult::PostgreRawResult(PGresult* result) noexcept
+    : _result(result) {}
+
+PostgreRawResult::~PostgreRawResult() noexcept {
+    if (_result) PQclear(_result);
+}
+
+std::unique_ptr<IResult> PostgreRawResult::clone() const {
+    // Keeps column formats and types, rows and the command status
+    PGresult* copy =
+        PQcopyResult(_result, PG_COPYRES_ATTRS | PG_COPYRES_TUPLES);
+    if (copy == nullptr) throw std::bad_alloc();
+    return std::make_unique<PostgreRawResult>(copy);
+}
+
+std::size_t PostgreRawResult::memory_usage() const noexcept {
+    return sizeof(*this) + PQresultMemorySize(_result);
+}
+
+// Result properties
+std::size_t PostgreRawResult::size() const noexcept {
+    return _result ? static_cast<std::size_t>(PQntuples(_result)) : 0;
+}
+bool PostgreRawResult::empty() const noexcept { return size() == 0; }
+std::size_t PostgreRawResult::columns() const noexcept {
+    return _result ? static_cast<std::size_t>(PQnfields(_result)) : 0;
+}
+std::size_t PostgreRawResult::affected_rows() const noexcept {
+    if (!_result) return 0;
+    const char* tuples = PQcmdTuples(_result);
+    return tuples && *tuples ? std::stoul(tuples) : 0;
+}
+
+// Column information
+std::string PostgreRawResult::column_name(std::size_t col) const {
+    if (col >= columns()) {
+        throw std::out_of_range("Column index out of range");
+    }
+    return PQfname(_result, static_cast<int>(col));
+}
+
+int PostgreRawResult::column(const std::string& colName) const {
+    int col = _result ? PQfnumber(_result, colName.c_str()) : -1;
+    if (col < 0) {
+        throw std::out_of_range("Unknown column: " + colName);
+    }
+    return col;
+}
+
+// Check if field is NULL
+bool PostgreRawResult::is_null(std::size_t row, std::size_t col) const {
+    check(row, col);
+    return PQgetisnull(_result, static_cast<int>(row), static_cast<int>(col));
+}
+
+// Raw field bytes (valid while the result lives)
+std::string_view PostgreRawResult::value(std::size_t row,
+                                         std::size_t col) const {
+    check(row, col);
+    return std::string_view(
+        PQgetvalue(_result, static_cast<int>(row), static_cast<int>(col)),
+        PQgetlength(_result, static_cast<int>(row), static_cast<int>(col)));
+}
+
+// Whether col was returned in binary wire format
+bool PostgreRawResult::binary(std::size_t col) const {
+    if (col >= columns()) {
+        throw std::out_of_range("Column index out of range");
+    }
+    return PQfformat(_result, static_cast<int>(col)) == 1;
+}
+
+// Type OID of col
+unsigned PostgreRawResult::type(std::size_t col) const {
+    if (col >= columns()) {
+        throw std::out_of_range("Column index out of range");
+    }
+    return PQftype(_result, static_cast<int>(col));
+}
+
+PGresult* PostgreRawResult::handle() const noexcept { return _result; }
+
+void PostgreRawResult::check(std::size_t row, std::size_t col) const {
+    if (row >= size()) {
+        throw std::out_of_range("Row index out of range");
+    }
+    if (col >= columns()) {
+        throw std::out_of_range("Column index out of range");
+    }
+}
+
+// Opens the connection (blocking) and switches it to non-blocking I/O
+PostgreRawConnection::PostgreRawConnection(const std::string& connectionString)
+    : _conn(PQconnectdb(connectionString.c_str())) {
+    if (_conn == nullptr || PQstatus(_conn) != CONNECTION_OK) {
+        std::string msg = _conn ? error() : "out of memory";
+        if (_conn) PQfinish(_conn);
+        _conn = nullptr;
+        throw ConnectionError(msg);
+    }
+    if (PQsetnonblocking(_conn, 1) != 0) {
+        std::string msg = error();
+        PQfinish(_conn);
+        _conn = nullptr;
+        throw ConnectionError(msg);
+    }
+}
+
+PostgreRawConnection::~PostgreRawConnection() noexcept {
+    if (_conn) PQfinish(_conn);
+}
+
+bool PostgreRawConnection::connected() const noexcept {
+    return _conn && PQstatus(_conn) == CONNECTION_OK;
+}
+
+int PostgreRawConnection::socket() const noexcept {
+    return _conn ? PQsocket(_conn) : -1;
+}
+
+// Start a query without waiting for its result
+void PostgreRawConnection::send(const std::string& sql, const Params& params,
+                                int resultFormat) {
+    std::vector<const char*> values;
+    values.reserve(params.size());
+    for (const auto& param : params)
+        values.push_back(param ? param->c_str() : nullptr);
+
+    if (!PQsendQueryParams(_conn, sql.c_str(), static_cast<int>(values.size()),
+                           nullptr, values.data(), nullptr, nullptr,
+                           resultFormat))
+        throw QueryError(error());
+}
+
+// Push buffered output, true once everything was sent
+bool PostgreRawConnection::flush() {
+    int status = PQflush(_conn);
+    if (status < 0) throw ConnectionError(error());
+    return status == 0;
+}
+
+// Read available input, true once a result can be taken without blocking
+bool PostgreRawConnection::consume() {
+    if (!PQconsumeInput(_conn)) throw ConnectionError(error());
+    return !PQisBusy(_conn);
+}
+
+// Next result of the current query (nullptr once the query is complete)
+PGresult* PostgreRawConnection::next_result() noexcept {
+    return PQgetResult(_conn);
+}
+
+void PostgreRawConnection::enter_pipeline() {
+    if (!PQenterPipelineMode(_conn)) throw ConnectionError(error());
+}
+
+void PostgreRawConnection::sync_pipeline() {
+    if (!PQpipelineSync(_conn)) throw ConnectionError(error());
+}
+
+void PostgreRawConnection::exit_pipeline() {
+    if (!PQexitPipelineMode(_conn)) throw ConnectionError(error());
+}
+
+// Result of the next query in the pipeline, or its PGRES_PIPELINE_SYNC
+std::unique_ptr<PostgreRawResult> PostgreRawConnection::pipeline_result() {
+    auto result = std::make_unique<PostgreRawResult>(PQgetResult(_conn));
+    if (result->handle() == nullptr) throw ConnectionError(error());
+
+    // A query's results end with nullptr, the sync's do not
+    if (PQresultStatus(result->handle()) != PGRES_PIPELINE_SYNC) {
+        while (PGresult* extra = PQgetResult(_conn)) PQclear(extra);
+    }
+    return result;
+}
+
+// Run a query and wait for its last result (throws QueryError)
+std::unique_ptr<PostgreRawResult> PostgreRawConnection::exec(
+    const std::string& sql, const Params& params, int resultFormat) {
+    std::vector<const char*> values;
+    values.reserve(params.size());
+    for (const auto& param : params)
+        values.push_back(param ? param->c_str() : nullptr);
+
+    // PQexecParams blocks regardless of the non-blocking setting
+    return finish(PQexecParams(_conn, sql.c_str(),
+                               static_cast<int>(values.size()), nullptr,
+                               values.data(), nullptr, nullptr, resultFormat));
+}
+
+// Create a named prepared statement (blocking)
+void PostgreRawConnection::prepare(const std::string& name,
+                                   const std::string& sql) {
+    finish(PQprepare(_conn, name.c_str(), sql.c_str(), 0, nullptr));
+}
+
+// Run a prepared statement and wait for its result (throws QueryError)
+std::unique_ptr<PostgreRawResult> PostgreRawConnection::exec_prepared(
+    const std::string& name, const Params& params, int resultFormat) {
+    std::vector<const char*> values;
+    values.reserve(params.size());
+    for (const auto& param : params)
+        values.push_back(param ? param->c_str() : nullptr);
+
+    return finish(PQexecPrepared(_conn, name.c_str(),
+                                 static_cast<int>(values.size()),
+                                 values.data(), nullptr, nullptr,
+                                 resultFormat));
+}
+
+// Ask the server to cancel the running query (thread-safe)
+bool PostgreRawConnection::cancel() noexcept {
+    if (_conn == nullptr) return false;
+
+    PGcancel* handle = PQgetCancel(_conn);
+    if (handle == nullptr) return false;
+
+    char buffer[256];
+    bool sent = PQcancel(handle, buffer, sizeof(buffer)) == 1;
+    PQfreeCancel(handle);
+    return sent;
+}
+
+// Next notification read so far, nullptr if none (free with PQfreemem)
+PGnotify* PostgreRawConnection::next_notification() noexcept {
+    return _conn ? PQnotifies(_conn) : nullptr;
+}
+
+// name quoted as an SQL identifier
+std::string PostgreRawConnection::quote_identifier(
+    const std::string& name) const {
+    char* quoted = PQescapeIdentifier(_conn, name.c_str(), name.size());
+    if (quoted == nullptr) throw QueryError(error());
+    std::string result(quoted);
+    PQfreemem(quoted);
+    return result;
+}
+
+// Last connection-level error message
+std::string PostgreRawConnection::error() const {
+    return _conn ? PQerrorMessage(_conn) : "not connected";
+}
+
+// Take ownership of a blocking call's result, throwing on failure
+std::unique_ptr<PostgreRawResult> PostgreRawConnection::finish(
+    PGresult* result) {
+    auto owned = std::make_unique<PostgreRawResult>(result);
+    if (owned->handle() == nullptr) throw ConnectionError(error());
+    check(owned->handle());
+    return owned;
+}
+
+// Throw QueryError if result reports a failure
+void PostgreRawConnection::check(const PGresult* result) {
+    switch (PQresultStatus(result)) {
+        case PGRES_COMMAND_OK:
+        case PGRES_TUPLES_OK:
+        case PGRES_EMPTY_QUERY:
+            return;
+        default: {
+            const char* state = PQresultErrorField(result, PG_DIAG_SQLSTATE);
+            throw QueryError(PQresultErrorMessage(result), state ? state : "");
+        }
+    }
+}
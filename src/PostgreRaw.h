@@ -0,0 +1,211 @@
+#pragma once
+
+#include <libpq-fe.h>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ColumnDecoder.h"
+#include "IDatabase.h"
+#include "PostgreBinary.h"
+
+// PostgreRawResult class - query result owned directly from libpq, used by
+// the paths libpqxx does not expose (non-blocking execution)
+class PostgreRawResult : public IResult {
+   public:
+    explicit PostgreRawResult(PGresult* result) noexcept;
+
+    PostgreRawResult(const PostgreRawResult&) noexcept = delete;
+    PostgreRawResult& operator=(const PostgreRawResult&) noexcept = delete;
+
+    ~PostgreRawResult() noexcept;
+
+    std::unique_ptr<IResult> clone() const override;
+    std::size_t memory_usage() const noexcept override;
+
+    // Result properties
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    std::size_t columns() const noexcept;
+    std::size_t affected_rows() const noexcept;
+
+    // Column information
+    std::string column_name(std::size_t col) const;
+    int column(const std::string& colName) const;
+
+    // Check if field is NULL
+    bool is_null(std::size_t row, std::size_t col) const;
+
+    // Raw field bytes (valid while the result lives)
+    std::string_view value(std::size_t row, std::size_t col) const;
+
+    // Whether col was returned in binary wire format
+    bool binary(std::size_t col) const;
+
+    // Type OID of col
+    unsigned type(std::size_t col) const;
+
+    // Get value converted to T, decoding text or binary format per column
+    template <typename T>
+    T get(std::size_t row, std::size_t col) const {
+        auto bytes = value(row, col);
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            return bytes;
+        } else {
+            T result{};
+            decode(binary(col), type(col), bytes, result);
+            return result;
+        }
+    }
+
+    template <typename T>
+    std::optional<T> get_optional(std::size_t row, std::size_t col) const {
+        return is_null(row, col) ? std::nullopt
+                                 : std::make_optional(get<T>(row, col));
+    }
+
+    // Decode one column into a contiguous typed array with a null bitmap
+    template <typename T>
+    Column<T> to_column(std::size_t col) const {
+        if (col >= columns()) {
+            throw std::out_of_range("Column index out of range");
+        }
+
+        const bool isBinary = binary(col);
+        const unsigned oid = type(col);
+        const int rows = static_cast<int>(size());
+        const int field = static_cast<int>(col);
+
+        Column<T> column;
+        column.reserve(rows);
+        for (int row = 0; row < rows; ++row) {
+            if (PQgetisnull(_result, row, field)) {
+                column.push_null();
+                continue;
+            }
+            T result{};
+            decode(isBinary, oid,
+                   std::string_view(PQgetvalue(_result, row, field),
+                                    PQgetlength(_result, row, field)),
+                   result);
+            column.push_back(std::move(result));
+        }
+        return column;
+    }
+
+    // Decode the leading sizeof...(T) columns, one pass per column
+    template <typename... T>
+    std::tuple<Column<T>...> to_columns() const {
+        if (sizeof...(T) > columns()) {
+            throw std::invalid_argument(
+                "More column types requested than the result has columns");
+        }
+        return to_columns<T...>(std::index_sequence_for<T...>{});
+    }
+
+    PGresult* handle() const noexcept;
+
+   private:
+    template <typename T>
+    static void decode(bool binary, unsigned oid, std::string_view bytes,
+                       T& value) {
+        static_assert(ColumnDecoder::supports<T>, "Unsupported result type");
+        if (binary)
+            PostgreBinary::decode(oid, bytes, value);
+        else
+            ColumnDecoder::decode(bytes.data(), bytes.size(), value);
+    }
+
+    template <typename... T, std::size_t... Col>
+    std::tuple<Column<T>...> to_columns(std::index_sequence<Col...>) const {
+        return std::tuple<Column<T>...>(to_column<T>(Col)...);
+    }
+
+    void check(std::size_t row, std::size_t col) const;
+
+    PGresult* _result;
+};
+
+// PostgreRawConnection class - libpq connection driven in non-blocking mode
+class PostgreRawConnection final {
+   public:
+    using Params = std::vector<std::optional<std::string>>;
+
+    // Opens the connection (blocking) and switches it to non-blocking I/O
+    explicit PostgreRawConnection(const std::string& connectionString);
+
+    PostgreRawConnection(const PostgreRawConnection&) noexcept = delete;
+    PostgreRawConnection& operator=(const PostgreRawConnection&) noexcept =
+        delete;
+
+    ~PostgreRawConnection() noexcept;
+
+    bool connected() const noexcept;
+    int socket() const noexcept;
+
+    // Start a query without waiting for its result
+    void send(const std::string& sql, const Params& params,
+              int resultFormat = 0);
+
+    // Push buffered output, true once everything was sent
+    bool flush();
+
+    // Read available input, true once a result can be taken without blocking
+    bool consume();
+
+    // Next result of the current query (nullptr once the query is complete)
+    PGresult* next_result() noexcept;
+
+    // Pipeline mode: queries sent until sync_pipeline() go out together and
+    // their results are read back in order with pipeline_result()
+    void enter_pipeline();
+    void sync_pipeline();
+    void exit_pipeline();
+
+    // Result of the next query in the pipeline, or its PGRES_PIPELINE_SYNC
+    // (throws ConnectionError if none comes)
+    std::unique_ptr<PostgreRawResult> pipeline_result();
+
+    // Run a query and wait for its last result (throws QueryError).
+    // resultFormat 1 asks the server for binary wire-format values.
+    std::unique_ptr<PostgreRawResult> exec(const std::string& sql,
+                                           const Params& params,
+                                           int resultFormat = 0);
+
+    // Create a named prepared statement (blocking)
+    void prepare(const std::string& name, const std::string& sql);
+
+    // Run a prepared statement and wait for its result (throws QueryError)
+    std::unique_ptr<PostgreRawResult> exec_prepared(const std::string& name,
+                                                    const Params& params,
+                                                    int resultFormat = 0);
+
+    // Ask the server to cancel the running query (thread-safe)
+    bool cancel() noexcept;
+
+    // Next notification read so far, nullptr if none (free with PQfreemem)
+    PGnotify* next_notification() noexcept;
+
+    // name quoted as an SQL identifier
+    std::string quote_identifier(const std::string& name) const;
+
+    // Last connection-level error message
+    std::string error() const;
+
+    // Throw QueryError if result reports a failure
+    static void check(const PGresult* result);
+
+   private:
+    // Take ownership of a blocking call's result, throwing on failure
+    std::unique_ptr<PostgreRawResult> finish(PGresult* result);
+
+    PGconn* _conn;
+};
@@ -0,0 +1,125 @@
+#include "PostgreStatementCache.h"
+
+#include <utility>
+
+#include "Errors.h"
+
+PostgreStatementCache::PostgreStatementCache(
+    std::size_t capacity, std::size_t prepareThreshold) noexcept
+    : _entries(capacity),
+      _prepareThreshold(prepareThreshold == 0 ? 1 : prepareThreshold),
+      _nextId(0) {}
+
+// Resize the cache, dropping (and deallocating) entries that no longer fit
+void PostgreStatementCache::configure(pqxx::connection* conn,
+                                      std::size_t capacity,
+                                      std::size_t prepareThreshold) {
+    LruCache<std::string, Entry> entries(capacity);
+
+    // Keep the most recently used entries, oldest inserted first
+    while (auto entry = _entries.pop_back()) {
+        if (entries.size() + _entries.size() < capacity)
+            entries.insert(entry->first, std::move(entry->second));
+        else
+            evict(conn, entry->second);
+    }
+
+    _entries = std::move(entries);
+    _prepareThreshold = prepareThreshold == 0 ? 1 : prepareThreshold;
+}
+
+// Statement name to execute for sql, preparing it on first use.
+// Returns nullopt when sql should be sent as plain text.
+std::optional<std::string> PostgreStatementCache::lookup(
+    pqxx::connection& conn, const std::string& sql) {
+    if (_entries.capacity() == 0) {
+        ++_stats.misses;
+        return std::nullopt;
+    }
+
+    auto entry = _entries.find(sql);
+    if (entry == nullptr) {
+        Entry fresh;
+        fresh.name = "dbf_stmt_" + std::to_string(++_nextId);
+        if (auto evicted = _entries.insert(sql, std::move(fresh)))
+            evict(&conn, evicted->second);
+        entry = _entries.find(sql);
+    }
+
+    if (entry->prepared) {
+        ++_stats.hits;
+        return entry->name;
+    }
+
+    if (++entry->uses < _prepareThreshold) {
+        ++_stats.misses;
+        return std::nullopt;
+    }
+
+    try {
+        conn.prepare(entry->name, sql);
+    } catch (const pqxx::sql_error& e) {
+        _entries.erase(sql);
+        throw QueryError(e.what(), e.sqlstate());
+    } catch (const std::exception& e) {
+        _entries.erase(sql);
+        throw DatabaseError(e.what());
+    }
+    entry->prepared = true;
+    ++_stats.prepares;
+    ++_stats.misses;
+    return entry->name;
+}
+
+// Drop a statement whose cached plan went stale
+void PostgreStatementCache::invalidate(pqxx::connection& conn,
+                                       const std::string& sql) noexcept {
+    auto entry = _entries.peek(sql);
+    if (entry == nullptr) return;
+
+    if (entry->prepared) {
+        try {
+            conn.unprepare(entry->name);
+        } catch (...) {
+            // Statement may already be gone on the server
+        }
+    }
+    _entries.erase(sql);
+    ++_stats.invalidations;
+}
+
+// Forget all entries (server-side statements died with the connection)
+void PostgreStatementCache::clear() noexcept { _entries.clear(); }
+
+// Whether the error means the prepared statement must be re-prepared
+bool PostgreStatementCache::stale(const QueryError& error) noexcept {
+    // 0A000: "cached plan must not change result type"
+    // 26000: prepared statement does not exist (e.g. after DISCARD ALL)
+    return error.sqlstate() == "0A000" || error.sqlstate() == "26000";
+}
+
+std::size_t PostgreStatementCache::size() const noexcept {
+    return _entries.size();
+}
+std::size_t PostgreStatementCache::capacity() const noexcept {
+    return _entries.capacity();
+}
+std::size_t PostgreStatementCache::prepare_threshold() const noexcept {
+    return _prepareThreshold;
+}
+
+const PostgreStatementStats& PostgreStatementCache::stats() const noexcept {
+    return _stats;
+}
+
+void PostgreStatementCache::evict(pqxx::connection* conn,
+                                  const Entry& entry) noexcept {
+    if (entry.prepared && conn != nullptr && conn->is_open()) {
+        try {
+            conn->unprepare(entry.name);
+        } catch (...) {
+            // Deallocation failure only leaks a server-side statement
+        }
+    }
+    ++_stats.evictions;
+}
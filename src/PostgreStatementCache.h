@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <pqxx/pqxx>
+#include <string>
+
+#include "LruCache.h"
+
+class QueryError;
+
+// Statement cache counters
+struct PostgreStatementStats {
+    std::size_t hits = 0;           // executions through a prepared statement
+    std::size_t misses = 0;         // executions sent as plain SQL text
+    std::size_t prepares = 0;       // statements prepared on the server
+    std::size_t evictions = 0;      // statements dropped to stay in capacity
+    std::size_t invalidations = 0;  // statements dropped after a stale plan
+};
+
+// Per-connection LRU cache of server-side prepared statements keyed by SQL
+class PostgreStatementCache final {
+   public:
+    // capacity 0 disables the cache; a statement is prepared once it has
+    // been seen prepareThreshold times
+    explicit PostgreStatementCache(std::size_t capacity = 128,
+                                   std::size_t prepareThreshold = 1) noexcept;
+
+    // Resize the cache, dropping (and deallocating) entries that no longer fit
+    void configure(pqxx::connection* conn, std::size_t capacity,
+                   std::size_t prepareThreshold);
+
+    // Statement name to execute for sql, preparing it on first use.
+    // Returns nullopt when sql should be sent as plain text.
+    std::optional<std::string> lookup(pqxx::connection& conn,
+                                      const std::string& sql);
+
+    // Drop a statement whose cached plan went stale
+    void invalidate(pqxx::connection& conn, const std::string& sql) noexcept;
+
+    // Forget all entries (server-side statements died with the connection)
+    void clear() noexcept;
+
+    // Whether the error means the prepared statement must be re-prepared
+    static bool stale(const QueryError& error) noexcept;
+
+    std::size_t size() const noexcept;
+    std::size_t capacity() const noexcept;
+    std::size_t prepare_threshold() const noexcept;
+
+    const PostgreStatementStats& stats() const noexcept;
+
+   private:
+    struct Entry {
+        std::string name;
+        std::size_t uses = 0;
+        bool prepared = false;
+    };
+
+    void evict(pqxx::connection* conn, const Entry& entry) noexcept;
+
+    LruCache<std::string, Entry> _entries;
+    std::size_t _prepareThreshold;
+    std::size_t _nextId;
+    PostgreStatementStats _stats;
+};
@@ -0,0 +1,119 @@
+#include "PostgreStream.h"
+
+#include "Errors.h"
+#include "Metrics.h"
+#include "PostgreParams.h"
+
+PostgreStream::iterator::iterator(PostgreStream* stream) : _stream(stream) {}
+
+PostgreRow PostgreStream::iterator::operator*() const {
+    return PostgreRow(_stream->_batch[_stream->_index]);
+}
+
+bool PostgreStream::iterator::operator==(
+    const PostgreStream::iterator& itr) const {
+    bool atEnd = _stream == nullptr || _stream->done();
+    bool itrAtEnd = itr._stream == nullptr || itr._stream->done();
+    return atEnd == itrAtEnd;
+}
+
+bool PostgreStream::iterator::operator!=(
+    const PostgreStream::iterator& itr) const {
+    return !(*this == itr);
+}
+
+PostgreStream::iterator& PostgreStream::iterator::operator++() {
+    _stream->advance();
+    return *this;
+}
+
+void PostgreStream::iterator::operator++(int) { _stream->advance(); }
+
+// Declares the cursor for sql with params bound
+PostgreStream::PostgreStream(pqxx::connection& conn, const std::string& sql,
+                             const ParamPack& params, std::size_t fetchSize)
+    : _index(0),
+      _rows(0),
+      _fetchSize(fetchSize == 0 ? 1 : fetchSize),
+      _started(false),
+      _done(false) {
+    // A trailing semicolon would end the DECLARE early
+    std::size_t end = sql.find_last_not_of(" \t\r\n;");
+    end = end == std::string::npos ? 0 : end + 1;
+    _fetch = "FETCH FORWARD " + std::to_string(_fetchSize) + " FROM dbf_cursor";
+    try {
+        _txn = std::make_unique<pqxx::work>(conn);
+        PostgreParams::Bound bound(params);
+        _txn->exec_params("DECLARE dbf_cursor NO SCROLL CURSOR FOR " +
+                              sql.substr(0, end),
+                          bound.get());
+    } catch (const pqxx::sql_error& e) {
+        throw QueryError(e.what(), e.sqlstate());
+    } catch (const std::exception& e) {
+        throw DatabaseError(e.what());
+    }
+}
+
+PostgreStream::~PostgreStream() {
+    try {
+        close();
+    } catch (...) {
+        // Ignore exceptions in destructor
+    }
+}
+
+PostgreStream::iterator PostgreStream::begin() {
+    if (!_started) advance();
+    return iterator(this);
+}
+PostgreStream::iterator PostgreStream::end() { return iterator(nullptr); }
+
+// Rows handed out so far
+std::size_t PostgreStream::rows() const noexcept { return _rows; }
+
+std::size_t PostgreStream::fetch_size() const noexcept { return _fetchSize; }
+
+// Whether the cursor is exhausted
+bool PostgreStream::done() const noexcept { return _done; }
+
+// Close the cursor and end the transaction early
+void PostgreStream::close() {
+    _done = true;
+    _batch = pqxx::result();
+    if (_txn) {
+        auto txn = std::move(_txn);
+        // Read-only use, aborting just closes the cursor
+        txn->abort();
+    }
+}
+
+// Move to the next row, fetching the next batch when needed
+void PostgreStream::advance() {
+    if (_done) return;
+
+    if (_started && ++_index < static_cast<std::size_t>(_batch.size())) {
+        ++_rows;
+        return;
+    }
+    _started = true;
+
+    try {
+        _batch = pqxx::result();  // release the previous batch first
+        const auto start = Metrics::start();
+        _batch = _txn->exec(_fetch);
+        Metrics::record(MetricsPhase::Fetch, start);
+    } catch (const pqxx::sql_error& e) {
+        close();
+        throw QueryError(e.what(), e.sqlstate());
+    } catch (const std::exception& e) {
+        close();
+        throw DatabaseError(e.what());
+    }
+
+    _index = 0;
+    if (_batch.empty()) {
+        close();
+        return;
+    }
+    ++_rows;
+}
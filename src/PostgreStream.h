@@ -0,0 +1,75 @@
+#pragma once
+
+#include <any>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <pqxx/pqxx>
+#include <string>
+#include <vector>
+
+#include "PostgreDatabase.h"
+
+// PostgreStream class - single-pass result read through a server-side
+// cursor, holding at most fetch_size rows in client memory at a time
+class PostgreStream {
+   public:
+    // Declares the cursor for sql with params bound ($1, $2, ...)
+    PostgreStream(pqxx::connection& conn, const std::string& sql,
+                  const ParamPack& params, std::size_t fetchSize);
+
+    PostgreStream(PostgreStream&&) noexcept = default;
+    PostgreStream& operator=(PostgreStream&&) noexcept = delete;
+
+    ~PostgreStream();
+
+    // Single-pass input iterator
+    class iterator {
+       public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = PostgreRow;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const PostgreRow*;
+        using reference = PostgreRow;
+
+        explicit iterator(PostgreStream* stream = nullptr);
+
+        PostgreRow operator*() const;
+
+        bool operator==(const iterator& itr) const;
+        bool operator!=(const iterator& itr) const;
+
+        iterator& operator++();
+        void operator++(int);
+
+       private:
+        PostgreStream* _stream;
+    };
+
+    iterator begin();
+    iterator end();
+
+    // Rows handed out so far
+    std::size_t rows() const noexcept;
+
+    std::size_t fetch_size() const noexcept;
+
+    // Whether the cursor is exhausted
+    bool done() const noexcept;
+
+    // Close the cursor and end the transaction early
+    void close();
+
+   private:
+    // Move to the next row, fetching the next batch when needed
+    void advance();
+
+    std::unique_ptr<pqxx::work> _txn;
+    std::string _fetch;  // FETCH statement for the next batch
+    pqxx::result _batch;
+    std::size_t _index;
+    std::size_t _rows;
+    std::size_t _fetchSize;
+    bool _started;
+    bool _done;
+};
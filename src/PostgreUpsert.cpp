@@ -0,0 +1,281 @@
+#include "PostgreUpsert.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#include "Errors.h"
+#include "Metrics.h"
+#include "PostgreParams.h"
+
+namespace {
+
+// Name of the WITH ORDINALITY column, not a valid unquoted column name
+constexpr std::string_view Ordinal = "\"upsert ordinal\"";
+
+std::string join(const std::vector<std::string>& names) {
+    std::string joined;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (i > 0) joined += ',';
+        joined += names[i];
+    }
+    return joined;
+}
+
+}  // namespace
+
+PostgreUpsert::PostgreUpsert(pqxx::connection& conn, const std::string& table,
+                             const std::vector<std::string>& columns,
+                             const std::vector<std::string>& keyColumns,
+                             const PostgreUpsertOptions& options)
+    : _conn(&conn),
+      _options(options),
+      _arrays(columns.size()),
+      _chunkRows(0),
+      _chunkBytes(0),
+      _start(std::chrono::steady_clock::now()) {
+    if (columns.empty())
+        throw std::invalid_argument("Upsert needs at least one column");
+    if (keyColumns.empty())
+        throw std::invalid_argument("Upsert needs at least one key column");
+    for (const auto& key : keyColumns) {
+        if (std::find(columns.begin(), columns.end(), key) == columns.end())
+            throw std::invalid_argument("Upsert key " + key +
+                                        " is not one of the columns");
+    }
+    if (_options.chunk_bytes == 0 || _options.chunk_bytes > MaxChunkBytes)
+        _options.chunk_bytes = MaxChunkBytes;
+
+    auto types = column_types(conn, table, columns);
+
+    std::vector<std::string> names, keys, updates;
+    for (const auto& column : columns) names.push_back(conn.quote_name(column));
+    for (const auto& key : keyColumns) keys.push_back(conn.quote_name(key));
+    for (std::size_t i = 0; i < columns.size(); ++i) {
+        if (std::find(keyColumns.begin(), keyColumns.end(), columns[i]) ==
+            keyColumns.end())
+            updates.push_back(names[i] + "=EXCLUDED." + names[i]);
+    }
+
+    const std::string list = join(names);
+    _sql = "INSERT INTO " + PostgreParams::quote_table(conn, table) + " (" +
+           list + ") SELECT ";
+    if (_options.deduplicate) _sql += "DISTINCT ON (" + join(keys) + ") ";
+    _sql += list + " FROM unnest(";
+    for (std::size_t i = 0; i < types.size(); ++i) {
+        if (i > 0) _sql += ',';
+        _sql += '$' + std::to_string(i + 1) + "::" + types[i] + "[]";
+    }
+    _sql += ")";
+    if (_options.deduplicate) {
+        // The last row written for a key wins
+        _sql += " WITH ORDINALITY AS u(" + list + ',' + std::string(Ordinal) +
+                ") ORDER BY " + join(keys) + ',' + std::string(Ordinal) +
+                " DESC";
+    } else {
+        _sql += " AS u(" + list + ")";
+    }
+    _sql += " ON CONFLICT (" + join(keys) + ") DO ";
+    _sql += updates.empty() ? "NOTHING" : "UPDATE SET " + join(updates);
+
+    open_arrays();
+}
+
+PostgreUpsert::~PostgreUpsert() {
+    if (!_txn) return;
+    try {
+        _txn->abort();
+    } catch (...) {
+        // Ignore exceptions in destructor
+    }
+}
+
+// Write one row, one value per column
+void PostgreUpsert::write_params(const ParamPack& row) {
+    if (row.size() != _arrays.size())
+        throw std::invalid_argument("Upsert row has " +
+                                    std::to_string(row.size()) +
+                                    " values for " +
+                                    std::to_string(_arrays.size()) +
+                                    " columns");
+
+    for (std::size_t i = 0; i < _arrays.size(); ++i) {
+        auto& array = _arrays[i];
+        const auto size = array.size();
+        if (_chunkRows > 0) array += ',';
+        append_element(array, row[i]);
+        _chunkBytes += array.size() - size;
+    }
+    ++_chunkRows;
+
+    if ((_options.chunk_rows != 0 && _chunkRows >= _options.chunk_rows) ||
+        _chunkBytes >= _options.chunk_bytes)
+        flush();
+}
+
+// Send rows written so far as one chunk
+void PostgreUpsert::flush() {
+    if (_chunkRows == 0) return;
+
+    // Arrays are bound in place, without copies
+    pqxx::params params;
+    params.reserve(_arrays.size());
+    for (auto& array : _arrays) {
+        array += '}';
+        params.append(pqxx::zview(array.c_str(), array.size()));
+    }
+
+    const std::size_t rows = _chunkRows, bytes = _chunkBytes;
+    auto discard = [this]() {
+        open_arrays();
+        if (_txn) {
+            auto txn = std::move(_txn);
+            txn->abort();
+        }
+    };
+
+    const auto start = Metrics::start();
+    std::size_t affected = 0;
+    try {
+        if (_options.atomic) {
+            if (!_txn) _txn = std::make_unique<pqxx::work>(*_conn);
+            affected = _txn->exec_params(_sql, params).affected_rows();
+        } else {
+            pqxx::work txn(*_conn);
+            affected = txn.exec_params(_sql, params).affected_rows();
+            txn.commit();
+        }
+    } catch (const pqxx::sql_error& e) {
+        Metrics::record(_sql, start, 0, 0, true);
+        discard();
+        throw QueryError(e.what(), e.sqlstate());
+    } catch (const std::exception& e) {
+        Metrics::record(_sql, start, 0, 0, true);
+        discard();
+        throw DatabaseError(e.what());
+    }
+    Metrics::record(_sql, start, affected, bytes);
+
+    open_arrays();
+    _stats.rows += rows;
+    _stats.affected += affected;
+    _stats.chunks.push_back(affected);
+    _stats.elapsed = std::chrono::steady_clock::now() - _start;
+}
+
+// Send remaining rows, commit and close the upsert
+PostgreUpsertStats PostgreUpsert::finish() {
+    flush();
+    if (_txn) {
+        auto txn = std::move(_txn);
+        const auto start = Metrics::start();
+        try {
+            txn->commit();
+        } catch (const std::exception& e) {
+            throw DatabaseError(e.what());
+        }
+        Metrics::record(MetricsPhase::Commit, start);
+    }
+    _stats.elapsed = std::chrono::steady_clock::now() - _start;
+    return _stats;
+}
+
+const PostgreUpsertStats& PostgreUpsert::stats() const noexcept {
+    return _stats;
+}
+
+// Statement run for every chunk
+const std::string& PostgreUpsert::sql() const noexcept { return _sql; }
+
+// Column type names (format_type) in the order of columns
+std::vector<std::string> PostgreUpsert::column_types(
+    pqxx::connection& conn, const std::string& table,
+    const std::vector<std::string>& columns) {
+    pqxx::result result;
+    try {
+        pqxx::work txn(conn);
+        result = txn.exec_params(
+            "SELECT a.attname, format_type(a.atttypid, a.atttypmod), "
+            "t.typcategory = 'A' FROM pg_attribute a "
+            "JOIN pg_type t ON t.oid = a.atttypid "
+            "WHERE a.attrelid = $1::regclass AND a.attnum > 0 "
+            "AND NOT a.attisdropped",
+            PostgreParams::quote_table(conn, table));
+        txn.commit();
+    } catch (const pqxx::sql_error& e) {
+        throw QueryError(e.what(), e.sqlstate());
+    } catch (const std::exception& e) {
+        throw DatabaseError(e.what());
+    }
+
+    std::vector<std::string> types;
+    types.reserve(columns.size());
+    for (const auto& column : columns) {
+        bool found = false;
+        for (const auto& row : result) {
+            if (row[0].view() != column) continue;
+            if (row[2].as<bool>())
+                throw std::invalid_argument(
+                    "Upsert cannot bind array column " + column);
+            types.push_back(row[1].as<std::string>());
+            found = true;
+            break;
+        }
+        if (!found)
+            throw QueryError("Column " + column + " not found in " + table);
+    }
+    return types;
+}
+
+// Append one element to a PostgreSQL array literal
+void PostgreUpsert::append_element(std::string& array, const Param& value) {
+    static constexpr char Digits[] = "0123456789abcdef";
+
+    switch (value.type()) {
+        case Param::Type::Null:
+            array += "NULL";
+            return;
+        case Param::Type::Bool:
+        case Param::Type::Int:
+        case Param::Type::Float: {
+            char buffer[Param::TextSize];
+            array += value.to_text(buffer);
+            return;
+        }
+        case Param::Type::Bytea: {
+            // bytea hex input, its backslash escaped for the array
+            auto bytes = value.as_text();
+            array.reserve(array.size() + 6 + 2 * bytes.size());
+            array += "\"\\\\x";
+            for (unsigned char byte : bytes) {
+                array += Digits[byte >> 4];
+                array += Digits[byte & 0xF];
+            }
+            array += '"';
+            return;
+        }
+        default: {
+            char buffer[Param::TextSize];
+            auto text = value.to_text(buffer);
+            array += '"';
+            while (!text.empty()) {
+                auto special = text.find_first_of("\"\\");
+                array.append(text.substr(0, special));
+                if (special == std::string_view::npos) break;
+                array += '\\';
+                array += text[special];
+                text.remove_prefix(special + 1);
+            }
+            array += '"';
+            return;
+        }
+    }
+}
+
+void PostgreUpsert::open_arrays() {
+    for (auto& array : _arrays) {
+        array.clear();
+        array += '{';
+    }
+    _chunkRows = _chunkBytes = 0;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <pqxx/pqxx>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "ParamPack.h"
+
+// Bulk upsert options
+struct PostgreUpsertOptions {
+    // Send a chunk after this many rows (0 = no row limit)
+    std::size_t chunk_rows = 50000;
+    // Send a chunk once its array parameters reach about this many bytes
+    // (0 or more than MaxChunkBytes = MaxChunkBytes)
+    std::size_t chunk_bytes = 16 * 1024 * 1024;
+    // Keep only the last row of each key within a chunk, since ON CONFLICT
+    // DO UPDATE fails on a chunk that affects the same row twice
+    bool deduplicate = true;
+    // Run every chunk in one transaction committed by finish() instead of
+    // committing each chunk on its own
+    bool atomic = false;
+};
+
+// Bulk upsert counters
+struct PostgreUpsertStats {
+    std::size_t rows = 0;             // rows sent
+    std::size_t affected = 0;         // rows inserted or updated
+    std::vector<std::size_t> chunks;  // affected rows of each chunk
+    std::chrono::steady_clock::duration elapsed{};
+};
+
+// PostgreUpsert class - inserts or updates many rows with one statement per
+// chunk:
+//   INSERT INTO t (c...) SELECT c... FROM unnest($1::type[], ...) AS u(c...)
+//   ON CONFLICT (keys) DO UPDATE SET c = EXCLUDED.c, ...
+// Each column travels as a single array parameter, so a chunk costs one
+// round trip and one plan whatever its row count. Column types are read
+// from the catalog once; array-typed columns are not supported. Rows not
+// yet sent, and an unfinished atomic upsert, are dropped on destruction.
+class PostgreUpsert {
+   public:
+    // Keeps the bind messages far below the 1 GiB protocol limit
+    static constexpr std::size_t MaxChunkBytes = 256 * 1024 * 1024;
+
+    PostgreUpsert(pqxx::connection& conn, const std::string& table,
+                  const std::vector<std::string>& columns,
+                  const std::vector<std::string>& keyColumns,
+                  const PostgreUpsertOptions& options = PostgreUpsertOptions{});
+
+    PostgreUpsert(PostgreUpsert&&) noexcept = default;
+    PostgreUpsert& operator=(PostgreUpsert&&) noexcept = delete;
+
+    ~PostgreUpsert();
+
+    // Write one row given as values
+    template <typename... Args>
+    void write(const Args&... values) {
+        write_params(ParamPack::of(values...));
+    }
+
+    // Write one row given as a tuple
+    template <typename... Args>
+    void write_row(const std::tuple<Args...>& row) {
+        std::apply([this](const auto&... values) { write(values...); }, row);
+    }
+
+    // Write rows of any type, converting each with toTuple
+    template <typename Range, typename ToTuple>
+    void write_all(const Range& rows, ToTuple&& toTuple) {
+        for (const auto& row : rows) write_row(toTuple(row));
+    }
+
+    // Write one row, one value per column
+    void write_params(const ParamPack& row);
+
+    // Send rows written so far as one chunk
+    void flush();
+
+    // Send remaining rows, commit and close the upsert
+    PostgreUpsertStats finish();
+
+    const PostgreUpsertStats& stats() const noexcept;
+
+    // Statement run for every chunk
+    const std::string& sql() const noexcept;
+
+   private:
+    // Column type names (format_type) in the order of columns
+    static std::vector<std::string> column_types(
+        pqxx::connection& conn, const std::string& table,
+        const std::vector<std::string>& columns);
+
+    // Append one element to a PostgreSQL array literal
+    static void append_element(std::string& array, const Param& value);
+
+    void open_arrays();
+
+    pqxx::connection* _conn;
+    PostgreUpsertOptions _options;
+    std::string _sql;
+    std::vector<std::string> _arrays;  // one literal per column
+    std::unique_ptr<pqxx::work> _txn;  // atomic upserts only
+    std::size_t _chunkRows;
+    std::size_t _chunkBytes;
+    PostgreUpsertStats _stats;
+    std::chrono::steady_clock::time_point _start;
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <pqxx/pqxx>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "ColumnDecoder.h"
+#include "Errors.h"
+
+// PostgreFieldView class - non-owning view of one field in text format,
+// valid as long as the result it came from
+class PostgreFieldView final {
+   public:
+    PostgreFieldView(const char* data, std::size_t size, bool null) noexcept
+        : _data(data), _size(size), _null(null) {}
+
+    bool is_null() const noexcept { return _null; }
+
+    // Text of the field (empty for NULL)
+    std::string_view view() const noexcept {
+        return std::string_view(_data, _size);
+    }
+    // NUL-terminated text of the field
+    const char* c_str() const noexcept { return _data; }
+    std::size_t size() const noexcept { return _size; }
+
+    // Value converted to T (throws QueryError for NULL)
+    template <typename T>
+    T as() const {
+        T value{};
+        decode(value);
+        return value;
+    }
+
+    template <typename T>
+    std::optional<T> as_optional() const {
+        if (_null) return std::nullopt;
+        return as<T>();
+    }
+
+    // Decode into value; an optional takes NULL, other types throw
+    template <typename T>
+    void decode(T& value) const {
+        if (_null) throw QueryError("NULL field read as a value");
+        if constexpr (std::is_same_v<T, std::string_view>) {
+            value = view();
+        } else if constexpr (ColumnDecoder::supports<T>) {
+            ColumnDecoder::decode(_data, _size, value);
+        } else {
+            value = pqxx::from_string<T>(view());
+        }
+    }
+
+    template <typename T>
+    void decode(std::optional<T>& value) const {
+        if (_null) {
+            value.reset();
+        } else {
+            decode(value.emplace());
+        }
+    }
+
+   private:
+    const char* _data;
+    std::size_t _size;
+    bool _null;
+};
+
+// PostgreRowView class - non-owning view of one row of Result
+// (PostgreResult or PostgreDetachedResult), two words wide
+template <typename Result>
+class PostgreRowView final {
+   public:
+    PostgreRowView(const Result& result, std::size_t row) noexcept
+        : _result(&result), _row(row) {}
+
+    // Field by column index (unchecked) or name
+    PostgreFieldView operator[](std::size_t col) const noexcept {
+        return _result->field(_row, col);
+    }
+    PostgreFieldView operator[](std::string_view colName) const {
+        return _result->field(_row, _result->column_index(colName));
+    }
+
+    // Text of a field (empty for NULL)
+    std::string_view view(std::size_t col) const noexcept {
+        return (*this)[col].view();
+    }
+
+    template <typename T>
+    T get(std::size_t col) const {
+        return (*this)[col].template as<T>();
+    }
+
+    template <typename T>
+    std::optional<T> get_optional(std::size_t col) const {
+        return (*this)[col].template as_optional<T>();
+    }
+
+    bool is_null(std::size_t col) const noexcept {
+        return (*this)[col].is_null();
+    }
+
+    std::size_t size() const noexcept { return _result->columns(); }
+    std::size_t index() const noexcept { return _row; }
+
+   private:
+    const Result* _result;
+    std::size_t _row;
+};
+
+// PostgreRowRange class - rows of Result as views, for range-for
+template <typename Result>
+class PostgreRowRange final {
+   public:
+    class iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = PostgreRowView<Result>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = PostgreRowView<Result>;
+
+        iterator(const Result& result, std::size_t row) noexcept
+            : _result(&result), _row(row) {}
+
+        PostgreRowView<Result> operator*() const noexcept {
+            return PostgreRowView<Result>(*_result, _row);
+        }
+
+        bool operator==(const iterator& itr) const noexcept {
+            return _row == itr._row;
+        }
+        bool operator!=(const iterator& itr) const noexcept {
+            return _row != itr._row;
+        }
+
+        iterator& operator++() noexcept {
+            ++_row;
+            return *this;
+        }
+        iterator operator++(int) noexcept {
+            iterator itr = *this;
+            ++_row;
+            return itr;
+        }
+
+       private:
+        const Result* _result;
+        std::size_t _row;
+    };
+
+    explicit PostgreRowRange(const Result& result) noexcept
+        : _result(&result) {}
+
+    iterator begin() const noexcept { return iterator(*_result, 0); }
+    iterator end() const noexcept { return iterator(*_result, size()); }
+
+    std::size_t size() const noexcept { return _result->size(); }
+
+   private:
+    const Result* _result;
+};
@@ -0,0 +1,377 @@
+#include "RedisConnection.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "ColumnDecoder.h"
+#include "Errors.h"
+
+namespace {
+
+// Initial receive buffer size and the least free space worth a read
+constexpr std::size_t BufferSize = 16 * 1024;
+constexpr std::size_t MinRead = 4 * 1024;
+
+[[noreturn]] void wrong_type(const char* expected) {
+    throw QueryError(std::string("[Redis] Reply is not ") + expected);
+}
+
+}  // namespace
+
+RedisReply::RedisReply(const RedisNode* nodes, std::uint32_t index) noexcept
+    : _nodes(nodes), _index(index) {}
+
+RedisType RedisReply::type() const noexcept { return node().type; }
+
+bool RedisReply::is_null() const noexcept {
+    return node().type == RedisType::Null;
+}
+
+bool RedisReply::is_error() const noexcept {
+    return node().type == RedisType::Error;
+}
+
+// Array, Map, Set or Push
+bool RedisReply::is_aggregate() const noexcept {
+    switch (node().type) {
+        case RedisType::Array:
+        case RedisType::Map:
+        case RedisType::Set:
+        case RedisType::Push:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Text of simple, bulk, verbatim, big number and error replies
+std::string_view RedisReply::str() const {
+    switch (node().type) {
+        case RedisType::Simple:
+        case RedisType::Error:
+        case RedisType::Bulk:
+        case RedisType::BigNumber:
+        case RedisType::Verbatim:
+            return node().text;
+        default:
+            wrong_type("a string");
+    }
+}
+
+// Integer reply, or a string reply holding an integer
+std::int64_t RedisReply::integer() const {
+    const RedisNode& n = node();
+    if (n.type == RedisType::Integer || n.type == RedisType::Boolean)
+        return n.integer;
+
+    std::int64_t value;
+    if ((n.type == RedisType::Bulk || n.type == RedisType::Simple) &&
+        ColumnDecoder::parse_int(n.text.data(), n.text.size(), value))
+        return value;
+    wrong_type("an integer");
+}
+
+// Double reply, or a numeric integer or string reply
+double RedisReply::number() const {
+    const RedisNode& n = node();
+    if (n.type == RedisType::Double) return n.number;
+    if (n.type == RedisType::Integer) return static_cast<double>(n.integer);
+    if (n.type == RedisType::Bulk || n.type == RedisType::Simple) {
+        // Bulk strings are followed by CRLF, so the parser stops in bounds
+        double value;
+        ColumnDecoder::decode(n.text.data(), n.text.size(), value);
+        return value;
+    }
+    wrong_type("a number");
+}
+
+// Boolean reply, or an integer reply (non-zero is true)
+bool RedisReply::boolean() const {
+    const RedisNode& n = node();
+    if (n.type == RedisType::Boolean || n.type == RedisType::Integer)
+        return n.integer != 0;
+    wrong_type("a boolean");
+}
+
+// Elements of aggregates
+std::size_t RedisReply::size() const noexcept { return node().count; }
+
+RedisReply RedisReply::operator[](std::size_t index) const {
+    if (index >= size()) {
+        throw std::out_of_range("Reply element index out of range");
+    }
+    // Elements that are all scalars sit side by side, otherwise skip the
+    // subtrees before index
+    const RedisNode& aggregate = node();
+    std::uint32_t child = _index + 1;
+    if (aggregate.next == child + aggregate.count)
+        return RedisReply(_nodes, child + static_cast<std::uint32_t>(index));
+    while (index-- > 0) child = _nodes[child].next;
+    return RedisReply(_nodes, child);
+}
+
+RedisReply::iterator::iterator(const RedisNode* nodes,
+                               std::uint32_t index) noexcept
+    : _nodes(nodes), _index(index) {}
+
+RedisReply RedisReply::iterator::operator*() const noexcept {
+    return RedisReply(_nodes, _index);
+}
+
+bool RedisReply::iterator::operator==(const iterator& itr) const noexcept {
+    return _index == itr._index;
+}
+
+bool RedisReply::iterator::operator!=(const iterator& itr) const noexcept {
+    return _index != itr._index;
+}
+
+RedisReply::iterator& RedisReply::iterator::operator++() noexcept {
+    _index = _nodes[_index].next;
+    return *this;
+}
+
+RedisReply::iterator RedisReply::iterator::operator++(int) noexcept {
+    auto itr = *this;
+    ++*this;
+    return itr;
+}
+
+RedisReply::iterator RedisReply::begin() const noexcept {
+    return iterator(_nodes, size() ? _index + 1 : node().next);
+}
+
+RedisReply::iterator RedisReply::end() const noexcept {
+    return iterator(_nodes, node().next);
+}
+
+const RedisNode& RedisReply::node() const noexcept { return _nodes[_index]; }
+
+RedisResult::RedisResult(std::shared_ptr<const std::string> buffer,
+                         std::vector<RedisNode> nodes) noexcept
+    : _buffer(std::move(buffer)), _nodes(std::move(nodes)) {}
+
+// Compact copy holding only the bytes its strings refer to
+std::unique_ptr<IResult> RedisResult::clone() const {
+    std::size_t size = 0;
+    for (const auto& node : _nodes) size += node.text.size();
+
+    // Reserved up front, so views into the copy stay valid while it grows
+    auto buffer = std::make_shared<std::string>();
+    buffer->reserve(size);
+    std::vector<RedisNode> nodes = _nodes;
+    for (auto& node : nodes) {
+        const char* start = buffer->data() + buffer->size();
+        buffer->append(node.text.data(), node.text.size());
+        node.text = std::string_view(start, node.text.size());
+    }
+    return std::make_unique<RedisResult>(std::move(buffer), std::move(nodes));
+}
+
+std::size_t RedisResult::memory_usage() const noexcept {
+    std::size_t bytes = sizeof(*this) + _nodes.capacity() * sizeof(RedisNode);
+    for (const auto& node : _nodes) bytes += node.text.size();
+    return bytes;
+}
+
+// Top-level reply
+RedisReply RedisResult::reply() const noexcept {
+    return RedisReply(_nodes.data(), 0);
+}
+
+// Shortcuts for reply()
+RedisType RedisResult::type() const noexcept { return reply().type(); }
+bool RedisResult::is_null() const noexcept { return reply().is_null(); }
+bool RedisResult::is_error() const noexcept { return reply().is_error(); }
+std::string_view RedisResult::str() const { return reply().str(); }
+std::int64_t RedisResult::integer() const { return reply().integer(); }
+std::size_t RedisResult::size() const noexcept { return reply().size(); }
+RedisReply RedisResult::operator[](std::size_t index) const {
+    return reply()[index];
+}
+
+#if !defined(_WIN32)
+
+// Connects (throws ConnectionError)
+RedisConnection::RedisConnection(const std::string& host, int port)
+    : _socket(-1),
+      _buffer(std::make_shared<std::string>(BufferSize, '\0')),
+      _begin(0),
+      _end(0) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addresses = nullptr;
+    int rc = ::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints,
+                           &addresses);
+    if (rc != 0) {
+        throw ConnectionError("[Redis] " + host + ": " + gai_strerror(rc));
+    }
+
+    std::string error = "no address";
+    for (addrinfo* addr = addresses; addr; addr = addr->ai_next) {
+        int fd =
+            ::socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, addr->ai_addr, addr->ai_addrlen) == 0) {
+            _socket = fd;
+            break;
+        }
+        error = std::strerror(errno);
+        ::close(fd);
+    }
+    ::freeaddrinfo(addresses);
+    if (_socket < 0) {
+        throw ConnectionError("[Redis] Cannot connect to " + host + ":" +
+                              std::to_string(port) + ": " + error);
+    }
+
+    // Small request/reply round trips must not wait for Nagle
+    int on = 1;
+    ::setsockopt(_socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+#if defined(SO_NOSIGPIPE)
+    ::setsockopt(_socket, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+}
+
+RedisConnection::~RedisConnection() noexcept { close(); }
+
+bool RedisConnection::connected() const noexcept { return _socket >= 0; }
+
+// Send all of data (throws ConnectionError)
+void RedisConnection::write(std::string_view data) {
+    if (_socket < 0) throw ConnectionError("[Redis] Not connected");
+
+#if defined(MSG_NOSIGNAL)
+    constexpr int flags = MSG_NOSIGNAL;
+#else
+    constexpr int flags = 0;
+#endif
+    while (!data.empty()) {
+        ssize_t sent = ::send(_socket, data.data(), data.size(), flags);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            std::string msg = std::strerror(errno);
+            close();
+            throw ConnectionError("[Redis] Send failed: " + msg);
+        }
+        data.remove_prefix(static_cast<std::size_t>(sent));
+    }
+}
+
+// Read the next count replies in order, skipping out-of-band pushes
+std::vector<std::unique_ptr<RedisResult>> RedisConnection::read(
+    std::size_t count) {
+    if (_socket < 0) throw ConnectionError("[Redis] Not connected");
+
+    std::vector<std::unique_ptr<RedisResult>> results;
+    results.reserve(count);
+    std::vector<RedisNode> nodes;
+    // Keeps its place in a reply spread over several receives
+    RedisParser parser;
+    while (results.size() < count) {
+        std::size_t used = 0;
+        if (_begin < _end) {
+            try {
+                used = parser.parse(_buffer->data() + _begin, _end - _begin,
+                                    nodes);
+            } catch (...) {
+                // The stream cannot be resynchronized
+                close();
+                throw;
+            }
+        }
+        if (used > 0) {
+            _begin += used;
+            if (nodes.front().type != RedisType::Push) {
+                results.push_back(
+                    std::make_unique<RedisResult>(_buffer, std::move(nodes)));
+            }
+            nodes.clear();
+            continue;
+        }
+
+        reserve();
+        ssize_t received = ::recv(_socket, _buffer->data() + _end,
+                                  _buffer->size() - _end, 0);
+        if (received == 0) {
+            close();
+            throw ConnectionError("[Redis] Connection closed by server");
+        }
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            std::string msg = std::strerror(errno);
+            close();
+            throw ConnectionError("[Redis] Receive failed: " + msg);
+        }
+        _end += static_cast<std::size_t>(received);
+    }
+    return results;
+}
+
+void RedisConnection::close() noexcept {
+    int fd = _socket.exchange(-1);
+    if (fd >= 0) ::close(fd);
+}
+
+#else
+
+RedisConnection::RedisConnection(const std::string& host, int port)
+    : _socket(-1), _begin(0), _end(0) {
+    throw ConnectionError("[Redis] POSIX sockets are required");
+}
+
+RedisConnection::~RedisConnection() noexcept = default;
+
+bool RedisConnection::connected() const noexcept { return false; }
+
+void RedisConnection::write(std::string_view) {
+    throw ConnectionError("[Redis] Not connected");
+}
+
+std::vector<std::unique_ptr<RedisResult>> RedisConnection::read(std::size_t) {
+    throw ConnectionError("[Redis] Not connected");
+}
+
+void RedisConnection::close() noexcept {}
+
+#endif  // _WIN32
+
+// Send one command and wait for its reply
+std::unique_ptr<RedisResult> RedisConnection::call(
+    const std::vector<std::string>& args) {
+    std::string out;
+    RedisProtocol::append_array(out, args.size());
+    for (const auto& arg : args) RedisProtocol::append_bulk(out, arg);
+    write(out);
+    return std::move(read(1).front());
+}
+
+// Make room for at least one more read after the unparsed bytes
+void RedisConnection::reserve() {
+    // Free space at the tail can be used even while results share the
+    // buffer, they only reference bytes before _begin
+    if (_buffer->size() - _end >= MinRead) return;
+
+    const std::size_t pending = _end - _begin;
+    if (_buffer.use_count() == 1 && _buffer->size() - pending >= MinRead) {
+        std::memmove(_buffer->data(), _buffer->data() + _begin, pending);
+    } else {
+        auto fresh = std::make_shared<std::string>(
+            std::max(BufferSize, pending * 2 + MinRead), '\0');
+        std::memcpy(fresh->data(), _buffer->data() + _begin, pending);
+        _buffer = std::move(fresh);
+    }
+    _begin = 0;
+    _end = pending;
+}
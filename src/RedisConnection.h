@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "IDatabase.h"
+#include "RedisProtocol.h"
+
+// RedisReply class - lightweight view of one element of a RedisResult
+class RedisReply final {
+   public:
+    RedisReply(const RedisNode* nodes, std::uint32_t index) noexcept;
+
+    RedisType type() const noexcept;
+    bool is_null() const noexcept;
+    bool is_error() const noexcept;
+    // Array, Map, Set or Push
+    bool is_aggregate() const noexcept;
+
+    // Text of simple, bulk, verbatim, big number and error replies (a view
+    // into the result's receive buffer)
+    std::string_view str() const;
+
+    // Integer reply, or a string reply holding an integer
+    std::int64_t integer() const;
+
+    // Double reply, or a numeric integer or string reply
+    double number() const;
+
+    // Boolean reply, or an integer reply (non-zero is true)
+    bool boolean() const;
+
+    // Elements of aggregates; maps list key, value, key, value, ...
+    std::size_t size() const noexcept;
+    RedisReply operator[](std::size_t index) const;
+
+    class iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = RedisReply;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = RedisReply;
+
+        iterator(const RedisNode* nodes, std::uint32_t index) noexcept;
+
+        RedisReply operator*() const noexcept;
+
+        bool operator==(const iterator& itr) const noexcept;
+        bool operator!=(const iterator& itr) const noexcept;
+
+        iterator& operator++() noexcept;
+        iterator operator++(int) noexcept;
+
+       private:
+        const RedisNode* _nodes;
+        std::uint32_t _index;
+    };
+
+    iterator begin() const noexcept;
+    iterator end() const noexcept;
+
+   private:
+    const RedisNode& node() const noexcept;
+
+    const RedisNode* _nodes;
+    std::uint32_t _index;
+};
+
+// RedisResult class - one reply. Strings are not copied out of the receive
+// buffer; the result shares ownership of the buffer instead.
+class RedisResult : public IResult {
+   public:
+    RedisResult(std::shared_ptr<const std::string> buffer,
+                std::vector<RedisNode> nodes) noexcept;
+
+    // Compact copy holding only the bytes its strings refer to, so a
+    // cached reply does not keep the whole receive buffer alive
+    std::unique_ptr<IResult> clone() const override;
+    std::size_t memory_usage() const noexcept override;
+
+    // Top-level reply
+    RedisReply reply() const noexcept;
+
+    // Shortcuts for reply()
+    RedisType type() const noexcept;
+    bool is_null() const noexcept;
+    bool is_error() const noexcept;
+    std::string_view str() const;
+    std::int64_t integer() const;
+    std::size_t size() const noexcept;
+    RedisReply operator[](std::size_t index) const;
+
+   private:
+    std::shared_ptr<const std::string> _buffer;
+    std::vector<RedisNode> _nodes;
+};
+
+// RedisConnection class - blocking TCP connection with a reusable receive
+// buffer that replies are parsed from in place
+class RedisConnection final {
+   public:
+    // Connects (throws ConnectionError)
+    RedisConnection(const std::string& host, int port);
+
+    RedisConnection(const RedisConnection&) noexcept = delete;
+    RedisConnection& operator=(const RedisConnection&) noexcept = delete;
+
+    ~RedisConnection() noexcept;
+
+    bool connected() const noexcept;
+
+    // Send all of data (throws ConnectionError)
+    void write(std::string_view data);
+
+    // Read the next count replies in order, skipping out-of-band pushes
+    // (throws ConnectionError)
+    std::vector<std::unique_ptr<RedisResult>> read(std::size_t count);
+
+    // Send one command and wait for its reply
+    std::unique_ptr<RedisResult> call(const std::vector<std::string>& args);
+
+    void close() noexcept;
+
+   private:
+    // Make room for at least one more read after the unparsed bytes
+    void reserve();
+
+    std::atomic<int> _socket;  // checked by other threads via connected()
+    std::shared_ptr<std::string> _buffer;
+    std::size_t _begin;  // first unparsed byte
+    std::size_t _end;    // end of received bytes
+};
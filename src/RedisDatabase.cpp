@@ -3,38 +3,285 @@
 #include <iostream>
 #include <stdexcept>
 
+#include "ColumnDecoder.h"
+#include "Errors.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Parameter number of a "$n" word (0 if the word is not a placeholder)
+std::size_t placeholder(const std::string& word) noexcept {
+    if (word.size() < 2 || word[0] != '$') return 0;
+    std::int64_t index;
+    if (!ColumnDecoder::parse_int(word.data() + 1, word.size() - 1, index) ||
+        index <= 0 || word[1] == '+' || word[1] == '-')
+        return 0;
+    return static_cast<std::size_t>(index);
+}
+
+void append_param(std::string& out, const Param& param) {
+    if (param.type() == Param::Type::Bool) {
+        RedisProtocol::append_bulk(out, param.as_bool() ? "1" : "0");
+        return;
+    }
+    char buffer[Param::TextSize];
+    RedisProtocol::append_bulk(out, param.to_text(buffer));
+}
+
+// Append the RESP array of a command line with its parameters
+void encode(std::string& out, const std::string& command,
+            const ParamPack& params) {
+    auto words = RedisProtocol::split(command);
+    if (words.empty()) throw QueryError("[Redis] Empty command");
+
+    bool substituted = false;
+    for (const auto& word : words) {
+        std::size_t index = placeholder(word);
+        if (index == 0) continue;
+        if (index > params.size()) {
+            throw QueryError("[Redis] Missing value for parameter " + word);
+        }
+        substituted = true;
+    }
+
+    RedisProtocol::append_array(
+        out, words.size() + (substituted ? 0 : params.size()));
+    for (const auto& word : words) {
+        std::size_t index = substituted ? placeholder(word) : 0;
+        if (index > 0)
+            append_param(out, params[index - 1]);
+        else
+            RedisProtocol::append_bulk(out, word);
+    }
+    if (!substituted) {
+        for (const auto& param : params) append_param(out, param);
+    }
+}
+
+}  // namespace
+
 RedisDatabase::RedisDatabase(const std::string& host, int port)
-    : _host(host), _port(port), _connected(false) {}
+    : _host(host), _port(port), _protocol(2), _driving(false) {}
+
+// Uses host, port, password (AUTH), username (ACL user) and database
+// (SELECT index)
+RedisDatabase::RedisDatabase(const DatabaseConfig& config)
+    : RedisDatabase(config.host.empty() ? "localhost" : config.host,
+                    config.port == 0 ? 6379 : config.port) {
+    _username = config.username;
+    _password = config.password;
+    _database = config.database;
+}
+
+RedisDatabase::~RedisDatabase() noexcept { wait_idle(); }
 
 std::string RedisDatabase::connection_info() const noexcept {
     return "Redis at " + _host + ":" + std::to_string(_port);
 }
 
-bool RedisDatabase::connected() const noexcept { return _connected; }
+bool RedisDatabase::connected() const noexcept {
+    return _conn && _conn->connected();
+}
 
 void RedisDatabase::connect() {
+    if (connected()) {
+        std::cout << "[Redis] Already connected\n";
+        return;
+    }
     std::cout << "[Redis] Connecting to " << _host << ":" << _port << "\n";
-    _connected = true;
+    _conn = std::make_unique<RedisConnection>(_host, _port);
+
+    try {
+        if (_protocol == 3) {
+            std::vector<std::string> hello{"HELLO", "3"};
+            if (!_password.empty()) {
+                hello.insert(hello.end(),
+                             {"AUTH",
+                              _username.empty() ? "default" : _username,
+                              _password});
+            }
+            call(hello);
+        } else if (!_password.empty()) {
+            if (_username.empty())
+                call({"AUTH", _password});
+            else
+                call({"AUTH", _username, _password});
+        }
+        if (!_database.empty()) call({"SELECT", _database});
+    } catch (...) {
+        _conn.reset();
+        throw;
+    }
+    std::cout << "[Redis] Successfully connected\n";
 }
 
 void RedisDatabase::disconnect() {
-    if (_connected) {
-        std::cout << "[Redis] Disconnecting\n";
-        _connected = false;
+    if (!_conn) {
+        std::cout << "[Redis] Already disconnected\n";
+        return;
     }
+    std::cout << "[Redis] Disconnecting\n";
+    wait_idle();
+    _conn.reset();
+    std::cout << "[Redis] Successfully disconnected\n";
 }
 
+// Run a command line such as "SET key 'some value'"
 std::unique_ptr<IResult> RedisDatabase::exec(const std::string& sql) {
-    if (!_connected) {
-        throw std::runtime_error("[Redis] Database not connected");
+    return exec_params(sql, ParamPack());
+}
+
+// Command with binary-safe arguments
+std::unique_ptr<IResult> RedisDatabase::exec_params(const std::string& sql,
+                                                    const ParamPack& params) {
+    if (!connected()) {
+        throw ConnectionError("[Redis] Database not connected");
     }
-    std::cout << "[Redis] Executing query: " << sql << "\n";
-    // Simulate query execution
-    std::cout << "[Redis] Query executed successfully\n";
-    return nullptr;
+
+    std::string frame;
+    encode(frame, sql, params);
+    std::future<std::unique_ptr<IResult>> future;
+    if (enqueue(frame, 1, true, &future)) drive(true);
+    return future.get();
 }
 
-std::unique_ptr<IResult> RedisDatabase::exec_params(
-    const std::string& sql, const std::vector<std::any>& args) {
-    return nullptr;
+// Same as exec and exec_params with the concrete result type. Replies
+// cross threads through the pipeline's promises, so they are still
+// allocated there and moved out here.
+RedisResult RedisDatabase::query(const std::string& sql) {
+    return query_params(sql, ParamPack());
+}
+
+RedisResult RedisDatabase::query_params(const std::string& sql,
+                                        const ParamPack& params) {
+    auto result = exec_params(sql, params);
+    return std::move(static_cast<RedisResult&>(*result));
+}
+
+// Queue without waiting, pipelined with concurrent commands
+std::future<std::unique_ptr<IResult>> RedisDatabase::exec_async(
+    const std::string& sql) {
+    return exec_params_async(sql, ParamPack());
+}
+
+std::future<std::unique_ptr<IResult>> RedisDatabase::exec_params_async(
+    const std::string& sql, const ParamPack& params) {
+    if (!connected()) {
+        throw ConnectionError("[Redis] Database not connected");
+    }
+
+    std::string frame;
+    encode(frame, sql, params);
+    std::future<std::unique_ptr<IResult>> future;
+    if (enqueue(frame, 1, true, &future))
+        ThreadPool::shared().post([this] { drive(false); });
+    return future;
+}
+
+// Send commands in one write and return every reply in order
+std::vector<std::unique_ptr<RedisResult>> RedisDatabase::pipeline(
+    const std::vector<std::string>& commands) {
+    if (!connected()) {
+        throw ConnectionError("[Redis] Database not connected");
+    }
+
+    // Encode everything first, so a malformed command throws before any
+    // of the others is queued
+    std::string frames;
+    for (const auto& command : commands) encode(frames, command, ParamPack());
+    std::vector<std::future<std::unique_ptr<IResult>>> futures(
+        commands.size());
+    if (!commands.empty() &&
+        enqueue(frames, commands.size(), false, futures.data()))
+        drive(true);
+
+    std::vector<std::unique_ptr<RedisResult>> results;
+    results.reserve(futures.size());
+    for (auto& future : futures) {
+        results.emplace_back(static_cast<RedisResult*>(future.get().release()));
+    }
+    return results;
+}
+
+// Protocol version negotiated with HELLO on connect (2 or 3)
+void RedisDatabase::protocol(int version) {
+    if (version != 2 && version != 3) {
+        throw std::invalid_argument("Redis protocol must be 2 or 3");
+    }
+    _protocol = version;
+}
+
+// Append encoded commands to the outbound batch
+bool RedisDatabase::enqueue(const std::string& frames, std::size_t count,
+                            bool throwErrors,
+                            std::future<std::unique_ptr<IResult>>* futures) {
+    std::lock_guard<std::mutex> lock(_queueMutex);
+    _outbound += frames;
+    for (std::size_t i = 0; i < count; ++i) {
+        _waiters.push_back(Waiter{{}, throwErrors});
+        futures[i] = _waiters.back().promise.get_future();
+    }
+
+    if (_driving) return false;
+    _driving = true;
+    return true;
+}
+
+// Write queued batches and complete their waiters
+void RedisDatabase::drive(bool handOff) noexcept {
+    std::string out;
+    std::vector<Waiter> batch;
+    for (bool first = true;; first = false) {
+        {
+            std::lock_guard<std::mutex> lock(_queueMutex);
+            if (_waiters.empty()) {
+                _driving = false;
+                _idle.notify_all();
+                return;
+            }
+            if (handOff && !first) {
+                // The caller's own command is done, let a worker carry on
+                ThreadPool::shared().post([this] { drive(false); });
+                return;
+            }
+            out.swap(_outbound);
+            batch.swap(_waiters);
+        }
+
+        try {
+            if (!connected()) {
+                throw ConnectionError("[Redis] Database not connected");
+            }
+            _conn->write(out);
+            auto replies = _conn->read(batch.size());
+            for (std::size_t i = 0; i < batch.size(); ++i) {
+                if (batch[i].throwErrors && replies[i]->is_error()) {
+                    batch[i].promise.set_exception(
+                        std::make_exception_ptr(QueryError(
+                            "[Redis] " + std::string(replies[i]->str()))));
+                } else {
+                    batch[i].promise.set_value(std::move(replies[i]));
+                }
+            }
+        } catch (...) {
+            for (auto& waiter : batch)
+                waiter.promise.set_exception(std::current_exception());
+        }
+        out.clear();
+        batch.clear();
+    }
+}
+
+// Block until no batch is in flight
+void RedisDatabase::wait_idle() {
+    std::unique_lock<std::mutex> lock(_queueMutex);
+    _idle.wait(lock, [this] { return !_driving; });
+}
+
+// Run a command outside the queue (connection setup)
+void RedisDatabase::call(const std::vector<std::string>& args) {
+    auto result = _conn->call(args);
+    if (result->is_error()) {
+        throw ConnectionError("[Redis] " + std::string(result->str()));
+    }
 }
@@ -1,10 +1,31 @@
 #pragma once
 
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DatabaseConfig.h"
 #include "IDatabase.h"
+#include "RedisConnection.h"
 
+// Redis Database implementation. Commands issued while another command is
+// on the wire (from other threads or through exec_async) are queued and
+// sent together in the next write, so one connection serves many callers
+// with one round trip per batch instead of one per command.
 class RedisDatabase : public IDatabase {
    public:
     RedisDatabase(const std::string& host, int port);
+    // Uses host, port, password (AUTH), username (ACL user) and database
+    // (SELECT index)
+    explicit RedisDatabase(const DatabaseConfig& config);
+
+    RedisDatabase(const RedisDatabase&) noexcept = delete;
+    RedisDatabase& operator=(const RedisDatabase&) noexcept = delete;
+
+    ~RedisDatabase() noexcept override;
 
     std::string connection_info() const noexcept override;
 
@@ -14,13 +35,69 @@ class RedisDatabase : public IDatabase {
 
     void disconnect() override;
 
+    // Run a command line such as "SET key 'some value'". Results are
+    // RedisResult; error replies throw QueryError.
     std::unique_ptr<IResult> exec(const std::string& sql) override;
 
-    std::unique_ptr<IResult> exec_params(
-        const std::string& sql, const std::vector<std::any>& args) override;
+    // Command with binary-safe arguments: "$n" words are replaced by the
+    // n-th parameter, without placeholders parameters are appended
+    using IDatabase::exec_params;
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         const ParamPack& params) override;
+
+    // Same as exec and exec_params, returning the result by value
+    RedisResult query(const std::string& sql);
+    RedisResult query_params(const std::string& sql, const ParamPack& params);
+
+    // Queue without waiting, pipelined with concurrent commands
+    using IDatabase::exec_params_async;
+    std::future<std::unique_ptr<IResult>> exec_async(
+        const std::string& sql) override;
+    std::future<std::unique_ptr<IResult>> exec_params_async(
+        const std::string& sql, const ParamPack& params) override;
+
+    // Send commands in one write and return every reply in order; error
+    // replies are returned rather than thrown
+    std::vector<std::unique_ptr<RedisResult>> pipeline(
+        const std::vector<std::string>& commands);
+
+    // Protocol version negotiated with HELLO on connect (2 or 3)
+    void protocol(int version);
 
    private:
+    struct Waiter {
+        std::promise<std::unique_ptr<IResult>> promise;
+        bool throwErrors;
+    };
+
+    // Append count encoded commands to the outbound batch, storing their
+    // futures, returns whether the caller must start driving the
+    // connection
+    bool enqueue(const std::string& frames, std::size_t count,
+                 bool throwErrors,
+                 std::future<std::unique_ptr<IResult>>* futures);
+
+    // Write queued batches and complete their waiters until the queue is
+    // empty (or after one batch when handOff, passing the rest to the pool)
+    void drive(bool handOff) noexcept;
+
+    // Block until no batch is in flight
+    void wait_idle();
+
+    // Run a command outside the queue (connection setup)
+    void call(const std::vector<std::string>& args);
+
     std::string _host;
     int _port;
-    bool _connected;
+    std::string _username;
+    std::string _password;
+    std::string _database;
+    int _protocol;
+    std::unique_ptr<RedisConnection> _conn;
+
+    std::mutex _queueMutex;
+    std::condition_variable _idle;
+    std::string _outbound;
+    std::vector<Waiter> _waiters;
+    bool _driving;
 };
@@ -0,0 +1,290 @@
+#include "RedisProtocol.h"
+
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "ColumnDecoder.h"
+#include "Errors.h"
+
+namespace {
+
+// Nesting deeper than this is rejected instead of exhausting the stack
+constexpr std::size_t MaxDepth = 512;
+
+[[noreturn]] void malformed(const char* what) {
+    throw QueryError(std::string("[Redis] Malformed reply: ") + what);
+}
+
+bool hex_digit(char c) noexcept {
+    return std::isxdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+// End of the CRLF-terminated line starting at data (nullptr if incomplete)
+const char* line_end(const char* data, const char* end) {
+    auto cr = static_cast<const char*>(std::memchr(data, '\r', end - data));
+    if (cr == nullptr || cr + 1 >= end) return nullptr;
+    if (cr[1] != '\n') malformed("expected CRLF");
+    return cr;
+}
+
+std::int64_t parse_integer(const char* data, const char* end) {
+    std::int64_t value;
+    if (!ColumnDecoder::parse_int(data, end - data, value))
+        malformed("bad integer");
+    return value;
+}
+
+double parse_double(const char* data, const char* end) {
+    std::string_view text(data, end - data);
+    if (text == "inf") return std::numeric_limits<double>::infinity();
+    if (text == "-inf") return -std::numeric_limits<double>::infinity();
+    if (text == "nan") return std::numeric_limits<double>::quiet_NaN();
+
+    // The line is followed by CRLF, so strtod stops inside the buffer
+    char* stop = nullptr;
+    double value = std::strtod(data, &stop);
+    if (data == end || stop != end) malformed("bad double");
+    return value;
+}
+
+// Offset of a node without text
+constexpr std::size_t NoText = static_cast<std::size_t>(-1);
+
+}  // namespace
+
+// Continue parsing the reply at data, of which size bytes arrived so far
+std::size_t RedisParser::parse(const char* data, std::size_t size,
+                               std::vector<RedisNode>& nodes) {
+    if (!_started) {
+        _started = true;
+        _mark = nodes.size();
+        _offset = 0;
+    }
+    const char* end = data + size;
+
+    while (true) {
+        // Only the element at _offset is looked at again on the next call
+        const char* line = data + _offset;
+        if (line == end) return 0;
+        const char marker = *line++;
+        const char* cr = line_end(line, end);
+        if (cr == nullptr) return 0;
+        const char* next = cr + 2;
+
+        RedisNode node{RedisType::Null, 0, 0, {}, 0, 0.0};
+        std::int64_t count = -1;  // elements of an aggregate
+        switch (marker) {
+            case '+':
+            case '-':
+            case '(':
+                node.type = marker == '+'   ? RedisType::Simple
+                            : marker == '-' ? RedisType::Error
+                                            : RedisType::BigNumber;
+                node.text = std::string_view(line, cr - line);
+                break;
+            case ':':
+                node.type = RedisType::Integer;
+                node.integer = parse_integer(line, cr);
+                break;
+            case ',':
+                node.type = RedisType::Double;
+                node.number = parse_double(line, cr);
+                break;
+            case '#':
+                if (cr - line != 1 || (*line != 't' && *line != 'f'))
+                    malformed("bad boolean");
+                node.type = RedisType::Boolean;
+                node.integer = *line == 't';
+                break;
+            case '_':
+                break;
+            case '$':
+            case '=':
+            case '!': {
+                std::int64_t length = parse_integer(line, cr);
+                if (length < 0) break;  // RESP2 null bulk string
+                if (end - next < length + 2) return 0;
+                if (next[length] != '\r' || next[length + 1] != '\n')
+                    malformed("bulk string length mismatch");
+
+                node.type = marker == '$'   ? RedisType::Bulk
+                            : marker == '=' ? RedisType::Verbatim
+                                            : RedisType::Error;
+                node.text = std::string_view(next, length);
+                // Verbatim strings start with a three letter format and ':'
+                if (marker == '=') {
+                    if (length < 4) malformed("bad verbatim string");
+                    node.text.remove_prefix(4);
+                }
+                next += length + 2;
+                break;
+            }
+            case '*':
+            case '%':
+            case '~':
+            case '>':
+            case '|':
+                count = parse_integer(line, cr);
+                if (count < 0) break;  // RESP2 null array
+                if (count > std::numeric_limits<std::uint32_t>::max() / 2)
+                    malformed("aggregate too large");
+                if (marker == '%' || marker == '|') count *= 2;
+
+                node.type = marker == '*'   ? RedisType::Array
+                            : marker == '%' ? RedisType::Map
+                            : marker == '~' ? RedisType::Set
+                                            : RedisType::Push;
+                node.count = static_cast<std::uint32_t>(count);
+                break;
+            default:
+                malformed("unknown type marker");
+        }
+
+        std::size_t index = nodes.size();
+        node.next = static_cast<std::uint32_t>(index + 1);
+        nodes.push_back(node);
+        _textOffsets.push_back(node.text.data() != nullptr
+                                   ? node.text.data() - data
+                                   : NoText);
+        _offset = next - data;
+
+        // Attributes annotate the reply that follows, they are dropped
+        bool attribute = marker == '|';
+        if (count > 0) {
+            if (_stack.size() >= MaxDepth) malformed("nesting too deep");
+            _stack.push_back(Frame{index, count, attribute});
+            continue;
+        }
+
+        // A value is complete, and with it every aggregate it was the last
+        // element of
+        while (!attribute && !_stack.empty()) {
+            Frame& top = _stack.back();
+            if (--top.remaining > 0) break;
+            index = top.index;
+            attribute = top.attribute;
+            _stack.pop_back();
+            if (!attribute)
+                nodes[index].next = static_cast<std::uint32_t>(nodes.size());
+        }
+        if (attribute) {
+            nodes.resize(index);
+            _textOffsets.resize(index - _mark);
+            continue;
+        }
+        if (!_stack.empty()) continue;
+
+        // Point the strings at data as it is now
+        for (std::size_t i = _mark; i < nodes.size(); ++i) {
+            const std::size_t offset = _textOffsets[i - _mark];
+            if (offset != NoText)
+                nodes[i].text =
+                    std::string_view(data + offset, nodes[i].text.size());
+        }
+        const std::size_t used = _offset;
+        reset();
+        return used;
+    }
+}
+
+// Forget a partial reply (nodes is not touched)
+void RedisParser::reset() noexcept {
+    _started = false;
+    _mark = 0;
+    _offset = 0;
+    _stack.clear();
+    _textOffsets.clear();
+}
+
+// Parse one complete reply at data, appending its nodes
+std::size_t RedisProtocol::parse(const char* data, std::size_t size,
+                                 std::vector<RedisNode>& nodes) {
+    const std::size_t mark = nodes.size();
+    RedisParser parser;
+    const std::size_t used = parser.parse(data, size, nodes);
+    if (used == 0) nodes.resize(mark);
+    return used;
+}
+
+// Append a command header for argc arguments
+void RedisProtocol::append_array(std::string& out, std::size_t argc) {
+    char digits[24];
+    auto stop = std::to_chars(digits, digits + sizeof(digits), argc).ptr;
+    out += '*';
+    out.append(digits, stop);
+    out += "\r\n";
+}
+
+// Append one binary-safe command argument
+void RedisProtocol::append_bulk(std::string& out, std::string_view arg) {
+    char digits[24];
+    auto stop = std::to_chars(digits, digits + sizeof(digits), arg.size()).ptr;
+    out += '$';
+    out.append(digits, stop);
+    out += "\r\n";
+    out.append(arg.data(), arg.size());
+    out += "\r\n";
+}
+
+// Split a command line into arguments, honouring redis-cli quoting
+std::vector<std::string> RedisProtocol::split(const std::string& command) {
+    std::vector<std::string> args;
+    auto itr = command.begin();
+    const auto end = command.end();
+    while (true) {
+        while (itr != end && std::isspace(static_cast<unsigned char>(*itr)))
+            ++itr;
+        if (itr == end) return args;
+
+        std::string arg;
+        const char quote = (*itr == '"' || *itr == '\'') ? *itr++ : '\0';
+        while (true) {
+            if (itr == end) {
+                if (quote) throw QueryError("[Redis] Unbalanced quotes");
+                break;
+            }
+            char c = *itr++;
+            if (quote == '\0' && std::isspace(static_cast<unsigned char>(c)))
+                break;
+            if (quote && c == quote) {
+                if (itr != end &&
+                    !std::isspace(static_cast<unsigned char>(*itr)))
+                    throw QueryError("[Redis] Closing quote must be "
+                                     "followed by a space");
+                break;
+            }
+            if (quote == '"' && c == '\\' && itr != end) {
+                c = *itr++;
+                switch (c) {
+                    case 'n':
+                        c = '\n';
+                        break;
+                    case 'r':
+                        c = '\r';
+                        break;
+                    case 't':
+                        c = '\t';
+                        break;
+                    case 'x':
+                        if (end - itr >= 2 && hex_digit(itr[0]) &&
+                            hex_digit(itr[1])) {
+                            c = static_cast<char>(std::stoi(
+                                std::string(itr, itr + 2), nullptr, 16));
+                            itr += 2;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            } else if (quote == '\'' && c == '\\' && itr != end &&
+                       *itr == '\'') {
+                c = *itr++;
+            }
+            arg += c;
+        }
+        args.push_back(std::move(arg));
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Reply types of RESP2 and RESP3
+enum class RedisType : std::uint8_t {
+    Simple,     // +OK
+    Error,      // -ERR ... and RESP3 blob errors
+    Integer,    // :1
+    Bulk,       // $3 foo
+    Array,      // *2 ...
+    Null,       // $-1, *-1 and RESP3 _
+    Boolean,    // #t
+    Double,     // ,1.5
+    BigNumber,  // (12345678901234567890
+    Verbatim,   // =txt:foo (text without the format prefix)
+    Map,        // %1 key value
+    Set,        // ~2 ...
+    Push        // >2 ... (out-of-band)
+};
+
+// One parsed reply element. Aggregates are followed by their elements in
+// pre-order; text points into the buffer the reply was parsed from.
+struct RedisNode {
+    RedisType type;
+    std::uint32_t count;  // elements of aggregates (maps count keys+values)
+    std::uint32_t next;   // index of the node after this subtree
+    std::string_view text;
+    std::int64_t integer;  // Integer and Boolean
+    double number;         // Double
+};
+
+// RedisParser class - resumable decoding of one reply that arrives in
+// pieces. Each call continues from the last complete element, so a reply
+// is scanned once however many reads it takes.
+class RedisParser final {
+   public:
+    // Continue parsing the reply at data, of which size bytes arrived so
+    // far (data may move between calls, the bytes must stay the same).
+    // Returns the bytes of the reply once complete, its nodes appended and
+    // pointing into data; otherwise 0 with the elements decoded so far
+    // kept in nodes for the next call. Throws QueryError on malformed
+    // input.
+    std::size_t parse(const char* data, std::size_t size,
+                      std::vector<RedisNode>& nodes);
+
+    // Forget a partial reply (nodes is not touched)
+    void reset() noexcept;
+
+   private:
+    // Aggregate still waiting for elements
+    struct Frame {
+        std::size_t index;       // its node
+        std::int64_t remaining;  // elements not parsed yet
+        bool attribute;          // dropped once complete
+    };
+
+    bool _started = false;
+    std::size_t _mark = 0;    // first node of the reply
+    std::size_t _offset = 0;  // first byte not parsed yet
+    std::vector<Frame> _stack;
+    // Offset of each node's text from data (strings are pointed at the
+    // final buffer only once the reply is complete)
+    std::vector<std::size_t> _textOffsets;
+};
+
+// RESP encoding and zero-copy decoding
+class RedisProtocol final {
+   private:
+    RedisProtocol() noexcept = delete;
+    ~RedisProtocol() noexcept = delete;
+
+   public:
+    // Parse one complete reply at data, appending its nodes. Returns the
+    // bytes consumed, or 0 (nodes unchanged) if more input is needed.
+    // Throws QueryError on malformed input.
+    static std::size_t parse(const char* data, std::size_t size,
+                             std::vector<RedisNode>& nodes);
+
+    // Append a command header for argc arguments
+    static void append_array(std::string& out, std::size_t argc);
+
+    // Append one binary-safe command argument
+    static void append_bulk(std::string& out, std::string_view arg);
+
+    // Split a command line into arguments, honouring redis-cli quoting
+    // ("a b" with escapes, 'a b' verbatim)
+    static std::vector<std::string> split(const std::string& command);
+};
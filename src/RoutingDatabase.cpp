@@ -0,0 +1,371 @@
+#include "RoutingDatabase.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "DatabaseFactory.h"
+#include "Errors.h"
+#include "PostgreDatabase.h"
+#include "SqlClassifier.h"
+#include "ThreadPool.h"
+
+namespace {
+
+std::vector<std::unique_ptr<IDatabase>> create_all(
+    const BackendHandle& backend, const std::vector<DatabaseConfig>& configs) {
+    std::vector<std::unique_ptr<IDatabase>> dbs;
+    dbs.reserve(configs.size());
+    for (const auto& config : configs) dbs.push_back(backend.create(config));
+    return dbs;
+}
+
+}  // namespace
+
+// Creates every backend through DatabaseFactory
+RoutingDatabase::RoutingDatabase(const std::string& dbType,
+                                 const DatabaseConfig& primary,
+                                 const std::vector<DatabaseConfig>& replicas,
+                                 const RoutingConfig& config)
+    : RoutingDatabase(DatabaseFactory::create(dbType, primary),
+                      create_all(DatabaseFactory::resolve(dbType), replicas),
+                      config) {}
+
+RoutingDatabase::RoutingDatabase(
+    std::unique_ptr<IDatabase> primary,
+    std::vector<std::unique_ptr<IDatabase>> replicas,
+    const RoutingConfig& config)
+    : _config(config),
+      _primary(std::make_unique<Backend>()),
+      _inTransaction(false),
+      _next(0),
+      _nextCheck(0),
+      _primaryStatements(0),
+      _replicaReads(0),
+      _fallbackReads(0),
+      _retries(0) {
+    if (!primary) {
+        throw std::invalid_argument("RoutingDatabase needs a primary");
+    }
+    _primary->db = std::move(primary);
+
+    _replicas.reserve(replicas.size());
+    for (auto& db : replicas) {
+        if (!db) throw std::invalid_argument("RoutingDatabase null replica");
+        _replicas.push_back(std::make_unique<Backend>());
+        _replicas.back()->db = std::move(db);
+    }
+
+    if (!_config.lag_probe) _config.lag_probe = postgres_lag;
+    _config.ewma_weight = std::clamp(_config.ewma_weight, 0.01, 1.0);
+    if (_config.max_failures == 0) _config.max_failures = 1;
+}
+
+std::string RoutingDatabase::connection_info() const noexcept {
+    return "Routing " + _primary->db->connection_info() + " with " +
+           std::to_string(_replicas.size()) + " replicas";
+}
+
+// Whether the primary is connected
+bool RoutingDatabase::connected() const noexcept {
+    return _primary->db->connected();
+}
+
+// Connects the primary (throws) and the replicas (failures eject them)
+void RoutingDatabase::connect() {
+    {
+        std::lock_guard<std::mutex> lock(_primary->mutex);
+        _primary->db->connect();
+    }
+    for (auto& replica : _replicas) check(*replica, true);
+
+    _nextCheck.store(
+        now() +
+        std::chrono::duration_cast<Clock::duration>(_config.check_interval)
+            .count());
+}
+
+void RoutingDatabase::disconnect() {
+    for (auto& replica : _replicas) {
+        std::lock_guard<std::mutex> lock(replica->mutex);
+        replica->db->disconnect();
+    }
+    std::lock_guard<std::mutex> lock(_primary->mutex);
+    _primary->db->disconnect();
+}
+
+std::unique_ptr<IResult> RoutingDatabase::exec(const std::string& sql) {
+    return route(sql, nullptr);
+}
+
+std::unique_ptr<IResult> RoutingDatabase::exec_params(
+    const std::string& sql, const ParamPack& params) {
+    return route(sql, &params);
+}
+
+// Run on the thread pool without serializing the whole router
+std::future<std::unique_ptr<IResult>> RoutingDatabase::exec_async(
+    const std::string& sql) {
+    return ThreadPool::shared().submit([this, sql] { return exec(sql); });
+}
+
+std::future<std::unique_ptr<IResult>> RoutingDatabase::exec_params_async(
+    const std::string& sql, const ParamPack& params) {
+    return ThreadPool::shared().submit(
+        [this, sql, params] { return exec_params(sql, params); });
+}
+
+// Probe the lag of every replica now and retry ejected ones
+void RoutingDatabase::check_replicas() {
+    for (auto& replica : _replicas) check(*replica, true);
+}
+
+RoutingStats RoutingDatabase::stats() const {
+    RoutingStats stats;
+    stats.primary_statements = _primaryStatements.load();
+    stats.replica_reads = _replicaReads.load();
+    stats.fallback_reads = _fallbackReads.load();
+    stats.retries = _retries.load();
+
+    const std::int64_t time = now();
+    for (const auto& replica : _replicas) {
+        ReplicaStats status;
+        status.connection_info = replica->db->connection_info();
+        status.available = available(*replica, time);
+        status.outstanding = replica->outstanding.load();
+        status.ewma_ns = replica->ewma_ns.load();
+        status.lag_ms = replica->lag_ms.load();
+        status.reads = replica->reads.load();
+        status.ejections = replica->ejections.load();
+        stats.replicas.push_back(std::move(status));
+    }
+    return stats;
+}
+
+// Backends, for backend specific calls (not synchronized with routing)
+IDatabase& RoutingDatabase::primary() noexcept { return *_primary->db; }
+
+std::size_t RoutingDatabase::replica_count() const noexcept {
+    return _replicas.size();
+}
+
+IDatabase& RoutingDatabase::replica(std::size_t index) {
+    return *_replicas.at(index)->db;
+}
+
+// Replay lag of a PostgreSQL standby (0 on a primary or when it has
+// replayed everything it received)
+std::chrono::milliseconds RoutingDatabase::postgres_lag(IDatabase& db) {
+    auto* postgres = dynamic_cast<PostgreDatabase*>(&db);
+    if (postgres == nullptr) return std::chrono::milliseconds(0);
+
+    PostgreResult result = postgres->query(
+        "SELECT CASE WHEN NOT pg_is_in_recovery() OR "
+        "pg_last_wal_receive_lsn() = pg_last_wal_replay_lsn() THEN 0 "
+        "ELSE COALESCE((EXTRACT(EPOCH FROM now() - "
+        "pg_last_xact_replay_timestamp()) * 1000)::bigint, 0) END");
+    return std::chrono::milliseconds(result.front().get<std::int64_t>(0));
+}
+
+std::unique_ptr<IResult> RoutingDatabase::route(const std::string& sql,
+                                                const ParamPack* params) {
+    if (!connected()) {
+        throw ConnectionError("[Routing] Database not connected");
+    }
+
+    // Reads of no table may call functions that write (a standby rejects
+    // them) or read session state, so only table reads go to replicas
+    const SqlStatement statement = SqlClassifier::classify(sql);
+    if (statement.kind == SqlKind::Read && !statement.tables.empty() &&
+        !statement.side_effects && !_inTransaction.load())
+        return read(sql, params);
+
+    _primaryStatements.fetch_add(1, std::memory_order_relaxed);
+    std::unique_ptr<IResult> result;
+    try {
+        result = run(*_primary, sql, params);
+    } catch (...) {
+        // A failed COMMIT still ends the transaction
+        if (statement.transaction == SqlTransaction::End)
+            _inTransaction.store(false);
+        throw;
+    }
+    if (statement.transaction != SqlTransaction::None)
+        _inTransaction.store(statement.transaction == SqlTransaction::Begin);
+    return result;
+}
+
+std::unique_ptr<IResult> RoutingDatabase::read(const std::string& sql,
+                                               const ParamPack* params) {
+    maybe_check();
+
+    std::vector<const Backend*> tried;
+    while (Backend* replica = pick(tried)) {
+        try {
+            auto result = run(*replica, sql, params);
+            replica->reads.fetch_add(1, std::memory_order_relaxed);
+            _replicaReads.fetch_add(1, std::memory_order_relaxed);
+            return result;
+        } catch (const DatabaseError& e) {
+            if (read_only(e)) {
+                // A function in it writes, which only the primary can run
+                _retries.fetch_add(1, std::memory_order_relaxed);
+                _primaryStatements.fetch_add(1, std::memory_order_relaxed);
+                return run(*_primary, sql, params);
+            }
+            if (!unusable(e)) throw;
+            fail(*replica);
+            tried.push_back(replica);
+            _retries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (!_config.primary_fallback) {
+        throw ConnectionError("[Routing] No replica available");
+    }
+    _fallbackReads.fetch_add(1, std::memory_order_relaxed);
+    return run(*_primary, sql, params);
+}
+
+std::unique_ptr<IResult> RoutingDatabase::run(Backend& backend,
+                                              const std::string& sql,
+                                              const ParamPack* params) {
+    struct InFlight {
+        Backend& backend;
+        explicit InFlight(Backend& b) : backend(b) {
+            backend.outstanding.fetch_add(1, std::memory_order_relaxed);
+        }
+        ~InFlight() {
+            backend.outstanding.fetch_sub(1, std::memory_order_relaxed);
+        }
+    } inFlight(backend);
+
+    std::lock_guard<std::mutex> lock(backend.mutex);
+    // Replicas reconnect after a failure, the primary only on connect()
+    if (&backend != _primary.get() && !backend.db->connected())
+        backend.db->connect();
+
+    const auto start = Clock::now();
+    auto result = params ? backend.db->exec_params(sql, *params)
+                         : backend.db->exec(sql);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - start);
+    const auto sample = static_cast<double>(elapsed.count());
+
+    // Updated under the backend's mutex, so a plain load and store suffice
+    const auto ewma = static_cast<double>(backend.ewma_ns.load());
+    backend.ewma_ns.store(static_cast<std::uint64_t>(
+        ewma == 0 ? sample : ewma + _config.ewma_weight * (sample - ewma)));
+    backend.failures.store(0, std::memory_order_relaxed);
+    return result;
+}
+
+// Least loaded available replica not in tried (nullptr if none)
+RoutingDatabase::Backend* RoutingDatabase::pick(
+    const std::vector<const Backend*>& tried) {
+    const std::size_t count = _replicas.size();
+    if (count == 0) return nullptr;
+
+    const std::int64_t time = now();
+    const std::size_t offset =
+        _next.fetch_add(1, std::memory_order_relaxed) % count;
+    Backend* best = nullptr;
+    double bestScore = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        Backend& replica = *_replicas[(offset + i) % count];
+        if (!available(replica, time) ||
+            std::find(tried.begin(), tried.end(), &replica) != tried.end())
+            continue;
+
+        const double inFlight = replica.outstanding.load();
+        double score = inFlight;
+        if (_config.balance == RoutingBalance::Ewma) {
+            const std::uint64_t ewma = replica.ewma_ns.load();
+            score = static_cast<double>(std::max<std::uint64_t>(ewma, 1)) *
+                    (inFlight + 1);
+        }
+        if (best == nullptr || score < bestScore) {
+            best = &replica;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+bool RoutingDatabase::available(const Backend& backend,
+                                std::int64_t now) const noexcept {
+    return !backend.lagging.load() && backend.ejected_until.load() <= now;
+}
+
+void RoutingDatabase::fail(Backend& backend) {
+    {
+        // Drop the connection, the next use reconnects
+        std::lock_guard<std::mutex> lock(backend.mutex);
+        try {
+            backend.db->disconnect();
+        } catch (...) {
+        }
+    }
+    if (backend.failures.fetch_add(1) + 1 < _config.max_failures) return;
+
+    backend.failures.store(0);
+    backend.ejected_until.store(
+        now() + std::chrono::duration_cast<Clock::duration>(_config.eject_time)
+                    .count());
+    backend.ejections.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Reconnect if needed and probe the lag; ejected replicas only when
+// force or their ejection is over
+void RoutingDatabase::check(Backend& backend, bool force) {
+    if (!force && backend.ejected_until.load() > now()) return;
+
+    try {
+        std::lock_guard<std::mutex> lock(backend.mutex);
+        if (!backend.db->connected()) backend.db->connect();
+        const std::int64_t lag = _config.lag_probe(*backend.db).count();
+        backend.lag_ms.store(lag);
+        backend.lagging.store(_config.max_lag.count() > 0 &&
+                              lag > _config.max_lag.count());
+    } catch (const std::exception&) {
+        fail(backend);
+        return;
+    }
+    backend.failures.store(0);
+    backend.ejected_until.store(0);
+}
+
+void RoutingDatabase::maybe_check() {
+    if (_config.check_interval.count() == 0 || _replicas.empty()) return;
+
+    const std::int64_t time = now();
+    std::int64_t due = _nextCheck.load(std::memory_order_relaxed);
+    if (time < due) return;
+
+    // One caller runs the checks, the others keep routing
+    const std::int64_t next =
+        time +
+        std::chrono::duration_cast<Clock::duration>(_config.check_interval)
+            .count();
+    if (!_nextCheck.compare_exchange_strong(due, next)) return;
+    for (auto& replica : _replicas) check(*replica, false);
+}
+
+// Errors that say the backend is unusable, not that the SQL failed
+bool RoutingDatabase::unusable(const DatabaseError& e) noexcept {
+    const auto* query = dynamic_cast<const QueryError*>(&e);
+    if (query == nullptr) return true;
+
+    // Connection exceptions (08) and operator intervention (57P)
+    const std::string& state = query->sqlstate();
+    return state.compare(0, 2, "08") == 0 || state.compare(0, 3, "57P") == 0;
+}
+
+// Write rejected by a hot standby (read_only_sql_transaction)
+bool RoutingDatabase::read_only(const DatabaseError& e) noexcept {
+    const auto* query = dynamic_cast<const QueryError*>(&e);
+    return query != nullptr && query->sqlstate() == "25006";
+}
+
+std::int64_t RoutingDatabase::now() noexcept {
+    return Clock::now().time_since_epoch().count();
+}
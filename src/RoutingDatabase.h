@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DatabaseConfig.h"
+#include "Errors.h"
+#include "IDatabase.h"
+
+// How reads pick a replica
+enum class RoutingBalance {
+    LeastOutstanding,  // fewest statements in flight or waiting
+    Ewma               // lowest smoothed latency times (in flight + 1)
+};
+
+// Read/write splitting settings
+struct RoutingConfig {
+    RoutingBalance balance = RoutingBalance::LeastOutstanding;
+    double ewma_weight = 0.2;                        // of the newest sample
+    std::uint32_t max_failures = 1;                  // in a row to eject
+    std::chrono::milliseconds eject_time{5 * 1000};  // before a retry
+    std::chrono::milliseconds max_lag{10 * 1000};    // 0 ignores lag
+    std::chrono::milliseconds check_interval{1000};  // 0 disables lag checks
+    bool primary_fallback = true;  // reads use the primary without replicas
+
+    // Replication lag of a replica; the default asks PostgreSQL
+    // (RoutingDatabase::postgres_lag) and reports 0 for other backends
+    std::function<std::chrono::milliseconds(IDatabase&)> lag_probe;
+};
+
+// State of one replica
+struct ReplicaStats {
+    std::string connection_info;
+    bool available = false;         // neither ejected nor lagging
+    std::uint32_t outstanding = 0;  // statements in flight or waiting
+    std::uint64_t ewma_ns = 0;      // smoothed read latency
+    std::int64_t lag_ms = -1;       // at the last check, -1 if unknown
+    std::uint64_t reads = 0;
+    std::uint64_t ejections = 0;
+};
+
+// Routing counters
+struct RoutingStats {
+    std::uint64_t primary_statements = 0;  // writes, transactions, others
+    std::uint64_t replica_reads = 0;
+    std::uint64_t fallback_reads = 0;  // reads sent to the primary
+    std::uint64_t retries = 0;         // reads retried after a failure
+    std::vector<ReplicaStats> replicas;
+};
+
+// RoutingDatabase class - one primary and any number of read replicas
+// behind a single IDatabase. Reads of tables (see SqlClassifier) are
+// spread across the replicas; writes, locking reads, reads of no table or
+// with side effects (nextval, advisory locks), session settings,
+// unclassified SQL and everything between BEGIN and COMMIT/ROLLBACK go to
+// the primary, as do reads a standby rejects as writes (SQLSTATE 25006).
+// Replicas whose connection fails are ejected for eject_time and reads
+// retried elsewhere; replicas lagging more than max_lag are skipped until
+// a later check sees them caught up. Every backend runs one statement at a
+// time, so concurrent callers queue per backend.
+class RoutingDatabase : public IDatabase {
+   public:
+    // Creates every backend through DatabaseFactory
+    RoutingDatabase(const std::string& dbType, const DatabaseConfig& primary,
+                    const std::vector<DatabaseConfig>& replicas,
+                    const RoutingConfig& config = {});
+
+    RoutingDatabase(std::unique_ptr<IDatabase> primary,
+                    std::vector<std::unique_ptr<IDatabase>> replicas,
+                    const RoutingConfig& config = {});
+
+    RoutingDatabase(const RoutingDatabase&) noexcept = delete;
+    RoutingDatabase& operator=(const RoutingDatabase&) noexcept = delete;
+
+    std::string connection_info() const noexcept override;
+
+    // Whether the primary is connected
+    bool connected() const noexcept override;
+
+    // Connects the primary (throws) and the replicas (failures eject them)
+    void connect() override;
+
+    void disconnect() override;
+
+    std::unique_ptr<IResult> exec(const std::string& sql) override;
+
+    using IDatabase::exec_params;
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         const ParamPack& params) override;
+
+    // Run on the thread pool without serializing the whole router
+    using IDatabase::exec_params_async;
+    std::future<std::unique_ptr<IResult>> exec_async(
+        const std::string& sql) override;
+    std::future<std::unique_ptr<IResult>> exec_params_async(
+        const std::string& sql, const ParamPack& params) override;
+
+    // Probe the lag of every replica now and retry ejected ones
+    void check_replicas();
+
+    RoutingStats stats() const;
+
+    // Backends, for backend specific calls (not synchronized with routing)
+    IDatabase& primary() noexcept;
+    std::size_t replica_count() const noexcept;
+    IDatabase& replica(std::size_t index);
+
+    // Replay lag of a PostgreSQL standby (0 on a primary or when it has
+    // replayed everything it received)
+    static std::chrono::milliseconds postgres_lag(IDatabase& db);
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Backend {
+        std::unique_ptr<IDatabase> db;
+        std::mutex mutex;  // one statement at a time
+        std::atomic<std::uint32_t> outstanding{0};
+        std::atomic<std::uint64_t> ewma_ns{0};
+        std::atomic<std::int64_t> ejected_until{0};  // Clock ticks
+        std::atomic<std::int64_t> lag_ms{-1};
+        std::atomic<bool> lagging{false};
+        std::atomic<std::uint32_t> failures{0};  // in a row
+        std::atomic<std::uint64_t> reads{0};
+        std::atomic<std::uint64_t> ejections{0};
+    };
+
+    std::unique_ptr<IResult> route(const std::string& sql,
+                                   const ParamPack* params);
+    std::unique_ptr<IResult> read(const std::string& sql,
+                                  const ParamPack* params);
+    std::unique_ptr<IResult> run(Backend& backend, const std::string& sql,
+                                 const ParamPack* params);
+
+    // Least loaded available replica not in tried (nullptr if none)
+    Backend* pick(const std::vector<const Backend*>& tried);
+    bool available(const Backend& backend, std::int64_t now) const noexcept;
+    void fail(Backend& backend);
+    // Reconnect if needed and probe the lag; ejected replicas only when
+    // force or their ejection is over
+    void check(Backend& backend, bool force);
+    void maybe_check();
+
+    // Errors that say the backend is unusable, not that the SQL failed
+    static bool unusable(const DatabaseError& e) noexcept;
+    // Write rejected by a hot standby, to be run on the primary instead
+    static bool read_only(const DatabaseError& e) noexcept;
+    static std::int64_t now() noexcept;
+
+    RoutingConfig _config;
+    std::unique_ptr<Backend> _primary;
+    std::vector<std::unique_ptr<Backend>> _replicas;
+    std::atomic<bool> _inTransaction;
+    std::atomic<std::uint32_t> _next;  // rotates ties between replicas
+    std::atomic<std::int64_t> _nextCheck;
+    std::atomic<std::uint64_t> _primaryStatements;
+    std::atomic<std::uint64_t> _replicaReads;
+    std::atomic<std::uint64_t> _fallbackReads;
+    std::atomic<std::uint64_t> _retries;
+};
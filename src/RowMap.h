@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+
+// RowField struct - one struct member bound to a result column by name
+template <typename Struct, typename T>
+struct RowField final {
+    using value_type = T;
+
+    std::string_view column;
+    T Struct::*member;
+};
+
+template <typename Struct, typename T>
+constexpr RowField<Struct, T> row_field(std::string_view column,
+                                        T Struct::*member) noexcept {
+    return RowField<Struct, T>{column, member};
+}
+
+// RowMap class - declarative row-to-struct mapping, usually a constant:
+//   static constexpr auto UserRow = row_map(row_field("id", &User::id),
+//                                           row_field("name", &User::name));
+// Results resolve the column names once and then decode every row straight
+// into a default-constructed Struct (PostgreResult::to_structs). Members
+// of type std::optional<T> take NULLs.
+template <typename Struct, typename... T>
+class RowMap final {
+   public:
+    using Fields = std::tuple<RowField<Struct, T>...>;
+
+    static constexpr std::size_t size = sizeof...(T);
+
+    constexpr explicit RowMap(RowField<Struct, T>... fields) noexcept
+        : _fields(fields...) {}
+
+    constexpr const Fields& fields() const noexcept { return _fields; }
+
+    template <std::size_t I>
+    constexpr const auto& field() const noexcept {
+        return std::get<I>(_fields);
+    }
+
+   private:
+    Fields _fields;
+};
+
+template <typename Struct, typename... T>
+constexpr RowMap<Struct, T...> row_map(RowField<Struct, T>... fields) noexcept {
+    return RowMap<Struct, T...>(fields...);
+}
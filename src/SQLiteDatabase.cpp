@@ -1,49 +1,306 @@
 #include "SQLiteDatabase.h"
 
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
 #include <iostream>
 #include <stdexcept>
 
+namespace {
+
+// Journal modes accepted by PRAGMA journal_mode
+bool valid_journal_mode(std::string mode) {
+    std::transform(mode.begin(), mode.end(), mode.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    return mode == "delete" || mode == "truncate" || mode == "persist" ||
+           mode == "memory" || mode == "wal" || mode == "off";
+}
+
+bool blank(const char* text) noexcept {
+    for (; *text; ++text)
+        if (!std::isspace(static_cast<unsigned char>(*text))) return false;
+    return true;
+}
+
+// Resets a statement when leaving scope so it can be reused
+struct ResetGuard {
+    sqlite3_stmt* stmt;
+    ~ResetGuard() {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+};
+
+}  // namespace
+
+std::unique_ptr<IResult> SQLiteResult::clone() const {
+    return std::make_unique<SQLiteResult>(*this);
+}
+
+void SQLiteDatabase::Finalizer::operator()(sqlite3_stmt* stmt) const noexcept {
+    sqlite3_finalize(stmt);
+}
+
 SQLiteDatabase::SQLiteDatabase(const std::string& filepath) noexcept
-    : _filepath(filepath), _connected(false) {}
+    : SQLiteDatabase(DatabaseConfig(filepath)) {}
+
+SQLiteDatabase::SQLiteDatabase(const DatabaseConfig& config) noexcept
+    : _config(config), _db(nullptr), _statements(64) {
+    if (_config.filepath.empty()) _config.filepath = ":memory:";
+}
+
+SQLiteDatabase::~SQLiteDatabase() noexcept {
+    _statements.clear();
+    if (_db) sqlite3_close_v2(_db);
+}
 
 std::string SQLiteDatabase::connection_info() const noexcept {
-    return "SQLite Database at " + _filepath;
+    return "SQLite Database at " + _config.filepath;
 }
 
-bool SQLiteDatabase::connected() const noexcept { return _connected; }
+bool SQLiteDatabase::connected() const noexcept { return _db != nullptr; }
 
 void SQLiteDatabase::connect() {
-    if (_connected) {
+    if (connected()) {
         std::cout << "[SQLite] Already connected\n";
         return;
     }
-    std::cout << "[SQLite] Opening database: " << _filepath << "\n";
-    // Simulate connection logic
-    _connected = true;
+    std::cout << "[SQLite] Opening database: " << _config.filepath << "\n";
+
+    // Connections are confined to one thread at a time, so SQLite's own
+    // per-connection mutex is not needed
+    int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_URI |
+                SQLITE_OPEN_NOMUTEX;
+    int rc = sqlite3_open_v2(_config.filepath.c_str(), &_db, flags, nullptr);
+    if (rc != SQLITE_OK) {
+        std::string msg = _db ? sqlite3_errmsg(_db) : sqlite3_errstr(rc);
+        sqlite3_close_v2(_db);
+        _db = nullptr;
+        throw ConnectionError("[SQLite] " + msg);
+    }
+
+    try {
+        sqlite3_busy_timeout(_db, _config.busy_timeout);
+        if (!_config.journal_mode.empty()) {
+            if (!valid_journal_mode(_config.journal_mode)) {
+                throw ConnectionError("[SQLite] Invalid journal mode: " +
+                                      _config.journal_mode);
+            }
+            pragma("PRAGMA journal_mode=" + _config.journal_mode);
+        }
+        pragma("PRAGMA mmap_size=" + std::to_string(_config.mmap_size));
+        if (_config.cache_size != 0) {
+            pragma("PRAGMA cache_size=" + std::to_string(_config.cache_size));
+        }
+    } catch (...) {
+        sqlite3_close_v2(_db);
+        _db = nullptr;
+        throw;
+    }
     std::cout << "[SQLite] Successfully opened\n";
 }
 
 void SQLiteDatabase::disconnect() {
-    if (!_connected) {
+    if (!connected()) {
         std::cout << "[SQLite] Already disconnected\n";
         return;
     }
     std::cout << "[SQLite] Closing database\n";
-    _connected = false;
+    // Statements must be finalized before the connection closes
+    _statements.clear();
+    sqlite3_close_v2(_db);
+    _db = nullptr;
     std::cout << "[SQLite] Successfully closed\n";
 }
 
+// Execute one or more ';'-separated statements, returns the last result
 std::unique_ptr<IResult> SQLiteDatabase::exec(const std::string& sql) {
-    if (!_connected) {
-        throw std::runtime_error("[SQLite] Database not connected");
-    }
-    std::cout << "[SQLite] Executing query: " << sql << "\n";
-    // Simulate query execution
-    std::cout << "[SQLite] Query executed successfully\n";
-    return nullptr;
+    return std::make_unique<SQLiteResult>(query_params(sql, ParamPack()));
 }
 
 std::unique_ptr<IResult> SQLiteDatabase::exec_params(
-    const std::string& sql, const std::vector<std::any>& args) {
-    return nullptr;
+    const std::string& sql, const ParamPack& params) {
+    return std::make_unique<SQLiteResult>(query_params(sql, params));
+}
+
+// Same as exec and exec_params, returning the result by value
+SQLiteResult SQLiteDatabase::query(const std::string& sql) {
+    return query_params(sql, ParamPack());
+}
+
+// Prepared statement cache keyed by SQL (capacity 0 disables)
+void SQLiteDatabase::statement_cache(std::size_t capacity) {
+    _statements = LruCache<std::string, Statement>(capacity);
+}
+
+std::size_t SQLiteDatabase::cached_statements() const noexcept {
+    return _statements.size();
+}
+
+// Underlying connection handle (nullptr when disconnected)
+sqlite3* SQLiteDatabase::handle() const noexcept { return _db; }
+
+SQLiteResult SQLiteDatabase::query_params(const std::string& sql,
+                                          const ParamPack& params) {
+    if (!connected()) {
+        throw ConnectionError("[SQLite] Database not connected");
+    }
+
+    if (auto cached = _statements.find(sql)) return step(cached->get(), params);
+
+    const bool cache = _statements.capacity() > 0;
+    SQLiteResult result{std::vector<std::string>()};
+    const char* head = sql.c_str();
+    while (*head) {
+        sqlite3_stmt* raw = nullptr;
+        const char* tail = nullptr;
+        int rc = sqlite3_prepare_v3(_db, head, -1,
+                                    cache ? SQLITE_PREPARE_PERSISTENT : 0,
+                                    &raw, &tail);
+        if (rc != SQLITE_OK) {
+            throw QueryError("[SQLite] " + std::string(sqlite3_errmsg(_db)));
+        }
+        if (raw == nullptr) break;  // only whitespace or comments left
+
+        Statement stmt(raw);
+        result = step(stmt.get(), params);
+
+        // Only single-statement SQL is cached, scripts are re-parsed
+        if (cache && head == sql.c_str() && blank(tail)) {
+            _statements.insert(sql, std::move(stmt));
+            break;
+        }
+        head = tail;
+    }
+
+    return result;
+}
+
+SQLiteResult SQLiteDatabase::step(sqlite3_stmt* stmt,
+                                  const ParamPack& params) {
+    ResetGuard guard{stmt};
+    bind(stmt, params);
+
+    // Columns are read after the first step: a cached statement whose
+    // schema changed is prepared again there (SELECT * may gain columns)
+    int rc = sqlite3_step(stmt);
+    const int count = sqlite3_column_count(stmt);
+    std::vector<std::string> names;
+    names.reserve(count);
+    for (int col = 0; col < count; ++col)
+        names.emplace_back(sqlite3_column_name(stmt, col));
+
+    SQLiteResult result(std::move(names));
+    std::vector<Param> row(count);
+    for (; rc == SQLITE_ROW; rc = sqlite3_step(stmt)) {
+        for (int col = 0; col < count; ++col) {
+            switch (sqlite3_column_type(stmt, col)) {
+                case SQLITE_INTEGER:
+                    row[col] = Param(sqlite3_column_int64(stmt, col));
+                    break;
+                case SQLITE_FLOAT:
+                    row[col] = Param(sqlite3_column_double(stmt, col));
+                    break;
+                case SQLITE_TEXT: {
+                    auto text = reinterpret_cast<const char*>(
+                        sqlite3_column_text(stmt, col));
+                    row[col] = Param(std::string_view(
+                        text, sqlite3_column_bytes(stmt, col)));
+                    break;
+                }
+                case SQLITE_BLOB: {
+                    auto blob = static_cast<const char*>(
+                        sqlite3_column_blob(stmt, col));
+                    row[col] = Param::bytea(std::string_view(
+                        blob, sqlite3_column_bytes(stmt, col)));
+                    break;
+                }
+                default:
+                    row[col] = Param();
+            }
+        }
+        result.append(row);
+    }
+    if (rc != SQLITE_DONE) {
+        throw QueryError("[SQLite] " + std::string(sqlite3_errmsg(_db)));
+    }
+
+    result.finish(sqlite3_stmt_readonly(stmt) ? 0 : sqlite3_changes(_db),
+                  sqlite3_last_insert_rowid(_db));
+    return result;
+}
+
+void SQLiteDatabase::bind(sqlite3_stmt* stmt, const ParamPack& params) {
+    const int count = sqlite3_bind_parameter_count(stmt);
+    for (int index = 1; index <= count; ++index) {
+        // '$n' and '?n' refer to the n-th parameter, anything else binds
+        // in order of appearance
+        std::size_t position = static_cast<std::size_t>(index);
+        const char* name = sqlite3_bind_parameter_name(stmt, index);
+        if (name && (name[0] == '$' || name[0] == '?') &&
+            std::isdigit(static_cast<unsigned char>(name[1])))
+            position = std::strtoul(name + 1, nullptr, 10);
+
+        if (position == 0 || position > params.size()) {
+            throw QueryError("[SQLite] Missing value for parameter " +
+                             std::string(name ? name : "?") + " (" +
+                             std::to_string(position) + ")");
+        }
+
+        const Param& param = params[position - 1];
+        int rc = SQLITE_OK;
+        switch (param.type()) {
+            case Param::Type::Null:
+                rc = sqlite3_bind_null(stmt, index);
+                break;
+            case Param::Type::Bool:
+                rc = sqlite3_bind_int(stmt, index, param.as_bool());
+                break;
+            case Param::Type::Int:
+                rc = sqlite3_bind_int64(stmt, index, param.as_int());
+                break;
+            case Param::Type::Float:
+                rc = sqlite3_bind_double(stmt, index, param.as_float());
+                break;
+            case Param::Type::Text: {
+                // The pack outlives the statement execution
+                auto text = param.as_text();
+                rc = sqlite3_bind_text(stmt, index, text.data(),
+                                       static_cast<int>(text.size()),
+                                       SQLITE_STATIC);
+                break;
+            }
+            case Param::Type::Bytea: {
+                auto bytes = param.as_text();
+                rc = sqlite3_bind_blob(stmt, index, bytes.data(),
+                                       static_cast<int>(bytes.size()),
+                                       SQLITE_STATIC);
+                break;
+            }
+            case Param::Type::Timestamp: {
+                char buffer[Param::TextSize];
+                auto text = param.to_text(buffer);
+                rc = sqlite3_bind_text(stmt, index, text.data(),
+                                       static_cast<int>(text.size()),
+                                       SQLITE_TRANSIENT);
+                break;
+            }
+        }
+        if (rc != SQLITE_OK) {
+            throw QueryError("[SQLite] " + std::string(sqlite3_errmsg(_db)));
+        }
+    }
+}
+
+void SQLiteDatabase::pragma(const std::string& sql) {
+    char* error = nullptr;
+    if (sqlite3_exec(_db, sql.c_str(), nullptr, nullptr, &error) !=
+        SQLITE_OK) {
+        std::string msg = error ? error : sqlite3_errmsg(_db);
+        sqlite3_free(error);
+        throw ConnectionError("[SQLite] " + sql + ": " + msg);
+    }
 }
@@ -1,11 +1,38 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "CellResult.h"
+#include "DatabaseConfig.h"
 #include "IDatabase.h"
+#include "LruCache.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+// SQLiteResult class - rows of a statement with cells as stored by SQLite
+// (integer, float, text, blob or NULL)
+class SQLiteResult : public CellResult {
+   public:
+    using CellResult::CellResult;
 
-// SQLite Database implementation
+    std::unique_ptr<IResult> clone() const override;
+};
+
+// SQLite Database implementation over the sqlite3 C API. Each instance owns
+// one connection and is used by one thread at a time; in WAL mode several
+// instances on the same file read in parallel with one writer.
 class SQLiteDatabase : public IDatabase {
    public:
     SQLiteDatabase(const std::string& filepath = ":memory:") noexcept;
+    explicit SQLiteDatabase(const DatabaseConfig& config) noexcept;
+
+    SQLiteDatabase(const SQLiteDatabase&) noexcept = delete;
+    SQLiteDatabase& operator=(const SQLiteDatabase&) noexcept = delete;
+
+    ~SQLiteDatabase() noexcept override;
 
     std::string connection_info() const noexcept override;
 
@@ -15,12 +42,37 @@ class SQLiteDatabase : public IDatabase {
 
     void disconnect() override;
 
+    // Execute one or more ';'-separated statements, returns the last result
     std::unique_ptr<IResult> exec(const std::string& sql) override;
 
-    std::unique_ptr<IResult> exec_params(
-        const std::string& sql, const std::vector<std::any>& args) override;
+    // Parameters are bound by position ('?') or number ('$n', '?n')
+    using IDatabase::exec_params;
+    std::unique_ptr<IResult> exec_params(const std::string& sql,
+                                         const ParamPack& params) override;
+
+    // Same as exec and exec_params, returning the result by value
+    SQLiteResult query(const std::string& sql);
+    SQLiteResult query_params(const std::string& sql, const ParamPack& params);
+
+    // Prepared statement cache keyed by SQL (capacity 0 disables)
+    void statement_cache(std::size_t capacity);
+
+    std::size_t cached_statements() const noexcept;
+
+    // Underlying connection handle (nullptr when disconnected)
+    sqlite3* handle() const noexcept;
 
    private:
-    std::string _filepath;
-    bool _connected;
+    struct Finalizer {
+        void operator()(sqlite3_stmt* stmt) const noexcept;
+    };
+    using Statement = std::unique_ptr<sqlite3_stmt, Finalizer>;
+
+    SQLiteResult step(sqlite3_stmt* stmt, const ParamPack& params);
+    void bind(sqlite3_stmt* stmt, const ParamPack& params);
+    void pragma(const std::string& sql);
+
+    DatabaseConfig _config;
+    sqlite3* _db;
+    LruCache<std::string, Statement> _statements;
 };
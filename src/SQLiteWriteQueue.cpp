@@ -0,0 +1,145 @@
+#include "SQLiteWriteQueue.h"
+
+#include <exception>
+
+#include "Errors.h"
+
+// Connects immediately (throws ConnectionError); at most maxBatch writes
+// share a transaction
+SQLiteWriteQueue::SQLiteWriteQueue(const DatabaseConfig& config,
+                                   std::size_t maxBatch)
+    : _db(config),
+      _maxBatch(maxBatch == 0 ? 1 : maxBatch),
+      _inFlight(0),
+      _stopping(false) {
+    _db.connect();
+    _writer = std::thread([this] { run(); });
+}
+
+// Commits queued writes, then stops the writer
+SQLiteWriteQueue::~SQLiteWriteQueue() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _ready.notify_all();
+    if (_writer.joinable()) _writer.join();
+}
+
+// Queue a write, the future is ready once its transaction committed
+std::future<std::unique_ptr<IResult>> SQLiteWriteQueue::submit(
+    std::string sql, ParamPack params) {
+    Write write{std::move(sql), std::move(params), {}};
+    auto future = write.promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_stopping) throw DatabaseError("[SQLite] Write queue is stopped");
+        _queue.push_back(std::move(write));
+    }
+    _ready.notify_one();
+    return future;
+}
+
+// Writes queued but not yet committed
+std::size_t SQLiteWriteQueue::pending() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size() + _inFlight;
+}
+
+SQLiteWriteStats SQLiteWriteQueue::stats() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void SQLiteWriteQueue::run() noexcept {
+    std::vector<Write> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _ready.wait(lock, [this] { return _stopping || !_queue.empty(); });
+            if (_queue.empty()) return;  // stopping and drained
+
+            // Everything that queued up while the last batch was written
+            while (!_queue.empty() && batch.size() < _maxBatch) {
+                batch.push_back(std::move(_queue.front()));
+                _queue.pop_front();
+            }
+            _inFlight = batch.size();
+        }
+
+        commit(batch);
+        batch.clear();
+    }
+}
+
+void SQLiteWriteQueue::commit(std::vector<Write>& batch) noexcept {
+    std::vector<std::unique_ptr<IResult>> results(batch.size());
+    std::vector<std::exception_ptr> errors(batch.size());
+    std::size_t failures = 0;
+
+    try {
+        _db.exec("BEGIN IMMEDIATE");
+    } catch (...) {
+        auto error = std::current_exception();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stats.failures += batch.size();
+            _inFlight = 0;
+        }
+        for (auto& write : batch) write.promise.set_exception(error);
+        return;
+    }
+
+    std::exception_ptr commitError;
+    for (std::size_t i = 0; i < batch.size() && !commitError; ++i) {
+        try {
+            _db.exec("SAVEPOINT dbf_write");
+            try {
+                results[i] = _db.exec_params(batch[i].sql, batch[i].params);
+            } catch (...) {
+                errors[i] = std::current_exception();
+                ++failures;
+                _db.exec("ROLLBACK TO dbf_write");
+            }
+            _db.exec("RELEASE dbf_write");
+        } catch (...) {
+            // Savepoint bookkeeping failed, give up on the whole batch
+            commitError = std::current_exception();
+        }
+    }
+
+    try {
+        if (!commitError) _db.exec("COMMIT");
+    } catch (...) {
+        commitError = std::current_exception();
+    }
+    if (commitError) {
+        try {
+            _db.exec("ROLLBACK");
+        } catch (...) {
+            // Transaction is already gone
+        }
+    }
+
+    // Counters first, so they include a write once its future is ready
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (commitError) {
+            _stats.failures += batch.size();
+        } else {
+            _stats.writes += batch.size() - failures;
+            _stats.failures += failures;
+            ++_stats.transactions;
+        }
+        _inFlight = 0;
+    }
+
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        if (commitError)
+            batch[i].promise.set_exception(commitError);
+        else if (errors[i])
+            batch[i].promise.set_exception(errors[i]);
+        else
+            batch[i].promise.set_value(std::move(results[i]));
+    }
+}
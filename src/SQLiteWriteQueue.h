@@ -0,0 +1,77 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "DatabaseConfig.h"
+#include "SQLiteDatabase.h"
+
+// Write queue counters
+struct SQLiteWriteStats {
+    std::size_t writes = 0;        // statements executed
+    std::size_t failures = 0;      // statements rolled back on error
+    std::size_t transactions = 0;  // batches committed
+};
+
+// SQLiteWriteQueue class - single writer thread with its own connection.
+// Writes submitted from any thread are batched into one transaction per
+// wake-up (each under its own savepoint, so one failing write does not
+// undo the others) while readers use separate SQLiteDatabase instances.
+class SQLiteWriteQueue final {
+   public:
+    // Connects immediately (throws ConnectionError); at most maxBatch
+    // writes share a transaction
+    explicit SQLiteWriteQueue(const DatabaseConfig& config,
+                              std::size_t maxBatch = 256);
+
+    SQLiteWriteQueue(const SQLiteWriteQueue&) noexcept = delete;
+    SQLiteWriteQueue& operator=(const SQLiteWriteQueue&) noexcept = delete;
+
+    // Commits queued writes, then stops the writer
+    ~SQLiteWriteQueue() noexcept;
+
+    // Queue a write, the future is ready once its transaction committed.
+    // sql must not begin or end transactions itself.
+    std::future<std::unique_ptr<IResult>> submit(std::string sql,
+                                                 ParamPack params = {});
+
+    template <typename... Args, typename = ParamPack::EnableIfValues<Args...>>
+    std::future<std::unique_ptr<IResult>> submit(std::string sql,
+                                                 Args&&... args) {
+        return submit(std::move(sql),
+                      ParamPack::of(std::forward<Args>(args)...));
+    }
+
+    // Writes queued but not yet committed
+    std::size_t pending() const;
+
+    SQLiteWriteStats stats() const;
+
+   private:
+    struct Write {
+        std::string sql;
+        ParamPack params;
+        std::promise<std::unique_ptr<IResult>> promise;
+    };
+
+    void run() noexcept;
+    void commit(std::vector<Write>& batch) noexcept;
+
+    SQLiteDatabase _db;
+    std::size_t _maxBatch;
+    mutable std::mutex _mutex;
+    std::condition_variable _ready;
+    std::deque<Write> _queue;
+    std::size_t _inFlight;
+    SQLiteWriteStats _stats;
+    bool _stopping;
+    std::thread _writer;
+};
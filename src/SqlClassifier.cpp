@@ -0,0 +1,258 @@
+#include "SqlClassifier.h"
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace {
+
+// Word or punctuation of a statement, with literals and comments removed
+struct Token {
+    std::string_view word;  // lowercased identifier or keyword
+    char punct;        // one of , ( ) ; . when word is empty
+};
+
+bool word_char(char c) noexcept {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' ||
+           c == '$' || static_cast<unsigned char>(c) >= 0x80;
+}
+
+std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    });
+    return text;
+}
+
+// Tokens of lowercased SQL; words are views into it
+std::vector<Token> tokenize(std::string_view sql) {
+    std::vector<Token> tokens;
+    tokens.reserve(sql.size() / 4 + 4);
+    const std::size_t n = sql.size();
+    std::size_t i = 0;
+    while (i < n) {
+        const char c = sql[i];
+        if (c == '-' && i + 1 < n && sql[i + 1] == '-') {
+            i = sql.find('\n', i);
+            if (i == std::string_view::npos) break;
+        } else if (c == '/' && i + 1 < n && sql[i + 1] == '*') {
+            i = sql.find("*/", i + 2);
+            if (i == std::string_view::npos) break;
+            i += 2;
+        } else if (c == '\'') {
+            // String literal, '' and (MySQL) backslash escapes
+            for (++i; i < n; ++i) {
+                if (sql[i] == '\\') {
+                    ++i;
+                } else if (sql[i] == '\'') {
+                    if (i + 1 < n && sql[i + 1] == '\'')
+                        ++i;
+                    else
+                        break;
+                }
+            }
+            ++i;
+        } else if (c == '$' && i + 1 < n &&
+                   !std::isdigit(static_cast<unsigned char>(sql[i + 1]))) {
+            // PostgreSQL dollar quoting: $tag$ ... $tag$
+            std::size_t close = sql.find('$', i + 1);
+            if (close == std::string_view::npos) break;
+            std::string_view tag = sql.substr(i, close - i + 1);
+            std::size_t end = sql.find(tag, close + 1);
+            if (end == std::string_view::npos) break;
+            i = end + tag.size();
+        } else if (c == '"' || c == '`') {
+            std::size_t close = sql.find(c, i + 1);
+            if (close == std::string_view::npos) break;
+            tokens.push_back({sql.substr(i + 1, close - i - 1), 0});
+            i = close + 1;
+        } else if (word_char(c)) {
+            std::size_t start = i;
+            while (i < n && word_char(sql[i])) ++i;
+            tokens.push_back({sql.substr(start, i - start), 0});
+        } else {
+            if (c == ',' || c == '(' || c == ')' || c == ';' || c == '.')
+                tokens.push_back({std::string_view(), c});
+            ++i;
+        }
+    }
+    return tokens;
+}
+
+template <std::size_t N>
+bool any_of(std::string_view word, const std::string_view (&words)[N]) {
+    return std::find(std::begin(words), std::end(words), word) !=
+           std::end(words);
+}
+
+// Words that end a FROM list
+constexpr std::string_view StopWords[] = {
+    "where",  "join",    "inner",  "left",      "right",  "full",
+    "cross",  "natural", "on",     "using",     "group",  "order",
+    "having", "limit",   "offset", "union",     "intersect",
+    "except", "window",  "for",    "fetch",     "returning",
+    "set",    "values",  "select", "straight_join"};
+
+// Modifiers that may precede a table name
+constexpr std::string_view Modifiers[] = {
+    "only",   "low_priority", "quick",  "ignore", "delayed", "high_priority",
+    "if",     "not",          "exists", "table",  "lateral"};
+
+// Table named at tokens[i] (last component of schema.table), or empty
+std::string table_at(const std::vector<Token>& tokens, std::size_t& i) {
+    while (i < tokens.size() && any_of(tokens[i].word, Modifiers)) ++i;
+    if (i >= tokens.size() || tokens[i].word.empty()) return std::string();
+
+    std::string_view name = tokens[i++].word;
+    while (i + 1 < tokens.size() && tokens[i].punct == '.' &&
+           !tokens[i + 1].word.empty()) {
+        name = tokens[i + 1].word;
+        i += 2;
+    }
+    return std::string(name);
+}
+
+// Tables of a FROM list: names after the keyword and after each comma
+void from_list(const std::vector<Token>& tokens, std::size_t i,
+               std::vector<std::string>& tables) {
+    while (i < tokens.size()) {
+        if (tokens[i].punct == '(') return;  // subquery, scanned on its own
+        std::string name = table_at(tokens, i);
+        if (name.empty()) return;
+        tables.push_back(std::move(name));
+
+        // Skip an alias up to the next comma
+        while (i < tokens.size() && tokens[i].punct != ',') {
+            const Token& token = tokens[i];
+            if (token.punct != 0 || any_of(token.word, StopWords)) return;
+            ++i;
+        }
+        ++i;
+    }
+}
+
+// Functions that write, lock or read session state, which a read-only
+// standby rejects or answers differently
+constexpr std::string_view SideEffects[] = {
+    "nextval",              "setval",               "currval",
+    "lastval",              "set_config",           "pg_notify",
+    "txid_current",         "pg_current_xact_id",   "lo_create",
+    "lo_import",            "lo_unlink",            "pg_switch_wal",
+    "pg_cancel_backend",    "pg_terminate_backend", "last_insert_id",
+    "get_lock",             "release_lock",         "release_all_locks"};
+
+bool side_effect(const std::vector<Token>& tokens, std::size_t i) {
+    const std::string_view word = tokens[i].word;
+    if (i + 1 >= tokens.size() || tokens[i + 1].punct != '(') return false;
+    // pg_advisory_lock, pg_try_advisory_xact_lock_shared, ...
+    return any_of(word, SideEffects) || word.substr(0, 11) == "pg_advisory" ||
+           word.substr(0, 15) == "pg_try_advisory";
+}
+
+// Transaction boundary set by a statement starting with verb
+SqlTransaction boundary(const std::vector<Token>& tokens, std::size_t first) {
+    const std::string_view verb = tokens[first].word;
+    if (verb == "begin" || verb == "start") return SqlTransaction::Begin;
+    if (verb == "commit" || verb == "end" || verb == "abort")
+        return SqlTransaction::End;
+    if (verb == "rollback") {
+        // ROLLBACK TO SAVEPOINT stays in the transaction
+        for (std::size_t i = first + 1; i < tokens.size(); ++i)
+            if (tokens[i].word == "to") return SqlTransaction::None;
+        return SqlTransaction::End;
+    }
+    if (verb == "prepare" && first + 1 < tokens.size() &&
+        tokens[first + 1].word == "transaction")
+        return SqlTransaction::End;
+    return SqlTransaction::None;
+}
+
+}  // namespace
+
+SqlStatement SqlClassifier::classify(const std::string& sql) {
+    const std::string text = lower(sql);
+    const std::vector<Token> tokens = tokenize(text);
+
+    std::size_t first = 0;
+    while (first < tokens.size() && tokens[first].word.empty()) ++first;
+    if (first == tokens.size())
+        return {SqlKind::Neutral, SqlTransaction::None, {}};
+    const std::string_view verb = tokens[first].word;
+
+    for (std::size_t i = first; i + 1 < tokens.size(); ++i) {
+        // Several statements in one call
+        if (tokens[i].punct == ';')
+            return {SqlKind::Other, SqlTransaction::None, {}};
+    }
+
+    static constexpr std::string_view Neutral[] = {
+        "begin",   "start", "commit", "end", "rollback",
+        "release", "savepoint", "set", "reset"};
+    const SqlTransaction transaction = boundary(tokens, first);
+    if (any_of(verb, Neutral) || transaction != SqlTransaction::None)
+        return {SqlKind::Neutral, transaction, {}};
+
+    static constexpr std::string_view Reads[] = {"select", "with", "values",
+                                                 "table", "show"};
+    static constexpr std::string_view Writes[] = {
+        "insert", "update", "delete", "replace", "merge", "upsert",
+        "truncate", "alter", "drop", "create", "copy", "load"};
+    SqlKind kind = any_of(verb, Reads)    ? SqlKind::Read
+                   : any_of(verb, Writes) ? SqlKind::Write
+                                          : SqlKind::Other;
+
+    // FOR UPDATE, FOR NO KEY UPDATE, FOR SHARE, FOR KEY SHARE
+    static constexpr std::string_view LockModes[] = {"update", "share", "no",
+                                                     "key"};
+
+    SqlStatement statement{kind, SqlTransaction::None, {}};
+    for (std::size_t i = first; i < tokens.size(); ++i) {
+        const std::string_view word = tokens[i].word;
+        if (side_effect(tokens, i)) statement.side_effects = true;
+        const bool locking = i > 0 && tokens[i - 1].word == "for" &&
+                             any_of(word, LockModes);
+        if (locking) {
+            // SELECT ... FOR UPDATE/SHARE takes row locks
+            if (statement.kind == SqlKind::Read)
+                statement.kind = SqlKind::Neutral;
+        } else if (word == "insert" || word == "update" || word == "delete" ||
+                   word == "merge") {
+            // Data-modifying WITH
+            if (statement.kind == SqlKind::Read)
+                statement.kind = SqlKind::Write;
+        } else if (word == "into" && statement.kind == SqlKind::Read) {
+            // SELECT ... INTO creates a table
+            statement.kind = SqlKind::Other;
+        }
+    }
+    if (statement.kind == SqlKind::Other ||
+        statement.kind == SqlKind::Neutral)
+        return {statement.kind, SqlTransaction::None, {},
+                statement.side_effects};
+
+    for (std::size_t i = first; i < tokens.size(); ++i) {
+        const std::string_view word = tokens[i].word;
+        std::size_t next = i + 1;
+        if (word == "from" || word == "join") {
+            from_list(tokens, next, statement.tables);
+        } else if (statement.kind == SqlKind::Write &&
+                   (word == "table" || word == "truncate")) {
+            // TRUNCATE [TABLE] a, b and DROP TABLE a, b name several
+            from_list(tokens, next, statement.tables);
+        } else if (statement.kind == SqlKind::Write &&
+                   (word == "into" || (word == "update" && i == first))) {
+            std::string name = table_at(tokens, next);
+            if (!name.empty()) statement.tables.push_back(std::move(name));
+        }
+    }
+    std::sort(statement.tables.begin(), statement.tables.end());
+    statement.tables.erase(
+        std::unique(statement.tables.begin(), statement.tables.end()),
+        statement.tables.end());
+
+    // A write to an unknown table may affect any cached read
+    if (statement.kind == SqlKind::Write && statement.tables.empty())
+        statement.kind = SqlKind::Other;
+    return statement;
+}
+
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Effect of a statement on the data
+enum class SqlKind {
+    Read,     // SELECT, WITH, VALUES, TABLE, SHOW without locks or INTO
+    Write,    // INSERT, UPDATE, DELETE, DDL, ... naming their tables
+    Neutral,  // transaction control, session settings, locking reads
+    Other     // anything else, several statements, unknown tables
+};
+
+// Transaction boundary set by a statement
+enum class SqlTransaction { None, Begin, End };
+
+struct SqlStatement {
+    SqlKind kind;
+    SqlTransaction transaction;
+    std::vector<std::string> tables;  // read or written, lowercase, no schema
+    // Calls a function known to change or depend on session or server
+    // state (nextval, setval, currval, advisory locks, set_config, ...)
+    bool side_effects = false;
+};
+
+// SqlClassifier class - lexical classification of a single statement,
+// enough to tell what may be cached or sent to a replica. Literals, quoted
+// strings and comments are skipped; user functions with side effects
+// called from a SELECT cannot be told apart from reads.
+class SqlClassifier final {
+   public:
+    SqlClassifier() = delete;
+    ~SqlClassifier() = delete;
+
+    static SqlStatement classify(const std::string& sql);
+};
@@ -0,0 +1,440 @@
+#include "SqlFingerprint.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+enum class Kind { None, Word, Literal, Open, Close, Comma, Dot, Cast, Other };
+
+bool alpha(char c) noexcept {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_' ||
+           static_cast<unsigned char>(c) >= 0x80;
+}
+
+bool digit(char c) noexcept {
+    return std::isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+bool operator_char(char c) noexcept {
+    switch (c) {
+        case '+':
+        case '-':
+        case '*':
+        case '/':
+        case '<':
+        case '>':
+        case '=':
+        case '~':
+        case '!':
+        case '@':
+        case '#':
+        case '%':
+        case '^':
+        case '&':
+        case '|':
+        case ':':
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Normalized text with canonical spacing and collapsed literal lists
+class Builder {
+   public:
+    explicit Builder(std::size_t capacity) { _out.reserve(capacity); }
+
+    Kind last() const noexcept { return _last; }
+
+    void add(Kind kind, std::string_view text, bool spaced) {
+        if (space_before(kind, spaced)) _out += ' ';
+
+        if (!_groups.empty() && kind != Kind::Literal && kind != Kind::Comma &&
+            kind != Kind::Close)
+            _groups.back().literals = false;
+
+        if (kind == Kind::Close && !_groups.empty()) {
+            const Group group = _groups.back();
+            _groups.pop_back();
+            if (group.literals && _out.size() > group.start) {
+                _out.resize(group.start);
+                _out += "...";
+            }
+        }
+        _out.append(text.data(), text.size());
+        if (kind == Kind::Open) _groups.push_back({_out.size(), true});
+        _last = kind;
+    }
+
+    std::string take() {
+        // Trailing semicolons do not change the statement
+        while (!_out.empty() && (_out.back() == ';' || _out.back() == ' '))
+            _out.pop_back();
+        return std::move(_out);
+    }
+
+   private:
+    struct Group {
+        std::size_t start;  // first byte after '('
+        bool literals;      // only literals and commas so far
+    };
+
+    bool space_before(Kind kind, bool spaced) const noexcept {
+        if (_out.empty()) return false;
+        switch (kind) {
+            case Kind::Close:
+            case Kind::Comma:
+            case Kind::Dot:
+            case Kind::Cast:
+                return false;
+            case Kind::Open:
+                // Keeps "count(*)" and "IN (" apart from each other
+                if (_last == Kind::Word) return spaced;
+                break;
+            default:
+                break;
+        }
+        return _last != Kind::Open && _last != Kind::Dot && _last != Kind::Cast;
+    }
+
+    std::string _out;
+    Kind _last = Kind::None;
+    std::vector<Group> _groups;
+};
+
+// Byte classes used by SqlFingerprint::key, matching alpha(), digit()
+// and std::isspace in the C locale without a call per byte
+struct KeyClasses {
+    enum : unsigned char { Alpha = 1, Word = 2, Digit = 4, Space = 8 };
+
+    unsigned char of[256];
+    char lower[256];
+};
+
+const KeyClasses& key_classes() noexcept {
+    static const KeyClasses classes = [] {
+        KeyClasses table{};
+        for (int c = 0; c < 256; ++c) {
+            const char ch = static_cast<char>(c);
+            unsigned char bits = 0;
+            if (alpha(ch)) bits |= KeyClasses::Alpha | KeyClasses::Word;
+            if (digit(ch)) bits |= KeyClasses::Digit | KeyClasses::Word;
+            if (ch == '$') bits |= KeyClasses::Word;
+            if (std::isspace(c)) bits |= KeyClasses::Space;
+            table.of[c] = bits;
+            table.lower[c] = static_cast<char>(std::tolower(c));
+        }
+        return table;
+    }();
+    return classes;
+}
+
+// Hash of the token stream read by SqlFingerprint::key. Bytes are
+// buffered and mixed eight at a time; markers for skipped literals and
+// whitespace are escaped with a zero byte so raw text cannot forge them.
+class KeyHasher {
+   public:
+    enum Marker : char { Space = 1, String = 2, Number = 3, Placeholder = 4 };
+
+    void put(char c) noexcept {
+        if (c == '\0') push('\0');
+        push(c);
+        _spaced = false;
+    }
+
+    // Bytes mapped through a table that never yields zero
+    void put(const char* text, std::size_t size, const char* map) noexcept {
+        while (size > 0) {
+            if (_size == sizeof(_buffer)) flush();
+            const std::size_t room = std::min(size, sizeof(_buffer) - _size);
+            // Local pointers: char stores could alias the members
+            char* out = _buffer + _size;
+            const unsigned char* in =
+                reinterpret_cast<const unsigned char*>(text);
+            for (std::size_t i = 0; i < room; ++i) out[i] = map[in[i]];
+            _size += room;
+            text += room;
+            size -= room;
+        }
+        _spaced = false;
+    }
+
+    // Runs of whitespace and comments count once
+    void mark(Marker marker) noexcept {
+        if (marker == Space && _spaced) return;
+        push('\0');
+        push(marker);
+        _spaced = marker == Space;
+    }
+
+    std::uint64_t finish() noexcept {
+        flush();
+        // Final avalanche (MurmurHash3 fmix64)
+        std::uint64_t h = _hash ^ _total;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        return h ^ (h >> 33);
+    }
+
+   private:
+    void push(char c) noexcept {
+        if (_size == sizeof(_buffer)) flush();
+        _buffer[_size++] = c;
+    }
+
+    void flush() noexcept {
+        std::memset(_buffer + _size, 0, (8 - _size % 8) % 8);
+        for (std::size_t i = 0; i < _size; i += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, _buffer + i, 8);
+            _hash = (_hash ^ word) * 0x9e3779b97f4a7c15ULL;
+            _hash ^= _hash >> 32;
+        }
+        _total += _size;
+        _size = 0;
+    }
+
+    char _buffer[256];
+    std::size_t _size = 0;
+    std::uint64_t _total = 0;
+    std::uint64_t _hash = 0;
+    bool _spaced = false;
+};
+
+// End of a '...' literal starting at quote
+std::size_t skip_string(std::string_view sql, std::size_t quote) noexcept {
+    std::size_t i = quote + 1;
+    for (; i < sql.size(); ++i) {
+        if (sql[i] == '\\') {
+            ++i;
+        } else if (sql[i] == '\'') {
+            if (i + 1 < sql.size() && sql[i + 1] == '\'')
+                ++i;
+            else
+                return i + 1;
+        }
+    }
+    return sql.size();
+}
+
+// End of a number starting at i (sign, digits, fraction, exponent, hex)
+std::size_t skip_number(std::string_view sql, std::size_t i) noexcept {
+    const std::size_t n = sql.size();
+    if (sql[i] == '-' || sql[i] == '+') ++i;
+    if (i + 1 < n && sql[i] == '0' &&
+        (sql[i + 1] == 'x' || sql[i + 1] == 'X')) {
+        i += 2;
+        while (i < n && std::isxdigit(static_cast<unsigned char>(sql[i]))) ++i;
+        return i;
+    }
+    while (i < n && (digit(sql[i]) || sql[i] == '.' || sql[i] == '_')) ++i;
+    if (i < n && (sql[i] == 'e' || sql[i] == 'E')) {
+        std::size_t j = i + 1;
+        if (j < n && (sql[j] == '+' || sql[j] == '-')) ++j;
+        if (j < n && digit(sql[j])) {
+            i = j;
+            while (i < n && digit(sql[i])) ++i;
+        }
+    }
+    return i;
+}
+
+}  // namespace
+
+std::string SqlFingerprint::normalize(std::string_view sql) {
+    Builder out(sql.size());
+    const std::size_t n = sql.size();
+    std::size_t i = 0;
+    bool spaced = false;  // whitespace or a comment before the token
+
+    while (i < n) {
+        const char c = sql[i];
+        const char next = i + 1 < n ? sql[i + 1] : '\0';
+
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            spaced = true;
+            ++i;
+            continue;
+        }
+        if (c == '-' && next == '-') {
+            while (i < n && sql[i] != '\n') ++i;
+            spaced = true;
+            continue;
+        }
+        if (c == '/' && next == '*') {
+            const std::size_t end = sql.find("*/", i + 2);
+            i = end == std::string_view::npos ? n : end + 2;
+            spaced = true;
+            continue;
+        }
+
+        if (c == '\'') {
+            i = skip_string(sql, i);
+            out.add(Kind::Literal, "?", spaced);
+        } else if (c == '$' && digit(next)) {
+            // Placeholder
+            for (++i; i < n && digit(sql[i]);) ++i;
+            out.add(Kind::Literal, "?", spaced);
+        } else if (c == '$' && (next == '$' || alpha(next))) {
+            // Dollar quote $tag$...$tag$, or a word starting with '$'
+            std::size_t close = i + 1;
+            while (close < n && (alpha(sql[close]) || digit(sql[close])))
+                ++close;
+            if (close < n && sql[close] == '$') {
+                const std::string_view tag = sql.substr(i, close - i + 1);
+                const std::size_t end = sql.find(tag, close + 1);
+                i = end == std::string_view::npos ? n : end + tag.size();
+                out.add(Kind::Literal, "?", spaced);
+            } else {
+                out.add(Kind::Other, sql.substr(i, 1), spaced);
+                ++i;
+            }
+        } else if (c == '?') {
+            out.add(Kind::Literal, "?", spaced);
+            ++i;
+        } else if (digit(c) || (c == '.' && digit(next))) {
+            i = skip_number(sql, i);
+            out.add(Kind::Literal, "?", spaced);
+        } else if (c == '-' && (digit(next) || next == '.') &&
+                   out.last() != Kind::Word && out.last() != Kind::Literal &&
+                   out.last() != Kind::Close) {
+            // Negative number
+            i = skip_number(sql, i);
+            out.add(Kind::Literal, "?", spaced);
+        } else if (alpha(c)) {
+            const std::size_t start = i;
+            while (i < n && (alpha(sql[i]) || digit(sql[i]) || sql[i] == '$'))
+                ++i;
+            // Prefixed strings: E'..', B'..', X'..', N'..'
+            const bool prefix =
+                std::string_view("eEbBxXnN").find(c) != std::string_view::npos;
+            if (i - start == 1 && i < n && sql[i] == '\'' && prefix) {
+                i = skip_string(sql, i);
+                out.add(Kind::Literal, "?", spaced);
+            } else {
+                std::string word(sql.substr(start, i - start));
+                for (auto& ch : word)
+                    ch = static_cast<char>(
+                        std::tolower(static_cast<unsigned char>(ch)));
+                out.add(Kind::Word, word, spaced);
+            }
+        } else if (c == '"' || c == '`') {
+            // Quoted identifiers keep their case
+            const std::size_t end = sql.find(c, i + 1);
+            const std::size_t stop =
+                end == std::string_view::npos ? n : end + 1;
+            out.add(Kind::Word, sql.substr(i, stop - i), spaced);
+            i = stop;
+        } else if (c == '(' || c == '[') {
+            out.add(Kind::Open, sql.substr(i++, 1), spaced);
+        } else if (c == ')' || c == ']') {
+            out.add(Kind::Close, sql.substr(i++, 1), spaced);
+        } else if (c == ',') {
+            out.add(Kind::Comma, ",", spaced);
+            ++i;
+        } else if (c == '.') {
+            out.add(Kind::Dot, ".", spaced);
+            ++i;
+        } else if (c == ':' && next == ':') {
+            out.add(Kind::Cast, "::", spaced);
+            i += 2;
+        } else if (operator_char(c)) {
+            const std::size_t start = i;
+            while (i < n && operator_char(sql[i]) &&
+                   !(sql[i] == '-' && i + 1 < n && sql[i + 1] == '-') &&
+                   !(sql[i] == '/' && i + 1 < n && sql[i + 1] == '*'))
+                ++i;
+            out.add(Kind::Other, sql.substr(start, i - start), spaced);
+        } else {
+            out.add(Kind::Other, sql.substr(i++, 1), spaced);
+        }
+        spaced = false;
+    }
+    return out.take();
+}
+
+// 64-bit FNV-1a hash of the normalized text
+std::uint64_t SqlFingerprint::hash(std::string_view normalized) noexcept {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (char c : normalized) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Same decisions as normalize() about where literals, words, quoted
+// identifiers and comments start and end, so skipping a literal never
+// swallows text that normalize() keeps
+std::uint64_t SqlFingerprint::key(std::string_view sql) noexcept {
+    const KeyClasses& classes = key_classes();
+    auto is = [&classes](char c, unsigned char mask) noexcept {
+        return (classes.of[static_cast<unsigned char>(c)] & mask) != 0;
+    };
+
+    KeyHasher out;
+    const std::size_t n = sql.size();
+    std::size_t i = 0;
+
+    while (i < n) {
+        const char c = sql[i];
+        const char next = i + 1 < n ? sql[i + 1] : '\0';
+
+        if (is(c, KeyClasses::Alpha)) {
+            // Prefixed strings keep their letter, followed by the string
+            const std::size_t start = i;
+            while (++i < n && is(sql[i], KeyClasses::Word)) {
+            }
+            out.put(sql.data() + start, i - start, classes.lower);
+        } else if (is(c, KeyClasses::Space)) {
+            while (++i < n && is(sql[i], KeyClasses::Space)) {
+            }
+            out.mark(KeyHasher::Space);
+        } else if (is(c, KeyClasses::Digit) ||
+                   (c == '.' && is(next, KeyClasses::Digit))) {
+            i = skip_number(sql, i);
+            out.mark(KeyHasher::Number);
+        } else if (c == '\'') {
+            i = skip_string(sql, i);
+            out.mark(KeyHasher::String);
+        } else if (c == '-' && next == '-') {
+            while (i < n && sql[i] != '\n') ++i;
+            out.mark(KeyHasher::Space);
+        } else if (c == '/' && next == '*') {
+            const std::size_t end = sql.find("*/", i + 2);
+            i = end == std::string_view::npos ? n : end + 2;
+            out.mark(KeyHasher::Space);
+        } else if (c == '$' && is(next, KeyClasses::Digit)) {
+            while (++i < n && is(sql[i], KeyClasses::Digit)) {
+            }
+            out.mark(KeyHasher::Placeholder);
+        } else if (c == '$' && (next == '$' || alpha(next))) {
+            std::size_t close = i + 1;
+            while (close < n && (alpha(sql[close]) || digit(sql[close])))
+                ++close;
+            if (close < n && sql[close] == '$') {
+                const std::string_view tag = sql.substr(i, close - i + 1);
+                const std::size_t end = sql.find(tag, close + 1);
+                i = end == std::string_view::npos ? n : end + tag.size();
+                out.mark(KeyHasher::String);
+            } else {
+                out.put(c);
+                ++i;
+            }
+        } else if (c == '"' || c == '`') {
+            const std::size_t end = sql.find(c, i + 1);
+            const std::size_t stop =
+                end == std::string_view::npos ? n : end + 1;
+            for (; i < stop; ++i) out.put(sql[i]);
+        } else {
+            out.put(c);
+            ++i;
+        }
+    }
+    return out.finish();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// SqlFingerprint class - groups statements that differ only in their
+// constants, like pg_stat_statements. Literals (strings, numbers, dollar
+// quotes) and placeholders ($n, ?) become '?', lists of them inside
+// parentheses become "(...)", comments are dropped, whitespace collapses
+// and unquoted words are lowercased:
+//   SELECT * FROM t WHERE id IN (1, 2, 3) AND name = 'x'
+//   select * from t where id in (...) and name = ?
+class SqlFingerprint final {
+   public:
+    SqlFingerprint() = delete;
+    ~SqlFingerprint() = delete;
+
+    static std::string normalize(std::string_view sql);
+
+    // 64-bit FNV-1a hash of the normalized text
+    static std::uint64_t hash(std::string_view normalized) noexcept;
+
+    // Cheap hash of sql that ignores literal values, whitespace, comments
+    // and keyword case, for caching fingerprints. Statements with equal
+    // keys have equal fingerprints; one fingerprint can have several keys
+    // (literal lists of different lengths, spacing inside operators).
+    static std::uint64_t key(std::string_view sql) noexcept;
+};
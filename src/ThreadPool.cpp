@@ -0,0 +1,57 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t threads) : _stopping(false) {
+    threads = std::max<std::size_t>(threads, 1);
+    _workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+        _workers.emplace_back([this] { run(); });
+}
+
+// Finishes queued tasks, then joins the workers
+ThreadPool::~ThreadPool() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _ready.notify_all();
+    for (auto& worker : _workers)
+        if (worker.joinable()) worker.join();
+}
+
+// Queue task without a result
+void ThreadPool::post(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    _ready.notify_one();
+}
+
+std::size_t ThreadPool::size() const noexcept { return _workers.size(); }
+
+// Process-wide pool sized to the hardware concurrency
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool(std::thread::hardware_concurrency());
+    return pool;
+}
+
+void ThreadPool::run() noexcept {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _ready.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+            if (_tasks.empty()) return;
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+        try {
+            task();
+        } catch (...) {
+            // Tasks report failures through their futures
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed-size worker pool running submitted tasks in FIFO order
+class ThreadPool final {
+   public:
+    explicit ThreadPool(std::size_t threads);
+
+    ThreadPool(const ThreadPool&) noexcept = delete;
+    ThreadPool& operator=(const ThreadPool&) noexcept = delete;
+    ThreadPool(ThreadPool&&) noexcept = delete;
+    ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+    // Finishes queued tasks, then joins the workers
+    ~ThreadPool() noexcept;
+
+    // Queue task, returns a future of its result
+    template <typename Fn>
+    std::future<std::invoke_result_t<Fn>> submit(Fn&& fn) {
+        using Result = std::invoke_result_t<Fn>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+            std::forward<Fn>(fn));
+        auto future = task->get_future();
+        post([task] { (*task)(); });
+        return future;
+    }
+
+    // Queue task without a result
+    void post(std::function<void()> task);
+
+    std::size_t size() const noexcept;
+
+    // Process-wide pool sized to the hardware concurrency
+    static ThreadPool& shared();
+
+   private:
+    void run() noexcept;
+
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _tasks;
+    std::mutex _mutex;
+    std::condition_variable _ready;
+    bool _stopping;
+};